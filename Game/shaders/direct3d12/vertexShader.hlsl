@@ -14,25 +14,23 @@ struct pixelShaderInput
 	float2 uv : TEXCOORD;
 };
 
-cbuffer objectConstants : register(b0, space0)
+// Matches sInstanceData in direct3D12Graphics.cpp
+struct instanceData
 {
-    float4x4 wvpMatrix =
-    { 
-		1, 0, 0, 0,
-		0, 1, 0, 0,
-		0, 0, 1, 0,
-		0, 0, 0, 1
-	};
-}
+    float4x4 wvpMatrix;
+};
+
+// Bound at the first instance of each draw
+StructuredBuffer<instanceData> instances : register(t0, space0);
 
 cbuffer cameraConstants : register(b1, space0)
 {
 }
 
-pixelShaderInput main(vertexShaderInput input)
+pixelShaderInput main(vertexShaderInput input, uint instanceId : SV_InstanceID)
 {
     pixelShaderInput output;
-    output.projectionPosition = mul(float4(input.localPosition, 1.0f), wvpMatrix);
+    output.projectionPosition = mul(float4(input.localPosition, 1.0f), instances[instanceId].wvpMatrix);
 	output.normal = input.normal;
 	output.color = input.color;
 	output.uv = input.uv;
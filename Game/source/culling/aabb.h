@@ -0,0 +1,54 @@
+#pragma once
+
+// Axis aligned bounding box stored as minimum and maximum corners
+struct sAabb
+{
+	float min[3] = {};
+	float max[3] = {};
+
+	static sAabb fromCenterExtents(const float centerX, const float centerY, const float centerZ, const float extentX, const float extentY, const float extentZ)
+	{
+		sAabb result;
+		result.min[0] = centerX - extentX;
+		result.min[1] = centerY - extentY;
+		result.min[2] = centerZ - extentZ;
+		result.max[0] = centerX + extentX;
+		result.max[1] = centerY + extentY;
+		result.max[2] = centerZ + extentZ;
+		return result;
+	}
+
+	static sAabb combine(const sAabb& a, const sAabb& b)
+	{
+		sAabb result;
+		for (size_t i = 0; i < 3; ++i)
+		{
+			result.min[i] = std::min(a.min[i], b.min[i]);
+			result.max[i] = std::max(a.max[i], b.max[i]);
+		}
+		return result;
+	}
+
+	static bool overlaps(const sAabb& a, const sAabb& b)
+	{
+		return (a.min[0] <= b.max[0]) && (a.max[0] >= b.min[0]) &&
+			(a.min[1] <= b.max[1]) && (a.max[1] >= b.min[1]) &&
+			(a.min[2] <= b.max[2]) && (a.max[2] >= b.min[2]);
+	}
+
+	// Returns true if b is entirely inside this box
+	bool contains(const sAabb& b) const
+	{
+		return (min[0] <= b.min[0]) && (min[1] <= b.min[1]) && (min[2] <= b.min[2]) &&
+			(max[0] >= b.max[0]) && (max[1] >= b.max[1]) && (max[2] >= b.max[2]);
+	}
+
+	// Surface area used as the insertion cost heuristic
+	float surfaceArea() const
+	{
+		const float x = max[0] - min[0];
+		const float y = max[1] - min[1];
+		const float z = max[2] - min[2];
+		return 2.0f * ((x * y) + (y * z) + (z * x));
+	}
+};
\ No newline at end of file
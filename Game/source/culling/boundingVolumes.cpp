@@ -0,0 +1,106 @@
+#include "pch.h"
+#include "boundingVolumes.h"
+#include "math/vector3f.h"
+
+template <typename T>
+static void removeSwapElement(std::vector<T>& values, const uint32_t index)
+{
+	values[index] = values.back();
+	values.pop_back();
+}
+
+uint32_t sBoundingSpheres::add(const vector3f& center, const float inRadius)
+{
+	centerX.push_back(center.x);
+	centerY.push_back(center.y);
+	centerZ.push_back(center.z);
+	radius.push_back(inRadius);
+	return size() - 1;
+}
+
+void sBoundingSpheres::set(const uint32_t index, const vector3f& center, const float inRadius)
+{
+	centerX[index] = center.x;
+	centerY[index] = center.y;
+	centerZ[index] = center.z;
+	radius[index] = inRadius;
+}
+
+uint32_t sBoundingSpheres::removeSwap(const uint32_t index)
+{
+	const uint32_t movedIndex = size() - 1;
+	removeSwapElement(centerX, index);
+	removeSwapElement(centerY, index);
+	removeSwapElement(centerZ, index);
+	removeSwapElement(radius, index);
+	return movedIndex;
+}
+
+void sBoundingSpheres::reserve(const size_t capacity)
+{
+	centerX.reserve(capacity);
+	centerY.reserve(capacity);
+	centerZ.reserve(capacity);
+	radius.reserve(capacity);
+}
+
+void sBoundingSpheres::clear()
+{
+	centerX.clear();
+	centerY.clear();
+	centerZ.clear();
+	radius.clear();
+}
+
+uint32_t sBoundingBoxes::add(const vector3f& center, const vector3f& halfExtents)
+{
+	centerX.push_back(center.x);
+	centerY.push_back(center.y);
+	centerZ.push_back(center.z);
+	extentX.push_back(halfExtents.x);
+	extentY.push_back(halfExtents.y);
+	extentZ.push_back(halfExtents.z);
+	return size() - 1;
+}
+
+void sBoundingBoxes::set(const uint32_t index, const vector3f& center, const vector3f& halfExtents)
+{
+	centerX[index] = center.x;
+	centerY[index] = center.y;
+	centerZ[index] = center.z;
+	extentX[index] = halfExtents.x;
+	extentY[index] = halfExtents.y;
+	extentZ[index] = halfExtents.z;
+}
+
+uint32_t sBoundingBoxes::removeSwap(const uint32_t index)
+{
+	const uint32_t movedIndex = size() - 1;
+	removeSwapElement(centerX, index);
+	removeSwapElement(centerY, index);
+	removeSwapElement(centerZ, index);
+	removeSwapElement(extentX, index);
+	removeSwapElement(extentY, index);
+	removeSwapElement(extentZ, index);
+	return movedIndex;
+}
+
+void sBoundingBoxes::reserve(const size_t capacity)
+{
+	centerX.reserve(capacity);
+	centerY.reserve(capacity);
+	centerZ.reserve(capacity);
+	extentX.reserve(capacity);
+	extentY.reserve(capacity);
+	extentZ.reserve(capacity);
+}
+
+void sBoundingBoxes::clear()
+{
+	centerX.clear();
+	centerY.clear();
+	centerZ.clear();
+	extentX.clear();
+	extentY.clear();
+	extentZ.clear();
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+class vector3f;
+
+// Structure of arrays storage for bounding spheres. Index i of every array describes object i
+struct sBoundingSpheres
+{
+	std::vector<float> centerX;
+	std::vector<float> centerY;
+	std::vector<float> centerZ;
+	std::vector<float> radius;
+
+	// Appends a sphere and returns its index
+	uint32_t add(const vector3f& center, const float inRadius);
+	void set(const uint32_t index, const vector3f& center, const float inRadius);
+
+	// Moves the last sphere into index. Returns the previous index of the moved sphere so callers can patch their references
+	uint32_t removeSwap(const uint32_t index);
+
+	void reserve(const size_t capacity);
+	void clear();
+	uint32_t size() const { return static_cast<uint32_t>(radius.size()); }
+};
+
+// Structure of arrays storage for axis aligned bounding boxes stored as center and half extents
+struct sBoundingBoxes
+{
+	std::vector<float> centerX;
+	std::vector<float> centerY;
+	std::vector<float> centerZ;
+	std::vector<float> extentX;
+	std::vector<float> extentY;
+	std::vector<float> extentZ;
+
+	// Appends a box and returns its index
+	uint32_t add(const vector3f& center, const vector3f& halfExtents);
+	void set(const uint32_t index, const vector3f& center, const vector3f& halfExtents);
+
+	// Moves the last box into index. Returns the previous index of the moved box so callers can patch their references
+	uint32_t removeSwap(const uint32_t index);
+
+	void reserve(const size_t capacity);
+	void clear();
+	uint32_t size() const { return static_cast<uint32_t>(extentX.size()); }
+};
\ No newline at end of file
@@ -0,0 +1,303 @@
+#include "pch.h"
+#include "culling.h"
+#include "frustum.h"
+#include "boundingVolumes.h"
+#include "jobs/jobSystem.h"
+#include "math/mathSimd.h"
+
+#include <bit>
+
+// Tests volumes [begin, end) and writes visible indices from outVisibleIndices[0]. Returns the visible count
+template <typename T>
+using cullRangeFunction = uint32_t(*)(const sFrustum& frustum, const T& volumes, const uint32_t begin, const uint32_t end, uint32_t* outVisibleIndices);
+
+static uint32_t cullSpheresScalarRange(const sFrustum& frustum, const sBoundingSpheres& spheres, const uint32_t begin, const uint32_t end, uint32_t* outVisibleIndices)
+{
+	uint32_t visibleCount = 0;
+	for (uint32_t i = begin; i < end; ++i)
+	{
+		const float negativeRadius = -spheres.radius[i];
+		bool inside = true;
+		for (size_t p = 0; p < sFrustum::ePlane::count; ++p)
+		{
+			const float* const plane = frustum.planes[p];
+			const float distance = ((spheres.centerX[i] * plane[0]) + (spheres.centerY[i] * plane[1])) + ((spheres.centerZ[i] * plane[2]) + plane[3]);
+			inside &= (distance >= negativeRadius);
+		}
+
+		// Write unconditionally and advance only when visible to avoid a branch per object
+		outVisibleIndices[visibleCount] = i;
+		visibleCount += inside ? 1 : 0;
+	}
+	return visibleCount;
+}
+
+static uint32_t cullBoxesScalarRange(const sFrustum& frustum, const sBoundingBoxes& boxes, const uint32_t begin, const uint32_t end, uint32_t* outVisibleIndices)
+{
+	uint32_t visibleCount = 0;
+	for (uint32_t i = begin; i < end; ++i)
+	{
+		bool inside = true;
+		for (size_t p = 0; p < sFrustum::ePlane::count; ++p)
+		{
+			// Projected radius of the box onto the plane normal
+			const float* const plane = frustum.planes[p];
+			const float distance = ((boxes.centerX[i] * plane[0]) + (boxes.centerY[i] * plane[1])) + ((boxes.centerZ[i] * plane[2]) + plane[3]);
+			const float radius = ((boxes.extentX[i] * std::abs(plane[0])) + (boxes.extentY[i] * std::abs(plane[1]))) + (boxes.extentZ[i] * std::abs(plane[2]));
+			inside &= (distance >= -radius);
+		}
+
+		outVisibleIndices[visibleCount] = i;
+		visibleCount += inside ? 1 : 0;
+	}
+	return visibleCount;
+}
+
+#if defined(MATH_SIMD_SSE)
+// Appends the indices of the set bits in visibleMask, offset by firstIndex
+static inline uint32_t writeVisibleIndices(uint32_t visibleMask, const uint32_t firstIndex, uint32_t* outVisibleIndices)
+{
+	uint32_t visibleCount = 0;
+	while (visibleMask != 0)
+	{
+		outVisibleIndices[visibleCount++] = firstIndex + static_cast<uint32_t>(std::countr_zero(visibleMask));
+		visibleMask &= visibleMask - 1;
+	}
+	return visibleCount;
+}
+
+static uint32_t cullSpheresSse(const sFrustum& frustum, const sBoundingSpheres& spheres, const uint32_t begin, const uint32_t end, uint32_t* outVisibleIndices)
+{
+	__m128 planes[sFrustum::ePlane::count][4];
+	for (size_t p = 0; p < sFrustum::ePlane::count; ++p)
+	{
+		for (size_t i = 0; i < 4; ++i)
+		{
+			planes[p][i] = _mm_set1_ps(frustum.planes[p][i]);
+		}
+	}
+
+	uint32_t visibleCount = 0;
+	const uint32_t simdEnd = begin + ((end - begin) & ~3u);
+	for (uint32_t i = begin; i < simdEnd; i += 4)
+	{
+		const __m128 x = _mm_loadu_ps(&spheres.centerX[i]);
+		const __m128 y = _mm_loadu_ps(&spheres.centerY[i]);
+		const __m128 z = _mm_loadu_ps(&spheres.centerZ[i]);
+		const __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&spheres.radius[i]));
+
+		__m128 inside = _mm_cmpeq_ps(x, x);
+		for (size_t p = 0; p < sFrustum::ePlane::count; ++p)
+		{
+			const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, planes[p][0]), _mm_mul_ps(y, planes[p][1])), _mm_add_ps(_mm_mul_ps(z, planes[p][2]), planes[p][3]));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+		}
+
+		visibleCount += writeVisibleIndices(static_cast<uint32_t>(_mm_movemask_ps(inside)), i, &outVisibleIndices[visibleCount]);
+	}
+
+	return visibleCount + cullSpheresScalarRange(frustum, spheres, simdEnd, end, &outVisibleIndices[visibleCount]);
+}
+
+static uint32_t cullBoxesSse(const sFrustum& frustum, const sBoundingBoxes& boxes, const uint32_t begin, const uint32_t end, uint32_t* outVisibleIndices)
+{
+	__m128 planes[sFrustum::ePlane::count][4];
+	__m128 absolutePlanes[sFrustum::ePlane::count][3];
+	for (size_t p = 0; p < sFrustum::ePlane::count; ++p)
+	{
+		for (size_t i = 0; i < 4; ++i)
+		{
+			planes[p][i] = _mm_set1_ps(frustum.planes[p][i]);
+		}
+
+		for (size_t i = 0; i < 3; ++i)
+		{
+			absolutePlanes[p][i] = _mm_set1_ps(std::abs(frustum.planes[p][i]));
+		}
+	}
+
+	uint32_t visibleCount = 0;
+	const uint32_t simdEnd = begin + ((end - begin) & ~3u);
+	for (uint32_t i = begin; i < simdEnd; i += 4)
+	{
+		const __m128 x = _mm_loadu_ps(&boxes.centerX[i]);
+		const __m128 y = _mm_loadu_ps(&boxes.centerY[i]);
+		const __m128 z = _mm_loadu_ps(&boxes.centerZ[i]);
+		const __m128 extentX = _mm_loadu_ps(&boxes.extentX[i]);
+		const __m128 extentY = _mm_loadu_ps(&boxes.extentY[i]);
+		const __m128 extentZ = _mm_loadu_ps(&boxes.extentZ[i]);
+
+		__m128 inside = _mm_cmpeq_ps(x, x);
+		for (size_t p = 0; p < sFrustum::ePlane::count; ++p)
+		{
+			const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, planes[p][0]), _mm_mul_ps(y, planes[p][1])), _mm_add_ps(_mm_mul_ps(z, planes[p][2]), planes[p][3]));
+			const __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(extentX, absolutePlanes[p][0]), _mm_mul_ps(extentY, absolutePlanes[p][1])), _mm_mul_ps(extentZ, absolutePlanes[p][2]));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_sub_ps(_mm_setzero_ps(), radius)));
+		}
+
+		visibleCount += writeVisibleIndices(static_cast<uint32_t>(_mm_movemask_ps(inside)), i, &outVisibleIndices[visibleCount]);
+	}
+
+	return visibleCount + cullBoxesScalarRange(frustum, boxes, simdEnd, end, &outVisibleIndices[visibleCount]);
+}
+
+MATH_SIMD_TARGET_AVX2 static uint32_t cullSpheresAvx2(const sFrustum& frustum, const sBoundingSpheres& spheres, const uint32_t begin, const uint32_t end, uint32_t* outVisibleIndices)
+{
+	__m256 planes[sFrustum::ePlane::count][4];
+	for (size_t p = 0; p < sFrustum::ePlane::count; ++p)
+	{
+		for (size_t i = 0; i < 4; ++i)
+		{
+			planes[p][i] = _mm256_set1_ps(frustum.planes[p][i]);
+		}
+	}
+
+	uint32_t visibleCount = 0;
+	const uint32_t simdEnd = begin + ((end - begin) & ~7u);
+	for (uint32_t i = begin; i < simdEnd; i += 8)
+	{
+		const __m256 x = _mm256_loadu_ps(&spheres.centerX[i]);
+		const __m256 y = _mm256_loadu_ps(&spheres.centerY[i]);
+		const __m256 z = _mm256_loadu_ps(&spheres.centerZ[i]);
+		const __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&spheres.radius[i]));
+
+		// Plain multiply and add rather than fma so results match the scalar reference exactly
+		__m256 inside = _mm256_cmp_ps(x, x, _CMP_EQ_OQ);
+		for (size_t p = 0; p < sFrustum::ePlane::count; ++p)
+		{
+			const __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, planes[p][0]), _mm256_mul_ps(y, planes[p][1])), _mm256_add_ps(_mm256_mul_ps(z, planes[p][2]), planes[p][3]));
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+		}
+
+		visibleCount += writeVisibleIndices(static_cast<uint32_t>(_mm256_movemask_ps(inside)), i, &outVisibleIndices[visibleCount]);
+	}
+
+	return visibleCount + cullSpheresScalarRange(frustum, spheres, simdEnd, end, &outVisibleIndices[visibleCount]);
+}
+
+MATH_SIMD_TARGET_AVX2 static uint32_t cullBoxesAvx2(const sFrustum& frustum, const sBoundingBoxes& boxes, const uint32_t begin, const uint32_t end, uint32_t* outVisibleIndices)
+{
+	__m256 planes[sFrustum::ePlane::count][4];
+	__m256 absolutePlanes[sFrustum::ePlane::count][3];
+	for (size_t p = 0; p < sFrustum::ePlane::count; ++p)
+	{
+		for (size_t i = 0; i < 4; ++i)
+		{
+			planes[p][i] = _mm256_set1_ps(frustum.planes[p][i]);
+		}
+
+		for (size_t i = 0; i < 3; ++i)
+		{
+			absolutePlanes[p][i] = _mm256_set1_ps(std::abs(frustum.planes[p][i]));
+		}
+	}
+
+	uint32_t visibleCount = 0;
+	const uint32_t simdEnd = begin + ((end - begin) & ~7u);
+	for (uint32_t i = begin; i < simdEnd; i += 8)
+	{
+		const __m256 x = _mm256_loadu_ps(&boxes.centerX[i]);
+		const __m256 y = _mm256_loadu_ps(&boxes.centerY[i]);
+		const __m256 z = _mm256_loadu_ps(&boxes.centerZ[i]);
+		const __m256 extentX = _mm256_loadu_ps(&boxes.extentX[i]);
+		const __m256 extentY = _mm256_loadu_ps(&boxes.extentY[i]);
+		const __m256 extentZ = _mm256_loadu_ps(&boxes.extentZ[i]);
+
+		__m256 inside = _mm256_cmp_ps(x, x, _CMP_EQ_OQ);
+		for (size_t p = 0; p < sFrustum::ePlane::count; ++p)
+		{
+			const __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, planes[p][0]), _mm256_mul_ps(y, planes[p][1])), _mm256_add_ps(_mm256_mul_ps(z, planes[p][2]), planes[p][3]));
+			const __m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(extentX, absolutePlanes[p][0]), _mm256_mul_ps(extentY, absolutePlanes[p][1])), _mm256_mul_ps(extentZ, absolutePlanes[p][2]));
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_sub_ps(_mm256_setzero_ps(), radius), _CMP_GE_OQ));
+		}
+
+		visibleCount += writeVisibleIndices(static_cast<uint32_t>(_mm256_movemask_ps(inside)), i, &outVisibleIndices[visibleCount]);
+	}
+
+	return visibleCount + cullBoxesScalarRange(frustum, boxes, simdEnd, end, &outVisibleIndices[visibleCount]);
+}
+#endif // defined(MATH_SIMD_SSE)
+
+static cullRangeFunction<sBoundingSpheres> getSphereKernel()
+{
+#if defined(MATH_SIMD_SSE)
+	static const cullRangeFunction<sBoundingSpheres> kernel = sCpuFeatures::get().avx2 ? &cullSpheresAvx2 : &cullSpheresSse;
+	return kernel;
+#else
+	return &cullSpheresScalarRange;
+#endif // defined(MATH_SIMD_SSE)
+}
+
+static cullRangeFunction<sBoundingBoxes> getBoxKernel()
+{
+#if defined(MATH_SIMD_SSE)
+	static const cullRangeFunction<sBoundingBoxes> kernel = sCpuFeatures::get().avx2 ? &cullBoxesAvx2 : &cullBoxesSse;
+	return kernel;
+#else
+	return &cullBoxesScalarRange;
+#endif // defined(MATH_SIMD_SSE)
+}
+
+template <typename T>
+static uint32_t cullParallel(const sFrustum& frustum, const T& volumes, const uint32_t minChunkSize, cullRangeFunction<T> kernel, uint32_t* outVisibleIndices)
+{
+	const uint32_t volumeCount = volumes.size();
+	const uint32_t maxChunkCount = jobSystem::getThreadCount();
+	const uint32_t chunkCount = std::clamp((volumeCount + std::max(minChunkSize, 1u) - 1) / std::max(minChunkSize, 1u), 1u, maxChunkCount);
+	if (chunkCount == 1)
+	{
+		return kernel(frustum, volumes, 0, volumeCount, outVisibleIndices);
+	}
+
+	// Each chunk writes its visible indices from its own first index so chunks never overlap, then the lists are packed together
+	const uint32_t chunkSize = (volumeCount + chunkCount - 1) / chunkCount;
+	std::vector<uint32_t> chunkVisibleCounts(chunkCount, 0);
+	jobSystem::parallelFor(chunkCount, 1, [&](const uint32_t firstChunk, const uint32_t lastChunk)
+		{
+			for (uint32_t chunk = firstChunk; chunk < lastChunk; ++chunk)
+			{
+				const uint32_t begin = std::min(chunk * chunkSize, volumeCount);
+				const uint32_t end = std::min(begin + chunkSize, volumeCount);
+				chunkVisibleCounts[chunk] = kernel(frustum, volumes, begin, end, &outVisibleIndices[begin]);
+			}
+		});
+
+	uint32_t visibleCount = chunkVisibleCounts[0];
+	for (uint32_t chunk = 1; chunk < chunkCount; ++chunk)
+	{
+		const uint32_t begin = std::min(chunk * chunkSize, volumeCount);
+		memmove(&outVisibleIndices[visibleCount], &outVisibleIndices[begin], sizeof(uint32_t) * chunkVisibleCounts[chunk]);
+		visibleCount += chunkVisibleCounts[chunk];
+	}
+	return visibleCount;
+}
+
+uint32_t culling::cullSpheres(const sFrustum& frustum, const sBoundingSpheres& spheres, uint32_t* outVisibleIndices)
+{
+	return getSphereKernel()(frustum, spheres, 0, spheres.size(), outVisibleIndices);
+}
+
+uint32_t culling::cullBoxes(const sFrustum& frustum, const sBoundingBoxes& boxes, uint32_t* outVisibleIndices)
+{
+	return getBoxKernel()(frustum, boxes, 0, boxes.size(), outVisibleIndices);
+}
+
+uint32_t culling::cullSpheresParallel(const sFrustum& frustum, const sBoundingSpheres& spheres, const uint32_t minChunkSize, uint32_t* outVisibleIndices)
+{
+	return cullParallel(frustum, spheres, minChunkSize, getSphereKernel(), outVisibleIndices);
+}
+
+uint32_t culling::cullBoxesParallel(const sFrustum& frustum, const sBoundingBoxes& boxes, const uint32_t minChunkSize, uint32_t* outVisibleIndices)
+{
+	return cullParallel(frustum, boxes, minChunkSize, getBoxKernel(), outVisibleIndices);
+}
+
+uint32_t culling::cullSpheresScalar(const sFrustum& frustum, const sBoundingSpheres& spheres, uint32_t* outVisibleIndices)
+{
+	return cullSpheresScalarRange(frustum, spheres, 0, spheres.size(), outVisibleIndices);
+}
+
+uint32_t culling::cullBoxesScalar(const sFrustum& frustum, const sBoundingBoxes& boxes, uint32_t* outVisibleIndices)
+{
+	return cullBoxesScalarRange(frustum, boxes, 0, boxes.size(), outVisibleIndices);
+}
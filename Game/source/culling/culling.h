@@ -0,0 +1,27 @@
+#pragma once
+
+struct sFrustum;
+struct sBoundingSpheres;
+struct sBoundingBoxes;
+
+// Tests structure of arrays bounding volumes against a frustum and writes a compact list of the visible object indices.
+// Volumes intersecting a plane count as visible. outVisibleIndices must have room for every volume in the input
+class culling
+{
+public:
+	// Returns the number of visible spheres written to outVisibleIndices
+	static uint32_t cullSpheres(const sFrustum& frustum, const sBoundingSpheres& spheres, uint32_t* outVisibleIndices);
+
+	// Returns the number of visible boxes written to outVisibleIndices
+	static uint32_t cullBoxes(const sFrustum& frustum, const sBoundingBoxes& boxes, uint32_t* outVisibleIndices);
+
+	// Splits the spheres into chunks of at least minChunkSize tested on job system threads. The visible list is in ascending index order
+	static uint32_t cullSpheresParallel(const sFrustum& frustum, const sBoundingSpheres& spheres, const uint32_t minChunkSize, uint32_t* outVisibleIndices);
+
+	// Splits the boxes into chunks of at least minChunkSize tested on job system threads. The visible list is in ascending index order
+	static uint32_t cullBoxesParallel(const sFrustum& frustum, const sBoundingBoxes& boxes, const uint32_t minChunkSize, uint32_t* outVisibleIndices);
+
+	// Reference implementations used to validate the simd paths
+	static uint32_t cullSpheresScalar(const sFrustum& frustum, const sBoundingSpheres& spheres, uint32_t* outVisibleIndices);
+	static uint32_t cullBoxesScalar(const sFrustum& frustum, const sBoundingBoxes& boxes, uint32_t* outVisibleIndices);
+};
\ No newline at end of file
@@ -0,0 +1,396 @@
+#include "pch.h"
+#include "dynamicAabbTree.h"
+
+int32_t dynamicAabbTree::createProxy(const sAabb& aabb, const uint32_t userData)
+{
+	const int32_t proxyId = allocateNode();
+
+	sNode& node = nodes[proxyId];
+	for (size_t i = 0; i < 3; ++i)
+	{
+		node.aabb.min[i] = aabb.min[i] - aabbMargin;
+		node.aabb.max[i] = aabb.max[i] + aabbMargin;
+	}
+	node.userData = userData;
+	node.height = 0;
+
+	insertLeaf(proxyId);
+	++proxyCount;
+	return proxyId;
+}
+
+void dynamicAabbTree::destroyProxy(const int32_t proxyId)
+{
+	assert(nodes[proxyId].isLeaf());
+	removeLeaf(proxyId);
+	freeNode(proxyId);
+	--proxyCount;
+}
+
+bool dynamicAabbTree::moveProxy(const int32_t proxyId, const sAabb& aabb, const float displacement[3])
+{
+	assert(nodes[proxyId].isLeaf());
+
+	// Extend the fat aabb in the direction of motion so a steadily moving proxy is reinserted less often
+	sAabb fatAabb;
+	for (size_t i = 0; i < 3; ++i)
+	{
+		fatAabb.min[i] = aabb.min[i] - aabbMargin;
+		fatAabb.max[i] = aabb.max[i] + aabbMargin;
+
+		const float predictedDisplacement = displacementMultiplier * displacement[i];
+		if (predictedDisplacement < 0.0f)
+		{
+			fatAabb.min[i] += predictedDisplacement;
+		}
+		else
+		{
+			fatAabb.max[i] += predictedDisplacement;
+		}
+	}
+
+	const sAabb& treeAabb = nodes[proxyId].aabb;
+	if (treeAabb.contains(aabb))
+	{
+		// The proxy still fits. Keep it unless the fat aabb has grown much larger than needed, e.g. a fast object that stopped
+		sAabb hugeAabb;
+		for (size_t i = 0; i < 3; ++i)
+		{
+			hugeAabb.min[i] = fatAabb.min[i] - (4.0f * aabbMargin);
+			hugeAabb.max[i] = fatAabb.max[i] + (4.0f * aabbMargin);
+		}
+
+		if (hugeAabb.contains(treeAabb))
+		{
+			return false;
+		}
+	}
+
+	removeLeaf(proxyId);
+	nodes[proxyId].aabb = fatAabb;
+	insertLeaf(proxyId);
+	return true;
+}
+
+int32_t dynamicAabbTree::getHeight() const
+{
+	return (root == nullNode) ? 0 : nodes[root].height;
+}
+
+float dynamicAabbTree::getAreaRatio() const
+{
+	if (root == nullNode)
+	{
+		return 0.0f;
+	}
+
+	float totalArea = 0.0f;
+	for (const sNode& node : nodes)
+	{
+		if (node.height >= 0)
+		{
+			totalArea += node.aabb.surfaceArea();
+		}
+	}
+
+	return totalArea / nodes[root].aabb.surfaceArea();
+}
+
+void dynamicAabbTree::clear()
+{
+	nodes.clear();
+	root = nullNode;
+	freeList = nullNode;
+	proxyCount = 0;
+}
+
+void dynamicAabbTree::reserve(const size_t proxyCapacity)
+{
+	// A binary tree with n leaves has n - 1 internal nodes
+	nodes.reserve(std::max<size_t>(proxyCapacity * 2, 1) - 1);
+}
+
+int32_t dynamicAabbTree::allocateNode()
+{
+	if (freeList == nullNode)
+	{
+		// Growing the pool may move nodes so callers must not hold node references across allocations
+		nodes.emplace_back();
+		return static_cast<int32_t>(nodes.size() - 1);
+	}
+
+	const int32_t nodeId = freeList;
+	sNode& node = nodes[nodeId];
+	freeList = node.parentOrNext;
+	node = sNode();
+	return nodeId;
+}
+
+void dynamicAabbTree::freeNode(const int32_t nodeId)
+{
+	sNode& node = nodes[nodeId];
+	node.parentOrNext = freeList;
+	node.child1 = nullNode;
+	node.child2 = nullNode;
+	node.height = -1;
+	freeList = nodeId;
+}
+
+void dynamicAabbTree::insertLeaf(const int32_t leaf)
+{
+	if (root == nullNode)
+	{
+		root = leaf;
+		nodes[root].parentOrNext = nullNode;
+		return;
+	}
+
+	// Descend to the sibling that minimizes the surface area cost of the new parent plus the growth of every ancestor
+	const sAabb leafAabb = nodes[leaf].aabb;
+	int32_t index = root;
+	while (!nodes[index].isLeaf())
+	{
+		const sNode& node = nodes[index];
+		const float area = node.aabb.surfaceArea();
+		const float combinedArea = sAabb::combine(node.aabb, leafAabb).surfaceArea();
+
+		// Cost of creating a new parent for this node and the new leaf
+		const float cost = 2.0f * combinedArea;
+
+		// Minimum cost of pushing the leaf further down the tree
+		const float inheritanceCost = 2.0f * (combinedArea - area);
+
+		const auto descendCost = [&](const int32_t child)
+		{
+			const sNode& childNode = nodes[child];
+			const float newArea = sAabb::combine(leafAabb, childNode.aabb).surfaceArea();
+			return childNode.isLeaf() ? (newArea + inheritanceCost) : ((newArea - childNode.aabb.surfaceArea()) + inheritanceCost);
+		};
+
+		const float cost1 = descendCost(node.child1);
+		const float cost2 = descendCost(node.child2);
+		if ((cost < cost1) && (cost < cost2))
+		{
+			break;
+		}
+
+		index = (cost1 < cost2) ? node.child1 : node.child2;
+	}
+
+	const int32_t sibling = index;
+
+	// Create a new parent holding the sibling and the leaf
+	const int32_t newParent = allocateNode();
+	const int32_t oldParent = nodes[sibling].parentOrNext;
+	sNode& parentNode = nodes[newParent];
+	parentNode.parentOrNext = oldParent;
+	parentNode.aabb = sAabb::combine(leafAabb, nodes[sibling].aabb);
+	parentNode.height = nodes[sibling].height + 1;
+	parentNode.child1 = sibling;
+	parentNode.child2 = leaf;
+
+	if (oldParent != nullNode)
+	{
+		sNode& oldParentNode = nodes[oldParent];
+		if (oldParentNode.child1 == sibling)
+		{
+			oldParentNode.child1 = newParent;
+		}
+		else
+		{
+			oldParentNode.child2 = newParent;
+		}
+	}
+	else
+	{
+		root = newParent;
+	}
+
+	nodes[sibling].parentOrNext = newParent;
+	nodes[leaf].parentOrNext = newParent;
+
+	refitAncestors(nodes[leaf].parentOrNext);
+}
+
+void dynamicAabbTree::removeLeaf(const int32_t leaf)
+{
+	if (leaf == root)
+	{
+		root = nullNode;
+		return;
+	}
+
+	const int32_t parent = nodes[leaf].parentOrNext;
+	const int32_t grandParent = nodes[parent].parentOrNext;
+	const int32_t sibling = (nodes[parent].child1 == leaf) ? nodes[parent].child2 : nodes[parent].child1;
+
+	if (grandParent != nullNode)
+	{
+		// Replace the parent with the sibling
+		sNode& grandParentNode = nodes[grandParent];
+		if (grandParentNode.child1 == parent)
+		{
+			grandParentNode.child1 = sibling;
+		}
+		else
+		{
+			grandParentNode.child2 = sibling;
+		}
+		nodes[sibling].parentOrNext = grandParent;
+		freeNode(parent);
+
+		refitAncestors(grandParent);
+	}
+	else
+	{
+		root = sibling;
+		nodes[sibling].parentOrNext = nullNode;
+		freeNode(parent);
+	}
+}
+
+void dynamicAabbTree::refitAncestors(int32_t nodeId)
+{
+	while (nodeId != nullNode)
+	{
+		nodeId = balance(nodeId);
+
+		sNode& node = nodes[nodeId];
+		const sNode& child1 = nodes[node.child1];
+		const sNode& child2 = nodes[node.child2];
+		node.height = 1 + std::max(child1.height, child2.height);
+		node.aabb = sAabb::combine(child1.aabb, child2.aabb);
+
+		nodeId = node.parentOrNext;
+	}
+}
+
+int32_t dynamicAabbTree::balance(const int32_t a)
+{
+	sNode& nodeA = nodes[a];
+	if (nodeA.isLeaf() || (nodeA.height < 2))
+	{
+		return a;
+	}
+
+	const int32_t b = nodeA.child1;
+	const int32_t c = nodeA.child2;
+	sNode& nodeB = nodes[b];
+	sNode& nodeC = nodes[c];
+
+	const int32_t heightDifference = nodeC.height - nodeB.height;
+
+	// Rotate c up
+	if (heightDifference > 1)
+	{
+		const int32_t f = nodeC.child1;
+		const int32_t g = nodeC.child2;
+		sNode& nodeF = nodes[f];
+		sNode& nodeG = nodes[g];
+
+		// Swap a and c
+		nodeC.child1 = a;
+		nodeC.parentOrNext = nodeA.parentOrNext;
+		nodeA.parentOrNext = c;
+
+		// a's old parent now points to c
+		if (nodeC.parentOrNext != nullNode)
+		{
+			sNode& parentNode = nodes[nodeC.parentOrNext];
+			if (parentNode.child1 == a)
+			{
+				parentNode.child1 = c;
+			}
+			else
+			{
+				parentNode.child2 = c;
+			}
+		}
+		else
+		{
+			root = c;
+		}
+
+		// Keep the taller grandchild under c
+		if (nodeF.height > nodeG.height)
+		{
+			nodeC.child2 = f;
+			nodeA.child2 = g;
+			nodeG.parentOrNext = a;
+			nodeA.aabb = sAabb::combine(nodeB.aabb, nodeG.aabb);
+			nodeC.aabb = sAabb::combine(nodeA.aabb, nodeF.aabb);
+			nodeA.height = 1 + std::max(nodeB.height, nodeG.height);
+			nodeC.height = 1 + std::max(nodeA.height, nodeF.height);
+		}
+		else
+		{
+			nodeC.child2 = g;
+			nodeA.child2 = f;
+			nodeF.parentOrNext = a;
+			nodeA.aabb = sAabb::combine(nodeB.aabb, nodeF.aabb);
+			nodeC.aabb = sAabb::combine(nodeA.aabb, nodeG.aabb);
+			nodeA.height = 1 + std::max(nodeB.height, nodeF.height);
+			nodeC.height = 1 + std::max(nodeA.height, nodeG.height);
+		}
+
+		return c;
+	}
+
+	// Rotate b up
+	if (heightDifference < -1)
+	{
+		const int32_t d = nodeB.child1;
+		const int32_t e = nodeB.child2;
+		sNode& nodeD = nodes[d];
+		sNode& nodeE = nodes[e];
+
+		// Swap a and b
+		nodeB.child1 = a;
+		nodeB.parentOrNext = nodeA.parentOrNext;
+		nodeA.parentOrNext = b;
+
+		// a's old parent now points to b
+		if (nodeB.parentOrNext != nullNode)
+		{
+			sNode& parentNode = nodes[nodeB.parentOrNext];
+			if (parentNode.child1 == a)
+			{
+				parentNode.child1 = b;
+			}
+			else
+			{
+				parentNode.child2 = b;
+			}
+		}
+		else
+		{
+			root = b;
+		}
+
+		// Keep the taller grandchild under b
+		if (nodeD.height > nodeE.height)
+		{
+			nodeB.child2 = d;
+			nodeA.child1 = e;
+			nodeE.parentOrNext = a;
+			nodeA.aabb = sAabb::combine(nodeC.aabb, nodeE.aabb);
+			nodeB.aabb = sAabb::combine(nodeA.aabb, nodeD.aabb);
+			nodeA.height = 1 + std::max(nodeC.height, nodeE.height);
+			nodeB.height = 1 + std::max(nodeA.height, nodeD.height);
+		}
+		else
+		{
+			nodeB.child2 = e;
+			nodeA.child1 = d;
+			nodeD.parentOrNext = a;
+			nodeA.aabb = sAabb::combine(nodeC.aabb, nodeD.aabb);
+			nodeB.aabb = sAabb::combine(nodeA.aabb, nodeE.aabb);
+			nodeA.height = 1 + std::max(nodeC.height, nodeD.height);
+			nodeB.height = 1 + std::max(nodeA.height, nodeE.height);
+		}
+
+		return b;
+	}
+
+	return a;
+}
@@ -0,0 +1,320 @@
+#pragma once
+
+#include "aabb.h"
+#include "frustum.h"
+
+// Dynamic bounding volume hierarchy. Each proxy is a leaf holding a fat aabb, enlarged by a margin so small movements do not
+// need the tree to change. Leaves are inserted with a surface area cost heuristic and the tree is kept balanced with rotations.
+// Nodes live in one contiguous pool addressed by index and are recycled through a free list.
+// Queries report proxies whose fat aabb passes the test, callers perform any exact test against their own bounds
+class dynamicAabbTree
+{
+public:
+	static constexpr int32_t nullNode = -1;
+
+	// Distance added to each side of a proxy aabb when it is inserted
+	float aabbMargin = 0.1f;
+
+	// Scales the displacement passed to moveProxy to extend the fat aabb in the direction of motion
+	float displacementMultiplier = 4.0f;
+
+public:
+	dynamicAabbTree() = default;
+
+	// Creates a proxy for aabb and returns its id. The id stays valid until the proxy is destroyed
+	int32_t createProxy(const sAabb& aabb, const uint32_t userData);
+	void destroyProxy(const int32_t proxyId);
+
+	// Updates the proxy bounds. Returns true if the proxy left its fat aabb and was reinserted
+	bool moveProxy(const int32_t proxyId, const sAabb& aabb, const float displacement[3]);
+
+	uint32_t getUserData(const int32_t proxyId) const { return nodes[proxyId].userData; }
+	const sAabb& getFatAabb(const int32_t proxyId) const { return nodes[proxyId].aabb; }
+	uint32_t getProxyCount() const { return proxyCount; }
+
+	// Returns the height of the root. An empty tree has height 0
+	int32_t getHeight() const;
+
+	// Returns the summed surface area of all internal and leaf nodes divided by the root surface area. Lower is a better tree
+	float getAreaRatio() const;
+
+	// Removes all proxies and keeps the node pool capacity
+	void clear();
+	void reserve(const size_t proxyCapacity);
+
+	// Calls callback(proxyId) for each proxy overlapping aabb. Return false from the callback to stop the query
+	template <typename T>
+	void queryAabb(const sAabb& aabb, T&& callback) const;
+
+	// Calls callback(proxyId) for each proxy overlapping the sphere. Return false from the callback to stop the query
+	template <typename T>
+	void querySphere(const float center[3], const float radius, T&& callback) const;
+
+	// Calls callback(proxyId) for each proxy inside or intersecting the frustum. Subtrees fully inside the frustum are reported
+	// without testing their children. Return false from the callback to stop the query
+	template <typename T>
+	void queryFrustum(const sFrustum& frustum, T&& callback) const;
+
+	// Casts the segment origin + direction * fraction for fraction in [0, maxFraction] and calls callback(proxyId, maxFraction) for each
+	// proxy it hits. The callback returns the new max fraction: 0 stops the cast, a smaller value clips the segment (e.g. closest hit)
+	// and maxFraction continues unchanged
+	template <typename T>
+	void rayCast(const float origin[3], const float direction[3], float maxFraction, T&& callback) const;
+
+private:
+	// Upper bound on the traversal stack. The balanced tree height grows with log2 of the proxy count
+	static constexpr size_t maxStackSize = 256;
+
+	struct sNode
+	{
+		sAabb aabb;
+
+		// Parent node while in the tree, next free node while in the free list
+		int32_t parentOrNext = nullNode;
+		int32_t child1 = nullNode;
+		int32_t child2 = nullNode;
+
+		// Leaves have height 0, free nodes have height -1
+		int32_t height = -1;
+		uint32_t userData = 0;
+
+		bool isLeaf() const { return child1 == nullNode; }
+	};
+
+	std::vector<sNode> nodes;
+	int32_t root = nullNode;
+	int32_t freeList = nullNode;
+	uint32_t proxyCount = 0;
+
+private:
+	int32_t allocateNode();
+	void freeNode(const int32_t nodeId);
+	void insertLeaf(const int32_t leaf);
+	void removeLeaf(const int32_t leaf);
+
+	// Walks from nodeId to the root rebalancing and refitting each ancestor
+	void refitAncestors(int32_t nodeId);
+
+	// Performs a left or right rotation if node a is imbalanced. Returns the new root of the subtree
+	int32_t balance(const int32_t a);
+
+	// Calls callback for every leaf below nodeId. Returns false if the callback stopped the query
+	template <typename T>
+	bool reportSubtree(const int32_t nodeId, T& callback) const;
+};
+
+template <typename T>
+void dynamicAabbTree::queryAabb(const sAabb& aabb, T&& callback) const
+{
+	int32_t stack[maxStackSize];
+	size_t stackSize = 0;
+	if (root != nullNode)
+	{
+		stack[stackSize++] = root;
+	}
+
+	while (stackSize > 0)
+	{
+		const sNode& node = nodes[stack[--stackSize]];
+		if (!sAabb::overlaps(node.aabb, aabb))
+		{
+			continue;
+		}
+
+		if (node.isLeaf())
+		{
+			if (!callback(static_cast<int32_t>(&node - nodes.data())))
+			{
+				return;
+			}
+		}
+		else
+		{
+			assert(stackSize + 2 <= maxStackSize);
+			stack[stackSize++] = node.child1;
+			stack[stackSize++] = node.child2;
+		}
+	}
+}
+
+template <typename T>
+void dynamicAabbTree::querySphere(const float center[3], const float radius, T&& callback) const
+{
+	int32_t stack[maxStackSize];
+	size_t stackSize = 0;
+	if (root != nullNode)
+	{
+		stack[stackSize++] = root;
+	}
+
+	const float radiusSquared = radius * radius;
+	while (stackSize > 0)
+	{
+		const sNode& node = nodes[stack[--stackSize]];
+
+		// Squared distance from the sphere center to the closest point on the node aabb
+		float distanceSquared = 0.0f;
+		for (size_t i = 0; i < 3; ++i)
+		{
+			const float closest = std::clamp(center[i], node.aabb.min[i], node.aabb.max[i]);
+			distanceSquared += (center[i] - closest) * (center[i] - closest);
+		}
+
+		if (distanceSquared > radiusSquared)
+		{
+			continue;
+		}
+
+		if (node.isLeaf())
+		{
+			if (!callback(static_cast<int32_t>(&node - nodes.data())))
+			{
+				return;
+			}
+		}
+		else
+		{
+			assert(stackSize + 2 <= maxStackSize);
+			stack[stackSize++] = node.child1;
+			stack[stackSize++] = node.child2;
+		}
+	}
+}
+
+template <typename T>
+void dynamicAabbTree::queryFrustum(const sFrustum& frustum, T&& callback) const
+{
+	int32_t stack[maxStackSize];
+	size_t stackSize = 0;
+	if (root != nullNode)
+	{
+		stack[stackSize++] = root;
+	}
+
+	while (stackSize > 0)
+	{
+		const int32_t nodeId = stack[--stackSize];
+		const sNode& node = nodes[nodeId];
+
+		const float center[3] = { (node.aabb.min[0] + node.aabb.max[0]) * 0.5f, (node.aabb.min[1] + node.aabb.max[1]) * 0.5f, (node.aabb.min[2] + node.aabb.max[2]) * 0.5f };
+		const float extent[3] = { (node.aabb.max[0] - node.aabb.min[0]) * 0.5f, (node.aabb.max[1] - node.aabb.min[1]) * 0.5f, (node.aabb.max[2] - node.aabb.min[2]) * 0.5f };
+
+		bool outside = false;
+		bool fullyInside = true;
+		for (size_t p = 0; p < sFrustum::ePlane::count; ++p)
+		{
+			const float* const plane = frustum.planes[p];
+			const float distance = (center[0] * plane[0]) + (center[1] * plane[1]) + (center[2] * plane[2]) + plane[3];
+			const float radius = (extent[0] * std::abs(plane[0])) + (extent[1] * std::abs(plane[1])) + (extent[2] * std::abs(plane[2]));
+			if (distance < -radius)
+			{
+				outside = true;
+				break;
+			}
+			fullyInside &= (distance >= radius);
+		}
+
+		if (outside)
+		{
+			continue;
+		}
+
+		if (fullyInside || node.isLeaf())
+		{
+			if (!reportSubtree(nodeId, callback))
+			{
+				return;
+			}
+		}
+		else
+		{
+			assert(stackSize + 2 <= maxStackSize);
+			stack[stackSize++] = node.child1;
+			stack[stackSize++] = node.child2;
+		}
+	}
+}
+
+template <typename T>
+void dynamicAabbTree::rayCast(const float origin[3], const float direction[3], float maxFraction, T&& callback) const
+{
+	int32_t stack[maxStackSize];
+	size_t stackSize = 0;
+	if (root != nullNode)
+	{
+		stack[stackSize++] = root;
+	}
+
+	// Division by a zero direction component gives infinity, which the slab test handles
+	const float inverseDirection[3] = { 1.0f / direction[0], 1.0f / direction[1], 1.0f / direction[2] };
+
+	while (stackSize > 0)
+	{
+		const sNode& node = nodes[stack[--stackSize]];
+
+		// Slab test clipped to the current segment length
+		float entry = 0.0f;
+		float exit = maxFraction;
+		for (size_t i = 0; i < 3; ++i)
+		{
+			float t0 = (node.aabb.min[i] - origin[i]) * inverseDirection[i];
+			float t1 = (node.aabb.max[i] - origin[i]) * inverseDirection[i];
+			if (t0 > t1)
+			{
+				std::swap(t0, t1);
+			}
+
+			// A ray parallel to and inside the slab produces nan for 0 * infinity, the comparisons below then leave the range unchanged
+			entry = (t0 > entry) ? t0 : entry;
+			exit = (t1 < exit) ? t1 : exit;
+		}
+
+		if (entry > exit)
+		{
+			continue;
+		}
+
+		if (node.isLeaf())
+		{
+			maxFraction = callback(static_cast<int32_t>(&node - nodes.data()), maxFraction);
+			if (maxFraction <= 0.0f)
+			{
+				return;
+			}
+		}
+		else
+		{
+			assert(stackSize + 2 <= maxStackSize);
+			stack[stackSize++] = node.child1;
+			stack[stackSize++] = node.child2;
+		}
+	}
+}
+
+template <typename T>
+bool dynamicAabbTree::reportSubtree(const int32_t nodeId, T& callback) const
+{
+	int32_t stack[maxStackSize];
+	size_t stackSize = 0;
+	stack[stackSize++] = nodeId;
+
+	while (stackSize > 0)
+	{
+		const int32_t id = stack[--stackSize];
+		const sNode& node = nodes[id];
+		if (node.isLeaf())
+		{
+			if (!callback(id))
+			{
+				return false;
+			}
+		}
+		else
+		{
+			assert(stackSize + 2 <= maxStackSize);
+			stack[stackSize++] = node.child1;
+			stack[stackSize++] = node.child2;
+		}
+	}
+	return true;
+}
\ No newline at end of file
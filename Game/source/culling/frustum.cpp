@@ -0,0 +1,36 @@
+#include "pch.h"
+#include "frustum.h"
+#include "math/matrix4x4f.h"
+
+sFrustum sFrustum::fromViewProjection(const matrix4x4f& viewProjection)
+{
+	// For a row vector layout each stored column holds a row of the column vector clip transform
+	const float* const row0 = &viewProjection.values[0];
+	const float* const row1 = &viewProjection.values[4];
+	const float* const row2 = &viewProjection.values[8];
+	const float* const row3 = &viewProjection.values[12];
+
+	sFrustum frustum;
+	for (size_t i = 0; i < 4; ++i)
+	{
+		frustum.planes[ePlane::left][i] = row3[i] + row0[i];
+		frustum.planes[ePlane::right][i] = row3[i] - row0[i];
+		frustum.planes[ePlane::bottom][i] = row3[i] + row1[i];
+		frustum.planes[ePlane::top][i] = row3[i] - row1[i];
+		frustum.planes[ePlane::nearPlane][i] = row2[i];
+		frustum.planes[ePlane::farPlane][i] = row3[i] - row2[i];
+	}
+
+	// Normalize so plane distances are in world units and can be compared against bounding sphere radii
+	for (size_t i = 0; i < ePlane::count; ++i)
+	{
+		float* const plane = frustum.planes[i];
+		const float inverseLength = 1.0f / std::sqrt((plane[0] * plane[0]) + (plane[1] * plane[1]) + (plane[2] * plane[2]));
+		plane[0] *= inverseLength;
+		plane[1] *= inverseLength;
+		plane[2] *= inverseLength;
+		plane[3] *= inverseLength;
+	}
+
+	return frustum;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+class matrix4x4f;
+
+// Six normalized planes in the form (a, b, c, d) where a point p is in front of the plane when a * p.x + b * p.y + c * p.z + d >= 0.
+// Plane normals point into the frustum
+struct sFrustum
+{
+	enum ePlane : uint8_t
+	{
+		left = 0,
+		right = 1,
+		bottom = 2,
+		top = 3,
+		nearPlane = 4,
+		farPlane = 5,
+		count = 6
+	};
+
+	float planes[ePlane::count][4] = {};
+
+	// Extracts the planes from a view projection matrix laid out for row vectors (position * viewProjection), as passed to graphics::render.
+	// Assumes a zero to one clip space depth range
+	static sFrustum fromViewProjection(const matrix4x4f& viewProjection);
+};
\ No newline at end of file
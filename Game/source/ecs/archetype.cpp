@@ -0,0 +1,104 @@
+#include "pch.h"
+#include "archetype.h"
+
+#include <bit>
+
+static constexpr uint32_t columnAlignment = 64;
+
+static uint32_t alignUp(const uint32_t value, const uint32_t alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+archetype::archetype(const componentMask inMask)
+	: mask(inMask)
+{
+	std::fill(std::begin(columnOffsets), std::end(columnOffsets), absentColumn);
+
+	// Every array starts on a cache line, reserve the worst case padding before dividing the rest between entities
+	uint32_t bytesPerEntity = sizeof(sEntity);
+	uint32_t columnCount = 1;
+	for (componentMask remaining = mask; remaining != 0; remaining &= remaining - 1)
+	{
+		bytesPerEntity += componentRegistry::getInfo(std::countr_zero(remaining)).size;
+		++columnCount;
+	}
+	chunkCapacity = static_cast<uint32_t>((chunkSize - (columnAlignment * columnCount)) / bytesPerEntity);
+	assert((chunkCapacity > 0) && "archetype: components are too large to fit one entity in a chunk");
+
+	uint32_t offset = 0;
+	for (componentMask remaining = mask; remaining != 0; remaining &= remaining - 1)
+	{
+		const uint32_t typeId = std::countr_zero(remaining);
+		columnOffsets[typeId] = offset;
+		offset = alignUp(offset + (componentRegistry::getInfo(typeId).size * chunkCapacity), columnAlignment);
+	}
+	entityArrayOffset = offset;
+	assert(entityArrayOffset + (sizeof(sEntity) * chunkCapacity) <= chunkSize);
+}
+
+void* archetype::getComponentArray(const uint32_t chunk, const uint32_t typeId) const
+{
+	const uint32_t offset = columnOffsets[typeId];
+	return (offset != absentColumn) ? &chunks[chunk]->bytes[offset] : nullptr;
+}
+
+sEntity* archetype::getEntityArray(const uint32_t chunk) const
+{
+	return reinterpret_cast<sEntity*>(&chunks[chunk]->bytes[entityArrayOffset]);
+}
+
+void* archetype::getComponent(const uint32_t row, const uint32_t typeId) const
+{
+	const uint32_t offset = columnOffsets[typeId];
+	if (offset == absentColumn)
+	{
+		return nullptr;
+	}
+
+	const uint32_t chunk = row / chunkCapacity;
+	const uint32_t index = row - (chunk * chunkCapacity);
+	return &chunks[chunk]->bytes[offset + (componentRegistry::getInfo(typeId).size * index)];
+}
+
+sEntity archetype::getEntity(const uint32_t row) const
+{
+	const uint32_t chunk = row / chunkCapacity;
+	return getEntityArray(chunk)[row - (chunk * chunkCapacity)];
+}
+
+uint32_t archetype::addRow(const sEntity entity)
+{
+	const uint32_t row = entityCount;
+	const uint32_t chunk = row / chunkCapacity;
+	if (chunk == chunks.size())
+	{
+		chunks.push_back(std::make_unique<sChunkStorage>());
+	}
+
+	getEntityArray(chunk)[row - (chunk * chunkCapacity)] = entity;
+	++entityCount;
+	return row;
+}
+
+sEntity archetype::removeRow(const uint32_t row)
+{
+	assert(row < entityCount);
+	const uint32_t lastRow = entityCount - 1;
+	--entityCount;
+	if (row == lastRow)
+	{
+		return sEntity();
+	}
+
+	for (componentMask remaining = mask; remaining != 0; remaining &= remaining - 1)
+	{
+		const uint32_t typeId = std::countr_zero(remaining);
+		memcpy(getComponent(row, typeId), getComponent(lastRow, typeId), componentRegistry::getInfo(typeId).size);
+	}
+
+	const sEntity movedEntity = getEntity(lastRow);
+	const uint32_t chunk = row / chunkCapacity;
+	getEntityArray(chunk)[row - (chunk * chunkCapacity)] = movedEntity;
+	return movedEntity;
+}
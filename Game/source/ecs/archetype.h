@@ -0,0 +1,61 @@
+#pragma once
+
+#include "sEntity.h"
+#include "componentRegistry.h"
+
+// Stores every entity with one exact set of component types. Entities are packed into fixed size chunks, each chunk holding one
+// contiguous array per component type followed by the entity handles (structure of arrays). Rows are addressed across the whole
+// archetype so row / capacity is the chunk. Removing a row moves the last row into it so every chunk but the last is full
+class archetype
+{
+public:
+	static constexpr size_t chunkSize = 16 * 1024;
+	static constexpr uint32_t absentColumn = UINT32_MAX;
+
+public:
+	explicit archetype(const componentMask inMask);
+	archetype(const archetype&) = delete;
+	archetype& operator=(const archetype&) = delete;
+
+	componentMask getMask() const { return mask; }
+	uint32_t getEntityCount() const { return entityCount; }
+	uint32_t getChunkCapacity() const { return chunkCapacity; }
+
+	// Number of chunks holding at least one entity
+	uint32_t getChunkCount() const { return (entityCount + chunkCapacity - 1) / chunkCapacity; }
+	uint32_t getChunkEntityCount(const uint32_t chunk) const { return std::min(entityCount - (chunk * chunkCapacity), chunkCapacity); }
+
+	// Returns the array of one component type in a chunk, or nullptr if the archetype does not have the type
+	void* getComponentArray(const uint32_t chunk, const uint32_t typeId) const;
+	sEntity* getEntityArray(const uint32_t chunk) const;
+
+	template <typename T>
+	T* getComponentArray(const uint32_t chunk) const { return static_cast<T*>(getComponentArray(chunk, componentRegistry::getTypeId<T>())); }
+
+	// Returns a pointer to one entity's component, or nullptr if the archetype does not have the type
+	void* getComponent(const uint32_t row, const uint32_t typeId) const;
+	sEntity getEntity(const uint32_t row) const;
+
+	// Appends a row for entity with uninitialized components and returns it
+	uint32_t addRow(const sEntity entity);
+
+	// Removes row by moving the last row into it. Returns the entity that moved into row, or an invalid entity if row was the last row
+	sEntity removeRow(const uint32_t row);
+
+private:
+	struct alignas(64) sChunkStorage
+	{
+		uint8_t bytes[chunkSize];
+	};
+
+	componentMask mask = 0;
+	uint32_t chunkCapacity = 0;
+	uint32_t entityCount = 0;
+
+	// Byte offset of each component array inside a chunk, absentColumn for types the archetype does not have
+	uint32_t columnOffsets[componentRegistry::maxComponentTypes];
+	uint32_t entityArrayOffset = 0;
+
+	// Chunks are kept once allocated and reused when the archetype grows again
+	std::vector<std::unique_ptr<sChunkStorage>> chunks;
+};
\ No newline at end of file
@@ -0,0 +1,20 @@
+#include "pch.h"
+#include "componentRegistry.h"
+
+static sComponentInfo componentInfos[componentRegistry::maxComponentTypes];
+static std::atomic<uint32_t> componentTypeCount = 0;
+
+const sComponentInfo& componentRegistry::getInfo(const uint32_t typeId)
+{
+	assert(typeId < componentTypeCount.load(std::memory_order_relaxed));
+	return componentInfos[typeId];
+}
+
+uint32_t componentRegistry::registerType(const sComponentInfo& info)
+{
+	// Called once per type from the function local static in getTypeId, which publishes the id to other threads after the info is written
+	const uint32_t typeId = componentTypeCount.fetch_add(1, std::memory_order_acq_rel);
+	assert((typeId < maxComponentTypes) && "componentRegistry::registerType: too many component types");
+	componentInfos[typeId] = info;
+	return typeId;
+}
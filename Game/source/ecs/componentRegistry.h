@@ -0,0 +1,55 @@
+#pragma once
+
+// One bit per component type
+using componentMask = uint64_t;
+
+struct sComponentInfo
+{
+	uint32_t size = 0;
+	uint32_t alignment = 0;
+};
+
+// Assigns each component type a small id on first use. Components are moved between chunks with memcpy so they must be trivially copyable
+class componentRegistry
+{
+public:
+	static constexpr uint32_t maxComponentTypes = 64;
+
+public:
+	// const and volatile qualified types share the id of the plain type, e.g. forEach<const T> finds the archetypes holding T
+	template <typename T>
+	static uint32_t getTypeId();
+
+	template <typename... T>
+	static componentMask getMask();
+
+	static const sComponentInfo& getInfo(const uint32_t typeId);
+
+private:
+	static uint32_t registerType(const sComponentInfo& info);
+
+	template <typename T>
+	static uint32_t getUnqualifiedTypeId();
+};
+
+template <typename T>
+uint32_t componentRegistry::getTypeId()
+{
+	return getUnqualifiedTypeId<std::remove_cv_t<T>>();
+}
+
+template <typename T>
+uint32_t componentRegistry::getUnqualifiedTypeId()
+{
+	static_assert(std::is_trivially_copyable_v<T>, "componentRegistry: components must be trivially copyable");
+	static_assert(alignof(T) <= 64, "componentRegistry: component alignment must not exceed a cache line");
+
+	static const uint32_t typeId = registerType({ static_cast<uint32_t>(sizeof(T)), static_cast<uint32_t>(alignof(T)) });
+	return typeId;
+}
+
+template <typename... T>
+componentMask componentRegistry::getMask()
+{
+	return (componentMask(0) | ... | (componentMask(1) << getTypeId<T>()));
+}
\ No newline at end of file
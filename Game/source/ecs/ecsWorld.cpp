@@ -0,0 +1,176 @@
+#include "pch.h"
+#include "ecsWorld.h"
+#include "memory/memoryTracker.h"
+
+#include <bit>
+
+ecsWorld::ecsWorld()
+{
+	// Entities without components live in the empty archetype
+	getOrCreateArchetype(0);
+}
+
+sEntity ecsWorld::createEntityById(const uint32_t componentCount, const uint32_t* typeIds, const void* const* values)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::ecs);
+	sEntity entity;
+	if (freeIndices.empty())
+	{
+		entity.index = static_cast<uint32_t>(records.size());
+		records.emplace_back();
+	}
+	else
+	{
+		entity.index = freeIndices.back();
+		freeIndices.pop_back();
+	}
+	entity.generation = records[entity.index].generation;
+
+	componentMask mask = 0;
+	for (uint32_t i = 0; i < componentCount; ++i)
+	{
+		mask |= componentMask(1) << typeIds[i];
+	}
+
+	archetype* const owner = getOrCreateArchetype(mask);
+	const uint32_t row = owner->addRow(entity);
+	for (uint32_t i = 0; i < componentCount; ++i)
+	{
+		memcpy(owner->getComponent(row, typeIds[i]), values[i], componentRegistry::getInfo(typeIds[i]).size);
+	}
+
+	sEntityRecord& record = records[entity.index];
+	record.owner = owner;
+	record.row = row;
+	++entityCount;
+	return entity;
+}
+
+void ecsWorld::destroyEntity(const sEntity entity)
+{
+	if (!isAlive(entity))
+	{
+		return;
+	}
+
+	// The callback can destroy other entities, which moves rows around, so the record is looked up after it returns
+	if (destroyCallback)
+	{
+		destroyCallback(entity);
+	}
+
+	sEntityRecord& record = records[entity.index];
+	const sEntity movedEntity = record.owner->removeRow(record.row);
+	if (movedEntity.isValid())
+	{
+		records[movedEntity.index].row = record.row;
+	}
+
+	// Bumping the generation invalidates every handle to the destroyed entity
+	record.owner = nullptr;
+	++record.generation;
+	freeIndices.push_back(entity.index);
+	--entityCount;
+}
+
+bool ecsWorld::isAlive(const sEntity entity) const
+{
+	return (entity.index < records.size()) && (records[entity.index].generation == entity.generation) && (records[entity.index].owner != nullptr);
+}
+
+sEntity ecsWorld::getEntity(const uint32_t index) const
+{
+	if ((index >= records.size()) || (records[index].owner == nullptr))
+	{
+		return sEntity();
+	}
+
+	sEntity entity;
+	entity.index = index;
+	entity.generation = records[index].generation;
+	return entity;
+}
+
+void ecsWorld::addComponentById(const sEntity entity, const uint32_t typeId, const void* value)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::ecs);
+	if (!isAlive(entity))
+	{
+		return;
+	}
+
+	const sEntityRecord& record = records[entity.index];
+	const componentMask typeBit = componentMask(1) << typeId;
+	uint32_t row = record.row;
+	if ((record.owner->getMask() & typeBit) == 0)
+	{
+		row = moveEntity(entity, getOrCreateArchetype(record.owner->getMask() | typeBit));
+	}
+
+	memcpy(records[entity.index].owner->getComponent(row, typeId), value, componentRegistry::getInfo(typeId).size);
+}
+
+void ecsWorld::removeComponentById(const sEntity entity, const uint32_t typeId)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::ecs);
+	if (!isAlive(entity))
+	{
+		return;
+	}
+
+	const sEntityRecord& record = records[entity.index];
+	const componentMask typeBit = componentMask(1) << typeId;
+	if ((record.owner->getMask() & typeBit) != 0)
+	{
+		moveEntity(entity, getOrCreateArchetype(record.owner->getMask() & ~typeBit));
+	}
+}
+
+void* ecsWorld::getComponentById(const sEntity entity, const uint32_t typeId) const
+{
+	if (!isAlive(entity))
+	{
+		return nullptr;
+	}
+
+	const sEntityRecord& record = records[entity.index];
+	return record.owner->getComponent(record.row, typeId);
+}
+
+archetype* ecsWorld::getOrCreateArchetype(const componentMask mask)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::ecs);
+	const auto found = archetypeLookup.find(mask);
+	if (found != archetypeLookup.end())
+	{
+		return found->second;
+	}
+
+	archetype* const created = archetypes.emplace_back(std::make_unique<archetype>(mask)).get();
+	archetypeLookup.emplace(mask, created);
+	return created;
+}
+
+uint32_t ecsWorld::moveEntity(const sEntity entity, archetype* target)
+{
+	sEntityRecord& record = records[entity.index];
+	archetype* const source = record.owner;
+	const uint32_t sourceRow = record.row;
+	const uint32_t targetRow = target->addRow(entity);
+
+	for (componentMask shared = source->getMask() & target->getMask(); shared != 0; shared &= shared - 1)
+	{
+		const uint32_t typeId = std::countr_zero(shared);
+		memcpy(target->getComponent(targetRow, typeId), source->getComponent(sourceRow, typeId), componentRegistry::getInfo(typeId).size);
+	}
+
+	const sEntity movedEntity = source->removeRow(sourceRow);
+	if (movedEntity.isValid())
+	{
+		records[movedEntity.index].row = sourceRow;
+	}
+
+	record.owner = target;
+	record.row = targetRow;
+	return targetRow;
+}
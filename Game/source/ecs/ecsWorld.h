@@ -0,0 +1,191 @@
+#pragma once
+
+#include "archetype.h"
+#include "jobs/jobSystem.h"
+
+// Archetype based entity component store. Entities with the same set of component types share an archetype, so a query walks the
+// contiguous component arrays of each matching chunk. Adding or removing a component moves the entity to another archetype.
+// Structural changes (create, destroy, add and remove) must not happen during a query, record them in an entityCommandBuffer instead
+class ecsWorld
+{
+public:
+	ecsWorld();
+	ecsWorld(const ecsWorld&) = delete;
+	ecsWorld& operator=(const ecsWorld&) = delete;
+
+	// Creates an entity with the given components
+	template <typename... T>
+	sEntity createEntity(const T&... components);
+
+	void destroyEntity(const sEntity entity);
+	bool isAlive(const sEntity entity) const;
+
+	// Returns the entity currently using slot index, or an invalid entity if the slot is free
+	sEntity getEntity(const uint32_t index) const;
+	uint32_t getEntityCount() const { return entityCount; }
+
+	// Called by destroyEntity while the entity and its components are still alive, e.g. to release what the components reference.
+	// The callback may destroy other entities
+	void setDestroyCallback(std::function<void(const sEntity)> callback) { destroyCallback = std::move(callback); }
+
+	// Adds the component, or overwrites it if the entity already has one
+	template <typename T>
+	void addComponent(const sEntity entity, const T& component);
+
+	template <typename T>
+	void removeComponent(const sEntity entity);
+
+	template <typename T>
+	bool hasComponent(const sEntity entity) const;
+
+	// Returns nullptr if the entity does not have the component. The pointer is invalidated by any structural change
+	template <typename T>
+	T* getComponent(const sEntity entity) const;
+
+	// Calls function(count, entities, T* components...) once per chunk holding all of the component types
+	template <typename... T, typename F>
+	void forEachChunk(F&& function) const;
+
+	// Calls function(entity, T& components...) for every entity holding all of the component types
+	template <typename... T, typename F>
+	void forEach(F&& function) const;
+
+	// Same as forEachChunk with the chunks spread over job system threads. function must be safe to call concurrently
+	template <typename... T, typename F>
+	void forEachChunkParallel(F&& function) const;
+
+	// Type erased operations used by templates and command buffer playback. values[i] holds the component of typeIds[i]
+	sEntity createEntityById(const uint32_t componentCount, const uint32_t* typeIds, const void* const* values);
+	void addComponentById(const sEntity entity, const uint32_t typeId, const void* value);
+	void removeComponentById(const sEntity entity, const uint32_t typeId);
+	void* getComponentById(const sEntity entity, const uint32_t typeId) const;
+
+private:
+	struct sEntityRecord
+	{
+		archetype* owner = nullptr;
+		uint32_t row = 0;
+		uint32_t generation = 0;
+	};
+
+	struct sChunkReference
+	{
+		archetype* owner = nullptr;
+		uint32_t chunk = 0;
+	};
+
+	std::vector<sEntityRecord> records;
+	std::vector<uint32_t> freeIndices;
+	uint32_t entityCount = 0;
+
+	std::vector<std::unique_ptr<archetype>> archetypes;
+	std::unordered_map<componentMask, archetype*> archetypeLookup;
+	std::function<void(const sEntity)> destroyCallback;
+
+private:
+	archetype* getOrCreateArchetype(const componentMask mask);
+
+	// Moves the entity to target, copying the components both archetypes have. Returns the entity's new row
+	uint32_t moveEntity(const sEntity entity, archetype* target);
+
+	template <typename... T, typename F>
+	static void invokeChunk(const archetype& owner, const uint32_t chunk, F& function);
+};
+
+template <typename... T>
+sEntity ecsWorld::createEntity(const T&... components)
+{
+	const uint32_t typeIds[] = { componentRegistry::getTypeId<T>()..., 0 };
+	const void* const values[] = { static_cast<const void*>(&components)..., nullptr };
+	return createEntityById(sizeof...(T), typeIds, values);
+}
+
+template <typename T>
+void ecsWorld::addComponent(const sEntity entity, const T& component)
+{
+	addComponentById(entity, componentRegistry::getTypeId<T>(), &component);
+}
+
+template <typename T>
+void ecsWorld::removeComponent(const sEntity entity)
+{
+	removeComponentById(entity, componentRegistry::getTypeId<T>());
+}
+
+template <typename T>
+bool ecsWorld::hasComponent(const sEntity entity) const
+{
+	return getComponentById(entity, componentRegistry::getTypeId<T>()) != nullptr;
+}
+
+template <typename T>
+T* ecsWorld::getComponent(const sEntity entity) const
+{
+	return static_cast<T*>(getComponentById(entity, componentRegistry::getTypeId<T>()));
+}
+
+template <typename... T, typename F>
+void ecsWorld::invokeChunk(const archetype& owner, const uint32_t chunk, F& function)
+{
+	function(owner.getChunkEntityCount(chunk), owner.getEntityArray(chunk), owner.getComponentArray<T>(chunk)...);
+}
+
+template <typename... T, typename F>
+void ecsWorld::forEachChunk(F&& function) const
+{
+	const componentMask queryMask = componentRegistry::getMask<T...>();
+	for (const std::unique_ptr<archetype>& owner : archetypes)
+	{
+		if ((owner->getMask() & queryMask) != queryMask)
+		{
+			continue;
+		}
+
+		const uint32_t chunkCount = owner->getChunkCount();
+		for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+		{
+			invokeChunk<T...>(*owner, chunk, function);
+		}
+	}
+}
+
+template <typename... T, typename F>
+void ecsWorld::forEach(F&& function) const
+{
+	forEachChunk<T...>([&function](const uint32_t count, const sEntity* entities, T*... components)
+		{
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				function(entities[i], components[i]...);
+			}
+		});
+}
+
+template <typename... T, typename F>
+void ecsWorld::forEachChunkParallel(F&& function) const
+{
+	// Flatten the matching chunks so the range split does not depend on how entities are spread between archetypes
+	const componentMask queryMask = componentRegistry::getMask<T...>();
+	std::vector<sChunkReference> queryChunks;
+	for (const std::unique_ptr<archetype>& owner : archetypes)
+	{
+		if ((owner->getMask() & queryMask) != queryMask)
+		{
+			continue;
+		}
+
+		const uint32_t chunkCount = owner->getChunkCount();
+		for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+		{
+			queryChunks.push_back({ owner.get(), chunk });
+		}
+	}
+
+	jobSystem::parallelFor(static_cast<uint32_t>(queryChunks.size()), 1, [&queryChunks, &function](const uint32_t begin, const uint32_t end)
+		{
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				invokeChunk<T...>(*queryChunks[i].owner, queryChunks[i].chunk, function);
+			}
+		});
+}
\ No newline at end of file
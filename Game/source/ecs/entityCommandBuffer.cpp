@@ -0,0 +1,112 @@
+#include "pch.h"
+#include "entityCommandBuffer.h"
+#include "ecsWorld.h"
+#include "memory/memoryTracker.h"
+
+// Stream layout: eCommand, entity, count, then count components of { type id, value }. removeComponent stores the type id as the count
+struct sCommandHeader
+{
+	uint8_t command = 0;
+	sEntity entity;
+	uint32_t count = 0;
+};
+
+void entityCommandBuffer::destroyEntity(const sEntity entity)
+{
+	writeHeader(eCommand::destroyEntity, entity, 0);
+}
+
+void entityCommandBuffer::playback(ecsWorld& world)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::ecs);
+	uint32_t typeIds[componentRegistry::maxComponentTypes];
+	const void* values[componentRegistry::maxComponentTypes];
+
+	size_t offset = 0;
+	const auto read = [this, &offset](void* outData, const size_t size)
+		{
+			memcpy(outData, &commands[offset], size);
+			offset += size;
+		};
+
+	// Component values are read in place, memcpy in the world handles their unaligned position in the stream
+	const auto readComponent = [this, &offset, &read](uint32_t& outTypeId, const void*& outValue)
+		{
+			read(&outTypeId, sizeof(outTypeId));
+			outValue = &commands[offset];
+			offset += componentRegistry::getInfo(outTypeId).size;
+		};
+
+	while (offset < commands.size())
+	{
+		sCommandHeader header;
+		read(&header, sizeof(header));
+
+		switch (static_cast<eCommand>(header.command))
+		{
+		case eCommand::createEntity:
+			for (uint32_t i = 0; i < header.count; ++i)
+			{
+				readComponent(typeIds[i], values[i]);
+			}
+			createdEntities.push_back(world.createEntityById(header.count, typeIds, values));
+			break;
+
+		case eCommand::destroyEntity:
+			world.destroyEntity(resolve(header.entity));
+			break;
+
+		case eCommand::addComponent:
+			readComponent(typeIds[0], values[0]);
+			world.addComponentById(resolve(header.entity), typeIds[0], values[0]);
+			break;
+
+		case eCommand::removeComponent:
+			world.removeComponentById(resolve(header.entity), header.count);
+			break;
+		}
+	}
+
+	clear();
+}
+
+void entityCommandBuffer::clear()
+{
+	commands.clear();
+	createdEntities.clear();
+	placeholderCount = 0;
+}
+
+void entityCommandBuffer::write(const void* data, const size_t size)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::ecs);
+	const size_t offset = commands.size();
+	commands.resize(offset + size);
+	memcpy(&commands[offset], data, size);
+}
+
+void entityCommandBuffer::writeHeader(const eCommand command, const sEntity entity, const uint32_t count)
+{
+	sCommandHeader header;
+	header.command = static_cast<uint8_t>(command);
+	header.entity = entity;
+	header.count = count;
+	write(&header, sizeof(header));
+}
+
+void entityCommandBuffer::writeComponent(const uint32_t typeId, const void* value)
+{
+	write(&typeId, sizeof(typeId));
+	write(value, componentRegistry::getInfo(typeId).size);
+}
+
+sEntity entityCommandBuffer::resolve(const sEntity entity) const
+{
+	if (!entity.isValid() || ((entity.index & placeholderIndexFlag) == 0))
+	{
+		return entity;
+	}
+
+	// Placeholders are only handed out by createEntity, which is always played back before any command that uses its result
+	return createdEntities[entity.index & ~placeholderIndexFlag];
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "sEntity.h"
+#include "componentRegistry.h"
+
+class ecsWorld;
+
+// Records structural changes to apply to an ecsWorld later, e.g. from inside a query where the world must not change. Commands are
+// stored in one byte stream with their component values copied in and are applied in the order they were recorded.
+// A command buffer is not thread safe, give each job thread its own and play them back in thread order for a deterministic result
+class entityCommandBuffer
+{
+public:
+	// Returns a placeholder that later commands in this buffer can use to refer to the new entity. It is replaced with the created
+	// entity during playback and is not a valid handle outside this buffer
+	template <typename... T>
+	sEntity createEntity(const T&... components);
+
+	void destroyEntity(const sEntity entity);
+
+	template <typename T>
+	void addComponent(const sEntity entity, const T& component);
+
+	template <typename T>
+	void removeComponent(const sEntity entity);
+
+	// Applies the commands to the world in record order and clears the buffer. Commands for entities that were destroyed are skipped
+	void playback(ecsWorld& world);
+
+	bool isEmpty() const { return commands.empty(); }
+	void clear();
+
+private:
+	// Placeholder indices have the top bit set, real entity indices never get that high
+	static constexpr uint32_t placeholderIndexFlag = 0x80000000u;
+
+	enum class eCommand : uint8_t
+	{
+		createEntity = 0,
+		destroyEntity = 1,
+		addComponent = 2,
+		removeComponent = 3
+	};
+
+	std::vector<uint8_t> commands;
+	uint32_t placeholderCount = 0;
+
+	// Entities created during playback, indexed by placeholder
+	std::vector<sEntity> createdEntities;
+
+private:
+	void write(const void* data, const size_t size);
+	void writeHeader(const eCommand command, const sEntity entity, const uint32_t count);
+	void writeComponent(const uint32_t typeId, const void* value);
+	sEntity resolve(const sEntity entity) const;
+};
+
+template <typename... T>
+sEntity entityCommandBuffer::createEntity(const T&... components)
+{
+	writeHeader(eCommand::createEntity, sEntity(), sizeof...(T));
+	(writeComponent(componentRegistry::getTypeId<T>(), &components), ...);
+
+	sEntity placeholder;
+	placeholder.index = placeholderIndexFlag | placeholderCount++;
+	return placeholder;
+}
+
+template <typename T>
+void entityCommandBuffer::addComponent(const sEntity entity, const T& component)
+{
+	writeHeader(eCommand::addComponent, entity, 1);
+	writeComponent(componentRegistry::getTypeId<T>(), &component);
+}
+
+template <typename T>
+void entityCommandBuffer::removeComponent(const sEntity entity)
+{
+	writeHeader(eCommand::removeComponent, entity, componentRegistry::getTypeId<T>());
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#pragma once
+
+// Handle to an entity in an ecsWorld. The index addresses the entity slot and the generation is incremented each time the slot is
+// reused, so a handle to a destroyed entity never refers to a newer one
+struct sEntity
+{
+	static constexpr uint32_t invalidIndex = UINT32_MAX;
+
+	uint32_t index = invalidIndex;
+	uint32_t generation = 0;
+
+	bool isValid() const { return index != invalidIndex; }
+	bool operator==(const sEntity& rhs) const { return (index == rhs.index) && (generation == rhs.generation); }
+	bool operator!=(const sEntity& rhs) const { return !(*this == rhs); }
+};
\ No newline at end of file
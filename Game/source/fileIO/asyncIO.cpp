@@ -0,0 +1,386 @@
+#include "pch.h"
+#include "asyncIO.h"
+#include "platform/framework/abstract/platformFile.h"
+#include "profiler/profiler.h"
+#include "memory/memoryTracker.h"
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+// Largest single read handed to the kernel queue, longer reads are issued in pieces
+static constexpr size_t maxKernelReadSize = 1024 * 1024 * 1024;
+
+// Completions reaped per wait
+static constexpr uint32_t completionBatchSize = 64;
+
+static bool initialized = false;
+static bool running = false;
+static sAsyncIODesc settings;
+static std::shared_ptr<platformLayer::file::readQueue> kernelQueue;
+static std::vector<std::thread> ioThreads;
+
+// Everything below is guarded by queueMutex
+static std::mutex queueMutex;
+static std::condition_variable workAvailable;
+static std::condition_variable requestFinished;
+static std::deque<sIORequest*> pendingRequests[static_cast<size_t>(eIOPriority::count)];
+static uint64_t inFlightBytes = 0;
+static uint32_t inFlightCount = 0;
+static uint32_t kernelReadCount = 0;
+
+static bool hasPendingRequests()
+{
+	for (const std::deque<sIORequest*>& requests : pendingRequests)
+	{
+		if (!requests.empty())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// Takes the highest priority pending request if the in flight budget allows it. A request held back by the budget also holds back lower
+// priorities, so a large high priority read is not starved by a stream of small ones
+static sIORequest* popNextRequest()
+{
+	for (std::deque<sIORequest*>& requests : pendingRequests)
+	{
+		if (requests.empty())
+		{
+			continue;
+		}
+
+		sIORequest* const request = requests.front();
+		if ((inFlightCount > 0) && ((inFlightBytes + request->desc.size) > settings.maxInFlightBytes))
+		{
+			return nullptr;
+		}
+
+		requests.pop_front();
+		inFlightBytes += request->desc.size;
+		++inFlightCount;
+		return request;
+	}
+	return nullptr;
+}
+
+static void completeRequest(sIORequest* request, const eIOStatus status)
+{
+	const int64_t bytesRead = (status == eIOStatus::complete) ? static_cast<int64_t>(request->bytesDone) : -1;
+
+	// The callback may own the request, keep it alive until the status has been published
+	const ioCompletionCallback onComplete = std::move(request->desc.onComplete);
+	if (onComplete)
+	{
+		onComplete(status, bytesRead);
+	}
+
+	// Published under the lock so a waiter cannot see the status and destroy the request before this thread is done with it
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		request->bytesRead = bytesRead;
+		request->status.store(status, std::memory_order_release);
+	}
+	requestFinished.notify_all();
+}
+
+static void finishRequest(sIORequest* request, const eIOStatus status)
+{
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		inFlightBytes -= request->desc.size;
+		--inFlightCount;
+	}
+
+	// Freed budget may let held back requests start
+	workAvailable.notify_all();
+	completeRequest(request, status);
+}
+
+static bool submitKernelRead(sIORequest* request)
+{
+	const size_t size = std::min(request->desc.size - request->bytesDone, maxKernelReadSize);
+	if (!platformLayer::file::submitRead(kernelQueue.get(), request->desc.file, request->desc.offset + request->bytesDone,
+		static_cast<uint8_t*>(request->desc.destination) + request->bytesDone, static_cast<uint32_t>(size), reinterpret_cast<uint64_t>(request)))
+	{
+		return false;
+	}
+
+	++kernelReadCount;
+	return true;
+}
+
+// Moves pending requests into the kernel queue while it has room. Called with queueMutex held
+static void dispatchKernelReads()
+{
+	while (kernelReadCount < settings.queueDepth)
+	{
+		sIORequest* const request = popNextRequest();
+		if (request == nullptr)
+		{
+			return;
+		}
+
+		if (!submitKernelRead(request))
+		{
+			inFlightBytes -= request->desc.size;
+			--inFlightCount;
+			pendingRequests[static_cast<size_t>(request->desc.priority)].push_front(request);
+			return;
+		}
+	}
+}
+
+static void kernelThreadMain()
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::fileIO);
+	PROFILE_THREAD("io");
+
+	platformLayer::file::sReadCompletion completions[completionBatchSize];
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			dispatchKernelReads();
+			while (kernelReadCount == 0)
+			{
+				if (!running && !hasPendingRequests())
+				{
+					return;
+				}
+
+				workAvailable.wait(lock);
+				dispatchKernelReads();
+			}
+		}
+
+		const uint32_t completionCount = platformLayer::file::waitReadCompletions(kernelQueue.get(), completions, completionBatchSize);
+		for (uint32_t i = 0; i < completionCount; ++i)
+		{
+			sIORequest* const request = reinterpret_cast<sIORequest*>(completions[i].userData);
+			const int64_t result = completions[i].result;
+
+			eIOStatus status = (result >= 0) ? eIOStatus::complete : eIOStatus::failed;
+			{
+				std::lock_guard<std::mutex> lock(queueMutex);
+				--kernelReadCount;
+
+				// Short reads are continued, a read returning 0 bytes has reached the end of the file
+				if (result > 0)
+				{
+					request->bytesDone += static_cast<size_t>(result);
+					if (request->bytesDone < request->desc.size)
+					{
+						status = submitKernelRead(request) ? eIOStatus::pending : eIOStatus::failed;
+					}
+				}
+			}
+
+			if (status != eIOStatus::pending)
+			{
+				finishRequest(request, status);
+			}
+		}
+	}
+}
+
+static void workerThreadMain()
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::fileIO);
+	PROFILE_THREAD("io worker");
+
+	while (true)
+	{
+		sIORequest* request = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			while ((request = popNextRequest()) == nullptr)
+			{
+				if (!running)
+				{
+					return;
+				}
+				workAvailable.wait(lock);
+			}
+		}
+
+		int64_t bytesRead = 0;
+		{
+			PROFILE_SCOPE("asyncIO::read");
+			bytesRead = platformLayer::file::readFile(request->desc.file, request->desc.offset, request->desc.destination, request->desc.size);
+		}
+		request->bytesDone = static_cast<size_t>(std::max<int64_t>(bytesRead, 0));
+		finishRequest(request, (bytesRead >= 0) ? eIOStatus::complete : eIOStatus::failed);
+	}
+}
+
+void asyncIO::init(const sAsyncIODesc& desc)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::fileIO);
+	assert(!initialized);
+
+	settings = desc;
+	settings.queueDepth = std::max(settings.queueDepth, 1u);
+	running = true;
+
+	if (settings.allowKernelQueue && (platformLayer::file::createReadQueue(settings.queueDepth, kernelQueue) == 0))
+	{
+		ioThreads.emplace_back(&kernelThreadMain);
+	}
+	else
+	{
+		kernelQueue.reset();
+		for (uint32_t i = 0; i < std::max(settings.workerThreadCount, 1u); ++i)
+		{
+			ioThreads.emplace_back(&workerThreadMain);
+		}
+	}
+
+	initialized = true;
+}
+
+void asyncIO::shutdown()
+{
+	if (!initialized)
+	{
+		return;
+	}
+
+	std::vector<sIORequest*> cancelledRequests;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		running = false;
+		for (std::deque<sIORequest*>& requests : pendingRequests)
+		{
+			cancelledRequests.insert(cancelledRequests.end(), requests.begin(), requests.end());
+			requests.clear();
+		}
+	}
+	workAvailable.notify_all();
+
+	for (sIORequest* const request : cancelledRequests)
+	{
+		completeRequest(request, eIOStatus::cancelled);
+	}
+
+	for (std::thread& thread : ioThreads)
+	{
+		thread.join();
+	}
+	ioThreads.clear();
+	kernelQueue.reset();
+
+	initialized = false;
+}
+
+bool asyncIO::isUsingKernelQueue()
+{
+	return (kernelQueue != nullptr);
+}
+
+void asyncIO::read(const sAsyncReadDesc& desc, sIORequest& request)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::fileIO);
+	assert((request.status.load(std::memory_order_relaxed) != eIOStatus::pending) && "asyncIO::read: request is already pending");
+	assert((desc.priority < eIOPriority::count) && "asyncIO::read: invalid priority");
+
+	request.desc = desc;
+	request.bytesDone = 0;
+	request.bytesRead = 0;
+	request.status.store(eIOStatus::pending, std::memory_order_relaxed);
+
+	if (!initialized)
+	{
+		const int64_t bytesRead = platformLayer::file::readFile(desc.file, desc.offset, desc.destination, desc.size);
+		request.bytesDone = static_cast<size_t>(std::max<int64_t>(bytesRead, 0));
+		completeRequest(&request, (bytesRead >= 0) ? eIOStatus::complete : eIOStatus::failed);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		pendingRequests[static_cast<size_t>(desc.priority)].push_back(&request);
+
+		// Submitting here rather than waking the io thread starts the read without waiting for a read already in flight to finish
+		if (kernelQueue != nullptr)
+		{
+			dispatchKernelReads();
+		}
+	}
+	workAvailable.notify_all();
+}
+
+std::future<int64_t> asyncIO::read(const sAsyncReadDesc& desc)
+{
+	struct sFutureRead
+	{
+		sIORequest request;
+		std::promise<int64_t> promise;
+	};
+
+	// The completion callback owns the request, it is released once the read has finished
+	std::shared_ptr<sFutureRead> futureRead = std::make_shared<sFutureRead>();
+	std::future<int64_t> future = futureRead->promise.get_future();
+
+	sAsyncReadDesc futureDesc = desc;
+	futureDesc.onComplete = [futureRead, onComplete = desc.onComplete](const eIOStatus status, const int64_t bytesRead)
+	{
+		if (onComplete)
+		{
+			onComplete(status, bytesRead);
+		}
+		futureRead->promise.set_value(bytesRead);
+	};
+
+	sIORequest& request = futureRead->request;
+	futureRead.reset();
+	read(futureDesc, request);
+	return future;
+}
+
+bool asyncIO::cancel(sIORequest& request)
+{
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		if (request.status.load(std::memory_order_relaxed) != eIOStatus::pending)
+		{
+			return false;
+		}
+
+		std::deque<sIORequest*>& requests = pendingRequests[static_cast<size_t>(request.desc.priority)];
+		const std::deque<sIORequest*>::iterator found = std::find(requests.begin(), requests.end(), &request);
+		if (found == requests.end())
+		{
+			return false;
+		}
+		requests.erase(found);
+	}
+
+	completeRequest(&request, eIOStatus::cancelled);
+	return true;
+}
+
+void asyncIO::wait(const sIORequest& request)
+{
+	std::unique_lock<std::mutex> lock(queueMutex);
+	requestFinished.wait(lock, [&request]() { return request.isDone(); });
+}
+
+uint64_t asyncIO::getInFlightBytes()
+{
+	std::lock_guard<std::mutex> lock(queueMutex);
+	return inFlightBytes;
+}
+
+uint32_t asyncIO::getPendingCount()
+{
+	std::lock_guard<std::mutex> lock(queueMutex);
+	size_t count = 0;
+	for (const std::deque<sIORequest*>& requests : pendingRequests)
+	{
+		count += requests.size();
+	}
+	return static_cast<uint32_t>(count);
+}
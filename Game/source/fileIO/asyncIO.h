@@ -0,0 +1,96 @@
+#pragma once
+
+#include <future>
+
+// Reads with a lower value are started first
+enum class eIOPriority : uint8_t
+{
+	// Data the current frame is waiting on
+	high = 0,
+	normal,
+	// Streaming and prefetching that can wait behind everything else
+	low,
+	count
+};
+
+enum class eIOStatus : uint8_t
+{
+	idle = 0,
+	pending,
+	complete,
+	failed,
+	cancelled
+};
+
+// Called on an io thread when a read finishes. bytesRead is less than the requested size if the read reached the end of the file.
+// Keep it short, e.g. mark data ready or push to a queue, as it delays the reads behind it
+using ioCompletionCallback = std::function<void(const eIOStatus status, const int64_t bytesRead)>;
+
+struct sAsyncReadDesc
+{
+	// Handle from platformLayer::file::openFile, kept open until the read finishes
+	intptr_t file = -1;
+	uint64_t offset = 0;
+	size_t size = 0;
+	// Must stay valid until the read finishes
+	void* destination = nullptr;
+	eIOPriority priority = eIOPriority::normal;
+	ioCompletionCallback onComplete;
+};
+
+// Tracks one read. Owned by the caller and must outlive the read, i.e. stay alive until isDone returns true
+struct sIORequest
+{
+	std::atomic<eIOStatus> status = eIOStatus::idle;
+	int64_t bytesRead = 0;
+
+	bool isDone() const
+	{
+		const eIOStatus current = status.load(std::memory_order_acquire);
+		return (current != eIOStatus::pending);
+	}
+
+	// Used by the queue while the read is pending
+	sAsyncReadDesc desc;
+	size_t bytesDone = 0;
+};
+
+struct sAsyncIODesc
+{
+	// Threads issuing blocking reads when there is no kernel read queue
+	uint32_t workerThreadCount = 2;
+	// Reads are held back while this many bytes are already being read. A single larger read still runs on its own
+	uint64_t maxInFlightBytes = 64ull * 1024 * 1024;
+	// Reads the kernel read queue can hold at once
+	uint32_t queueDepth = 64;
+	bool allowKernelQueue = true;
+};
+
+// Reads file ranges in the background so the calling thread never waits on the disk. Uses io_uring where the kernel supports it, with one
+// thread submitting reads and reaping completions, and otherwise a small pool of threads issuing blocking reads. Pending reads are started
+// in priority order while the bytes in flight stay under a budget. Before init, or after shutdown, reads run on the calling thread
+class asyncIO
+{
+public:
+	static void init(const sAsyncIODesc& desc);
+
+	// Cancels pending reads and waits for reads in flight to finish
+	static void shutdown();
+
+	static bool isUsingKernelQueue();
+
+	// Queues a read tracked by request, which must not already be pending
+	static void read(const sAsyncReadDesc& desc, sIORequest& request);
+
+	// Queues a read that cannot be cancelled. The future holds the bytes read, or -1 if the read failed
+	static std::future<int64_t> read(const sAsyncReadDesc& desc);
+
+	// Returns true if the read was removed before it started. Reads already in flight finish as normal
+	static bool cancel(sIORequest& request);
+
+	// Blocks until the read finishes. Use sparingly from the game thread, this is the stall asyncIO exists to avoid
+	static void wait(const sIORequest& request);
+
+	static uint64_t getInFlightBytes();
+	static uint32_t getPendingCount();
+};
\ No newline at end of file
@@ -1,6 +1,9 @@
 #include "pch.h"
 #include "fileIO.h"
 #include "platform/framework/abstract/platformMessageBox.h"
+#include "memory/memoryTracker.h"
+
+#include <utility>
 
 bool fileIO::fileExists(const std::string& file)
 {
@@ -42,6 +45,7 @@ uintmax_t fileIO::fileSize(const std::string& file)
 
 void fileIO::writeSerializedBuffer(const std::string& file, const std::vector<uint8_t>& buffer)
 {
+    MEMORY_TAG_SCOPE(eMemoryTag::fileIO);
     std::ofstream ofStream(file, std::ios::out | std::ios::binary);
     if (!ofStream)
     {
@@ -54,18 +58,73 @@ void fileIO::writeSerializedBuffer(const std::string& file, const std::vector<ui
 
 void fileIO::readSerializedBuffer(const std::string& file, std::vector<uint8_t>& outBuffer)
 {
-    std::ifstream ifStream;
-    ifStream.open(file.c_str(), std::ifstream::in | std::ifstream::binary);
-
-    if (!ifStream.good())
+    MEMORY_TAG_SCOPE(eMemoryTag::fileIO);
+    const mappedFile mapped(file, eFileAccessPattern::sequential);
+    if (!mapped.isOpen())
     {
         platformLayer::messageBox::showMessageBox(platformLayer::messageBox::eMessageLevel::error, "fileIO::readSerializedBuffer: Failed to read serialized buffer from " + file + '.');
         return;
     }
 
-    uintmax_t size = fileSize(file);
-    outBuffer.resize(size);
-    ifStream.seekg(0, std::ios::beg);
-    ifStream.read(reinterpret_cast<char*>(outBuffer.data()), size);
-    ifStream.close();
+    // Copies straight from the mapped pages, the buffer is not zero filled first
+    const std::span<const uint8_t> contents = mapped.getData();
+    outBuffer.assign(contents.begin(), contents.end());
+}
+
+fileIO::mappedFile::mappedFile(const std::string& file, const eFileAccessPattern accessPattern)
+{
+    open(file, accessPattern);
+}
+
+fileIO::mappedFile::~mappedFile()
+{
+    close();
+}
+
+fileIO::mappedFile::mappedFile(mappedFile&& other) noexcept
+    : data(std::exchange(other.data, nullptr)), size(std::exchange(other.size, 0)), opened(std::exchange(other.opened, false))
+{
+}
+
+fileIO::mappedFile& fileIO::mappedFile::operator=(mappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+        opened = std::exchange(other.opened, false);
+    }
+    return *this;
+}
+
+bool fileIO::mappedFile::open(const std::string& file, const eFileAccessPattern accessPattern)
+{
+    close();
+    opened = (platformLayer::file::mapFile(file, accessPattern, data, size) == 0);
+    return opened;
+}
+
+void fileIO::mappedFile::close()
+{
+    platformLayer::file::unmapFile(data, size);
+    data = nullptr;
+    size = 0;
+    opened = false;
+}
+
+void fileIO::mappedFile::advise(const size_t offset, const size_t count, const eFileAccessPattern accessPattern) const
+{
+    if (offset < size)
+    {
+        platformLayer::file::adviseMappedRange(data + offset, std::min(count, size - offset), accessPattern);
+    }
+}
+
+void fileIO::mappedFile::prefetch(const size_t offset, const size_t count) const
+{
+    if (offset < size)
+    {
+        platformLayer::file::prefetchMappedRange(data + offset, std::min(count, size - offset));
+    }
 }
@@ -1,7 +1,48 @@
 #pragma once
 
+#include "platform/framework/abstract/platformFile.h"
+
 class fileIO
 {
+public:
+	/** Read only view of a whole file mapped into memory. The contents are paged in from disk as they are touched, so loaders can
+	* consume a file in place without allocating, zero filling or copying it. The view starts on a page boundary and is unmapped when the
+	* object is destroyed, spans taken from it must not outlive it
+	*/
+	class mappedFile
+	{
+	public:
+		mappedFile() = default;
+		explicit mappedFile(const std::string& file, const eFileAccessPattern accessPattern = eFileAccessPattern::normal);
+		~mappedFile();
+
+		mappedFile(mappedFile&& other) noexcept;
+		mappedFile& operator=(mappedFile&& other) noexcept;
+		mappedFile(const mappedFile&) = delete;
+		mappedFile& operator=(const mappedFile&) = delete;
+
+		/** Maps the file, replacing any file already mapped
+		* @return True if the file was mapped, otherwise false
+		*/
+		bool open(const std::string& file, const eFileAccessPattern accessPattern = eFileAccessPattern::normal);
+		void close();
+
+		bool isOpen() const { return opened; }
+		std::span<const uint8_t> getData() const { return std::span<const uint8_t>(data, size); }
+		size_t getSize() const { return size; }
+
+		/** Changes the read ahead for part of the file, e.g. random access for a table of contents read by lookups */
+		void advise(const size_t offset, const size_t count, const eFileAccessPattern accessPattern) const;
+
+		/** Starts paging part of the file in ahead of use */
+		void prefetch(const size_t offset, const size_t count) const;
+
+	private:
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+		bool opened = false;
+	};
+
 public:
 	/** Checks if the file at the path exists
 	* @return True if the file exists on disk, otherwise false
@@ -31,6 +72,6 @@ public:
 	/** Writes the serialized buffer to the hard disk. */
 	static void writeSerializedBuffer(const std::string& file, const std::vector<uint8_t>& buffer);
 
-	/** Reads the contents of a serialized file from the hard disk into a buffer */
+	/** Reads the contents of a serialized file from the hard disk into a buffer. Prefer mappedFile when the contents can be used in place */
 	static void readSerializedBuffer(const std::string& file, std::vector<uint8_t>& outBuffer);
 };
\ No newline at end of file
@@ -0,0 +1,250 @@
+#include "pch.h"
+#include "lz4.h"
+
+static constexpr size_t minMatch = 4;
+// The last 5 bytes of a block are always literals and the last match starts at least 12 bytes before the end
+static constexpr size_t lastLiterals = 5;
+static constexpr size_t matchFindLimit = 12;
+static constexpr size_t maxOffset = 65535;
+
+static constexpr uint32_t hashLog = 12;
+
+static inline uint32_t read32(const uint8_t* memory)
+{
+	uint32_t value;
+	memcpy(&value, memory, sizeof(value));
+	return value;
+}
+
+static inline uint32_t hashSequence(const uint32_t sequence)
+{
+	return (sequence * 2654435761u) >> (32 - hashLog);
+}
+
+// Writes a length that did not fit in its token nibble as a run of 255s and a final byte
+static inline uint8_t* writeLengthExtension(uint8_t* out, size_t length)
+{
+	while (length >= 255)
+	{
+		*out++ = 255;
+		length -= 255;
+	}
+	*out++ = static_cast<uint8_t>(length);
+	return out;
+}
+
+static uint8_t* writeSequence(uint8_t* out, const uint8_t* literals, const size_t literalLength, const size_t offset, const size_t matchLength)
+{
+	uint8_t* const token = out++;
+	*token = static_cast<uint8_t>(std::min<size_t>(literalLength, 15) << 4);
+	if (literalLength >= 15)
+	{
+		out = writeLengthExtension(out, literalLength - 15);
+	}
+	memcpy(out, literals, literalLength);
+	out += literalLength;
+
+	// The final sequence carries only literals
+	if (matchLength == 0)
+	{
+		return out;
+	}
+
+	*out++ = static_cast<uint8_t>(offset);
+	*out++ = static_cast<uint8_t>(offset >> 8);
+
+	const size_t matchCode = matchLength - minMatch;
+	*token |= static_cast<uint8_t>(std::min<size_t>(matchCode, 15));
+	if (matchCode >= 15)
+	{
+		out = writeLengthExtension(out, matchCode - 15);
+	}
+	return out;
+}
+
+size_t lz4::getCompressBound(const size_t inputSize)
+{
+	return inputSize + (inputSize / 255) + 16;
+}
+
+size_t lz4::compress(std::span<const uint8_t> source, std::span<uint8_t> destination)
+{
+	const size_t size = source.size();
+	if ((size > maxInputSize) || (destination.size() < getCompressBound(size)))
+	{
+		return 0;
+	}
+
+	const uint8_t* const in = source.data();
+	uint8_t* out = destination.data();
+	size_t anchor = 0;
+
+	if (size > matchFindLimit)
+	{
+		uint32_t table[1 << hashLog] = {};
+		const size_t matchEndLimit = size - lastLiterals;
+		const size_t matchStartLimit = size - matchFindLimit;
+
+		size_t position = 1;
+		table[hashSequence(read32(in))] = 0;
+		while (position < matchStartLimit)
+		{
+			const uint32_t sequence = read32(in + position);
+			const uint32_t hash = hashSequence(sequence);
+			const size_t candidate = table[hash];
+			table[hash] = static_cast<uint32_t>(position);
+
+			if (((position - candidate) > maxOffset) || (candidate >= position) || (read32(in + candidate) != sequence))
+			{
+				// Skip faster through data that is not compressing
+				position += 1 + ((position - anchor) >> 6);
+				continue;
+			}
+
+			// Extend the match backwards over literals, then forwards
+			size_t matchStart = position;
+			size_t reference = candidate;
+			while ((matchStart > anchor) && (reference > 0) && (in[matchStart - 1] == in[reference - 1]))
+			{
+				--matchStart;
+				--reference;
+			}
+
+			size_t matchLength = (position - matchStart) + minMatch;
+			while (((matchStart + matchLength) < matchEndLimit) && (in[matchStart + matchLength] == in[reference + matchLength]))
+			{
+				++matchLength;
+			}
+
+			out = writeSequence(out, in + anchor, matchStart - anchor, matchStart - reference, matchLength);
+			position = matchStart + matchLength;
+			anchor = position;
+
+			// Index a position inside the match so the next search can find repeats of its tail
+			if (position < matchStartLimit)
+			{
+				table[hashSequence(read32(in + position - 2))] = static_cast<uint32_t>(position - 2);
+			}
+		}
+	}
+
+	out = writeSequence(out, in + anchor, size - anchor, 0, 0);
+	return static_cast<size_t>(out - destination.data());
+}
+
+int64_t lz4::decompress(std::span<const uint8_t> source, std::span<uint8_t> destination)
+{
+	const uint8_t* in = source.data();
+	const uint8_t* const inEnd = in + source.size();
+	uint8_t* out = destination.data();
+	uint8_t* const outEnd = out + destination.size();
+
+	while (in < inEnd)
+	{
+		const uint8_t token = *in++;
+
+		size_t literalLength = token >> 4;
+		if (literalLength == 15)
+		{
+			uint8_t extension;
+			do
+			{
+				if (in >= inEnd)
+				{
+					return -1;
+				}
+				extension = *in++;
+				literalLength += extension;
+			} while (extension == 255);
+		}
+
+		if ((literalLength > static_cast<size_t>(inEnd - in)) || (literalLength > static_cast<size_t>(outEnd - out)))
+		{
+			return -1;
+		}
+		// Short runs are copied as a fixed 16 bytes when both buffers have room, avoiding a variable length copy per sequence
+		if ((literalLength <= 16) && ((inEnd - in) >= 16) && ((outEnd - out) >= 16))
+		{
+			memcpy(out, in, 16);
+		}
+		else
+		{
+			memcpy(out, in, literalLength);
+		}
+		in += literalLength;
+		out += literalLength;
+
+		// A block ends after the literals of its last sequence
+		if (in == inEnd)
+		{
+			break;
+		}
+
+		if ((inEnd - in) < 2)
+		{
+			return -1;
+		}
+		const size_t offset = static_cast<size_t>(in[0]) | (static_cast<size_t>(in[1]) << 8);
+		in += 2;
+		if ((offset == 0) || (offset > static_cast<size_t>(out - destination.data())))
+		{
+			return -1;
+		}
+
+		size_t matchLength = token & 15;
+		if (matchLength == 15)
+		{
+			uint8_t extension;
+			do
+			{
+				if (in >= inEnd)
+				{
+					return -1;
+				}
+				extension = *in++;
+				matchLength += extension;
+			} while (extension == 255);
+		}
+		matchLength += minMatch;
+
+		if (matchLength > static_cast<size_t>(outEnd - out))
+		{
+			return -1;
+		}
+
+		// Matches may overlap the bytes they produce, e.g. an offset of 1 repeats one byte. Chunks no longer than the offset only read
+		// bytes that have already been written
+		const uint8_t* match = out - offset;
+		if ((offset >= 16) && (matchLength <= 16) && ((outEnd - out) >= 16))
+		{
+			memcpy(out, match, 16);
+			out += matchLength;
+		}
+		else if (offset >= matchLength)
+		{
+			memcpy(out, match, matchLength);
+			out += matchLength;
+		}
+		else if (offset >= 8)
+		{
+			size_t remaining = matchLength;
+			for (; remaining >= 8; remaining -= 8, out += 8, match += 8)
+			{
+				memcpy(out, match, 8);
+			}
+			for (; remaining > 0; --remaining)
+			{
+				*out++ = *match++;
+			}
+		}
+		else
+		{
+			for (size_t i = 0; i < matchLength; ++i)
+			{
+				*out++ = *match++;
+			}
+		}
+	}
+
+	return static_cast<int64_t>(out - destination.data());
+}
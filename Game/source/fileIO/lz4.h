@@ -0,0 +1,27 @@
+#pragma once
+
+// Compression and decompression of the lz4 block format. Each call handles one independent block, so blocks of a larger buffer can be
+// compressed or decompressed on different threads. Compression is the greedy single pass from the reference encoder, tuned for decode
+// speed rather than ratio
+class lz4
+{
+public:
+	// Largest block a call accepts, offsets in the format are 16 bit so larger inputs gain nothing from being compressed as one block
+	static constexpr size_t maxInputSize = 0x7E000000;
+
+public:
+	/** Gets the most bytes compressing an input of inputSize can produce
+	* @return The size the destination of compress must have to always succeed
+	*/
+	static size_t getCompressBound(const size_t inputSize);
+
+	/** Compresses source into destination
+	* @return The compressed size, or 0 if destination is too small
+	*/
+	static size_t compress(std::span<const uint8_t> source, std::span<uint8_t> destination);
+
+	/** Decompresses a block, checking every length and offset against both buffers so corrupt data cannot read or write out of bounds
+	* @return The decompressed size, or -1 if the block is malformed or does not fit in destination
+	*/
+	static int64_t decompress(std::span<const uint8_t> source, std::span<uint8_t> destination);
+};
\ No newline at end of file
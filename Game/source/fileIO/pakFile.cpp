@@ -0,0 +1,190 @@
+#include "pch.h"
+#include "pakFile.h"
+#include "lz4.h"
+#include "jobs/jobSystem.h"
+
+// Blocks decompressed by one job when an entry is split over the job system
+static constexpr uint32_t blocksPerJob = 4;
+
+// Returns true if [offset, offset + size) lies inside a file of fileSize bytes
+static bool isRangeInFile(const uint64_t offset, const uint64_t size, const uint64_t fileSize)
+{
+	return (offset <= fileSize) && (size <= (fileSize - offset));
+}
+
+bool pakFile::open(const std::string& file)
+{
+	close();
+	if (!mapped.open(file))
+	{
+		return false;
+	}
+
+	const std::span<const uint8_t> data = mapped.getData();
+	if (data.size() < sizeof(sPakHeader))
+	{
+		close();
+		return false;
+	}
+
+	header = reinterpret_cast<const sPakHeader*>(data.data());
+	if ((header->magic != sPakHeader::expectedMagic) || (header->version != sPakHeader::currentVersion) ||
+		!isRangeInFile(header->entriesOffset, static_cast<uint64_t>(header->entryCount) * sizeof(sPakEntry), data.size()) ||
+		!isRangeInFile(header->blocksOffset, static_cast<uint64_t>(header->blockCount) * sizeof(sPakBlock), data.size()) ||
+		!isRangeInFile(header->stringsOffset, header->stringsSize, data.size()) ||
+		((header->entriesOffset % alignof(sPakEntry)) != 0) || ((header->blocksOffset % alignof(sPakBlock)) != 0))
+	{
+		close();
+		return false;
+	}
+
+	entries = std::span<const sPakEntry>(reinterpret_cast<const sPakEntry*>(data.data() + header->entriesOffset), header->entryCount);
+	blocks = std::span<const sPakBlock>(reinterpret_cast<const sPakBlock*>(data.data() + header->blocksOffset), header->blockCount);
+	strings = std::span<const char>(reinterpret_cast<const char*>(data.data() + header->stringsOffset), static_cast<size_t>(header->stringsSize));
+
+	if (!validate())
+	{
+		close();
+		return false;
+	}
+
+	// Lookups jump around the table of contents, read ahead there only pulls in pages that are never used
+	mapped.advise(0, static_cast<size_t>(header->stringsOffset + header->stringsSize), eFileAccessPattern::random);
+	return true;
+}
+
+void pakFile::close()
+{
+	mapped.close();
+	header = nullptr;
+	entries = {};
+	blocks = {};
+	strings = {};
+}
+
+const sPakEntry* pakFile::find(std::string_view path) const
+{
+	const uint64_t hash = pakPath::hashUnnormalized(path);
+
+	const std::span<const sPakEntry>::iterator first = std::lower_bound(entries.begin(), entries.end(), hash,
+		[](const sPakEntry& entry, const uint64_t value) { return entry.pathHash < value; });
+
+	// Paths sharing a hash sit next to each other, the stored path tells them apart
+	for (std::span<const sPakEntry>::iterator it = first; (it != entries.end()) && (it->pathHash == hash); ++it)
+	{
+		if (pakPath::matches(path, getPath(*it)))
+		{
+			return &*it;
+		}
+	}
+	return nullptr;
+}
+
+std::string_view pakFile::getPath(const sPakEntry& entry) const
+{
+	return std::string_view(strings.data() + entry.pathOffset);
+}
+
+std::span<const uint8_t> pakFile::getStoredData(const sPakEntry& entry) const
+{
+	if (isCompressed(entry))
+	{
+		return {};
+	}
+	return mapped.getData().subspan(static_cast<size_t>(entry.dataOffset), static_cast<size_t>(entry.size));
+}
+
+bool pakFile::read(const sPakEntry& entry, std::span<uint8_t> destination) const
+{
+	if (destination.size() < entry.size)
+	{
+		return false;
+	}
+
+	if (!isCompressed(entry))
+	{
+		const std::span<const uint8_t> stored = getStoredData(entry);
+		memcpy(destination.data(), stored.data(), stored.size());
+		return true;
+	}
+
+	const std::span<const uint8_t> data = mapped.getData();
+	std::atomic<bool> failed = false;
+	const auto decompressBlocks = [&](const uint32_t begin, const uint32_t end)
+		{
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				const sPakBlock& block = blocks[entry.firstBlock + i];
+				const std::span<const uint8_t> source = data.subspan(static_cast<size_t>(block.offset), block.compressedSize);
+				const std::span<uint8_t> target = destination.subspan(static_cast<size_t>(i) * header->blockSize, block.uncompressedSize);
+				if (block.compressedSize == block.uncompressedSize)
+				{
+					memcpy(target.data(), source.data(), source.size());
+				}
+				else if (lz4::decompress(source, target) != static_cast<int64_t>(block.uncompressedSize))
+				{
+					failed.store(true, std::memory_order_relaxed);
+				}
+			}
+		};
+
+	// Blocks decompress independently, so large entries are decoded on every core
+	mapped.prefetch(static_cast<size_t>(entry.dataOffset), static_cast<size_t>(blocks[entry.firstBlock + entry.blockCount - 1].offset +
+		blocks[entry.firstBlock + entry.blockCount - 1].compressedSize - entry.dataOffset));
+	if (entry.blockCount > blocksPerJob)
+	{
+		jobSystem::parallelFor(entry.blockCount, blocksPerJob, decompressBlocks);
+	}
+	else
+	{
+		decompressBlocks(0, entry.blockCount);
+	}
+	return !failed.load(std::memory_order_relaxed);
+}
+
+bool pakFile::validate() const
+{
+	if ((header->blockSize == 0) || ((header->stringsSize != 0) && (strings.back() != '\0')))
+	{
+		return false;
+	}
+
+	const uint64_t fileSize = mapped.getSize();
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		const sPakEntry& entry = entries[i];
+		if ((entry.pathOffset >= header->stringsSize) || ((i > 0) && (entries[i - 1].pathHash > entry.pathHash)))
+		{
+			return false;
+		}
+
+		if (entry.blockCount == 0)
+		{
+			if (!isRangeInFile(entry.dataOffset, entry.size, fileSize))
+			{
+				return false;
+			}
+			continue;
+		}
+
+		// Every block but the last is a full block, and together they make up the entry
+		if ((entry.firstBlock > header->blockCount) || (entry.blockCount > (header->blockCount - entry.firstBlock)) ||
+			(entry.size > (static_cast<uint64_t>(entry.blockCount) * header->blockSize)) ||
+			(entry.size <= (static_cast<uint64_t>(entry.blockCount - 1) * header->blockSize)))
+		{
+			return false;
+		}
+
+		for (uint32_t j = 0; j < entry.blockCount; ++j)
+		{
+			const sPakBlock& block = blocks[entry.firstBlock + j];
+			const uint64_t expectedSize = std::min<uint64_t>(header->blockSize, entry.size - (static_cast<uint64_t>(j) * header->blockSize));
+			if ((block.uncompressedSize != expectedSize) || (block.compressedSize > block.uncompressedSize) ||
+				!isRangeInFile(block.offset, block.compressedSize, fileSize))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
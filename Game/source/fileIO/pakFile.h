@@ -0,0 +1,50 @@
+#pragma once
+
+#include "fileIO.h"
+#include "pakFormat.h"
+
+// Read only access to a pak archive through a memory map. Opening validates the table of contents once, after which lookups are a
+// binary search over the mapped entries with no allocation or file system calls. Stored entries can be used in place, compressed entries
+// are decompressed block by block, spread over the job system when there is more than one block
+class pakFile
+{
+public:
+	/** Maps and validates an archive, replacing any archive already open
+	* @return True if the archive was opened, otherwise false
+	*/
+	bool open(const std::string& file);
+	void close();
+	bool isOpen() const { return header != nullptr; }
+
+	/** Looks up an entry by path, see pakPath for how paths are matched
+	* @return The entry, or nullptr if the archive does not contain the path
+	*/
+	const sPakEntry* find(std::string_view path) const;
+
+	uint32_t getEntryCount() const { return static_cast<uint32_t>(entries.size()); }
+	const sPakEntry& getEntry(const uint32_t index) const { return entries[index]; }
+	std::string_view getPath(const sPakEntry& entry) const;
+	bool isCompressed(const sPakEntry& entry) const { return entry.blockCount != 0; }
+
+	/** Gets the contents of a stored entry without copying, valid while the archive is open
+	* @return The entry's bytes in the mapped file, or an empty span if the entry is compressed
+	*/
+	std::span<const uint8_t> getStoredData(const sPakEntry& entry) const;
+
+	/** Decompresses or copies an entry into destination, which must hold at least entry.size bytes
+	* @return True if the entry was read, false if destination is too small or the data is corrupt
+	*/
+	bool read(const sPakEntry& entry, std::span<uint8_t> destination) const;
+
+	const fileIO::mappedFile& getMappedFile() const { return mapped; }
+
+private:
+	fileIO::mappedFile mapped;
+	const sPakHeader* header = nullptr;
+	std::span<const sPakEntry> entries;
+	std::span<const sPakBlock> blocks;
+	std::span<const char> strings;
+
+private:
+	bool validate() const;
+};
\ No newline at end of file
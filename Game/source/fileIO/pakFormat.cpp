@@ -0,0 +1,52 @@
+#include "pch.h"
+#include "pakFormat.h"
+
+std::string pakPath::normalize(std::string_view path)
+{
+	std::string normalized;
+	normalized.reserve(path.size());
+	forEachNormalizedCharacter(path, [&normalized](const char character)
+		{
+			normalized.push_back(character);
+			return true;
+		});
+	return normalized;
+}
+
+uint64_t pakPath::hash(std::string_view normalizedPath)
+{
+	uint64_t hash = 0xCBF29CE484222325ull;
+	for (const char character : normalizedPath)
+	{
+		hash ^= static_cast<uint8_t>(character);
+		hash *= 0x100000001B3ull;
+	}
+	return hash;
+}
+
+uint64_t pakPath::hashUnnormalized(std::string_view path)
+{
+	uint64_t hash = 0xCBF29CE484222325ull;
+	forEachNormalizedCharacter(path, [&hash](const char character)
+		{
+			hash ^= static_cast<uint8_t>(character);
+			hash *= 0x100000001B3ull;
+			return true;
+		});
+	return hash;
+}
+
+bool pakPath::matches(std::string_view path, std::string_view normalizedPath)
+{
+	size_t matched = 0;
+	const bool complete = forEachNormalizedCharacter(path, [&matched, normalizedPath](const char character)
+		{
+			if ((matched == normalizedPath.size()) || (normalizedPath[matched] != character))
+			{
+				return false;
+			}
+			++matched;
+			return true;
+		});
+	return complete && (matched == normalizedPath.size());
+}
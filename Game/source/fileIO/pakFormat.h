@@ -0,0 +1,125 @@
+#pragma once
+
+// Layout of a pak archive. Everything is little endian and read in place from a memory map, so the structs are fixed size with explicit
+// padding. The file is laid out as
+//   sPakHeader
+//   sPakEntry[entryCount], sorted by path hash so lookups are a binary search
+//   sPakBlock[blockCount], the compressed blocks of every entry in order
+//   path strings, each null terminated, referenced by entries for collision checks and listing
+//   entry data, each entry starting on a multiple of the archive's data alignment
+struct sPakHeader
+{
+	static constexpr uint32_t expectedMagic = 0x314B4150; // "PAK1"
+	static constexpr uint32_t currentVersion = 1;
+
+	uint32_t magic = expectedMagic;
+	uint32_t version = currentVersion;
+	uint32_t entryCount = 0;
+	uint32_t blockCount = 0;
+	// Uncompressed size of every block but the last of each entry
+	uint32_t blockSize = 0;
+	uint32_t dataAlignment = 0;
+	uint64_t entriesOffset = 0;
+	uint64_t blocksOffset = 0;
+	uint64_t stringsOffset = 0;
+	uint64_t stringsSize = 0;
+};
+static_assert(sizeof(sPakHeader) == 56, "sPakHeader: layout is part of the file format");
+
+struct sPakEntry
+{
+	uint64_t pathHash = 0;
+	// Offset of the first byte of the entry's data in the archive. Stored entries can be used in place from here
+	uint64_t dataOffset = 0;
+	uint64_t size = 0;
+	// Compressed entries are blockCount blocks starting at firstBlock, stored entries have a block count of 0
+	uint32_t firstBlock = 0;
+	uint32_t blockCount = 0;
+	// Offset of the entry's path in the string table
+	uint32_t pathOffset = 0;
+	uint32_t padding = 0;
+};
+static_assert(sizeof(sPakEntry) == 40, "sPakEntry: layout is part of the file format");
+
+struct sPakBlock
+{
+	uint64_t offset = 0;
+	// A block whose compressed size equals its uncompressed size did not compress and is stored as is
+	uint32_t compressedSize = 0;
+	uint32_t uncompressedSize = 0;
+};
+static_assert(sizeof(sPakBlock) == 16, "sPakBlock: layout is part of the file format");
+
+// Paths are looked up case insensitively with forward slashes, e.g. "Shaders\Vulkan\a.spv" and "shaders/vulkan/a.spv" name the same entry
+class pakPath
+{
+public:
+	static std::string normalize(std::string_view path);
+
+	// 64 bit FNV-1a of the normalized path
+	static uint64_t hash(std::string_view normalizedPath);
+
+	// Same as hash(normalize(path)) without building the normalized string
+	static uint64_t hashUnnormalized(std::string_view path);
+
+	// Returns true if path normalizes to normalizedPath, without building the normalized string
+	static bool matches(std::string_view path, std::string_view normalizedPath);
+
+	// Calls function(character) for each character of the normalized path in order. Return false from the function to stop.
+	// Returns false if the function stopped the walk
+	template <typename F>
+	static bool forEachNormalizedCharacter(std::string_view path, F&& function);
+};
+
+template <typename F>
+bool pakPath::forEachNormalizedCharacter(std::string_view path, F&& function)
+{
+	// Length and last character of the normalized path so far, counting a leading "./" that is dropped
+	size_t length = 0;
+	char previous = 0;
+
+	// A leading '.' is held back until the next character shows whether it starts a "./" to drop
+	bool heldDot = false;
+	for (const char character : path)
+	{
+		char normalized = ((character >= 'A') && (character <= 'Z')) ? static_cast<char>(character - 'A' + 'a') : character;
+		if ((character == '\\') || (character == '/'))
+		{
+			// Collapse repeated separators and drop leading ones
+			if ((length == 0) || (previous == '/'))
+			{
+				continue;
+			}
+			normalized = '/';
+		}
+
+		++length;
+		previous = normalized;
+		if ((length == 1) && (normalized == '.'))
+		{
+			heldDot = true;
+			continue;
+		}
+
+		if (heldDot)
+		{
+			heldDot = false;
+			if (normalized == '/')
+			{
+				continue;
+			}
+
+			if (!function('.'))
+			{
+				return false;
+			}
+		}
+
+		if (!function(normalized))
+		{
+			return false;
+		}
+	}
+
+	return !heldDot || function('.');
+}
\ No newline at end of file
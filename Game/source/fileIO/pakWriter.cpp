@@ -0,0 +1,259 @@
+#include "pch.h"
+#include "pakWriter.h"
+#include "pakFormat.h"
+#include "lz4.h"
+#include "fileIO.h"
+#include "jobs/jobSystem.h"
+#include "platform/framework/abstract/platformConsole.h"
+#include "sString.h"
+#include "memory/memoryTracker.h"
+
+#include <fstream>
+
+// Table offsets are kept 8 byte aligned so the structs can be read in place
+static constexpr uint64_t tableAlignment = 8;
+
+static uint64_t alignUp(const uint64_t value, const uint64_t alignment)
+{
+	return ((value + alignment - 1) / alignment) * alignment;
+}
+
+void pakWriter::addFile(std::string_view path, std::vector<uint8_t>&& data)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::fileIO);
+
+	std::string normalizedPath = pakPath::normalize(path);
+	const std::vector<sSourceFile>::iterator existing = std::find_if(files.begin(), files.end(),
+		[&normalizedPath](const sSourceFile& file) { return file.path == normalizedPath; });
+	if (existing != files.end())
+	{
+		existing->data = std::move(data);
+		return;
+	}
+
+	sSourceFile& file = files.emplace_back();
+	file.pathHash = pakPath::hash(normalizedPath);
+	file.path = std::move(normalizedPath);
+	file.data = std::move(data);
+}
+
+int64_t pakWriter::addDirectory(const std::string& directory)
+{
+	std::error_code error;
+	std::filesystem::recursive_directory_iterator it(directory, error);
+	if (error)
+	{
+		return -1;
+	}
+
+	int64_t addedCount = 0;
+	for (const std::filesystem::directory_entry& entry : it)
+	{
+		if (!entry.is_regular_file())
+		{
+			continue;
+		}
+
+		std::vector<uint8_t> data;
+		fileIO::readSerializedBuffer(entry.path().string(), data);
+		addFile(std::filesystem::relative(entry.path(), directory).generic_string(), std::move(data));
+		++addedCount;
+	}
+	return addedCount;
+}
+
+bool pakWriter::write(const std::string& file, const sPakWriterDesc& desc) const
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::fileIO);
+	assert((desc.blockSize > 0) && (desc.blockSize <= lz4::maxInputSize) && "pakWriter::write: invalid block size");
+	assert((desc.dataAlignment > 0) && ((desc.dataAlignment & (desc.dataAlignment - 1)) == 0) && "pakWriter::write: data alignment must be a power of two");
+
+	// Entries are sorted by hash for the binary search, ties by path so the output does not depend on the order files were added
+	std::vector<const sSourceFile*> sortedFiles(files.size());
+	for (size_t i = 0; i < files.size(); ++i)
+	{
+		sortedFiles[i] = &files[i];
+	}
+	std::sort(sortedFiles.begin(), sortedFiles.end(), [](const sSourceFile* a, const sSourceFile* b)
+		{
+			return (a->pathHash != b->pathHash) ? (a->pathHash < b->pathHash) : (a->path < b->path);
+		});
+
+	// Lookups handle colliding hashes, but a collision in one archive is rare enough that it is reported so a path can be renamed
+	for (size_t i = 1; i < sortedFiles.size(); ++i)
+	{
+		if (sortedFiles[i - 1]->pathHash == sortedFiles[i]->pathHash)
+		{
+			platformLayer::console::consolePrint(sString::printf("pakWriter::write: warning, %s and %s have the same path hash.",
+				sortedFiles[i - 1]->path.c_str(), sortedFiles[i]->path.c_str()));
+		}
+	}
+
+	// Split every file into blocks. Blocks from all files are compressed together so small files still use every core
+	struct sBlockJob
+	{
+		const uint8_t* source = nullptr;
+		uint32_t size = 0;
+		std::vector<uint8_t> compressed;
+	};
+
+	std::vector<sPakEntry> entries(sortedFiles.size());
+	std::vector<sBlockJob> blockJobs;
+	for (size_t i = 0; i < sortedFiles.size(); ++i)
+	{
+		const std::vector<uint8_t>& data = sortedFiles[i]->data;
+		entries[i].pathHash = sortedFiles[i]->pathHash;
+		entries[i].size = data.size();
+		if (!desc.compress || data.empty())
+		{
+			continue;
+		}
+
+		entries[i].firstBlock = static_cast<uint32_t>(blockJobs.size());
+		for (size_t offset = 0; offset < data.size(); offset += desc.blockSize)
+		{
+			sBlockJob& blockJob = blockJobs.emplace_back();
+			blockJob.source = data.data() + offset;
+			blockJob.size = static_cast<uint32_t>(std::min<size_t>(desc.blockSize, data.size() - offset));
+		}
+		entries[i].blockCount = static_cast<uint32_t>(blockJobs.size()) - entries[i].firstBlock;
+	}
+
+	jobSystem::parallelFor(static_cast<uint32_t>(blockJobs.size()), 1, [&blockJobs](const uint32_t begin, const uint32_t end)
+		{
+			MEMORY_TAG_SCOPE(eMemoryTag::fileIO);
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				sBlockJob& blockJob = blockJobs[i];
+				const std::span<const uint8_t> source(blockJob.source, blockJob.size);
+				blockJob.compressed.resize(lz4::getCompressBound(blockJob.size));
+				blockJob.compressed.resize(lz4::compress(source, blockJob.compressed));
+
+				// Blocks that do not shrink are stored as is
+				if (blockJob.compressed.empty() || (blockJob.compressed.size() >= blockJob.size))
+				{
+					blockJob.compressed.assign(source.begin(), source.end());
+				}
+			}
+		});
+
+	// Entries that barely compress are stored, they can then be used in place from the map
+	for (sPakEntry& entry : entries)
+	{
+		uint64_t compressedSize = 0;
+		for (uint32_t i = 0; i < entry.blockCount; ++i)
+		{
+			compressedSize += blockJobs[entry.firstBlock + i].compressed.size();
+		}
+
+		if ((entry.blockCount > 0) && (static_cast<double>(compressedSize) > (static_cast<double>(entry.size) * desc.maxCompressionRatio)))
+		{
+			entry.blockCount = 0;
+		}
+	}
+
+	// Compact the block table to the entries that kept their blocks
+	std::vector<sPakBlock> blocks;
+	std::vector<const sBlockJob*> blockSources;
+	for (sPakEntry& entry : entries)
+	{
+		const uint32_t firstBlock = entry.firstBlock;
+		entry.firstBlock = (entry.blockCount > 0) ? static_cast<uint32_t>(blocks.size()) : 0;
+		for (uint32_t i = 0; i < entry.blockCount; ++i)
+		{
+			const sBlockJob& blockJob = blockJobs[firstBlock + i];
+			sPakBlock& block = blocks.emplace_back();
+			block.compressedSize = static_cast<uint32_t>(blockJob.compressed.size());
+			block.uncompressedSize = blockJob.size;
+			blockSources.push_back(&blockJob);
+		}
+	}
+
+	std::string strings;
+	for (size_t i = 0; i < sortedFiles.size(); ++i)
+	{
+		entries[i].pathOffset = static_cast<uint32_t>(strings.size());
+		strings.append(sortedFiles[i]->path);
+		strings.push_back('\0');
+	}
+
+	sPakHeader header;
+	header.entryCount = static_cast<uint32_t>(entries.size());
+	header.blockCount = static_cast<uint32_t>(blocks.size());
+	header.blockSize = desc.blockSize;
+	header.dataAlignment = desc.dataAlignment;
+	header.entriesOffset = alignUp(sizeof(sPakHeader), tableAlignment);
+	header.blocksOffset = alignUp(header.entriesOffset + (entries.size() * sizeof(sPakEntry)), tableAlignment);
+	header.stringsOffset = header.blocksOffset + (blocks.size() * sizeof(sPakBlock));
+	header.stringsSize = strings.size();
+
+	// Lay out the data. Each entry starts aligned, blocks within a compressed entry follow each other
+	uint64_t offset = header.stringsOffset + header.stringsSize;
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		sPakEntry& entry = entries[i];
+		offset = alignUp(offset, desc.dataAlignment);
+		entry.dataOffset = offset;
+		if (entry.blockCount == 0)
+		{
+			offset += entry.size;
+			continue;
+		}
+
+		for (uint32_t j = 0; j < entry.blockCount; ++j)
+		{
+			blocks[entry.firstBlock + j].offset = offset;
+			offset += blocks[entry.firstBlock + j].compressedSize;
+		}
+	}
+
+	std::ofstream stream(file, std::ios::binary | std::ios::trunc);
+	if (!stream.is_open())
+	{
+		platformLayer::console::consolePrint(sString::printf("pakWriter::write: could not open %s for writing.", file.c_str()));
+		return false;
+	}
+
+	const auto writePadding = [&stream](const uint64_t targetOffset)
+		{
+			static constexpr char zeros[4096] = {};
+			uint64_t position = static_cast<uint64_t>(stream.tellp());
+			while (position < targetOffset)
+			{
+				const uint64_t count = std::min<uint64_t>(targetOffset - position, sizeof(zeros));
+				stream.write(zeros, static_cast<std::streamsize>(count));
+				position += count;
+			}
+		};
+
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	writePadding(header.entriesOffset);
+	stream.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(sPakEntry)));
+	writePadding(header.blocksOffset);
+	stream.write(reinterpret_cast<const char*>(blocks.data()), static_cast<std::streamsize>(blocks.size() * sizeof(sPakBlock)));
+	stream.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		const sPakEntry& entry = entries[i];
+		writePadding(entry.dataOffset);
+		if (entry.blockCount == 0)
+		{
+			stream.write(reinterpret_cast<const char*>(sortedFiles[i]->data.data()), static_cast<std::streamsize>(entry.size));
+			continue;
+		}
+
+		for (uint32_t j = 0; j < entry.blockCount; ++j)
+		{
+			const std::vector<uint8_t>& compressed = blockSources[entry.firstBlock + j]->compressed;
+			stream.write(reinterpret_cast<const char*>(compressed.data()), static_cast<std::streamsize>(compressed.size()));
+		}
+	}
+
+	if (!stream.good())
+	{
+		platformLayer::console::consolePrint(sString::printf("pakWriter::write: failed writing %s.", file.c_str()));
+		return false;
+	}
+	return true;
+}
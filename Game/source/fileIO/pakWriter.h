@@ -0,0 +1,42 @@
+#pragma once
+
+struct sPakWriterDesc
+{
+	// Uncompressed size of each independently decompressible block
+	uint32_t blockSize = 64 * 1024;
+	// Alignment of the start of every entry's data, e.g. 512 or 4096 so stored textures and buffers can be uploaded straight from the map
+	uint32_t dataAlignment = 16;
+	bool compress = true;
+	// Entries that compress to more than this fraction of their size are stored uncompressed, decompressing them would cost more than it saves
+	float maxCompressionRatio = 0.9f;
+};
+
+// Builds pak archives offline. Files are gathered in memory and written in one go, blocks are compressed in parallel on the job system
+class pakWriter
+{
+public:
+	/** Adds a file to the archive under path, replacing a file already added under the same path */
+	void addFile(std::string_view path, std::vector<uint8_t>&& data);
+
+	/** Adds every file below directory, named by their path relative to it
+	* @return The number of files added, or -1 if the directory could not be read
+	*/
+	int64_t addDirectory(const std::string& directory);
+
+	/** Writes the archive
+	* @return True if the archive was written, otherwise false
+	*/
+	bool write(const std::string& file, const sPakWriterDesc& desc) const;
+
+	size_t getFileCount() const { return files.size(); }
+
+private:
+	struct sSourceFile
+	{
+		std::string path;
+		uint64_t pathHash = 0;
+		std::vector<uint8_t> data;
+	};
+
+	std::vector<sSourceFile> files;
+};
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "pch.h"
+#include "virtualFileSystem.h"
+#include "fileIO.h"
+#include "memory/memoryTracker.h"
+
+// Searched from the back so later mounts win
+static std::vector<std::unique_ptr<pakFile>> mountedPaks;
+
+bool virtualFileSystem::mountPak(const std::string& file)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::fileIO);
+
+	std::unique_ptr<pakFile> pak = std::make_unique<pakFile>();
+	if (!pak->open(file))
+	{
+		return false;
+	}
+
+	mountedPaks.push_back(std::move(pak));
+	return true;
+}
+
+void virtualFileSystem::unmountAll()
+{
+	mountedPaks.clear();
+}
+
+const sPakEntry* virtualFileSystem::findInPaks(std::string_view path, const pakFile** outPak)
+{
+	for (std::vector<std::unique_ptr<pakFile>>::reverse_iterator it = mountedPaks.rbegin(); it != mountedPaks.rend(); ++it)
+	{
+		const sPakEntry* const entry = (*it)->find(path);
+		if (entry != nullptr)
+		{
+			if (outPak != nullptr)
+			{
+				*outPak = it->get();
+			}
+			return entry;
+		}
+	}
+	return nullptr;
+}
+
+bool virtualFileSystem::exists(const std::string& path)
+{
+	return (findInPaks(path, nullptr) != nullptr) || fileIO::fileExists(path);
+}
+
+uint64_t virtualFileSystem::getFileSize(const std::string& path)
+{
+	const sPakEntry* const entry = findInPaks(path, nullptr);
+	if (entry != nullptr)
+	{
+		return entry->size;
+	}
+	return static_cast<uint64_t>(fileIO::fileSize(path));
+}
+
+bool virtualFileSystem::readFile(const std::string& path, std::vector<uint8_t>& outBuffer)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::fileIO);
+
+	const pakFile* pak = nullptr;
+	const sPakEntry* const entry = findInPaks(path, &pak);
+	if (entry != nullptr)
+	{
+		outBuffer.resize(static_cast<size_t>(entry->size));
+		return pak->read(*entry, outBuffer);
+	}
+
+	if (!fileIO::fileExists(path))
+	{
+		return false;
+	}
+
+	fileIO::readSerializedBuffer(path, outBuffer);
+	return true;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "pakFile.h"
+
+// Resolves asset paths against mounted pak archives before falling back to loose files on disk, so a shipped build reads everything
+// from a few mapped archives while development builds pick up edited files without repacking. Mount archives at startup before other
+// threads read through it, lookups are then lock free
+class virtualFileSystem
+{
+public:
+	/** Mounts an archive. Archives mounted later take precedence over earlier ones, e.g. a patch mounted over the base archive
+	* @return True if the archive was mounted, otherwise false
+	*/
+	static bool mountPak(const std::string& file);
+	static void unmountAll();
+
+	/** Finds the archive holding path
+	* @return The entry, or nullptr if no mounted archive contains the path. outPak is set to the archive holding the entry
+	*/
+	static const sPakEntry* findInPaks(std::string_view path, const pakFile** outPak);
+
+	/** Checks if the path exists in a mounted archive or on disk
+	* @return True if the file exists, otherwise false
+	*/
+	static bool exists(const std::string& path);
+
+	/** Gets the uncompressed size of the file
+	* @return The size of the file, or 0 if it does not exist
+	*/
+	static uint64_t getFileSize(const std::string& path);
+
+	/** Reads the whole file from a mounted archive, or from disk when no archive contains it
+	* @return True if the file was read, otherwise false
+	*/
+	static bool readFile(const std::string& path, std::vector<uint8_t>& outBuffer);
+};
\ No newline at end of file
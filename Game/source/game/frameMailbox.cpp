@@ -0,0 +1,46 @@
+#include "pch.h"
+#include "frameMailbox.h"
+
+void frameMailbox::publish()
+{
+	// Release makes the snapshot contents visible to the acquire exchange that picks up the index
+	writeIndex = sharedSlot.exchange(writeIndex | freshBit, std::memory_order_acq_rel) & indexMask;
+
+	publishCount.fetch_add(1, std::memory_order_release);
+	publishCount.notify_one();
+}
+
+const sFrameSnapshot* frameMailbox::tryAcquire()
+{
+	if ((sharedSlot.load(std::memory_order_relaxed) & freshBit) == 0)
+	{
+		return nullptr;
+	}
+
+	// Only the game thread can change the shared slot in between and it can only keep it fresh
+	readIndex = sharedSlot.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+	return &snapshots[readIndex];
+}
+
+const sFrameSnapshot* frameMailbox::waitAcquire()
+{
+	while (!closed.load(std::memory_order_acquire))
+	{
+		const uint32_t observedPublishCount = publishCount.load(std::memory_order_acquire);
+		if (const sFrameSnapshot* const snapshot = tryAcquire())
+		{
+			return snapshot;
+		}
+
+		// Returns immediately if a publish or close happened after the count was read
+		publishCount.wait(observedPublishCount, std::memory_order_acquire);
+	}
+	return nullptr;
+}
+
+void frameMailbox::close()
+{
+	closed.store(true, std::memory_order_release);
+	publishCount.fetch_add(1, std::memory_order_release);
+	publishCount.notify_all();
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "frameSnapshot.h"
+
+// Lock free triple buffered mailbox passing frame snapshots from the game thread to the render thread. The game thread always has a
+// snapshot to write and never waits, publishing replaces any snapshot the render thread has not picked up yet. The render thread
+// always reads the most recently published snapshot, which stays untouched until it acquires the next one
+class frameMailbox
+{
+public:
+	frameMailbox() = default;
+	frameMailbox(const frameMailbox&) = delete;
+	frameMailbox& operator=(const frameMailbox&) = delete;
+
+	// Game thread. Returns the snapshot to fill for the next publish
+	sFrameSnapshot& getWriteSnapshot() { return snapshots[writeIndex]; }
+
+	// Game thread. Hands the write snapshot to the render thread and returns a new one to write
+	void publish();
+
+	// Render thread. Returns the latest snapshot published since the last acquire, or nullptr if there is none
+	const sFrameSnapshot* tryAcquire();
+
+	// Render thread. Blocks until a new snapshot is published or the mailbox is closed. Returns nullptr once closed
+	const sFrameSnapshot* waitAcquire();
+
+	// Wakes a render thread blocked in waitAcquire and makes it return nullptr
+	void close();
+
+private:
+	// The shared slot holds the index of the snapshot between the threads and whether it was published since the last acquire
+	static constexpr uint32_t indexMask = 0x3;
+	static constexpr uint32_t freshBit = 0x4;
+
+	sFrameSnapshot snapshots[3];
+	uint32_t writeIndex = 0;
+	uint32_t readIndex = 2;
+	std::atomic<uint32_t> sharedSlot = 1;
+
+	// Incremented by publish and close for the render thread to wait on
+	std::atomic<uint32_t> publishCount = 0;
+	std::atomic<bool> closed = false;
+};
\ No newline at end of file
@@ -0,0 +1,36 @@
+#include "pch.h"
+#include "frameSnapshot.h"
+
+void sFrameSnapshot::clear()
+{
+	worldMatrices.clear();
+	renderDatas.clear();
+	renderDataPointers.clear();
+}
+
+void sFrameSnapshot::reserve(const size_t itemCount)
+{
+	worldMatrices.reserve(itemCount);
+	renderDatas.reserve(itemCount);
+	renderDataPointers.reserve(itemCount);
+}
+
+void sFrameSnapshot::addRenderItem(sMeshResources* meshResources, const matrix4x4f& worldMatrix)
+{
+	worldMatrices.push_back(worldMatrix);
+
+	sRenderData& renderData = renderDatas.emplace_back();
+	renderData.pMeshResources = meshResources;
+	renderData.pWorldMatrix = nullptr;
+}
+
+void sFrameSnapshot::finalize()
+{
+	// Matrices may have moved while the list grew so pointers are only taken once it is complete
+	renderDataPointers.resize(renderDatas.size());
+	for (size_t i = 0; i < renderDatas.size(); ++i)
+	{
+		renderDatas[i].pWorldMatrix = &worldMatrices[i];
+		renderDataPointers[i] = &renderDatas[i];
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "math/matrix4x4f.h"
+#include "platform/graphics/sRenderData.h"
+
+// Everything the render thread needs to draw one frame. The game thread fills a snapshot and publishes it, after which the snapshot is
+// not modified until the render thread has released it. World matrices are copied in so the simulation can keep moving objects
+struct sFrameSnapshot
+{
+	uint64_t frameIndex = 0;
+
+	// Surface client area the frame was simulated for. The render thread resizes the surface when it changes
+	uint32_t surfaceWidth = 0;
+	uint32_t surfaceHeight = 0;
+
+	matrix4x4f viewProjection;
+
+	// Visible render items. renderDatas[i] points to worldMatrices[i] and renderDataPointers[i] points to renderDatas[i]
+	std::vector<matrix4x4f> worldMatrices;
+	std::vector<sRenderData> renderDatas;
+	std::vector<const sRenderData*> renderDataPointers;
+
+	// Empties the item lists and keeps their capacity
+	void clear();
+
+	void reserve(const size_t itemCount);
+
+	// Copies the world matrix into the snapshot
+	void addRenderItem(sMeshResources* meshResources, const matrix4x4f& worldMatrix);
+
+	// Points the render data at the copied matrices. Call once after the last item is added and before publishing
+	void finalize();
+
+	uint32_t getRenderItemCount() const { return static_cast<uint32_t>(renderDataPointers.size()); }
+};
\ No newline at end of file
@@ -6,13 +6,17 @@
 #include "platform/framework/abstract/platformDisplay.h"
 #include "platform/framework/abstract/platformOS.h"
 #include "platform/framework/abstract/platformGamepad.h"
-#include "platform/framework/abstract/PlatformAudio.h"
+#include "platform/framework/abstract/platformAudio.h"
 #include "platform/framework/abstract/platformMessageBox.h"
 #include "platform/framework/abstract/platformTiming.h"
 #include "platform/framework/events/sClosedEvent.h"
 #include "platform/framework/events/sInputEvent.h"
 #include "platform/framework/events/sResizedEvent.h"
 #include "platform/graphics/abstract/graphics.h"
+#include "platform/graphics/shaderCache.h"
+#include "platform/graphics/shaderBuild.h"
+#include "platform/graphics/gpuAllocator.h"
+#include "platform/graphics/renderQueue.h"
 #include "sString.h"
 
 #include "platform/graphics/sVertexPos3Norm3Col4UV2.h"
@@ -20,6 +24,21 @@
 #include "math/vector4d.h"
 #include "math/vector2d.h"
 #include "math/transform.h"
+#include "math/matrix4x4.h"
+#include "math/vector3f.h"
+#include "math/quaternionf.h"
+#include "math/matrix3x4f.h"
+#include "culling/frustum.h"
+#include "culling/culling.h"
+#include "jobs/jobSystem.h"
+#include "fileIO/fileIO.h"
+#include "fileIO/asyncIO.h"
+#include "fileIO/virtualFileSystem.h"
+#include "fileIO/pakWriter.h"
+#include "profiler/profiler.h"
+#include "memory/scratchArena.h"
+#include "memory/memoryTracker.h"
+#include "gameComponents.h"
 
 struct sGameSettings
 {
@@ -40,23 +59,96 @@ struct sGameSettings
 	static constexpr bool enableVSync = false;
 	static constexpr bool enableTripleBuffering = false;
 	static constexpr eGraphicsApi graphicsApi = eGraphicsApi::vulkan;
+	// Records and submits frames on a separate thread while the game thread simulates the next frame
+	static constexpr bool enableRenderThread = true;
+
+	// Run mode settings
+	// Platforms without a window or graphics backend can only run the simulation
+#if defined(PLATFORM_LINUX)
+	static constexpr eRunMode defaultRunMode = eRunMode::server;
+#else
+	static constexpr eRunMode defaultRunMode = eRunMode::client;
+#endif // defined(PLATFORM_LINUX)
+	// The time in between server throughput reports printed to the console in seconds
+	static constexpr double serverReportInterval = 1.0;
+
+	// Profiler settings
+	// Chrome trace json written on exit when the profiler is compiled in
+	static constexpr const char* profilerTraceFile = "profilerTrace.json";
+
+	// Frame statistics settings
+	// Frames longer than both thresholds are recorded as hitches along with the profiler zones that grew the most
+	static constexpr double hitchThresholdMs = 1000.0 / 30.0;
+	static constexpr double hitchMedianMultiple = 2.0;
+	static constexpr const char* frameStatisticsCsvFile = "frameStatistics.csv";
+	static constexpr const char* frameStatisticsJsonFile = "frameStatistics.json";
+
+	// Memory settings
+	// Live heap bytes each subsystem should stay under, a warning is printed when one goes over. Only tracked when ENABLE_MEMORY_TRACKING is defined
+	static constexpr uint64_t graphicsMemoryBudget = 256ull * 1024 * 1024;
+	static constexpr uint64_t ecsMemoryBudget = 128ull * 1024 * 1024;
+	static constexpr uint64_t sceneMemoryBudget = 64ull * 1024 * 1024;
+	static constexpr uint64_t profilerMemoryBudget = 64ull * 1024 * 1024;
+	// Call sites listed by the memory report printed on exit
+	static constexpr uint32_t memoryReportCallSiteCount = 10;
+
+	// Async io settings
+	// Threads issuing blocking reads on platforms without a kernel read queue
+	static constexpr uint32_t ioWorkerThreadCount = 2;
+	// Bytes being read at once before further reads are held back
+	static constexpr uint64_t ioMaxInFlightBytes = 64ull * 1024 * 1024;
+
+	// Asset settings
+	// Mounted at startup when present, files it holds are read from it instead of from disk
+	static constexpr const char* assetPakFile = "assets.pak";
+	// Archive written by pack mode when no output is given
+	static constexpr const char* defaultPackOutputFile = "assets.pak";
+	static constexpr uint32_t packBlockSize = 64 * 1024;
+	// Matches the d3d12 texture data placement alignment so stored entries can be copied to the gpu straight from the mapped archive
+	static constexpr uint32_t packDataAlignment = 512;
+	// Compiled shaders keyed by their sources and settings, shared between every instance of the game run from the same directory
+	static constexpr const char* shaderCacheDirectory = "shaderCache";
 };
 
 bool game::running = false;
+eRunMode game::runMode = sGameSettings::defaultRunMode;
+uint64_t game::serverTickLimit = 0;
+uint32_t game::jobWorkerCount = 0;
+std::string game::packSourceDirectory;
+std::string game::packOutputFile = sGameSettings::defaultPackOutputFile;
+std::string game::shaderManifestFile;
+eGraphicsApi game::shaderBuildApi = sGameSettings::graphicsApi;
 std::shared_ptr<platformLayer::window::platformWindow> game::window;
 std::shared_ptr<graphics> game::graphicsContext;
 std::shared_ptr<graphicsSurface> game::surface;
 int64_t game::fps = 0;
 double game::ms = 0.0;
+frameStatistics game::frameStats;
 bool game::graphicsInitialized = false;
 
 sMeshResources game::triangleMeshResources = {};
-matrix4x4 game::triangleWorldMatrix;
-sRenderData game::triangleRenderData = {};
-matrix4x4 game::viewProjectionMatrix;
+matrix4x4f game::viewProjectionMatrix;
+ecsWorld game::world;
+entityCommandBuffer game::commandBuffer;
+transformHierarchy game::transforms;
+std::vector<sEntity> game::nodeEntities;
+dynamicAabbTree game::sceneTree;
+std::vector<sEntity> game::proxyEntities;
+std::vector<sMeshResources*> game::renderMeshes;
+std::vector<const matrix4x4f*> game::renderWorldMatrices;
+sBoundingSpheres game::renderBounds;
+std::vector<uint32_t> game::visibleIndices;
+frameMailbox game::renderMailbox;
+std::thread game::renderThread;
+uint64_t game::frameIndex = 0;
+uint32_t game::surfaceWidth = 0;
+uint32_t game::surfaceHeight = 0;
+uint32_t game::renderedSurfaceWidth = 0;
+uint32_t game::renderedSurfaceHeight = 0;
 
 void game::start()
 {
+	MEMORY_TAG_SCOPE(eMemoryTag::game);
 	running = true;
 
 	if (platformLayer::console::initConsole() != 0)
@@ -65,6 +157,129 @@ void game::start()
 	}
 
 	parseCommandLineArgs();
+
+	sFrameStatisticsDesc frameStatisticsDesc = {};
+	frameStatisticsDesc.hitchThresholdMs = sGameSettings::hitchThresholdMs;
+	frameStatisticsDesc.hitchMedianMultiple = sGameSettings::hitchMedianMultiple;
+	frameStats.init(frameStatisticsDesc);
+
+	memoryTracker::setBudget(eMemoryTag::graphics, sGameSettings::graphicsMemoryBudget);
+	memoryTracker::setBudget(eMemoryTag::ecs, sGameSettings::ecsMemoryBudget);
+	memoryTracker::setBudget(eMemoryTag::scene, sGameSettings::sceneMemoryBudget);
+	memoryTracker::setBudget(eMemoryTag::profiler, sGameSettings::profilerMemoryBudget);
+
+	// The calling thread becomes job thread 0 and helps run jobs whenever it waits on them
+	PROFILE_THREAD("game");
+	jobSystem::init(jobWorkerCount);
+
+	sAsyncIODesc asyncIODesc = {};
+	asyncIODesc.workerThreadCount = sGameSettings::ioWorkerThreadCount;
+	asyncIODesc.maxInFlightBytes = sGameSettings::ioMaxInFlightBytes;
+	asyncIO::init(asyncIODesc);
+
+	// Mounted before anything reads assets, the virtual file system is not changed after this
+	if ((runMode != eRunMode::pack) && (runMode != eRunMode::buildShaders) && (runMode != eRunMode::benchmarkRenderQueue) && fileIO::fileExists(sGameSettings::assetPakFile) && !virtualFileSystem::mountPak(sGameSettings::assetPakFile))
+	{
+		platformLayer::console::consolePrint(sString::printf("game: failed to mount %s, reading loose files.", sGameSettings::assetPakFile));
+	}
+
+	switch (runMode)
+	{
+	case eRunMode::client: runClient(); break;
+	case eRunMode::server: runServer(); break;
+	case eRunMode::pack: runPack(); break;
+	case eRunMode::buildShaders: runBuildShaders(); break;
+	case eRunMode::benchmarkRenderQueue: runRenderQueueBenchmark(); break;
+	}
+
+	virtualFileSystem::unmountAll();
+	asyncIO::shutdown();
+	jobSystem::shutdown();
+
+	// Tool modes run no frames
+	if ((runMode == eRunMode::client) || (runMode == eRunMode::server))
+	{
+		const sFrameTimeSummary frameTimes = frameStats.getTotalSummary();
+		platformLayer::console::consolePrint(sString::printf("game: %llu frames, mean %.4f ms, p50 %.4f ms, p95 %.4f ms, p99 %.4f ms, max %.4f ms, %zu hitches.",
+			static_cast<unsigned long long>(frameTimes.frameCount), frameTimes.meanMs, frameTimes.p50Ms, frameTimes.p95Ms, frameTimes.p99Ms, frameTimes.maxMs, frameStats.getHitches().size()));
+		frameStats.exportCsv(sGameSettings::frameStatisticsCsvFile);
+		frameStats.exportJson(sGameSettings::frameStatisticsJsonFile);
+	}
+
+#if defined(ENABLE_PROFILER)
+	profiler::exportChromeTrace(sGameSettings::profilerTraceFile);
+#endif // defined(ENABLE_PROFILER)
+
+	memoryTracker::printReport(sGameSettings::memoryReportCallSiteCount);
+}
+
+void game::parseCommandLineArgs()
+{
+	int32_t argc;
+	wchar_t** argv = platformLayer::commandLine::getArgcArgv(argc);
+
+	// The first argument is the executable path
+	for (int32_t i = 1; i < argc; ++i)
+	{
+		const std::wstring arg = argv[i];
+
+		if (arg == L"-client")
+		{
+			runMode = eRunMode::client;
+		}
+		else if (arg == L"-server")
+		{
+			runMode = eRunMode::server;
+		}
+		else if (arg.rfind(L"-workers=", 0) == 0)
+		{
+			// Number of job worker threads. 0 creates one for every core but the main thread's
+			jobWorkerCount = static_cast<uint32_t>(std::wcstoul(arg.c_str() + 9, nullptr, 10));
+		}
+		else if (arg.rfind(L"-ticks=", 0) == 0)
+		{
+			// Number of ticks the server runs for before exiting. 0 runs until a quit is requested
+			serverTickLimit = std::wcstoull(arg.c_str() + 7, nullptr, 10);
+		}
+		else if (arg.rfind(L"-pack=", 0) == 0)
+		{
+			// Directory packed into an archive by pack mode
+			runMode = eRunMode::pack;
+			packSourceDirectory = std::filesystem::path(arg.substr(6)).string();
+		}
+		else if (arg.rfind(L"-packOutput=", 0) == 0)
+		{
+			packOutputFile = std::filesystem::path(arg.substr(12)).string();
+		}
+		else if (arg.rfind(L"-buildShaders=", 0) == 0)
+		{
+			// Shader manifest compiled by build shaders mode
+			runMode = eRunMode::buildShaders;
+			shaderManifestFile = std::filesystem::path(arg.substr(14)).string();
+		}
+		else if (arg == L"-benchmarkRenderQueue")
+		{
+			runMode = eRunMode::benchmarkRenderQueue;
+		}
+		else if (arg == L"-shaderApi=direct3d12")
+		{
+			shaderBuildApi = eGraphicsApi::direct3d12;
+		}
+		else if (arg == L"-shaderApi=vulkan")
+		{
+			shaderBuildApi = eGraphicsApi::vulkan;
+		}
+		else
+		{
+			platformLayer::console::consolePrint(sString::printf("game::parseCommandLineArgs: ignoring unknown argument %ls.", arg.c_str()));
+		}
+	}
+
+	platformLayer::commandLine::freeArgv(argv);
+}
+
+void game::runClient()
+{
 	initializeWindow();
 	initializeGamepad();
 	initializeGraphics();
@@ -73,13 +288,17 @@ void game::start()
 
 	// Initialize game loop
 	begin();
-	
+	startRenderThread();
+
 	double fixedTimeSliceMs = sGameSettings::fixedTimeSlice * 1000.0;
 	double accumulator = 0.0;
 	std::chrono::time_point previousTime = std::chrono::high_resolution_clock::now();
 
 	while (running)
 	{
+		PROFILE_FRAME();
+		frameStats.recordFrame(platformLayer::timing::getTimestampNanoseconds());
+
 		// Calculate and accumulate delta time in seconds
 		std::chrono::time_point currentTime = std::chrono::high_resolution_clock::now();
 		const float deltaSeconds = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - previousTime).count();
@@ -89,6 +308,11 @@ void game::start()
 		platformLayer::os::pollOS();
 		platformLayer::gamepad::pollGamepads();
 
+		if (platformLayer::os::isQuitRequested())
+		{
+			exit();
+		}
+
 		tick(deltaSeconds);
 
 		while (accumulator > fixedTimeSliceMs)
@@ -104,22 +328,235 @@ void game::start()
 
 		// Update frame timing
 		platformLayer::timing::updateTiming(fps, ms);
+		memoryTracker::reportBudgetWarnings();
 	}
 
+	stopRenderThread();
 	shutdownGraphics();
 	platformLayer::window::destroyWindow(window);
 }
 
-void game::parseCommandLineArgs()
+void game::runPack()
 {
-	int32_t argc;
-	wchar_t** argv = platformLayer::commandLine::getArgcArgv(argc);
-	// Todo: Parse arguments
-	platformLayer::commandLine::freeArgv(argv);
+	MEMORY_TAG_SCOPE(eMemoryTag::fileIO);
+	platformLayer::console::consolePrint(sString::printf("game: packing %s into %s.", packSourceDirectory.c_str(), packOutputFile.c_str()));
+
+	const int64_t startTimestamp = platformLayer::timing::getTimestampNanoseconds();
+	pakWriter writer;
+	if (writer.addDirectory(packSourceDirectory) < 0)
+	{
+		platformLayer::console::consolePrint(sString::printf("game: could not read %s.", packSourceDirectory.c_str()));
+		return;
+	}
+
+	sPakWriterDesc pakWriterDesc = {};
+	pakWriterDesc.blockSize = sGameSettings::packBlockSize;
+	pakWriterDesc.dataAlignment = sGameSettings::packDataAlignment;
+	if (!writer.write(packOutputFile, pakWriterDesc))
+	{
+		return;
+	}
+
+	const double seconds = static_cast<double>(platformLayer::timing::getTimestampNanoseconds() - startTimestamp) / 1000000000.0;
+	platformLayer::console::consolePrint(sString::printf("game: packed %zu files into %llu bytes in %.3f s.", writer.getFileCount(),
+		static_cast<unsigned long long>(fileIO::fileSize(packOutputFile)), seconds));
+}
+
+void game::runBuildShaders()
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::graphics);
+
+	sShaderCompiler compiler;
+	if (!graphics::getShaderCompiler(shaderBuildApi, compiler))
+	{
+		platformLayer::console::consolePrint("game: the graphics api has no shader compiler on this platform.");
+		return;
+	}
+
+	std::vector<sShaderDesc> shaders;
+	std::string errors;
+	if (!shaderBuild::parseManifest(shaderManifestFile, shaders, errors))
+	{
+		platformLayer::console::consolePrint(errors);
+		return;
+	}
+
+	platformLayer::console::consolePrint(sString::printf("game: building %zu shaders from %s with %s.", shaders.size(), shaderManifestFile.c_str(), compiler.version.c_str()));
+	shaderCache::open(sGameSettings::shaderCacheDirectory);
+
+	const int64_t startTimestamp = platformLayer::timing::getTimestampNanoseconds();
+	const sShaderBuildResult result = shaderBuild::build(shaders, compiler, nullptr);
+	const double seconds = static_cast<double>(platformLayer::timing::getTimestampNanoseconds() - startTimestamp) / 1000000000.0;
+
+	if (!result.diagnostics.empty())
+	{
+		platformLayer::console::consolePrint(result.diagnostics);
+	}
+	platformLayer::console::consolePrint(sString::printf("game: built shaders in %.3f s, %u from the cache, %u compiled, %u failed.",
+		seconds, result.cachedCount, result.compiledCount, result.failedCount));
+
+	shaderCache::close();
+}
+
+void game::runRenderQueueBenchmark()
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::graphics);
+
+	static constexpr uint32_t sceneSizes[] = { 10000, 100000, 1000000 };
+	static constexpr uint32_t repeatCount = 5;
+
+	// Synthetic scenes of a few passes and pipelines, more materials and many meshes, the same seed every run
+	std::mt19937 random(1234);
+	std::uniform_int_distribution<uint32_t> passDistribution(0, 1);
+	std::uniform_int_distribution<uint32_t> pipelineDistribution(0, 7);
+	std::uniform_int_distribution<uint32_t> materialDistribution(0, 63);
+	std::uniform_int_distribution<uint32_t> meshDistribution(0, 511);
+	std::uniform_real_distribution<float> depthDistribution(0.1f, 1000.0f);
+
+	// Items further along the view direction must sort after nearer ones. Laid out as the game passes matrices to graphics::render
+	const matrix4x4f checkViewProjection(matrix4x4::transpose(matrix4x4::view(vector3d(0.0, 0.0, -5.0), rotator(0.0, 0.0, 0.0))) *
+		matrix4x4::transpose(matrix4x4::perspective(45.0, 1280.0, 720.0, 0.1, 100.0)));
+	static constexpr float checkDistances[] = { 0.0f, 10.0f, 50.0f };
+	uint64_t previousCheckKey = 0;
+	for (const float distance : checkDistances)
+	{
+		const matrix4x4f worldMatrix = matrix4x4f::transpose(matrix4x4f::translation(vector3f(0.0f, 0.0f, distance)));
+		const uint64_t key = renderQueue::makeKey(0, 0, 0, 0, renderQueue::getViewDepth(worldMatrix, checkViewProjection));
+		if (key <= previousCheckKey)
+		{
+			platformLayer::console::consolePrint(sString::printf("game: render queue key of an item %.1f units away does not sort after nearer items.", distance));
+			return;
+		}
+		previousCheckKey = key;
+	}
+
+	platformLayer::console::consolePrint(sString::printf("game: benchmarking the render queue, best of %u sorts per scene.", repeatCount));
+
+	for (const uint32_t itemCount : sceneSizes)
+	{
+		std::vector<uint64_t> sceneKeys(itemCount);
+		for (uint64_t& key : sceneKeys)
+		{
+			key = renderQueue::makeKey(passDistribution(random), pipelineDistribution(random), materialDistribution(random), meshDistribution(random), depthDistribution(random));
+		}
+
+		// Each sort starts from the unsorted scene, only the sort itself is timed
+		renderQueue queue;
+		std::vector<uint64_t> referenceKeys;
+		int64_t radixNanoseconds = INT64_MAX;
+		int64_t referenceNanoseconds = INT64_MAX;
+		for (uint32_t repeat = 0; repeat < repeatCount; ++repeat)
+		{
+			queue.reset(itemCount);
+			std::copy(sceneKeys.begin(), sceneKeys.end(), queue.getKeys().begin());
+			int64_t startTimestamp = platformLayer::timing::getTimestampNanoseconds();
+			queue.sort(std::pmr::new_delete_resource());
+			radixNanoseconds = std::min(radixNanoseconds, platformLayer::timing::getTimestampNanoseconds() - startTimestamp);
+
+			referenceKeys = sceneKeys;
+			startTimestamp = platformLayer::timing::getTimestampNanoseconds();
+			std::sort(referenceKeys.begin(), referenceKeys.end());
+			referenceNanoseconds = std::min(referenceNanoseconds, platformLayer::timing::getTimestampNanoseconds() - startTimestamp);
+		}
+
+		const std::span<const uint64_t> sortedKeys = queue.getKeys();
+		if (!std::equal(sortedKeys.begin(), sortedKeys.end(), referenceKeys.begin()))
+		{
+			platformLayer::console::consolePrint(sString::printf("game: render queue sort of %u items does not match std::sort.", itemCount));
+			return;
+		}
+
+		const sRenderStateChanges unsortedChanges = renderQueue::countStateChanges(sceneKeys);
+		const sRenderStateChanges sortedChanges = renderQueue::countStateChanges(sortedKeys);
+		platformLayer::console::consolePrint(sString::printf("game: %u items, radix sort %.3f ms, std::sort %.3f ms.",
+			itemCount, static_cast<double>(radixNanoseconds) / 1000000.0, static_cast<double>(referenceNanoseconds) / 1000000.0));
+		platformLayer::console::consolePrint(sString::printf("game:   unsorted %u pipeline, %u material and %u mesh changes, sorted %u pipeline, %u material and %u mesh changes.",
+			unsortedChanges.pipelineChanges, unsortedChanges.materialChanges, unsortedChanges.meshChanges,
+			sortedChanges.pipelineChanges, sortedChanges.materialChanges, sortedChanges.meshChanges));
+	}
+}
+
+void game::runServer()
+{
+	platformLayer::console::consolePrint("game: running in server mode.");
+
+	// Initialize game loop
+	begin();
+
+	double accumulator = 0.0;
+	uint64_t tickCount = 0;
+	uint64_t fixedTickCount = 0;
+	uint64_t reportTickCount = 0;
+	uint64_t reportFixedTickCount = 0;
+
+	// One monotonic timestamp per tick drives the delta time, the throughput report and the frame statistics
+	const int64_t startTimestamp = platformLayer::timing::getTimestampNanoseconds();
+	int64_t previousTimestamp = startTimestamp;
+	int64_t reportTimestamp = startTimestamp;
+
+	// Tick as fast as possible. There is no window to poll, no graphics to wait on and no vsync to throttle the loop
+	while (running)
+	{
+		PROFILE_FRAME();
+		const int64_t currentTimestamp = platformLayer::timing::getTimestampNanoseconds();
+		frameStats.recordFrame(currentTimestamp);
+
+		// Calculate and accumulate delta time in seconds
+		const float deltaSeconds = static_cast<float>(static_cast<double>(currentTimestamp - previousTimestamp) / 1000000000.0);
+		previousTimestamp = currentTimestamp;
+		accumulator += deltaSeconds;
+
+		platformLayer::os::pollOS();
+
+		if (platformLayer::os::isQuitRequested())
+		{
+			exit();
+		}
+
+		tick(deltaSeconds);
+		++tickCount;
+
+		while (accumulator > sGameSettings::fixedTimeSlice)
+		{
+			fixedTick(sGameSettings::fixedStep);
+			accumulator -= sGameSettings::fixedTimeSlice;
+			++fixedTickCount;
+		}
+
+		// Report tick throughput over the last interval
+		const double reportSeconds = static_cast<double>(currentTimestamp - reportTimestamp) / 1000000000.0;
+		if (reportSeconds >= sGameSettings::serverReportInterval)
+		{
+			const uint64_t intervalTicks = tickCount - reportTickCount;
+			const uint64_t intervalFixedTicks = fixedTickCount - reportFixedTickCount;
+			scratchScope scratch;
+			platformLayer::console::consolePrint(sString::printf(scratch.getArena(), "server: %.0f ticks/s (%.3f us/tick), %.0f fixed ticks/s.",
+				static_cast<double>(intervalTicks) / reportSeconds,
+				(reportSeconds * 1000000.0) / static_cast<double>(std::max<uint64_t>(intervalTicks, 1)),
+				static_cast<double>(intervalFixedTicks) / reportSeconds));
+
+			reportTimestamp = currentTimestamp;
+			reportTickCount = tickCount;
+			reportFixedTickCount = fixedTickCount;
+
+			memoryTracker::reportBudgetWarnings();
+		}
+
+		if ((serverTickLimit != 0) && (tickCount >= serverTickLimit))
+		{
+			exit();
+		}
+	}
+
+	const double totalSeconds = static_cast<double>(platformLayer::timing::getTimestampNanoseconds() - startTimestamp) / 1000000000.0;
+	platformLayer::console::consolePrint(sString::printf("server: ran %llu ticks and %llu fixed ticks in %.3f s (%.0f ticks/s).",
+		static_cast<unsigned long long>(tickCount), static_cast<unsigned long long>(fixedTickCount), totalSeconds,
+		static_cast<double>(tickCount) / std::max(totalSeconds, 0.000001)));
 }
 
 void game::initializeWindow()
 {
+	MEMORY_TAG_SCOPE(eMemoryTag::platform);
 	// Get the default display info
 	sDisplayDesc defaultDisplayDesc = platformLayer::display::getInfoForDisplayAtIndex(sGameSettings::defaultDisplayIndex);
 
@@ -144,11 +581,13 @@ void game::initializeWindow()
 
 void game::initializeGamepad()
 {
+	MEMORY_TAG_SCOPE(eMemoryTag::platform);
 	platformLayer::gamepad::addOnInputEventDelegate([](platformLayer::input::sInputEvent&& evt) { onInput(std::move(evt)); });
 }
 
 void game::initializeGraphics()
 {
+	MEMORY_TAG_SCOPE(eMemoryTag::graphics);
 	uint32_t width;
 	uint32_t height;
 	if (platformLayer::window::getWindowClientAreaDimensions(window.get(), width, height) != 0)
@@ -156,6 +595,9 @@ void game::initializeGraphics()
 		platformLayer::messageBox::showMessageBoxFatal("initializeGraphics: failed to get window client area dimensions.");
 	}
 	
+	// Without the cache every shader is compiled
+	shaderCache::open(sGameSettings::shaderCacheDirectory);
+
 	graphics::create(sGameSettings::graphicsApi, graphicsContext);
 	if (graphicsContext == nullptr)
 	{
@@ -164,6 +606,8 @@ void game::initializeGraphics()
 
 	graphicsContext->init(false, sGameSettings::enableTripleBuffering ? 3 : 2);
 	graphicsContext->createSurface(platformLayer::window::getWindowHandle(window.get()), width, height, sGameSettings::enableVSync, surface);
+	surfaceWidth = renderedSurfaceWidth = width;
+	surfaceHeight = renderedSurfaceHeight = height;
 
 	loadResources();
 
@@ -172,14 +616,27 @@ void game::initializeGraphics()
 
 void game::shutdownGraphics()
 {
+	MEMORY_TAG_SCOPE(eMemoryTag::graphics);
+
+	sGpuMemoryStats memoryStats = {};
+	graphicsContext->getMemoryStats(memoryStats);
+	platformLayer::console::consolePrint(sString::printf("game: gpu memory %u heaps (%u dedicated), %u allocations, %.2f of %.2f MB used, %.2f fragmentation.",
+		memoryStats.heapCount, memoryStats.dedicatedHeapCount, memoryStats.allocationCount, static_cast<double>(memoryStats.usedBytes) / (1024.0 * 1024.0),
+		static_cast<double>(memoryStats.reservedBytes) / (1024.0 * 1024.0), memoryStats.getFragmentation()));
+
 	graphicsContext->destroySurface(surface);
 	graphicsContext->shutdown();
 
+	const sShaderCacheStats shaderCacheStats = shaderCache::getStats();
+	platformLayer::console::consolePrint(sString::printf("game: %u shaders loaded from the cache, %u compiled.", shaderCacheStats.hits, shaderCacheStats.misses));
+	shaderCache::close();
+
 	graphicsInitialized = false;
 }
 
 void game::initializeAudio()
 {
+	MEMORY_TAG_SCOPE(eMemoryTag::platform);
 	platformLayer::audio::initAudio();
 }
 
@@ -200,11 +657,62 @@ void game::loadResources()
 	sMeshResources* loadOutMeshResources[] = { &triangleMeshResources };
 	graphicsContext->loadMeshes(1, loadVertexCounts, loadVertices, loadIndexCounts, loadIndices, loadOutMeshResources);
 
-	transform(vector3d(-1.0, 0.5, 0.0), rotator(0.0, 0.0, 45.0), vector3d(1.0, 1.0, 1.0));
-	triangleWorldMatrix = matrix4x4::transpose(matrix4x4::transformation(transform(vector3d(-1.0, 0.5, 0.0), rotator(0.0, 0.0, 45.0), vector3d(1.0, 1.0, 1.0))));
-	
-	triangleRenderData.pMeshResources = &triangleMeshResources;
-	triangleRenderData.pWorldMatrix = &triangleWorldMatrix;
+	sMeshComponent triangleMesh;
+	triangleMesh.meshResources = &triangleMeshResources;
+
+	// Bounding sphere around the triangle vertices, placed and scaled to the triangle world transform by updateTransforms
+	sBoundingSphereComponent triangleBounds;
+	triangleBounds.localRadius = 0.75f;
+	triangleBounds.radius = triangleBounds.localRadius;
+
+	const sEntity triangle = world.createEntity(sWorldMatrixComponent(), triangleMesh, triangleBounds);
+
+	const uint32_t triangleNode = transforms.createNode(transformHierarchy::invalidNode, vector3f(-1.0f, 0.5f, 0.0f), quaternionf(rotator(0.0, 0.0, 45.0)), vector3f(1.0f, 1.0f, 1.0f));
+	attachTransformNode(triangle, triangleNode);
+}
+
+void game::attachTransformNode(const sEntity entity, const uint32_t node)
+{
+	if (node >= nodeEntities.size())
+	{
+		nodeEntities.resize(node + 1);
+	}
+	nodeEntities[node] = entity;
+
+	sTransformNodeComponent nodeComponent;
+	nodeComponent.node = node;
+	world.addComponent(entity, nodeComponent);
+}
+
+void game::onEntityDestroyed(const sEntity entity)
+{
+	if (const sBoundingSphereComponent* const bounds = world.getComponent<sBoundingSphereComponent>(entity))
+	{
+		if (bounds->sceneProxy != dynamicAabbTree::nullNode)
+		{
+			sceneTree.destroyProxy(bounds->sceneProxy);
+			proxyEntities[bounds->sceneProxy] = sEntity();
+		}
+	}
+
+	const sTransformNodeComponent* const nodeComponent = world.getComponent<sTransformNodeComponent>(entity);
+	if ((nodeComponent == nullptr) || (nodeComponent->node >= nodeEntities.size()) || (nodeEntities[nodeComponent->node] != entity))
+	{
+		return;
+	}
+
+	// Entities attached to nodes below the destroyed node go with it, the same way their nodes do
+	std::vector<uint32_t> destroyedNodes;
+	transforms.destroyNode(nodeComponent->node, &destroyedNodes);
+	for (const uint32_t node : destroyedNodes)
+	{
+		const sEntity nodeEntity = nodeEntities[node];
+		nodeEntities[node] = sEntity();
+		if (nodeEntity != entity)
+		{
+			world.destroyEntity(nodeEntity);
+		}
+	}
 }
 
 void game::onWindowClosed(platformLayer::window::sClosedEvent&& evt)
@@ -214,8 +722,10 @@ void game::onWindowClosed(platformLayer::window::sClosedEvent&& evt)
 
 void game::onWindowResized(platformLayer::window::sResizedEvent&& evt)
 {
+	// The render thread resizes the surface when it draws the first frame simulated at the new size
 	updateViewProjectionMatrix();
-	graphicsContext->resizeSurface(surface.get(), evt.newClientWidth, evt.newClientHeight);
+	surfaceWidth = evt.newClientWidth;
+	surfaceHeight = evt.newClientHeight;
 }
 
 void game::onInput(platformLayer::input::sInputEvent&& evt)
@@ -230,10 +740,15 @@ void game::exit()
 
 void game::begin()
 {
+	world.setDestroyCallback(onEntityDestroyed);
 }
 
 void game::tick(float deltaSeconds)
 {
+	PROFILE_SCOPE("game::tick");
+
+	commandBuffer.playback(world);
+	updateTransforms();
 }
 
 void game::fixedTick(float fixedStep)
@@ -242,11 +757,100 @@ void game::fixedTick(float fixedStep)
 
 void game::render()
 {
+	PROFILE_SCOPE("game::render");
+
+	sFrameSnapshot& snapshot = renderMailbox.getWriteSnapshot();
+	snapshot.clear();
+	snapshot.frameIndex = frameIndex++;
+	snapshot.surfaceWidth = surfaceWidth;
+	snapshot.surfaceHeight = surfaceHeight;
+	snapshot.viewProjection = viewProjectionMatrix;
+
+	// Gather the renderable entities whose fat bounds in the scene tree touch the view frustum
+	const sFrustum frustum = sFrustum::fromViewProjection(viewProjectionMatrix);
+	renderMeshes.clear();
+	renderWorldMatrices.clear();
+	renderBounds.clear();
+	sceneTree.queryFrustum(frustum,
+		[](const int32_t proxy)
+		{
+			const sEntity entity = proxyEntities[proxy];
+			const sMeshComponent* const mesh = world.getComponent<sMeshComponent>(entity);
+			const sWorldMatrixComponent* const worldMatrix = world.getComponent<sWorldMatrixComponent>(entity);
+			const sBoundingSphereComponent* const bounds = world.getComponent<sBoundingSphereComponent>(entity);
+			if ((mesh != nullptr) && (worldMatrix != nullptr) && (bounds != nullptr))
+			{
+				renderMeshes.push_back(mesh->meshResources);
+				renderWorldMatrices.push_back(&worldMatrix->worldMatrix);
+				renderBounds.add(bounds->center, bounds->radius);
+			}
+			return true;
+		});
+
+	// Only submit entities with bounds inside the view frustum, the tree only tested their enlarged boxes
+	visibleIndices.resize(renderBounds.size());
+	const uint32_t visibleCount = culling::cullSpheres(frustum, renderBounds, visibleIndices.data());
+	snapshot.reserve(visibleCount);
+	for (uint32_t i = 0; i < visibleCount; ++i)
+	{
+		snapshot.addRenderItem(renderMeshes[visibleIndices[i]], *renderWorldMatrices[visibleIndices[i]]);
+	}
+	snapshot.finalize();
+
+	renderMailbox.publish();
+
+	if (!sGameSettings::enableRenderThread)
+	{
+		renderFrame(*renderMailbox.tryAcquire());
+	}
+}
+
+void game::startRenderThread()
+{
+	if (sGameSettings::enableRenderThread)
+	{
+		renderThread = std::thread(&game::renderThreadMain);
+	}
+}
+
+void game::stopRenderThread()
+{
+	if (renderThread.joinable())
+	{
+		renderMailbox.close();
+		renderThread.join();
+	}
+}
+
+void game::renderThreadMain()
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::graphics);
+	// Lets the render thread wait on jobs it submits without running them inline
+	jobSystem::registerThread();
+	PROFILE_THREAD("render");
+
+	while (const sFrameSnapshot* const snapshot = renderMailbox.waitAcquire())
+	{
+		renderFrame(*snapshot);
+	}
+}
+
+void game::renderFrame(const sFrameSnapshot& snapshot)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::graphics);
+	PROFILE_SCOPE("game::renderFrame");
+
+	if ((snapshot.surfaceWidth != renderedSurfaceWidth) || (snapshot.surfaceHeight != renderedSurfaceHeight))
+	{
+		graphicsContext->resizeSurface(surface.get(), snapshot.surfaceWidth, snapshot.surfaceHeight);
+		renderedSurfaceWidth = snapshot.surfaceWidth;
+		renderedSurfaceHeight = snapshot.surfaceHeight;
+	}
+
 	graphicsContext->beginFrame();
 
-	const sRenderData* const renderDatas[] = { &triangleRenderData };
 	graphicsSurface* const surfaces[] = { surface.get() };
-	graphicsContext->render(_countof(surfaces), surfaces, _countof(renderDatas), renderDatas, &viewProjectionMatrix);
+	graphicsContext->render(_countof(surfaces), surfaces, snapshot.getRenderItemCount(), snapshot.renderDataPointers.data(), &snapshot.viewProjection);
 
 	graphicsSurface* const renderedSurfaces[] = { surface.get() };
 	graphicsContext->endFrame(_countof(renderedSurfaces), renderedSurfaces);
@@ -260,5 +864,56 @@ void game::updateViewProjectionMatrix()
 	static const double orthoZoom = 0.002;
 	matrix4x4 projectionMatrix = matrix4x4::transpose(matrix4x4::orthographic(static_cast<double>(width) * orthoZoom, static_cast<double>(height) * orthoZoom, 0.1, 100.0));
 	//matrix4x4 projectionMatrix = matrix4x4::transpose(matrix4x4::perspective(45.0, static_cast<double>(width), static_cast<double>(height), 0.1, 100.0));
-	viewProjectionMatrix = viewMatrix * projectionMatrix;
+	// Camera matrices are built in double precision and narrowed once for the per-object multiplies
+	viewProjectionMatrix = matrix4x4f(viewMatrix * projectionMatrix);
+}
+
+void game::updateTransforms()
+{
+	// Only nodes that moved, or sit below one that moved, are recomputed and copied back to their entity
+	PROFILE_SCOPE("game::updateTransforms");
+	transforms.update();
+	for (const uint32_t node : transforms.getChangedNodes())
+	{
+		// A recycled entity slot must not pick up the transform of the entity that used it before
+		const sEntity entity = nodeEntities[node];
+		if (!world.isAlive(entity))
+		{
+			continue;
+		}
+
+		const matrix3x4f& worldMatrix = transforms.getWorldMatrix(node);
+
+		if (sWorldMatrixComponent* const worldMatrixComponent = world.getComponent<sWorldMatrixComponent>(entity))
+		{
+			worldMatrixComponent->worldMatrix = matrix4x4f::transpose(worldMatrix.toMatrix4x4f());
+		}
+
+		if (sBoundingSphereComponent* const bounds = world.getComponent<sBoundingSphereComponent>(entity))
+		{
+			const vector3f previousCenter = bounds->center;
+			bounds->center = vector3f(worldMatrix.values[3], worldMatrix.values[7], worldMatrix.values[11]);
+			bounds->radius = bounds->localRadius * worldMatrix.maxAxisScale();
+			updateSceneProxy(entity, *bounds, previousCenter);
+		}
+	}
+}
+
+void game::updateSceneProxy(const sEntity entity, sBoundingSphereComponent& bounds, const vector3f& previousCenter)
+{
+	const sAabb aabb = sAabb::fromCenterExtents(bounds.center.x, bounds.center.y, bounds.center.z, bounds.radius, bounds.radius, bounds.radius);
+	if (bounds.sceneProxy == dynamicAabbTree::nullNode)
+	{
+		bounds.sceneProxy = sceneTree.createProxy(aabb, 0);
+		if (static_cast<size_t>(bounds.sceneProxy) >= proxyEntities.size())
+		{
+			proxyEntities.resize(bounds.sceneProxy + 1);
+		}
+		proxyEntities[bounds.sceneProxy] = entity;
+		return;
+	}
+
+	// The displacement stretches the fat box along the motion so steadily moving entities are reinserted less often
+	const float displacement[3] = { bounds.center.x - previousCenter.x, bounds.center.y - previousCenter.y, bounds.center.z - previousCenter.z };
+	sceneTree.moveProxy(bounds.sceneProxy, aabb, displacement);
 }
@@ -1,8 +1,16 @@
 #pragma once
 
 #include "platform/graphics/sMeshResources.h"
-#include "math/matrix4x4.h"
+#include "math/matrix4x4f.h"
 #include "platform/graphics/sRenderData.h"
+#include "platform/graphics/abstract/graphicsApi.h"
+#include "culling/boundingVolumes.h"
+#include "culling/dynamicAabbTree.h"
+#include "frameMailbox.h"
+#include "ecs/ecsWorld.h"
+#include "ecs/entityCommandBuffer.h"
+#include "scene/transformHierarchy.h"
+#include "profiler/frameStatistics.h"
 
 namespace platformLayer
 {
@@ -23,27 +31,87 @@ namespace platformLayer
 class graphics;
 class graphicsSurface;
 
+enum class eRunMode : uint8_t
+{
+	// Windowed game with graphics, audio and input
+	client = 0,
+	// Headless simulation that drives tick and fixed tick as fast as possible without a window, graphics or audio
+	server = 1,
+	// Offline tool that packs a directory of assets into a pak archive and exits
+	pack = 2,
+	// Offline tool that compiles every shader in a manifest into the shader cache and exits
+	buildShaders = 3,
+	// Offline tool that times sorting synthetic scenes with the render queue and exits
+	benchmarkRenderQueue = 4
+};
+
 class game
 {
 private:
 	static bool running;
+	static eRunMode runMode;
+	static uint64_t serverTickLimit;
+	static uint32_t jobWorkerCount;
+	// Pack mode input directory and output archive
+	static std::string packSourceDirectory;
+	static std::string packOutputFile;
+	// Build shaders mode manifest and the api whose compiler builds it
+	static std::string shaderManifestFile;
+	static eGraphicsApi shaderBuildApi;
 	static std::shared_ptr<platformLayer::window::platformWindow> window;
 	static std::shared_ptr<graphics> graphicsContext;
 	static std::shared_ptr<graphicsSurface> surface;
 	static int64_t fps;
 	static double ms;
+
+	// Frame time percentiles and hitches, exported on exit
+	static frameStatistics frameStats;
 	static bool graphicsInitialized;
 
+	// Mesh assets loaded on the gpu. Entities reference them through sMeshComponent
 	static sMeshResources triangleMeshResources;
-	static matrix4x4 triangleWorldMatrix;
-	static sRenderData triangleRenderData;
-	static matrix4x4 viewProjectionMatrix;
+	static matrix4x4f viewProjectionMatrix;
+
+	// Every object in the game is an entity. Structural changes recorded during a frame are applied after tick
+	static ecsWorld world;
+	static entityCommandBuffer commandBuffer;
+
+	// Entity transforms, with the entity attached to each node by node id. Destroying an entity destroys its node subtree
+	static transformHierarchy transforms;
+	static std::vector<sEntity> nodeEntities;
+
+	// Bounding volume hierarchy over entity bounds, with the entity owning each proxy by proxy id. Render queries it for the entities
+	// near the view frustum instead of walking every entity
+	static dynamicAabbTree sceneTree;
+	static std::vector<sEntity> proxyEntities;
+
+	// Renderable entities found in the scene tree each frame with a bounding sphere per entry at the same index
+	static std::vector<sMeshResources*> renderMeshes;
+	static std::vector<const matrix4x4f*> renderWorldMatrices;
+	static sBoundingSpheres renderBounds;
+	static std::vector<uint32_t> visibleIndices;
+
+	// The game thread publishes a snapshot of each frame that the render thread draws while the next frame is simulated
+	static frameMailbox renderMailbox;
+	static std::thread renderThread;
+	static uint64_t frameIndex;
+	static uint32_t surfaceWidth;
+	static uint32_t surfaceHeight;
+
+	// Surface size last applied by the render thread
+	static uint32_t renderedSurfaceWidth;
+	static uint32_t renderedSurfaceHeight;
 
 public:
 	static void start();
 
 private:
 	static void parseCommandLineArgs();
+	static void runClient();
+	static void runServer();
+	static void runPack();
+	static void runBuildShaders();
+	static void runRenderQueueBenchmark();
 	static void initializeWindow();
 	static void initializeGamepad();
 	static void initializeGraphics();
@@ -62,5 +130,14 @@ private:
 	static void fixedTick(float fixedStep);
 	static void render();
 
+	static void startRenderThread();
+	static void stopRenderThread();
+	static void renderThreadMain();
+	static void renderFrame(const sFrameSnapshot& snapshot);
+
 	static void updateViewProjectionMatrix();
+	static void updateTransforms();
+	static void attachTransformNode(const sEntity entity, const uint32_t node);
+	static void onEntityDestroyed(const sEntity entity);
+	static void updateSceneProxy(const sEntity entity, struct sBoundingSphereComponent& bounds, const vector3f& previousCenter);
 };
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "math/matrix4x4f.h"
+#include "math/vector3f.h"
+#include "culling/dynamicAabbTree.h"
+
+struct sMeshResources;
+
+// World matrix submitted for rendering, transposed for the shaders
+struct sWorldMatrixComponent
+{
+	matrix4x4f worldMatrix;
+};
+
+// Mesh drawn for the entity. The mesh resources are owned by the game and shared between entities
+struct sMeshComponent
+{
+	sMeshResources* meshResources = nullptr;
+};
+
+// Node in the game's transform hierarchy that drives the entity's world matrix and bounds. Add it with game::attachTransformNode
+struct sTransformNodeComponent
+{
+	uint32_t node = 0;
+};
+
+// World space sphere enclosing the entity, used for culling. localRadius encloses the mesh, radius is it scaled by the world matrix.
+// updateTransforms inserts the sphere into the game's scene tree, so only entities with a transform node are rendered
+struct sBoundingSphereComponent
+{
+	vector3f center;
+	float radius = 0.0f;
+	float localRadius = 0.0f;
+	int32_t sceneProxy = dynamicAabbTree::nullNode;
+};
\ No newline at end of file
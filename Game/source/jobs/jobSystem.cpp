@@ -0,0 +1,362 @@
+#include "pch.h"
+#include "jobSystem.h"
+#include "workStealingDeque.h"
+#include "math/mathLibrary.h"
+#include "profiler/profiler.h"
+#include "platform/framework/abstract/platformMessageBox.h"
+#include "sString.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif // defined(_MSC_VER)
+
+// Jobs each thread can have alive at once before its ring of jobs wraps
+static constexpr uint32_t jobPoolSize = 4096;
+
+// Failed attempts to find a job before an idle worker goes to sleep
+static constexpr uint32_t workerSpinCount = 256;
+
+static bool initialized = false;
+static std::atomic<bool> workersRunning = false;
+static std::vector<std::thread> workerThreads;
+static std::vector<std::unique_ptr<workStealingDeque>> deques;
+static std::atomic<uint32_t> registeredThreadCount = 0;
+
+// Incremented when jobs are pushed while a worker sleeps, so sleeping workers can wait on it without missing a push
+static std::atomic<uint32_t> wakeGeneration = 0;
+static std::atomic<uint32_t> sleepingWorkerCount = 0;
+
+static thread_local uint32_t threadIndex = jobSystem::invalidThreadIndex;
+static thread_local uint32_t nextVictimIndex = 0;
+static thread_local std::unique_ptr<sJob[]> jobPool;
+static thread_local uint32_t nextJobIndex = 0;
+
+static inline void cpuPause()
+{
+#if defined(_MSC_VER)
+	_mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#else
+	std::this_thread::yield();
+#endif // defined(_MSC_VER)
+}
+
+static workStealingDeque* getLocalDeque()
+{
+	return (threadIndex != jobSystem::invalidThreadIndex) ? deques[threadIndex].get() : nullptr;
+}
+
+static void wakeWorkers()
+{
+	// Pushes only write the shared generation when a worker sleeps. The fence orders the push before reading the sleeper count and pairs
+	// with the fence a worker makes between counting itself as sleeping and its last look for jobs, so one of the two sees the other
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (sleepingWorkerCount.load(std::memory_order_relaxed) > 0)
+	{
+		wakeGeneration.fetch_add(1, std::memory_order_release);
+		wakeGeneration.notify_all();
+	}
+}
+
+static void executeJob(sJob* job);
+
+static void submitJob(sJob* job)
+{
+	workStealingDeque* const deque = getLocalDeque();
+	if ((deque == nullptr) || !initialized)
+	{
+		executeJob(job);
+		return;
+	}
+
+	// A full deque means the thread is producing far faster than jobs are consumed, run the job now rather than grow
+	if (!deque->push(job))
+	{
+		executeJob(job);
+		return;
+	}
+
+	wakeWorkers();
+}
+
+static void executeJob(sJob* job)
+{
+	{
+		PROFILE_SCOPE("job");
+		MEMORY_TAG_SCOPE(job->memoryTag);
+		job->function(*job);
+	}
+
+	for (uint32_t i = 0; i < job->continuationCount; ++i)
+	{
+		sJob* const continuation = job->continuations[i];
+		if (continuation->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			submitJob(continuation);
+		}
+	}
+
+	// The counter may be destroyed as soon as it reaches zero so it is the last thing touched
+	sJobCounter* const counter = job->counter;
+	job->function = nullptr;
+	if (counter != nullptr)
+	{
+		counter->value.fetch_sub(1, std::memory_order_release);
+	}
+}
+
+// Pops a job from the calling thread's deque, or steals one from another thread
+static sJob* findJob()
+{
+	workStealingDeque* const deque = getLocalDeque();
+	if (deque == nullptr)
+	{
+		return nullptr;
+	}
+
+	if (sJob* const job = deque->pop())
+	{
+		return job;
+	}
+
+	// Start each search at a different victim so thieves spread out
+	const uint32_t threadCount = registeredThreadCount.load(std::memory_order_acquire);
+	for (uint32_t i = 0; i < threadCount; ++i)
+	{
+		const uint32_t victim = (nextVictimIndex + i) % threadCount;
+		if (victim == threadIndex)
+		{
+			continue;
+		}
+
+		if (sJob* const job = deques[victim]->steal())
+		{
+			nextVictimIndex = victim;
+			return job;
+		}
+	}
+
+	nextVictimIndex = (nextVictimIndex + 1) % std::max(threadCount, 1u);
+	return nullptr;
+}
+
+static void workerMain(const uint32_t index)
+{
+	threadIndex = index;
+	PROFILE_THREAD("job worker");
+
+	// Each worker draws from its own random stream so results do not depend on which thread ran a job first
+	mathLibrary::seedThreadRandom(mathLibrary::getDefaultRandomSeed(), index);
+
+	uint32_t failedAttempts = 0;
+	while (workersRunning.load(std::memory_order_acquire))
+	{
+		if (sJob* const job = findJob())
+		{
+			executeJob(job);
+			failedAttempts = 0;
+			continue;
+		}
+
+		if (++failedAttempts < workerSpinCount)
+		{
+			cpuPause();
+			continue;
+		}
+
+		// Count this worker as sleeping before looking for jobs one last time. A push this look misses sees the sleeper and moves the
+		// generation on, so the wait returns immediately
+		sleepingWorkerCount.fetch_add(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const uint32_t generation = wakeGeneration.load(std::memory_order_acquire);
+		sJob* const job = findJob();
+		if ((job == nullptr) && workersRunning.load(std::memory_order_acquire))
+		{
+			wakeGeneration.wait(generation, std::memory_order_acquire);
+		}
+		sleepingWorkerCount.fetch_sub(1, std::memory_order_relaxed);
+		failedAttempts = 0;
+
+		if (job != nullptr)
+		{
+			executeJob(job);
+		}
+	}
+
+	// Finish the jobs still queued when shutdown began, and any they queue, so none are dropped
+	while (sJob* const job = findJob())
+	{
+		executeJob(job);
+	}
+
+	threadIndex = jobSystem::invalidThreadIndex;
+}
+
+void jobSystem::init(const uint32_t workerThreadCount)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::jobs);
+	assert(!initialized);
+
+	const uint32_t workerCount = (workerThreadCount != 0) ? workerThreadCount : (std::max(std::thread::hardware_concurrency(), 1u) - 1);
+
+	// Thread 0 and the workers take the first deques, the rest are left for registered external threads
+	deques.clear();
+	for (uint32_t i = 0; i < (1 + workerCount + maxExternalThreads); ++i)
+	{
+		deques.push_back(std::make_unique<workStealingDeque>());
+	}
+
+	threadIndex = 0;
+	registeredThreadCount.store(1 + workerCount, std::memory_order_release);
+	workersRunning.store(true, std::memory_order_release);
+	initialized = true;
+
+	workerThreads.reserve(workerCount);
+	for (uint32_t i = 0; i < workerCount; ++i)
+	{
+		workerThreads.emplace_back(&workerMain, 1 + i);
+	}
+}
+
+void jobSystem::shutdown()
+{
+	if (!initialized)
+	{
+		return;
+	}
+
+	// Workers drain the deques before they exit. Jobs left in this thread's and registered threads' deques are run here once they have
+	workersRunning.store(false, std::memory_order_release);
+	wakeGeneration.fetch_add(1, std::memory_order_release);
+	wakeGeneration.notify_all();
+	for (std::thread& thread : workerThreads)
+	{
+		thread.join();
+	}
+	workerThreads.clear();
+
+	while (sJob* const job = findJob())
+	{
+		executeJob(job);
+	}
+
+	initialized = false;
+	threadIndex = invalidThreadIndex;
+	registeredThreadCount.store(0, std::memory_order_release);
+	deques.clear();
+}
+
+bool jobSystem::isInitialized()
+{
+	return initialized;
+}
+
+void jobSystem::registerThread()
+{
+	assert(initialized);
+	if (threadIndex != invalidThreadIndex)
+	{
+		return;
+	}
+
+	const uint32_t index = registeredThreadCount.fetch_add(1, std::memory_order_acq_rel);
+	if (index >= deques.size())
+	{
+		platformLayer::messageBox::showMessageBoxFatal(sString::printf("jobSystem::registerThread: more than %u threads registered.", maxExternalThreads));
+	}
+	threadIndex = index;
+}
+
+uint32_t jobSystem::getThreadCount()
+{
+	return std::max(registeredThreadCount.load(std::memory_order_acquire), 1u);
+}
+
+uint32_t jobSystem::getThreadIndex()
+{
+	return threadIndex;
+}
+
+void jobSystem::addDependency(sJob* job, sJob* dependency)
+{
+	assert(dependency->continuationCount < sJob::maxContinuations);
+	dependency->continuations[dependency->continuationCount++] = job;
+	job->pendingDependencies.fetch_add(1, std::memory_order_relaxed);
+}
+
+void jobSystem::run(sJob* job)
+{
+	// Drop the reference held until submission. Whoever brings the count to zero queues the job
+	if (job->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		submitJob(job);
+	}
+}
+
+void jobSystem::wait(const sJobCounter& counter)
+{
+	while (!counter.isDone())
+	{
+		if (sJob* const job = findJob())
+		{
+			executeJob(job);
+		}
+		else
+		{
+			cpuPause();
+		}
+	}
+}
+
+sJob* jobSystem::allocateJob(sJobCounter* counter)
+{
+	if (jobPool == nullptr)
+	{
+		MEMORY_TAG_SCOPE(eMemoryTag::jobs);
+		jobPool = std::make_unique<sJob[]>(jobPoolSize);
+	}
+
+	sJob* const job = &jobPool[nextJobIndex++ & (jobPoolSize - 1)];
+	if (job->function != nullptr)
+	{
+		platformLayer::messageBox::showMessageBoxFatal(sString::printf("jobSystem::allocateJob: job ring wrapped onto a job that has not finished, more than %u jobs alive on one thread.", jobPoolSize));
+	}
+
+	job->counter = counter;
+	job->pendingDependencies.store(1, std::memory_order_relaxed);
+	job->continuationCount = 0;
+	job->memoryTag = memoryTracker::getThreadTag();
+	if (counter != nullptr)
+	{
+		counter->value.fetch_add(1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+void jobSystem::parallelForRange(const sParallelForContext& context, uint32_t begin, uint32_t end)
+{
+	workStealingDeque* const deque = initialized ? getLocalDeque() : nullptr;
+	if (deque == nullptr)
+	{
+		context.invoke(context.function, begin, end);
+		return;
+	}
+
+	while (begin < end)
+	{
+		// Split off the upper half only when other threads have taken everything queued here, they are evidently free
+		if (((end - begin) > context.grainSize) && (deque->size() == 0))
+		{
+			const uint32_t middle = begin + ((end - begin) / 2);
+			const sParallelForContext* const sharedContext = &context;
+			run(createJob([sharedContext, middle, end]() { parallelForRange(*sharedContext, middle, end); }, context.counter));
+			end = middle;
+			continue;
+		}
+
+		const uint32_t grainEnd = std::min(begin + context.grainSize, end);
+		context.invoke(context.function, begin, grainEnd);
+		begin = grainEnd;
+	}
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "memory/memoryTracker.h"
+
+class workStealingDeque;
+
+// Counts unfinished jobs. Jobs created with a counter increment it and decrement it when they finish, so a counter reaching
+// zero is a fence for every job attached to it. A counter must outlive the jobs attached to it
+struct sJobCounter
+{
+	std::atomic<uint32_t> value = 0;
+
+	bool isDone() const { return value.load(std::memory_order_acquire) == 0; }
+};
+
+// A unit of work with its callable stored inline. Jobs are allocated from a per-thread ring and must finish before the ring wraps
+struct alignas(64) sJob
+{
+	static constexpr size_t maxContinuations = 4;
+	static constexpr size_t payloadSize = 128;
+
+	void (*function)(sJob& job) = nullptr;
+	sJobCounter* counter = nullptr;
+
+	// Unfinished dependencies, plus one until the job is submitted with run
+	std::atomic<int32_t> pendingDependencies = 0;
+
+	// Jobs waiting on this job to finish
+	uint32_t continuationCount = 0;
+	sJob* continuations[maxContinuations] = {};
+
+	// Memory tag of the thread that allocated the job, heap allocations the job makes are attributed to it
+	eMemoryTag memoryTag = eMemoryTag::untagged;
+
+	alignas(16) uint8_t payload[payloadSize];
+};
+
+// Work stealing job scheduler with one thread per core. The thread calling init is thread 0 and runs jobs while it waits on a counter,
+// the remaining cores each run a worker thread. Every thread owns a deque, pushes and pops its own jobs at one end and steals from the
+// other end of another thread's deque when it runs out. Idle workers sleep until new jobs are pushed.
+// Before init, and on threads that are not registered, jobs run inline when they are submitted
+class jobSystem
+{
+public:
+	// Threads created outside the job system that call registerThread
+	static constexpr uint32_t maxExternalThreads = 4;
+	static constexpr uint32_t invalidThreadIndex = UINT32_MAX;
+
+public:
+	// Creates workerThreadCount worker threads. 0 creates one worker for every core but the calling thread's
+	static void init(const uint32_t workerThreadCount = 0);
+	// Runs every job still queued, then stops the workers. Registered threads must have stopped submitting jobs
+	static void shutdown();
+	static bool isInitialized();
+
+	// Gives the calling thread a deque so it can submit and wait on jobs without running them inline
+	static void registerThread();
+
+	// Returns the number of registered threads, including the workers and thread 0
+	static uint32_t getThreadCount();
+
+	// Returns the calling thread's index, or invalidThreadIndex if the thread is not registered
+	static uint32_t getThreadIndex();
+
+	// Creates a job calling function(). The job does not run until it is passed to run. counter may be nullptr
+	template <typename T>
+	static sJob* createJob(T&& function, sJobCounter* counter = nullptr);
+
+	// Makes job wait for dependency to finish. Both jobs must have been created but not yet run
+	static void addDependency(sJob* job, sJob* dependency);
+
+	// Submits the job. It is queued immediately if it has no unfinished dependencies, otherwise when the last one finishes
+	static void run(sJob* job);
+
+	// Creates and submits a job calling function()
+	template <typename T>
+	static void run(T&& function, sJobCounter* counter);
+
+	// Runs queued jobs on the calling thread until the counter reaches zero
+	static void wait(const sJobCounter& counter);
+
+	// Calls function(begin, end) over sub ranges of [0, count) and returns once every sub range has finished. Ranges are split lazily: the
+	// calling thread keeps processing grains of at least minGrainSize and only splits off the remaining half when its deque has been
+	// emptied by other threads stealing, so the job count adapts to how many threads are free
+	template <typename T>
+	static void parallelFor(const uint32_t count, const uint32_t minGrainSize, T&& function);
+
+private:
+	struct sParallelForContext
+	{
+		void (*invoke)(const void* function, const uint32_t begin, const uint32_t end) = nullptr;
+		const void* function = nullptr;
+		uint32_t grainSize = 1;
+		sJobCounter* counter = nullptr;
+	};
+
+private:
+	static sJob* allocateJob(sJobCounter* counter);
+	static void parallelForRange(const sParallelForContext& context, uint32_t begin, uint32_t end);
+};
+
+template <typename T>
+sJob* jobSystem::createJob(T&& function, sJobCounter* counter)
+{
+	using functionType = std::decay_t<T>;
+	static_assert(sizeof(functionType) <= sJob::payloadSize, "jobSystem::createJob: job function is too large to store inline, capture a pointer to its data instead");
+	static_assert(alignof(functionType) <= 16, "jobSystem::createJob: job function alignment is too large");
+
+	sJob* job = allocateJob(counter);
+	new (job->payload) functionType(std::forward<T>(function));
+	job->function = [](sJob& job)
+		{
+			functionType* const storedFunction = std::launder(reinterpret_cast<functionType*>(job.payload));
+			(*storedFunction)();
+			storedFunction->~functionType();
+		};
+	return job;
+}
+
+template <typename T>
+void jobSystem::run(T&& function, sJobCounter* counter)
+{
+	run(createJob(std::forward<T>(function), counter));
+}
+
+template <typename T>
+void jobSystem::parallelFor(const uint32_t count, const uint32_t minGrainSize, T&& function)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	using functionType = std::remove_reference_t<T>;
+	sJobCounter counter;
+	sParallelForContext context;
+	context.invoke = [](const void* function, const uint32_t begin, const uint32_t end)
+		{
+			(*static_cast<functionType*>(const_cast<void*>(function)))(begin, end);
+		};
+	context.function = &function;
+	context.grainSize = std::max(minGrainSize, 1u);
+	context.counter = &counter;
+
+	parallelForRange(context, 0, count);
+	wait(counter);
+}
\ No newline at end of file
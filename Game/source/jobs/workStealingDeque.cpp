@@ -0,0 +1,70 @@
+#include "pch.h"
+#include "workStealingDeque.h"
+
+bool workStealingDeque::push(sJob* job)
+{
+	const int64_t b = bottom.load(std::memory_order_relaxed);
+	const int64_t t = top.load(std::memory_order_acquire);
+	if ((b - t) >= capacity)
+	{
+		return false;
+	}
+
+	// Publishing bottom with release makes the job visible to a thief that reads bottom with acquire
+	jobs[b & (capacity - 1)].store(job, std::memory_order_relaxed);
+	bottom.store(b + 1, std::memory_order_release);
+	return true;
+}
+
+sJob* workStealingDeque::pop()
+{
+	const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+	bottom.store(b, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t t = top.load(std::memory_order_relaxed);
+
+	if (t > b)
+	{
+		// Empty
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	sJob* job = jobs[b & (capacity - 1)].load(std::memory_order_relaxed);
+	if (t == b)
+	{
+		// Last job, race any thieves for it
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			job = nullptr;
+		}
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+sJob* workStealingDeque::steal()
+{
+	int64_t t = top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	const int64_t b = bottom.load(std::memory_order_acquire);
+
+	if (t >= b)
+	{
+		return nullptr;
+	}
+
+	sJob* job = jobs[t & (capacity - 1)].load(std::memory_order_relaxed);
+	if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+	{
+		return nullptr;
+	}
+	return job;
+}
+
+int64_t workStealingDeque::size() const
+{
+	const int64_t b = bottom.load(std::memory_order_relaxed);
+	const int64_t t = top.load(std::memory_order_relaxed);
+	return std::max<int64_t>(b - t, 0);
+}
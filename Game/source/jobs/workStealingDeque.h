@@ -0,0 +1,36 @@
+#pragma once
+
+struct sJob;
+
+// Fixed capacity Chase-Lev work stealing deque. The owning thread pushes and pops jobs at the bottom, any other thread
+// steals from the top. Uses the memory orderings from "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al.)
+class workStealingDeque
+{
+public:
+	static constexpr int64_t capacity = 4096;
+
+public:
+	workStealingDeque() = default;
+	workStealingDeque(const workStealingDeque&) = delete;
+	workStealingDeque& operator=(const workStealingDeque&) = delete;
+
+	// Owner only. Returns false if the deque is full
+	bool push(sJob* job);
+
+	// Owner only. Returns nullptr if the deque is empty
+	sJob* pop();
+
+	// Any thread. Returns nullptr if the deque is empty or another thread won the race for the top job
+	sJob* steal();
+
+	// Approximate number of jobs in the deque
+	int64_t size() const;
+
+private:
+	static_assert((capacity & (capacity - 1)) == 0, "workStealingDeque capacity must be a power of two");
+
+	// Top and bottom are written by different threads so keep them on separate cache lines
+	alignas(64) std::atomic<int64_t> top = 0;
+	alignas(64) std::atomic<int64_t> bottom = 0;
+	alignas(64) std::atomic<sJob*> jobs[capacity] = {};
+};
\ No newline at end of file
@@ -1,14 +1,61 @@
 #include "pch.h"
 #include "mathLibrary.h"
+#include "randomEngine.h"
+#include "vector3f.h"
 
-// Todo: Create the random engine and device per thread that needs to generate random numbers
-static std::random_device randomDevice;
-static std::mt19937 randomEngine(randomDevice());
-static std::uniform_int_distribution<uint32_t> uniformUInt32Distribution;
+static uint64_t createDefaultRandomSeed()
+{
+    std::random_device randomDevice;
+    return (static_cast<uint64_t>(randomDevice()) << 32) | static_cast<uint64_t>(randomDevice());
+}
+
+static std::atomic<uint64_t> defaultRandomSeed = createDefaultRandomSeed();
+static std::atomic<uint64_t> nextRandomStreamIndex = 0;
 
 uint32_t mathLibrary::randomUInt32()
 {
-    return uniformUInt32Distribution(randomEngine);
+    return getThreadRandomEngine().nextUInt32();
+}
+
+float mathLibrary::randomFloat()
+{
+    return getThreadRandomEngine().nextFloat();
+}
+
+randomEngine& mathLibrary::getThreadRandomEngine()
+{
+    thread_local randomEngine threadRandomEngine(defaultRandomSeed.load(std::memory_order_relaxed), nextRandomStreamIndex.fetch_add(1, std::memory_order_relaxed));
+    return threadRandomEngine;
+}
+
+void mathLibrary::seedThreadRandom(const uint64_t seed, const uint64_t streamIndex)
+{
+    getThreadRandomEngine() = randomEngine(seed, streamIndex);
+}
+
+void mathLibrary::setDefaultRandomSeed(const uint64_t seed)
+{
+    defaultRandomSeed.store(seed, std::memory_order_relaxed);
+}
+
+uint64_t mathLibrary::getDefaultRandomSeed()
+{
+    return defaultRandomSeed.load(std::memory_order_relaxed);
+}
+
+void mathLibrary::fillRandomUInt32(std::span<uint32_t> outValues)
+{
+    getThreadRandomEngine().fillUInt32(outValues);
+}
+
+void mathLibrary::fillRandomFloat(std::span<float> outValues, const float minValue, const float maxValue)
+{
+    getThreadRandomEngine().fillFloat(outValues, minValue, maxValue);
+}
+
+void mathLibrary::fillRandomUnitVectors(std::span<vector3f> outVectors)
+{
+    getThreadRandomEngine().fillUnitVectors(outVectors);
 }
 
 float mathLibrary::fRoundTo1DecimalPlace(const float value, const bool negativeAwayFromZero)
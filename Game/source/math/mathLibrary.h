@@ -3,7 +3,21 @@
 class mathLibrary
 {
 public:
+	// Random numbers come from a per-thread engine so threads never contend. Each thread's engine is seeded on first use with the
+	// default seed and the next free stream index. Call seedThreadRandom to make a thread's sequence independent of thread start order
 	static uint32_t randomUInt32();
+	static float randomFloat();
+	static class randomEngine& getThreadRandomEngine();
+	static void seedThreadRandom(const uint64_t seed, const uint64_t streamIndex);
+
+	// Sets the seed used by threads that generate their first random number after this call
+	static void setDefaultRandomSeed(const uint64_t seed);
+	static uint64_t getDefaultRandomSeed();
+
+	// Bulk generation from the calling thread's engine
+	static void fillRandomUInt32(std::span<uint32_t> outValues);
+	static void fillRandomFloat(std::span<float> outValues, const float minValue = 0.0f, const float maxValue = 1.0f);
+	static void fillRandomUnitVectors(std::span<class vector3f> outVectors);
 
 	template <typename T>
 	static int32_t sign(const T Value)
@@ -0,0 +1,43 @@
+#include "pch.h"
+#include "mathSimd.h"
+
+#if defined(MATH_SIMD_SSE) && defined(_MSC_VER)
+#include <intrin.h>
+#endif // defined(MATH_SIMD_SSE) && defined(_MSC_VER)
+
+static sCpuFeatures queryCpuFeatures()
+{
+	sCpuFeatures features = {};
+
+#if defined(MATH_SIMD_SSE)
+#if defined(_MSC_VER)
+	int32_t info[4] = {};
+	__cpuid(info, 0);
+	const int32_t maxLeaf = info[0];
+
+	__cpuid(info, 1);
+	const bool osSavesYmm = ((info[2] & (1 << 27)) != 0) && ((_xgetbv(0) & 0x6) == 0x6);
+	const bool avx = osSavesYmm && ((info[2] & (1 << 28)) != 0);
+	features.fma = avx && ((info[2] & (1 << 12)) != 0);
+
+	if (maxLeaf >= 7)
+	{
+		__cpuidex(info, 7, 0);
+		features.avx2 = avx && ((info[1] & (1 << 5)) != 0);
+	}
+#else
+	// Also checks the operating system saves the ymm registers
+	__builtin_cpu_init();
+	features.avx2 = __builtin_cpu_supports("avx2");
+	features.fma = __builtin_cpu_supports("fma");
+#endif // defined(_MSC_VER)
+#endif // defined(MATH_SIMD_SSE)
+
+	return features;
+}
+
+const sCpuFeatures& sCpuFeatures::get()
+{
+	static const sCpuFeatures features = queryCpuFeatures();
+	return features;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+// Selects the simd instruction set used by the single precision math types at compile time. Define MATH_SIMD_SCALAR to force the scalar reference path
+#if !defined(MATH_SIMD_SCALAR)
+
+#if defined(__AVX__)
+#define MATH_SIMD_AVX
+#endif // defined(__AVX__)
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define MATH_SIMD_SSE
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define MATH_SIMD_NEON
+#endif // defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+
+#endif // !defined(MATH_SIMD_SCALAR)
+
+#if defined(MATH_SIMD_SSE)
+#include <immintrin.h>
+#elif defined(MATH_SIMD_NEON)
+#include <arm_neon.h>
+#endif // defined(MATH_SIMD_SSE)
+
+// Kernels with an avx2 path wider than the compile time selection are compiled for avx2 individually and chosen at runtime.
+// Msvc allows avx2 intrinsics without /arch:AVX2, gcc and clang need the target attribute on the function
+#if defined(MATH_SIMD_SSE)
+#if defined(_MSC_VER) && !defined(__clang__)
+#define MATH_SIMD_TARGET_AVX2
+#else
+#define MATH_SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif // defined(_MSC_VER) && !defined(__clang__)
+#endif // defined(MATH_SIMD_SSE)
+
+// Instruction sets supported by the cpu and operating system at runtime
+struct sCpuFeatures
+{
+	bool avx2 = false;
+	bool fma = false;
+
+	static const sCpuFeatures& get();
+};
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "pch.h"
+#include "matrix3x4f.h"
+#include "matrix4x4f.h"
+#include "mathSimd.h"
+
+matrix3x4f::matrix3x4f(const matrix4x4f& a)
+{
+	for (size_t row = 0; row < 3; ++row)
+	{
+		for (size_t column = 0; column < 4; ++column)
+		{
+			values[(row * 4) + column] = a.values[(column * 4) + row];
+		}
+	}
+}
+
+matrix4x4f matrix3x4f::toMatrix4x4f() const
+{
+	matrix4x4f result = matrix4x4f::identity();
+	for (size_t row = 0; row < 3; ++row)
+	{
+		for (size_t column = 0; column < 4; ++column)
+		{
+			result.values[(column * 4) + row] = values[(row * 4) + column];
+		}
+	}
+	return result;
+}
+
+matrix3x4f matrix3x4f::operator*(const matrix3x4f& rhs) const
+{
+	// Each result row is a linear combination of the rhs rows plus this row's translation, the implicit fourth rhs row is (0, 0, 0, 1)
+	matrix3x4f result;
+#if defined(MATH_SIMD_SSE)
+	const __m128 rhsRow0 = _mm_loadu_ps(&rhs.values[0]);
+	const __m128 rhsRow1 = _mm_loadu_ps(&rhs.values[4]);
+	const __m128 rhsRow2 = _mm_loadu_ps(&rhs.values[8]);
+	const __m128 translationMask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+	for (size_t row = 0; row < 3; ++row)
+	{
+		const float* const lhsRow = &values[row * 4];
+		__m128 resultRow = _mm_mul_ps(_mm_set1_ps(lhsRow[0]), rhsRow0);
+		resultRow = _mm_add_ps(resultRow, _mm_mul_ps(_mm_set1_ps(lhsRow[1]), rhsRow1));
+		resultRow = _mm_add_ps(resultRow, _mm_mul_ps(_mm_set1_ps(lhsRow[2]), rhsRow2));
+		resultRow = _mm_add_ps(resultRow, _mm_and_ps(_mm_set1_ps(lhsRow[3]), translationMask));
+		_mm_storeu_ps(&result.values[row * 4], resultRow);
+	}
+#elif defined(MATH_SIMD_NEON)
+	const float32x4_t rhsRow0 = vld1q_f32(&rhs.values[0]);
+	const float32x4_t rhsRow1 = vld1q_f32(&rhs.values[4]);
+	const float32x4_t rhsRow2 = vld1q_f32(&rhs.values[8]);
+	for (size_t row = 0; row < 3; ++row)
+	{
+		const float* const lhsRow = &values[row * 4];
+		float32x4_t resultRow = vmulq_n_f32(rhsRow0, lhsRow[0]);
+		resultRow = vmlaq_n_f32(resultRow, rhsRow1, lhsRow[1]);
+		resultRow = vmlaq_n_f32(resultRow, rhsRow2, lhsRow[2]);
+		resultRow = vsetq_lane_f32(vgetq_lane_f32(resultRow, 3) + lhsRow[3], resultRow, 3);
+		vst1q_f32(&result.values[row * 4], resultRow);
+	}
+#else
+	for (size_t row = 0; row < 3; ++row)
+	{
+		const float* const lhsRow = &values[row * 4];
+		for (size_t column = 0; column < 4; ++column)
+		{
+			result.values[(row * 4) + column] = (lhsRow[0] * rhs.values[column]) + (lhsRow[1] * rhs.values[4 + column]) + (lhsRow[2] * rhs.values[8 + column]);
+		}
+		result.values[(row * 4) + 3] += lhsRow[3];
+	}
+#endif // defined(MATH_SIMD_SSE)
+	return result;
+}
+
+matrix3x4f matrix3x4f::identity()
+{
+	matrix3x4f result;
+	result.values[0] = 1.0f;
+	result.values[5] = 1.0f;
+	result.values[10] = 1.0f;
+	return result;
+}
+
+float matrix3x4f::maxAxisScale() const
+{
+	// Axes are the first three columns
+	float maxLengthSquared = 0.0f;
+	for (size_t column = 0; column < 3; ++column)
+	{
+		const float x = values[column];
+		const float y = values[4 + column];
+		const float z = values[8 + column];
+		maxLengthSquared = std::max(maxLengthSquared, (x * x) + (y * y) + (z * z));
+	}
+	return std::sqrt(maxLengthSquared);
+}
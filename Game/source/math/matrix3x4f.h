@@ -0,0 +1,30 @@
+#pragma once
+
+class matrix4x4f;
+
+// Single precision affine matrix stored as 3 rows of 4 values. The fourth row is implicitly (0, 0, 0, 1).
+// Packed to 48 bytes so large arrays of world matrices can be written and uploaded without the constant row
+class matrix3x4f
+{
+public:
+	float values[12] = {};
+
+public:
+	matrix3x4f() = default;
+
+	// Packs the affine part of a column-major matrix
+	explicit matrix3x4f(const matrix4x4f& a);
+
+public:
+	// Composes two affine matrices, the result applies rhs first. Used to concatenate parent and local transforms
+	matrix3x4f operator*(const matrix3x4f& rhs) const;
+
+public:
+	static matrix3x4f identity();
+
+	// Expands to a column-major matrix
+	matrix4x4f toMatrix4x4f() const;
+
+	// Length of the longest basis axis, the most a bounding sphere radius can grow under this transform
+	float maxAxisScale() const;
+};
\ No newline at end of file
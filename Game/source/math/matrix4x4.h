@@ -11,6 +11,7 @@ public:
 public:
 	matrix4x4() = default;
 	matrix4x4(const vector4d& column0, const vector4d& column1, const vector4d& column2, const vector4d& column3);
+	matrix4x4(const matrix4x4&) = default;
 
 	void operator=(const matrix4x4& rhs);
 
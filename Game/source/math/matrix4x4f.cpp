@@ -0,0 +1,293 @@
+#include "pch.h"
+#include "matrix4x4f.h"
+#include "matrix4x4.h"
+#include "vector3f.h"
+#include "quaternionf.h"
+#include "transform.h"
+#include "mathSimd.h"
+
+// Writes the upper 3x3 rotation of quaternion a into the first three columns of outValues, scaling each column by the matching scale component
+static void writeScaledRotation(const quaternionf& a, const float scaleX, const float scaleY, const float scaleZ, float* outValues)
+{
+	const float xx = a.x * a.x;
+	const float yy = a.y * a.y;
+	const float zz = a.z * a.z;
+	const float xy = a.x * a.y;
+	const float xz = a.x * a.z;
+	const float yz = a.y * a.z;
+	const float wx = a.w * a.x;
+	const float wy = a.w * a.y;
+	const float wz = a.w * a.z;
+
+	outValues[0] = (1.0f - (2.0f * (yy + zz))) * scaleX;
+	outValues[1] = (2.0f * (xy + wz)) * scaleX;
+	outValues[2] = (2.0f * (xz - wy)) * scaleX;
+	outValues[3] = 0.0f;
+
+	outValues[4] = (2.0f * (xy - wz)) * scaleY;
+	outValues[5] = (1.0f - (2.0f * (xx + zz))) * scaleY;
+	outValues[6] = (2.0f * (yz + wx)) * scaleY;
+	outValues[7] = 0.0f;
+
+	outValues[8] = (2.0f * (xz + wy)) * scaleZ;
+	outValues[9] = (2.0f * (yz - wx)) * scaleZ;
+	outValues[10] = (1.0f - (2.0f * (xx + yy))) * scaleZ;
+	outValues[11] = 0.0f;
+}
+
+matrix4x4f::matrix4x4f(const vector4f& column0, const vector4f& column1, const vector4f& column2, const vector4f& column3)
+{
+	memcpy(&values[0], &column0.x, sizeof(float) * 4);
+	memcpy(&values[4], &column1.x, sizeof(float) * 4);
+	memcpy(&values[8], &column2.x, sizeof(float) * 4);
+	memcpy(&values[12], &column3.x, sizeof(float) * 4);
+}
+
+matrix4x4f::matrix4x4f(const matrix4x4& a)
+{
+	for (size_t i = 0; i < _countof(values); ++i)
+	{
+		values[i] = static_cast<float>(a.values[i]);
+	}
+}
+
+matrix4x4f matrix4x4f::operator*(const matrix4x4f& rhs) const
+{
+	// Each result column is the lhs columns weighted by the matching rhs column components
+	matrix4x4f result;
+#if defined(MATH_SIMD_AVX)
+	// Computes two result columns per iteration. Each lane half holds one column
+	const __m256 column0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&values[0]));
+	const __m256 column1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&values[4]));
+	const __m256 column2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&values[8]));
+	const __m256 column3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&values[12]));
+
+	for (size_t i = 0; i < 16; i += 8)
+	{
+		const __m256 rhsColumns = _mm256_loadu_ps(&rhs.values[i]);
+		__m256 resultColumns = _mm256_mul_ps(column0, _mm256_shuffle_ps(rhsColumns, rhsColumns, _MM_SHUFFLE(0, 0, 0, 0)));
+		resultColumns = _mm256_add_ps(resultColumns, _mm256_mul_ps(column1, _mm256_shuffle_ps(rhsColumns, rhsColumns, _MM_SHUFFLE(1, 1, 1, 1))));
+		resultColumns = _mm256_add_ps(resultColumns, _mm256_mul_ps(column2, _mm256_shuffle_ps(rhsColumns, rhsColumns, _MM_SHUFFLE(2, 2, 2, 2))));
+		resultColumns = _mm256_add_ps(resultColumns, _mm256_mul_ps(column3, _mm256_shuffle_ps(rhsColumns, rhsColumns, _MM_SHUFFLE(3, 3, 3, 3))));
+		_mm256_storeu_ps(&result.values[i], resultColumns);
+	}
+#elif defined(MATH_SIMD_SSE)
+	const __m128 column0 = _mm_load_ps(&values[0]);
+	const __m128 column1 = _mm_load_ps(&values[4]);
+	const __m128 column2 = _mm_load_ps(&values[8]);
+	const __m128 column3 = _mm_load_ps(&values[12]);
+
+	for (size_t i = 0; i < 16; i += 4)
+	{
+		const __m128 rhsColumn = _mm_load_ps(&rhs.values[i]);
+		__m128 resultColumn = _mm_mul_ps(column0, _mm_shuffle_ps(rhsColumn, rhsColumn, _MM_SHUFFLE(0, 0, 0, 0)));
+		resultColumn = _mm_add_ps(resultColumn, _mm_mul_ps(column1, _mm_shuffle_ps(rhsColumn, rhsColumn, _MM_SHUFFLE(1, 1, 1, 1))));
+		resultColumn = _mm_add_ps(resultColumn, _mm_mul_ps(column2, _mm_shuffle_ps(rhsColumn, rhsColumn, _MM_SHUFFLE(2, 2, 2, 2))));
+		resultColumn = _mm_add_ps(resultColumn, _mm_mul_ps(column3, _mm_shuffle_ps(rhsColumn, rhsColumn, _MM_SHUFFLE(3, 3, 3, 3))));
+		_mm_store_ps(&result.values[i], resultColumn);
+	}
+#elif defined(MATH_SIMD_NEON)
+	const float32x4_t column0 = vld1q_f32(&values[0]);
+	const float32x4_t column1 = vld1q_f32(&values[4]);
+	const float32x4_t column2 = vld1q_f32(&values[8]);
+	const float32x4_t column3 = vld1q_f32(&values[12]);
+
+	for (size_t i = 0; i < 16; i += 4)
+	{
+		float32x4_t resultColumn = vmulq_n_f32(column0, rhs.values[i + 0]);
+		resultColumn = vmlaq_n_f32(resultColumn, column1, rhs.values[i + 1]);
+		resultColumn = vmlaq_n_f32(resultColumn, column2, rhs.values[i + 2]);
+		resultColumn = vmlaq_n_f32(resultColumn, column3, rhs.values[i + 3]);
+		vst1q_f32(&result.values[i], resultColumn);
+	}
+#else
+	for (size_t column = 0; column < 4; ++column)
+	{
+		for (size_t row = 0; row < 4; ++row)
+		{
+			result.values[(column * 4) + row] = (values[0 + row] * rhs.values[(column * 4) + 0]) +
+				(values[4 + row] * rhs.values[(column * 4) + 1]) +
+				(values[8 + row] * rhs.values[(column * 4) + 2]) +
+				(values[12 + row] * rhs.values[(column * 4) + 3]);
+		}
+	}
+#endif // defined(MATH_SIMD_AVX)
+	return result;
+}
+
+vector4f matrix4x4f::operator*(const vector4f& rhs) const
+{
+	vector4f result;
+#if defined(MATH_SIMD_SSE)
+	const __m128 vector = _mm_load_ps(&rhs.x);
+	__m128 resultVector = _mm_mul_ps(_mm_load_ps(&values[0]), _mm_shuffle_ps(vector, vector, _MM_SHUFFLE(0, 0, 0, 0)));
+	resultVector = _mm_add_ps(resultVector, _mm_mul_ps(_mm_load_ps(&values[4]), _mm_shuffle_ps(vector, vector, _MM_SHUFFLE(1, 1, 1, 1))));
+	resultVector = _mm_add_ps(resultVector, _mm_mul_ps(_mm_load_ps(&values[8]), _mm_shuffle_ps(vector, vector, _MM_SHUFFLE(2, 2, 2, 2))));
+	resultVector = _mm_add_ps(resultVector, _mm_mul_ps(_mm_load_ps(&values[12]), _mm_shuffle_ps(vector, vector, _MM_SHUFFLE(3, 3, 3, 3))));
+	_mm_store_ps(&result.x, resultVector);
+#elif defined(MATH_SIMD_NEON)
+	float32x4_t resultVector = vmulq_n_f32(vld1q_f32(&values[0]), rhs.x);
+	resultVector = vmlaq_n_f32(resultVector, vld1q_f32(&values[4]), rhs.y);
+	resultVector = vmlaq_n_f32(resultVector, vld1q_f32(&values[8]), rhs.z);
+	resultVector = vmlaq_n_f32(resultVector, vld1q_f32(&values[12]), rhs.w);
+	vst1q_f32(&result.x, resultVector);
+#else
+	result = vector4f((values[0] * rhs.x) + (values[4] * rhs.y) + (values[8] * rhs.z) + (values[12] * rhs.w),
+		(values[1] * rhs.x) + (values[5] * rhs.y) + (values[9] * rhs.z) + (values[13] * rhs.w),
+		(values[2] * rhs.x) + (values[6] * rhs.y) + (values[10] * rhs.z) + (values[14] * rhs.w),
+		(values[3] * rhs.x) + (values[7] * rhs.y) + (values[11] * rhs.z) + (values[15] * rhs.w));
+#endif // defined(MATH_SIMD_SSE)
+	return result;
+}
+
+matrix4x4f matrix4x4f::identity()
+{
+	matrix4x4f result;
+	result.values[0] = 1.0f;
+	result.values[5] = 1.0f;
+	result.values[10] = 1.0f;
+	result.values[15] = 1.0f;
+	return result;
+}
+
+matrix4x4f matrix4x4f::inverse(const matrix4x4f& a)
+{
+	// Not used on per-object paths so the scalar cofactor expansion is used for all instruction sets
+	const float* m = a.values;
+	matrix4x4f result;
+	float* r = result.values;
+
+	r[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+	r[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+	r[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+	r[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+	r[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+	r[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+	r[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+	r[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+	r[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+	r[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+	r[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+	r[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+	r[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+	r[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+	r[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+	r[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+	const float inverseDeterminant = 1.0f / ((m[0] * r[0]) + (m[1] * r[4]) + (m[2] * r[8]) + (m[3] * r[12]));
+	for (size_t i = 0; i < _countof(result.values); ++i)
+	{
+		r[i] *= inverseDeterminant;
+	}
+
+	return result;
+}
+
+matrix4x4f matrix4x4f::transpose(const matrix4x4f& a)
+{
+	matrix4x4f result;
+#if defined(MATH_SIMD_SSE)
+	__m128 column0 = _mm_load_ps(&a.values[0]);
+	__m128 column1 = _mm_load_ps(&a.values[4]);
+	__m128 column2 = _mm_load_ps(&a.values[8]);
+	__m128 column3 = _mm_load_ps(&a.values[12]);
+	_MM_TRANSPOSE4_PS(column0, column1, column2, column3);
+	_mm_store_ps(&result.values[0], column0);
+	_mm_store_ps(&result.values[4], column1);
+	_mm_store_ps(&result.values[8], column2);
+	_mm_store_ps(&result.values[12], column3);
+#elif defined(MATH_SIMD_NEON)
+	// De-interleaving load gathers every fourth value into each register
+	const float32x4x4_t rows = vld4q_f32(a.values);
+	vst1q_f32(&result.values[0], rows.val[0]);
+	vst1q_f32(&result.values[4], rows.val[1]);
+	vst1q_f32(&result.values[8], rows.val[2]);
+	vst1q_f32(&result.values[12], rows.val[3]);
+#else
+	for (size_t column = 0; column < 4; ++column)
+	{
+		for (size_t row = 0; row < 4; ++row)
+		{
+			result.values[(column * 4) + row] = a.values[(row * 4) + column];
+		}
+	}
+#endif // defined(MATH_SIMD_SSE)
+	return result;
+}
+
+matrix4x4f matrix4x4f::translation(const vector3f& a)
+{
+	matrix4x4f result = identity();
+	result.values[12] = a.x;
+	result.values[13] = a.y;
+	result.values[14] = a.z;
+	return result;
+}
+
+matrix4x4f matrix4x4f::rotation(const quaternionf& a)
+{
+	matrix4x4f result;
+	writeScaledRotation(a, 1.0f, 1.0f, 1.0f, result.values);
+	result.values[15] = 1.0f;
+	return result;
+}
+
+matrix4x4f matrix4x4f::scale(const vector3f& a)
+{
+	matrix4x4f result;
+	result.values[0] = a.x;
+	result.values[5] = a.y;
+	result.values[10] = a.z;
+	result.values[15] = 1.0f;
+	return result;
+}
+
+matrix4x4f matrix4x4f::transformation(const vector3f& position, const quaternionf& inRotation, const vector3f& inScale)
+{
+	matrix4x4f result;
+	writeScaledRotation(inRotation, inScale.x, inScale.y, inScale.z, result.values);
+	result.values[12] = position.x;
+	result.values[13] = position.y;
+	result.values[14] = position.z;
+	result.values[15] = 1.0f;
+	return result;
+}
+
+matrix4x4f matrix4x4f::transformation(const transform& a)
+{
+	return transformation(vector3f(a.position), quaternionf(a.rotation), vector3f(a.scale));
+}
+
+matrix4x4f matrix4x4f::view(const vector3f& position, const quaternionf& inRotation)
+{
+	// inverse(translation * rotation) = transpose(rotation) * -position
+	const matrix4x4f rotationMatrix = rotation(inRotation);
+	matrix4x4f result = transpose(rotationMatrix);
+	for (size_t row = 0; row < 3; ++row)
+	{
+		const float* const column = &rotationMatrix.values[row * 4];
+		result.values[12 + row] = -((column[0] * position.x) + (column[1] * position.y) + (column[2] * position.z));
+	}
+	result.values[15] = 1.0f;
+	return result;
+}
+
+void matrix4x4f::inverseInPlace()
+{
+	*this = inverse(*this);
+}
+
+void matrix4x4f::transposeInPlace()
+{
+	*this = transpose(*this);
+}
+
+matrix4x4 matrix4x4f::toMatrix4x4() const
+{
+	matrix4x4 result;
+	for (size_t i = 0; i < _countof(values); ++i)
+	{
+		result.values[i] = static_cast<double>(values[i]);
+	}
+	return result;
+}
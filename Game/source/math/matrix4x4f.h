@@ -0,0 +1,53 @@
+#pragma once
+
+#include "vector4f.h"
+
+// Single precision 4x4 matrix stored in column-major order. Aligned to 16 bytes so each column can be loaded into a simd register.
+// Used on per-object paths. Keep matrix4x4 where double precision matters, e.g. building the camera matrices
+class alignas(16) matrix4x4f
+{
+public:
+	float values[16] = {};
+
+public:
+	matrix4x4f() = default;
+	matrix4x4f(const vector4f& column0, const vector4f& column1, const vector4f& column2, const vector4f& column3);
+
+	// Narrows a double precision matrix
+	explicit matrix4x4f(const class matrix4x4& a);
+
+public:
+	vector4f operator[](const size_t index) const { return vector4f(values[(index * 4) + 0], values[(index * 4) + 1], values[(index * 4) + 2], values[(index * 4) + 3]); }
+	matrix4x4f operator*(const matrix4x4f& rhs) const;
+	vector4f operator*(const vector4f& rhs) const;
+
+public:
+	static matrix4x4f identity();
+	static matrix4x4f inverse(const matrix4x4f& a);
+	static matrix4x4f transpose(const matrix4x4f& a);
+
+	// Computes a translation matrix from vector a
+	static matrix4x4f translation(const class vector3f& a);
+
+	// Computes a rotation matrix from quaternion a
+	static matrix4x4f rotation(const class quaternionf& a);
+
+	// Computes a scale matrix from vector a
+	static matrix4x4f scale(const class vector3f& a);
+
+	// Computes a transformation (world/model) matrix. Equivalent to translation * rotation * scale without the matrix multiplies
+	static matrix4x4f transformation(const class vector3f& position, const class quaternionf& inRotation, const class vector3f& inScale);
+
+	// Computes a transformation (world/model) matrix from transform a
+	static matrix4x4f transformation(const class transform& a);
+
+	// Computes a view matrix from input position and rotation. Inverts the rigid transform directly instead of a general inverse
+	static matrix4x4f view(const class vector3f& position, const class quaternionf& inRotation);
+
+public:
+	void inverseInPlace();
+	void transposeInPlace();
+
+	// Widens the matrix to double precision
+	class matrix4x4 toMatrix4x4() const;
+};
\ No newline at end of file
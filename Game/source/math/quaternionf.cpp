@@ -0,0 +1,53 @@
+#include "pch.h"
+#include "quaternionf.h"
+#include "quaternion.h"
+#include "rotator.h"
+#include "mathLibrary.h"
+
+quaternionf::quaternionf(const quaternion& a)
+	: x(static_cast<float>(a.x)), y(static_cast<float>(a.y)), z(static_cast<float>(a.z)), w(static_cast<float>(a.w))
+{
+}
+
+quaternionf::quaternionf(const rotator& a)
+{
+	// Matches the pitch (x), yaw (y), roll (z) euler order used by rotator::toQuaternion
+	const float halfPitch = mathLibrary::fDegreesToRadians(static_cast<float>(a.pitch)) * 0.5f;
+	const float halfYaw = mathLibrary::fDegreesToRadians(static_cast<float>(a.yaw)) * 0.5f;
+	const float halfRoll = mathLibrary::fDegreesToRadians(static_cast<float>(a.roll)) * 0.5f;
+
+	const float cosPitch = std::cos(halfPitch);
+	const float sinPitch = std::sin(halfPitch);
+	const float cosYaw = std::cos(halfYaw);
+	const float sinYaw = std::sin(halfYaw);
+	const float cosRoll = std::cos(halfRoll);
+	const float sinRoll = std::sin(halfRoll);
+
+	w = (cosPitch * cosYaw * cosRoll) + (sinPitch * sinYaw * sinRoll);
+	x = (sinPitch * cosYaw * cosRoll) - (cosPitch * sinYaw * sinRoll);
+	y = (cosPitch * sinYaw * cosRoll) + (sinPitch * cosYaw * sinRoll);
+	z = (cosPitch * cosYaw * sinRoll) - (sinPitch * sinYaw * cosRoll);
+}
+
+quaternionf quaternionf::operator*(const quaternionf& rhs) const
+{
+	return quaternionf((w * rhs.w) - (x * rhs.x) - (y * rhs.y) - (z * rhs.z),
+		(w * rhs.x) + (x * rhs.w) + (y * rhs.z) - (z * rhs.y),
+		(w * rhs.y) + (y * rhs.w) + (z * rhs.x) - (x * rhs.z),
+		(w * rhs.z) + (z * rhs.w) + (x * rhs.y) - (y * rhs.x));
+}
+
+quaternionf quaternionf::normalize(const quaternionf& a)
+{
+	const float inverseLength = 1.0f / std::sqrt((a.x * a.x) + (a.y * a.y) + (a.z * a.z) + (a.w * a.w));
+	return quaternionf(a.w * inverseLength, a.x * inverseLength, a.y * inverseLength, a.z * inverseLength);
+}
+
+vector3f quaternionf::rotate(const quaternionf& q, const vector3f& a)
+{
+	// a + 2w(q x a) + 2(q x (q x a))
+	const vector3f qVector(q.x, q.y, q.z);
+	const vector3f uv = vector3f::crossProduct(qVector, a);
+	const vector3f uuv = vector3f::crossProduct(qVector, uv);
+	return a + (2.0f * ((q.w * uv) + uuv));
+}
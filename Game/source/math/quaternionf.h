@@ -0,0 +1,35 @@
+#pragma once
+
+#include "vector3f.h"
+
+// Single precision quaternion. Components are stored x, y, z, w so the quaternion can be loaded into a simd register
+class alignas(16) quaternionf
+{
+public:
+	float x;
+	float y;
+	float z;
+	float w;
+
+public:
+	quaternionf() : x(0.0f), y(0.0f), z(0.0f), w(1.0f) {}
+
+	template <typename T>
+	quaternionf(const T inW, const T inX, const T inY, const T inZ)
+		: x(static_cast<float>(inX)), y(static_cast<float>(inY)), z(static_cast<float>(inZ)), w(static_cast<float>(inW)) {}
+
+	// Narrows a double precision quaternion
+	explicit quaternionf(const class quaternion& a);
+
+	// Computes the quaternion directly from the rotator euler angles without a double precision round trip
+	explicit quaternionf(const class rotator& a);
+
+public:
+	quaternionf operator*(const quaternionf& rhs) const;
+
+public:
+	static quaternionf normalize(const quaternionf& a);
+
+	// Rotates vector a by quaternion q
+	static vector3f rotate(const quaternionf& q, const vector3f& a);
+};
\ No newline at end of file
@@ -0,0 +1,260 @@
+#include "pch.h"
+#include "randomEngine.h"
+#include "vector3f.h"
+#include "mathSimd.h"
+
+static constexpr uint64_t jumpPolynomial[4] = { 0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c };
+static constexpr uint64_t longJumpPolynomial[4] = { 0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635 };
+
+// Number of 32-bit values produced by one step of every lane
+static constexpr size_t valuesPerLaneStep = 8;
+
+static inline uint64_t rotateLeft(const uint64_t value, const int32_t shift)
+{
+	return (value << shift) | (value >> (64 - shift));
+}
+
+// Expands a 64-bit seed into well mixed state words. Recommended by the xoshiro authors for seeding
+static uint64_t splitMix64(uint64_t& seedState)
+{
+	uint64_t z = (seedState += 0x9e3779b97f4a7c15);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+	return z ^ (z >> 31);
+}
+
+static inline uint64_t stepState(uint64_t* s)
+{
+	const uint64_t result = rotateLeft(s[1] * 5, 7) * 9;
+	const uint64_t t = s[1] << 17;
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotateLeft(s[3], 45);
+	return result;
+}
+
+static void jumpState(uint64_t* s, const uint64_t (&polynomial)[4])
+{
+	uint64_t jumped[4] = {};
+	for (size_t i = 0; i < 4; ++i)
+	{
+		for (int32_t bit = 0; bit < 64; ++bit)
+		{
+			if ((polynomial[i] & (static_cast<uint64_t>(1) << bit)) != 0)
+			{
+				jumped[0] ^= s[0];
+				jumped[1] ^= s[1];
+				jumped[2] ^= s[2];
+				jumped[3] ^= s[3];
+			}
+			stepState(s);
+		}
+	}
+	memcpy(s, jumped, sizeof(jumped));
+}
+
+// Each kernel writes stepCount * valuesPerLaneStep values. Every step writes the 64-bit result of lane 0, 1, 2 then 3
+#if !defined(MATH_SIMD_SSE)
+static void generateLaneStepsScalar(uint64_t (&laneStates)[4][4], uint32_t* outValues, const size_t stepCount)
+{
+	for (size_t step = 0; step < stepCount; ++step)
+	{
+		for (size_t lane = 0; lane < 4; ++lane)
+		{
+			uint64_t s[4] = { laneStates[0][lane], laneStates[1][lane], laneStates[2][lane], laneStates[3][lane] };
+			const uint64_t result = stepState(s);
+			memcpy(&outValues[(step * valuesPerLaneStep) + (lane * 2)], &result, sizeof(result));
+			for (size_t word = 0; word < 4; ++word)
+			{
+				laneStates[word][lane] = s[word];
+			}
+		}
+	}
+}
+#endif // !defined(MATH_SIMD_SSE)
+
+#if defined(MATH_SIMD_SSE)
+static inline __m128i rotateLeftSse(const __m128i value, const int32_t shift)
+{
+	return _mm_or_si128(_mm_slli_epi64(value, shift), _mm_srli_epi64(value, 64 - shift));
+}
+
+static void generateLaneStepsSse(uint64_t (&laneStates)[4][4], uint32_t* outValues, const size_t stepCount)
+{
+	// Lanes 0 and 1 in the low registers, lanes 2 and 3 in the high registers
+	__m128i s[4][2];
+	for (size_t word = 0; word < 4; ++word)
+	{
+		s[word][0] = _mm_load_si128(reinterpret_cast<const __m128i*>(&laneStates[word][0]));
+		s[word][1] = _mm_load_si128(reinterpret_cast<const __m128i*>(&laneStates[word][2]));
+	}
+
+	for (size_t step = 0; step < stepCount; ++step)
+	{
+		for (size_t half = 0; half < 2; ++half)
+		{
+			// s1 * 5 and the final * 9 are shift and add as sse2 has no 64-bit multiply
+			const __m128i s1Times5 = _mm_add_epi64(_mm_slli_epi64(s[1][half], 2), s[1][half]);
+			const __m128i rotated = rotateLeftSse(s1Times5, 7);
+			const __m128i result = _mm_add_epi64(_mm_slli_epi64(rotated, 3), rotated);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&outValues[(step * valuesPerLaneStep) + (half * 4)]), result);
+
+			const __m128i t = _mm_slli_epi64(s[1][half], 17);
+			s[2][half] = _mm_xor_si128(s[2][half], s[0][half]);
+			s[3][half] = _mm_xor_si128(s[3][half], s[1][half]);
+			s[1][half] = _mm_xor_si128(s[1][half], s[2][half]);
+			s[0][half] = _mm_xor_si128(s[0][half], s[3][half]);
+			s[2][half] = _mm_xor_si128(s[2][half], t);
+			s[3][half] = rotateLeftSse(s[3][half], 45);
+		}
+	}
+
+	for (size_t word = 0; word < 4; ++word)
+	{
+		_mm_store_si128(reinterpret_cast<__m128i*>(&laneStates[word][0]), s[word][0]);
+		_mm_store_si128(reinterpret_cast<__m128i*>(&laneStates[word][2]), s[word][1]);
+	}
+}
+
+MATH_SIMD_TARGET_AVX2 static void generateLaneStepsAvx2(uint64_t (&laneStates)[4][4], uint32_t* outValues, const size_t stepCount)
+{
+	__m256i s0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(laneStates[0]));
+	__m256i s1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(laneStates[1]));
+	__m256i s2 = _mm256_load_si256(reinterpret_cast<const __m256i*>(laneStates[2]));
+	__m256i s3 = _mm256_load_si256(reinterpret_cast<const __m256i*>(laneStates[3]));
+
+	for (size_t step = 0; step < stepCount; ++step)
+	{
+		const __m256i s1Times5 = _mm256_add_epi64(_mm256_slli_epi64(s1, 2), s1);
+		const __m256i rotated = _mm256_or_si256(_mm256_slli_epi64(s1Times5, 7), _mm256_srli_epi64(s1Times5, 57));
+		const __m256i result = _mm256_add_epi64(_mm256_slli_epi64(rotated, 3), rotated);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&outValues[step * valuesPerLaneStep]), result);
+
+		const __m256i t = _mm256_slli_epi64(s1, 17);
+		s2 = _mm256_xor_si256(s2, s0);
+		s3 = _mm256_xor_si256(s3, s1);
+		s1 = _mm256_xor_si256(s1, s2);
+		s0 = _mm256_xor_si256(s0, s3);
+		s2 = _mm256_xor_si256(s2, t);
+		s3 = _mm256_or_si256(_mm256_slli_epi64(s3, 45), _mm256_srli_epi64(s3, 19));
+	}
+
+	_mm256_store_si256(reinterpret_cast<__m256i*>(laneStates[0]), s0);
+	_mm256_store_si256(reinterpret_cast<__m256i*>(laneStates[1]), s1);
+	_mm256_store_si256(reinterpret_cast<__m256i*>(laneStates[2]), s2);
+	_mm256_store_si256(reinterpret_cast<__m256i*>(laneStates[3]), s3);
+}
+#endif // defined(MATH_SIMD_SSE)
+
+using generateLaneStepsFunction = void(*)(uint64_t (&laneStates)[4][4], uint32_t* outValues, const size_t stepCount);
+
+static generateLaneStepsFunction getLaneStepsKernel()
+{
+#if defined(MATH_SIMD_SSE)
+	static const generateLaneStepsFunction kernel = sCpuFeatures::get().avx2 ? &generateLaneStepsAvx2 : &generateLaneStepsSse;
+	return kernel;
+#else
+	return &generateLaneStepsScalar;
+#endif // defined(MATH_SIMD_SSE)
+}
+
+randomEngine::randomEngine(const uint64_t seed, const uint64_t streamIndex)
+{
+	uint64_t seedState = seed;
+	for (size_t i = 0; i < 4; ++i)
+	{
+		state[i] = splitMix64(seedState);
+	}
+
+	for (uint64_t i = 0; i < streamIndex; ++i)
+	{
+		longJump();
+	}
+
+	// Bulk lanes start 2^128 values apart inside this stream
+	uint64_t laneState[4];
+	memcpy(laneState, state, sizeof(laneState));
+	for (size_t lane = 0; lane < laneCount; ++lane)
+	{
+		jumpState(laneState, jumpPolynomial);
+		for (size_t word = 0; word < 4; ++word)
+		{
+			laneStates[word][lane] = laneState[word];
+		}
+	}
+}
+
+uint64_t randomEngine::next()
+{
+	return stepState(state);
+}
+
+float randomEngine::nextFloat()
+{
+	// The upper 24 bits fill the float mantissa exactly
+	return static_cast<float>(next() >> 40) * (1.0f / 16777216.0f);
+}
+
+void randomEngine::jump()
+{
+	jumpState(state, jumpPolynomial);
+}
+
+void randomEngine::longJump()
+{
+	jumpState(state, longJumpPolynomial);
+}
+
+void randomEngine::fillUInt32(std::span<uint32_t> outValues)
+{
+	const size_t stepCount = outValues.size() / valuesPerLaneStep;
+	getLaneStepsKernel()(laneStates, outValues.data(), stepCount);
+
+	// Generate one more step for the remainder and discard the unused values
+	const size_t remainder = outValues.size() - (stepCount * valuesPerLaneStep);
+	if (remainder > 0)
+	{
+		uint32_t tail[valuesPerLaneStep];
+		getLaneStepsKernel()(laneStates, tail, 1);
+		memcpy(&outValues[stepCount * valuesPerLaneStep], tail, sizeof(uint32_t) * remainder);
+	}
+}
+
+void randomEngine::fillFloat(std::span<float> outValues, const float minValue, const float maxValue)
+{
+	const float scale = (maxValue - minValue) * (1.0f / 16777216.0f);
+
+	// Generate integers in cache sized chunks and convert them in place of a second pass over the output
+	uint32_t chunk[256];
+	for (size_t offset = 0; offset < outValues.size(); offset += _countof(chunk))
+	{
+		const size_t count = std::min(_countof(chunk), outValues.size() - offset);
+		fillUInt32(std::span<uint32_t>(chunk, count));
+		for (size_t i = 0; i < count; ++i)
+		{
+			outValues[offset + i] = minValue + (static_cast<float>(chunk[i] >> 8) * scale);
+		}
+	}
+}
+
+void randomEngine::fillUnitVectors(std::span<vector3f> outVectors)
+{
+	// Uniform z in [-1, 1) and angle around z gives a uniform distribution over the sphere surface
+	static constexpr float twoPi = 6.28318530718f;
+	float chunk[256];
+	for (size_t offset = 0; offset < outVectors.size(); offset += (_countof(chunk) / 2))
+	{
+		const size_t count = std::min(_countof(chunk) / 2, outVectors.size() - offset);
+		fillFloat(std::span<float>(chunk, count * 2));
+		for (size_t i = 0; i < count; ++i)
+		{
+			const float z = (2.0f * chunk[i * 2]) - 1.0f;
+			const float angle = twoPi * chunk[(i * 2) + 1];
+			const float radius = std::sqrt(std::max(0.0f, 1.0f - (z * z)));
+			outVectors[offset + i] = vector3f(radius * std::cos(angle), radius * std::sin(angle), z);
+		}
+	}
+}
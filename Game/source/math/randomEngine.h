@@ -0,0 +1,52 @@
+#pragma once
+
+class vector3f;
+
+// xoshiro256** pseudo random engine with 256 bits of state and a period of 2^256 - 1. Not suitable for cryptography.
+// Satisfies UniformRandomBitGenerator so it can drive the standard library distributions
+class randomEngine
+{
+public:
+	using result_type = uint64_t;
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return UINT64_MAX; }
+
+public:
+	// Seeds the engine at the start of stream streamIndex for seed. Streams are 2^192 values apart so they never overlap.
+	// Selecting a stream costs one long jump per stream index
+	explicit randomEngine(const uint64_t seed = 0, const uint64_t streamIndex = 0);
+
+	result_type operator()() { return next(); }
+
+public:
+	uint64_t next();
+	uint32_t nextUInt32() { return static_cast<uint32_t>(next() >> 32); }
+
+	// Returns a uniformly distributed float in [0, 1)
+	float nextFloat();
+
+	// Advances the engine by 2^128 values
+	void jump();
+
+	// Advances the engine by 2^192 values
+	void longJump();
+
+	// Bulk generation runs 4 interleaved lanes seeded from this engine's stream, 8 values per step with avx2 or sse2.
+	// The lanes produce the same values on every instruction set so results are reproducible across machines
+	void fillUInt32(std::span<uint32_t> outValues);
+
+	// Fills outValues with uniformly distributed floats in [minValue, maxValue)
+	void fillFloat(std::span<float> outValues, const float minValue = 0.0f, const float maxValue = 1.0f);
+
+	// Fills outVectors with uniformly distributed directions on the unit sphere
+	void fillUnitVectors(std::span<vector3f> outVectors);
+
+private:
+	static constexpr size_t laneCount = 4;
+
+	uint64_t state[4] = {};
+
+	// Bulk lane states stored word major so each state word of every lane loads as one simd register
+	alignas(32) uint64_t laneStates[4][laneCount] = {};
+};
\ No newline at end of file
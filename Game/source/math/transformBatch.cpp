@@ -0,0 +1,231 @@
+#include "pch.h"
+#include "transformBatch.h"
+#include "matrix3x4f.h"
+#include "mathSimd.h"
+
+// Computes world matrices for objects [begin, end)
+static void computeWorldMatricesScalarRange(const sTransformBatch& batch, const size_t begin, const size_t end, matrix3x4f* outWorldMatrices)
+{
+	for (size_t i = begin; i < end; ++i)
+	{
+		const float x = batch.rotationX[i];
+		const float y = batch.rotationY[i];
+		const float z = batch.rotationZ[i];
+		const float w = batch.rotationW[i];
+		const float x2 = x + x;
+		const float y2 = y + y;
+		const float z2 = z + z;
+		const float xx = x * x2;
+		const float yy = y * y2;
+		const float zz = z * z2;
+		const float xy = x * y2;
+		const float xz = x * z2;
+		const float yz = y * z2;
+		const float wx = w * x2;
+		const float wy = w * y2;
+		const float wz = w * z2;
+
+		const float scaleX = batch.scaleX[i];
+		const float scaleY = batch.scaleY[i];
+		const float scaleZ = batch.scaleZ[i];
+
+		float* const values = outWorldMatrices[i].values;
+		values[0] = (1.0f - (yy + zz)) * scaleX;
+		values[1] = (xy - wz) * scaleY;
+		values[2] = (xz + wy) * scaleZ;
+		values[3] = batch.positionX[i];
+
+		values[4] = (xy + wz) * scaleX;
+		values[5] = (1.0f - (xx + zz)) * scaleY;
+		values[6] = (yz - wx) * scaleZ;
+		values[7] = batch.positionY[i];
+
+		values[8] = (xz - wy) * scaleX;
+		values[9] = (yz + wx) * scaleY;
+		values[10] = (1.0f - (xx + yy)) * scaleZ;
+		values[11] = batch.positionZ[i];
+	}
+}
+
+#if defined(MATH_SIMD_SSE)
+static void computeWorldMatricesSse(const sTransformBatch& batch, matrix3x4f* outWorldMatrices)
+{
+	const size_t simdCount = batch.count & ~static_cast<size_t>(3);
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	for (size_t i = 0; i < simdCount; i += 4)
+	{
+		const __m128 x = _mm_loadu_ps(&batch.rotationX[i]);
+		const __m128 y = _mm_loadu_ps(&batch.rotationY[i]);
+		const __m128 z = _mm_loadu_ps(&batch.rotationZ[i]);
+		const __m128 w = _mm_loadu_ps(&batch.rotationW[i]);
+		const __m128 x2 = _mm_add_ps(x, x);
+		const __m128 y2 = _mm_add_ps(y, y);
+		const __m128 z2 = _mm_add_ps(z, z);
+		const __m128 xx = _mm_mul_ps(x, x2);
+		const __m128 yy = _mm_mul_ps(y, y2);
+		const __m128 zz = _mm_mul_ps(z, z2);
+		const __m128 xy = _mm_mul_ps(x, y2);
+		const __m128 xz = _mm_mul_ps(x, z2);
+		const __m128 yz = _mm_mul_ps(y, z2);
+		const __m128 wx = _mm_mul_ps(w, x2);
+		const __m128 wy = _mm_mul_ps(w, y2);
+		const __m128 wz = _mm_mul_ps(w, z2);
+
+		const __m128 scaleX = _mm_loadu_ps(&batch.scaleX[i]);
+		const __m128 scaleY = _mm_loadu_ps(&batch.scaleY[i]);
+		const __m128 scaleZ = _mm_loadu_ps(&batch.scaleZ[i]);
+
+		// Each register holds one matrix element for 4 objects
+		__m128 rows[3][4] =
+		{
+			{
+				_mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), scaleX),
+				_mm_mul_ps(_mm_sub_ps(xy, wz), scaleY),
+				_mm_mul_ps(_mm_add_ps(xz, wy), scaleZ),
+				_mm_loadu_ps(&batch.positionX[i])
+			},
+			{
+				_mm_mul_ps(_mm_add_ps(xy, wz), scaleX),
+				_mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), scaleY),
+				_mm_mul_ps(_mm_sub_ps(yz, wx), scaleZ),
+				_mm_loadu_ps(&batch.positionY[i])
+			},
+			{
+				_mm_mul_ps(_mm_sub_ps(xz, wy), scaleX),
+				_mm_mul_ps(_mm_add_ps(yz, wx), scaleY),
+				_mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), scaleZ),
+				_mm_loadu_ps(&batch.positionZ[i])
+			}
+		};
+
+		// Transpose each row from element-per-register to object-per-register and write it out
+		for (size_t row = 0; row < 3; ++row)
+		{
+			_MM_TRANSPOSE4_PS(rows[row][0], rows[row][1], rows[row][2], rows[row][3]);
+			_mm_storeu_ps(&outWorldMatrices[i + 0].values[row * 4], rows[row][0]);
+			_mm_storeu_ps(&outWorldMatrices[i + 1].values[row * 4], rows[row][1]);
+			_mm_storeu_ps(&outWorldMatrices[i + 2].values[row * 4], rows[row][2]);
+			_mm_storeu_ps(&outWorldMatrices[i + 3].values[row * 4], rows[row][3]);
+		}
+	}
+
+	computeWorldMatricesScalarRange(batch, simdCount, batch.count, outWorldMatrices);
+}
+
+MATH_SIMD_TARGET_AVX2 static void computeWorldMatricesAvx2(const sTransformBatch& batch, matrix3x4f* outWorldMatrices)
+{
+	const size_t simdCount = batch.count & ~static_cast<size_t>(7);
+
+	for (size_t i = 0; i < simdCount; i += 8)
+	{
+		const __m256 x = _mm256_loadu_ps(&batch.rotationX[i]);
+		const __m256 y = _mm256_loadu_ps(&batch.rotationY[i]);
+		const __m256 z = _mm256_loadu_ps(&batch.rotationZ[i]);
+		const __m256 w = _mm256_loadu_ps(&batch.rotationW[i]);
+		const __m256 x2 = _mm256_add_ps(x, x);
+		const __m256 y2 = _mm256_add_ps(y, y);
+		const __m256 z2 = _mm256_add_ps(z, z);
+		const __m256 xx = _mm256_mul_ps(x, x2);
+		const __m256 yy = _mm256_mul_ps(y, y2);
+		const __m256 zz = _mm256_mul_ps(z, z2);
+		const __m256 xy = _mm256_mul_ps(x, y2);
+		const __m256 xz = _mm256_mul_ps(x, z2);
+		const __m256 yz = _mm256_mul_ps(y, z2);
+		const __m256 wx = _mm256_mul_ps(w, x2);
+		const __m256 wy = _mm256_mul_ps(w, y2);
+		const __m256 wz = _mm256_mul_ps(w, z2);
+
+		const __m256 scaleX = _mm256_loadu_ps(&batch.scaleX[i]);
+		const __m256 scaleY = _mm256_loadu_ps(&batch.scaleY[i]);
+		const __m256 scaleZ = _mm256_loadu_ps(&batch.scaleZ[i]);
+
+		// Each register holds one matrix element for 8 objects. Diagonal terms fold the scale with fnmadd: (1 - a) * s = s - a * s
+		const __m256 rows[3][4] =
+		{
+			{
+				_mm256_fnmadd_ps(_mm256_add_ps(yy, zz), scaleX, scaleX),
+				_mm256_mul_ps(_mm256_sub_ps(xy, wz), scaleY),
+				_mm256_mul_ps(_mm256_add_ps(xz, wy), scaleZ),
+				_mm256_loadu_ps(&batch.positionX[i])
+			},
+			{
+				_mm256_mul_ps(_mm256_add_ps(xy, wz), scaleX),
+				_mm256_fnmadd_ps(_mm256_add_ps(xx, zz), scaleY, scaleY),
+				_mm256_mul_ps(_mm256_sub_ps(yz, wx), scaleZ),
+				_mm256_loadu_ps(&batch.positionY[i])
+			},
+			{
+				_mm256_mul_ps(_mm256_sub_ps(xz, wy), scaleX),
+				_mm256_mul_ps(_mm256_add_ps(yz, wx), scaleY),
+				_mm256_fnmadd_ps(_mm256_add_ps(xx, yy), scaleZ, scaleZ),
+				_mm256_loadu_ps(&batch.positionZ[i])
+			}
+		};
+
+		// Transpose each row within both 128-bit lanes. The low lane holds objects 0-3 and the high lane objects 4-7
+		for (size_t row = 0; row < 3; ++row)
+		{
+			const __m256 t0 = _mm256_unpacklo_ps(rows[row][0], rows[row][1]);
+			const __m256 t1 = _mm256_unpackhi_ps(rows[row][0], rows[row][1]);
+			const __m256 t2 = _mm256_unpacklo_ps(rows[row][2], rows[row][3]);
+			const __m256 t3 = _mm256_unpackhi_ps(rows[row][2], rows[row][3]);
+			const __m256 object0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+			const __m256 object1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+			const __m256 object2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+			const __m256 object3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+			_mm_storeu_ps(&outWorldMatrices[i + 0].values[row * 4], _mm256_castps256_ps128(object0));
+			_mm_storeu_ps(&outWorldMatrices[i + 1].values[row * 4], _mm256_castps256_ps128(object1));
+			_mm_storeu_ps(&outWorldMatrices[i + 2].values[row * 4], _mm256_castps256_ps128(object2));
+			_mm_storeu_ps(&outWorldMatrices[i + 3].values[row * 4], _mm256_castps256_ps128(object3));
+			_mm_storeu_ps(&outWorldMatrices[i + 4].values[row * 4], _mm256_extractf128_ps(object0, 1));
+			_mm_storeu_ps(&outWorldMatrices[i + 5].values[row * 4], _mm256_extractf128_ps(object1, 1));
+			_mm_storeu_ps(&outWorldMatrices[i + 6].values[row * 4], _mm256_extractf128_ps(object2, 1));
+			_mm_storeu_ps(&outWorldMatrices[i + 7].values[row * 4], _mm256_extractf128_ps(object3, 1));
+		}
+	}
+
+	computeWorldMatricesScalarRange(batch, simdCount, batch.count, outWorldMatrices);
+}
+#endif // defined(MATH_SIMD_SSE)
+
+void transformBatch::computeWorldMatrices(const sTransformBatch& batch, matrix3x4f* outWorldMatrices)
+{
+#if defined(MATH_SIMD_SSE)
+	static const bool useAvx2 = sCpuFeatures::get().avx2 && sCpuFeatures::get().fma;
+	if (useAvx2)
+	{
+		computeWorldMatricesAvx2(batch, outWorldMatrices);
+	}
+	else
+	{
+		computeWorldMatricesSse(batch, outWorldMatrices);
+	}
+#else
+	computeWorldMatricesScalarRange(batch, 0, batch.count, outWorldMatrices);
+#endif // defined(MATH_SIMD_SSE)
+}
+
+void transformBatch::computeWorldMatricesScalar(const sTransformBatch& batch, matrix3x4f* outWorldMatrices)
+{
+	computeWorldMatricesScalarRange(batch, 0, batch.count, outWorldMatrices);
+}
+
+float transformBatch::validate(const sTransformBatch& batch)
+{
+	std::vector<matrix3x4f> simdResults(batch.count);
+	std::vector<matrix3x4f> scalarResults(batch.count);
+	computeWorldMatrices(batch, simdResults.data());
+	computeWorldMatricesScalar(batch, scalarResults.data());
+
+	float maxDifference = 0.0f;
+	for (size_t i = 0; i < batch.count; ++i)
+	{
+		for (size_t j = 0; j < _countof(simdResults[i].values); ++j)
+		{
+			maxDifference = std::max(maxDifference, std::abs(simdResults[i].values[j] - scalarResults[i].values[j]));
+		}
+	}
+	return maxDifference;
+}
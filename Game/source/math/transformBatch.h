@@ -0,0 +1,34 @@
+#pragma once
+
+class matrix3x4f;
+
+// Structure of arrays view over a batch of transforms. Each array holds count values. Rotations are unit quaternions
+struct sTransformBatch
+{
+	const float* positionX = nullptr;
+	const float* positionY = nullptr;
+	const float* positionZ = nullptr;
+	const float* rotationX = nullptr;
+	const float* rotationY = nullptr;
+	const float* rotationZ = nullptr;
+	const float* rotationW = nullptr;
+	const float* scaleX = nullptr;
+	const float* scaleY = nullptr;
+	const float* scaleZ = nullptr;
+	size_t count = 0;
+};
+
+// Builds world matrices for many objects at once. The fused kernels compute translation * rotation * scale for 4 (sse) or 8 (avx2)
+// objects per iteration straight from the structure of arrays input
+class transformBatch
+{
+public:
+	// Writes batch.count world matrices to outWorldMatrices using the widest kernel supported by the cpu
+	static void computeWorldMatrices(const sTransformBatch& batch, matrix3x4f* outWorldMatrices);
+
+	// Reference implementation used to validate the simd kernels
+	static void computeWorldMatricesScalar(const sTransformBatch& batch, matrix3x4f* outWorldMatrices);
+
+	// Returns the largest absolute difference between the simd kernel selected for this cpu and the scalar reference over the batch
+	static float validate(const sTransformBatch& batch);
+};
\ No newline at end of file
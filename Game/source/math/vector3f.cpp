@@ -0,0 +1,92 @@
+#include "pch.h"
+#include "vector3f.h"
+#include "vector3d.h"
+#include "mathSimd.h"
+#include "sString.h"
+
+vector3f::vector3f(const vector3d& a)
+	: x(static_cast<float>(a.x)), y(static_cast<float>(a.y)), z(static_cast<float>(a.z))
+{
+}
+
+vector3f vector3f::operator-(const vector3f& rhs) const
+{
+	vector3f result;
+#if defined(MATH_SIMD_SSE)
+	_mm_store_ps(&result.x, _mm_sub_ps(_mm_load_ps(&x), _mm_load_ps(&rhs.x)));
+#elif defined(MATH_SIMD_NEON)
+	vst1q_f32(&result.x, vsubq_f32(vld1q_f32(&x), vld1q_f32(&rhs.x)));
+#else
+	result = vector3f(x - rhs.x, y - rhs.y, z - rhs.z);
+#endif // defined(MATH_SIMD_SSE)
+	return result;
+}
+
+vector3f vector3f::operator+(const vector3f& rhs) const
+{
+	vector3f result;
+#if defined(MATH_SIMD_SSE)
+	_mm_store_ps(&result.x, _mm_add_ps(_mm_load_ps(&x), _mm_load_ps(&rhs.x)));
+#elif defined(MATH_SIMD_NEON)
+	vst1q_f32(&result.x, vaddq_f32(vld1q_f32(&x), vld1q_f32(&rhs.x)));
+#else
+	result = vector3f(x + rhs.x, y + rhs.y, z + rhs.z);
+#endif // defined(MATH_SIMD_SSE)
+	return result;
+}
+
+vector3f vector3f::crossProduct(const vector3f& a, const vector3f& b)
+{
+	vector3f result;
+#if defined(MATH_SIMD_SSE)
+	// (a.yzx * b.zxy) - (a.zxy * b.yzx). The padding lane stays zero
+	const __m128 aVector = _mm_load_ps(&a.x);
+	const __m128 bVector = _mm_load_ps(&b.x);
+	const __m128 aYzx = _mm_shuffle_ps(aVector, aVector, _MM_SHUFFLE(3, 0, 2, 1));
+	const __m128 bYzx = _mm_shuffle_ps(bVector, bVector, _MM_SHUFFLE(3, 0, 2, 1));
+	const __m128 crossZxy = _mm_sub_ps(_mm_mul_ps(aVector, bYzx), _mm_mul_ps(aYzx, bVector));
+	_mm_store_ps(&result.x, _mm_shuffle_ps(crossZxy, crossZxy, _MM_SHUFFLE(3, 0, 2, 1)));
+#else
+	result = vector3f((a.y * b.z) - (a.z * b.y), (a.z * b.x) - (a.x * b.z), (a.x * b.y) - (a.y * b.x));
+#endif // defined(MATH_SIMD_SSE)
+	return result;
+}
+
+float vector3f::dotProduct(const vector3f& a, const vector3f& b)
+{
+	return (a.x * b.x) + (a.y * b.y) + (a.z * b.z);
+}
+
+vector3f vector3f::normalize(const vector3f& a)
+{
+	const float inverseLength = 1.0f / std::sqrt(dotProduct(a, a));
+	return inverseLength * a;
+}
+
+void vector3f::normalizeInPlace()
+{
+	*this = normalize(*this);
+}
+
+vector3d vector3f::toVector3d() const
+{
+	return vector3d(x, y, z);
+}
+
+std::string vector3f::toString() const
+{
+	return sString::printf("[x: %f, y: %f, z: %f]", x, y, z);
+}
+
+vector3f operator*(const float lhs, const vector3f& rhs)
+{
+	vector3f result;
+#if defined(MATH_SIMD_SSE)
+	_mm_store_ps(&result.x, _mm_mul_ps(_mm_set1_ps(lhs), _mm_load_ps(&rhs.x)));
+#elif defined(MATH_SIMD_NEON)
+	vst1q_f32(&result.x, vmulq_n_f32(vld1q_f32(&rhs.x), lhs));
+#else
+	result = vector3f(lhs * rhs.x, lhs * rhs.y, lhs * rhs.z);
+#endif // defined(MATH_SIMD_SSE)
+	return result;
+}
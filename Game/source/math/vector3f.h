@@ -0,0 +1,38 @@
+#pragma once
+
+// Single precision 3 component vector padded to 16 bytes so it can be loaded into a simd register
+class alignas(16) vector3f
+{
+public:
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+
+private:
+	float padding = 0.0f;
+
+public:
+	vector3f() = default;
+
+	template <typename T>
+	vector3f(const T inX, const T inY, const T inZ)
+		: x(static_cast<float>(inX)), y(static_cast<float>(inY)), z(static_cast<float>(inZ)) {}
+
+	// Narrows a double precision vector
+	explicit vector3f(const class vector3d& a);
+
+public:
+	vector3f operator-(const vector3f& rhs) const;
+	vector3f operator+(const vector3f& rhs) const;
+	friend vector3f operator*(const float lhs, const vector3f& rhs);
+
+public:
+	static vector3f crossProduct(const vector3f& a, const vector3f& b);
+	static float dotProduct(const vector3f& a, const vector3f& b);
+	static vector3f normalize(const vector3f& a);
+
+public:
+	void normalizeInPlace();
+	class vector3d toVector3d() const;
+	std::string toString() const;
+};
\ No newline at end of file
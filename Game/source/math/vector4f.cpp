@@ -0,0 +1,70 @@
+#include "pch.h"
+#include "vector4f.h"
+#include "vector4d.h"
+#include "mathSimd.h"
+#include "sString.h"
+
+vector4f::vector4f(const vector4d& a)
+	: x(static_cast<float>(a.x)), y(static_cast<float>(a.y)), z(static_cast<float>(a.z)), w(static_cast<float>(a.w))
+{
+}
+
+vector4f vector4f::operator-(const vector4f& rhs) const
+{
+	vector4f result;
+#if defined(MATH_SIMD_SSE)
+	_mm_store_ps(&result.x, _mm_sub_ps(_mm_load_ps(&x), _mm_load_ps(&rhs.x)));
+#elif defined(MATH_SIMD_NEON)
+	vst1q_f32(&result.x, vsubq_f32(vld1q_f32(&x), vld1q_f32(&rhs.x)));
+#else
+	result = vector4f(x - rhs.x, y - rhs.y, z - rhs.z, w - rhs.w);
+#endif // defined(MATH_SIMD_SSE)
+	return result;
+}
+
+vector4f vector4f::operator+(const vector4f& rhs) const
+{
+	vector4f result;
+#if defined(MATH_SIMD_SSE)
+	_mm_store_ps(&result.x, _mm_add_ps(_mm_load_ps(&x), _mm_load_ps(&rhs.x)));
+#elif defined(MATH_SIMD_NEON)
+	vst1q_f32(&result.x, vaddq_f32(vld1q_f32(&x), vld1q_f32(&rhs.x)));
+#else
+	result = vector4f(x + rhs.x, y + rhs.y, z + rhs.z, w + rhs.w);
+#endif // defined(MATH_SIMD_SSE)
+	return result;
+}
+
+float vector4f::dotProduct(const vector4f& a, const vector4f& b)
+{
+	return (a.x * b.x) + (a.y * b.y) + (a.z * b.z) + (a.w * b.w);
+}
+
+vector4f vector4f::normalize(const vector4f& a)
+{
+	const float inverseLength = 1.0f / std::sqrt(dotProduct(a, a));
+	return inverseLength * a;
+}
+
+vector4d vector4f::toVector4d() const
+{
+	return vector4d(x, y, z, w);
+}
+
+std::string vector4f::toString() const
+{
+	return sString::printf("[x: %f, y: %f, z: %f, w: %f]", x, y, z, w);
+}
+
+vector4f operator*(const float lhs, const vector4f& rhs)
+{
+	vector4f result;
+#if defined(MATH_SIMD_SSE)
+	_mm_store_ps(&result.x, _mm_mul_ps(_mm_set1_ps(lhs), _mm_load_ps(&rhs.x)));
+#elif defined(MATH_SIMD_NEON)
+	vst1q_f32(&result.x, vmulq_n_f32(vld1q_f32(&rhs.x), lhs));
+#else
+	result = vector4f(lhs * rhs.x, lhs * rhs.y, lhs * rhs.z, lhs * rhs.w);
+#endif // defined(MATH_SIMD_SSE)
+	return result;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+// Single precision 4 component vector aligned to 16 bytes so it can be loaded into a simd register
+class alignas(16) vector4f
+{
+public:
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+	float w = 1.0f;
+
+public:
+	vector4f() = default;
+
+	template <typename T>
+	vector4f(const T inX, const T inY, const T inZ, const T inW)
+		: x(static_cast<float>(inX)), y(static_cast<float>(inY)), z(static_cast<float>(inZ)), w(static_cast<float>(inW)) {}
+
+	// Narrows a double precision vector
+	explicit vector4f(const class vector4d& a);
+
+public:
+	vector4f operator-(const vector4f& rhs) const;
+	vector4f operator+(const vector4f& rhs) const;
+	friend vector4f operator*(const float lhs, const vector4f& rhs);
+
+public:
+	static float dotProduct(const vector4f& a, const vector4f& b);
+	static vector4f normalize(const vector4f& a);
+
+public:
+	class vector4d toVector4d() const;
+	std::string toString() const;
+};
\ No newline at end of file
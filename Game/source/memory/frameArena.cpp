@@ -0,0 +1,27 @@
+#include "pch.h"
+#include "frameArena.h"
+
+void frameArena::init(const uint32_t inFrameCount, const size_t bytesPerFrame)
+{
+	frameCount = std::max(inFrameCount, 1u);
+	frames = std::make_unique<sFrame[]>(frameCount);
+	for (uint32_t i = 0; i < frameCount; ++i)
+	{
+		frames[i].arena.init(bytesPerFrame);
+	}
+	currentFrame = 0;
+}
+
+void frameArena::shutdown()
+{
+	frames.reset();
+	frameCount = 0;
+	currentFrame = 0;
+}
+
+void frameArena::beginFrame(const uint32_t frameIndex)
+{
+	assert(frameIndex < frameCount);
+	currentFrame = frameIndex;
+	frames[currentFrame].arena.reset();
+}
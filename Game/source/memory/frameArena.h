@@ -0,0 +1,36 @@
+#pragma once
+
+#include "linearArena.h"
+
+// One linear arena per frame in flight. Memory allocated during a frame stays valid until the same frame slot begins again, by which
+// point the graphics backend has waited for the gpu to finish with it, so frame data can be referenced by recorded gpu work.
+// Owned by the thread that begins frames
+class frameArena
+{
+public:
+	void init(const uint32_t frameCount, const size_t bytesPerFrame);
+	void shutdown();
+
+	// Resets the arena of frameIndex and makes it the current arena. Call once the gpu has finished the frame that last used the slot
+	void beginFrame(const uint32_t frameIndex);
+
+	linearArena& getArena() { return frames[currentFrame].arena; }
+	std::pmr::memory_resource* getResource() { return &frames[currentFrame].resource; }
+
+	template <typename T>
+	T* allocateArray(const size_t count) { return getArena().allocateArray<T>(count); }
+
+private:
+	struct sFrame
+	{
+		linearArena arena;
+		arenaMemoryResource resource;
+
+		sFrame() : resource(arena) {}
+	};
+
+private:
+	std::unique_ptr<sFrame[]> frames;
+	uint32_t frameCount = 0;
+	uint32_t currentFrame = 0;
+};
\ No newline at end of file
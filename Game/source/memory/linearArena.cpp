@@ -0,0 +1,94 @@
+#include "pch.h"
+#include "linearArena.h"
+
+linearArena::linearArena(const size_t inCapacity)
+{
+	init(inCapacity);
+}
+
+void linearArena::init(const size_t inCapacity)
+{
+	memory = std::make_unique_for_overwrite<uint8_t[]>(inCapacity);
+	capacity = inCapacity;
+	offset = 0;
+	peak = 0;
+}
+
+void linearArena::shutdown()
+{
+	memory.reset();
+	capacity = 0;
+	offset = 0;
+}
+
+void* linearArena::allocate(const size_t size, const size_t alignment)
+{
+	assert((alignment & (alignment - 1)) == 0);
+
+	// Align the address rather than the offset as the block itself is only aligned for max_align_t
+	const uintptr_t base = reinterpret_cast<uintptr_t>(memory.get());
+	const uintptr_t alignedAddress = (base + offset + (alignment - 1)) & ~static_cast<uintptr_t>(alignment - 1);
+	const size_t alignedOffset = static_cast<size_t>(alignedAddress - base);
+	if ((memory == nullptr) || (alignedOffset > capacity) || (size > (capacity - alignedOffset)))
+	{
+		return nullptr;
+	}
+
+	offset = alignedOffset + size;
+	return memory.get() + alignedOffset;
+}
+
+void linearArena::deallocate(void* inMemory, const size_t size)
+{
+	uint8_t* const bytes = static_cast<uint8_t*>(inMemory);
+	if (owns(bytes) && ((bytes + size) == (memory.get() + offset)))
+	{
+		peak = std::max(peak, offset);
+		offset = static_cast<size_t>(bytes - memory.get());
+	}
+}
+
+void linearArena::rewind(const size_t marker)
+{
+	assert(marker <= offset);
+	peak = std::max(peak, offset);
+	offset = marker;
+}
+
+bool linearArena::owns(const void* inMemory) const
+{
+	const uint8_t* const bytes = static_cast<const uint8_t*>(inMemory);
+	return (memory != nullptr) && (bytes >= memory.get()) && (bytes < (memory.get() + capacity));
+}
+
+arenaMemoryResource::arenaMemoryResource(linearArena& inArena, std::pmr::memory_resource* inUpstream)
+	: arena(inArena), upstream(inUpstream)
+{
+}
+
+void* arenaMemoryResource::do_allocate(size_t bytes, size_t alignment)
+{
+	if (void* const memory = arena.allocate(bytes, alignment))
+	{
+		return memory;
+	}
+
+	++overflowCount;
+	return upstream->allocate(bytes, alignment);
+}
+
+void arenaMemoryResource::do_deallocate(void* memory, size_t bytes, size_t alignment)
+{
+	if (arena.owns(memory))
+	{
+		arena.deallocate(memory, bytes);
+		return;
+	}
+
+	upstream->deallocate(memory, bytes, alignment);
+}
+
+bool arenaMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+	return this == &other;
+}
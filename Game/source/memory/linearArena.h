@@ -0,0 +1,76 @@
+#pragma once
+
+#include <memory_resource>
+
+// Bump allocator over one fixed block. Allocating moves an offset forward, individual allocations are not freed and the whole arena
+// is released at once with reset or back to a marker with rewind. Destructors of objects placed in the arena are not run.
+// Not thread safe, each arena is owned by one thread at a time
+class linearArena
+{
+public:
+	linearArena() = default;
+	explicit linearArena(const size_t inCapacity);
+
+	linearArena(const linearArena&) = delete;
+	linearArena& operator=(const linearArena&) = delete;
+
+	// Allocates the backing block. Any previous block and everything allocated from it is released
+	void init(const size_t inCapacity);
+	void shutdown();
+
+	// Returns nullptr when the arena does not have enough space left
+	void* allocate(const size_t size, const size_t alignment = alignof(std::max_align_t));
+
+	// Allocates uninitialized storage for count objects of T
+	template <typename T>
+	T* allocateArray(const size_t count);
+
+	// Gives the memory back if it is the most recent allocation, so a container growing at the top of the arena does not leak its old buffer
+	void deallocate(void* memory, const size_t size);
+
+	// Returns the current offset. Passing it to rewind releases everything allocated after it
+	size_t getMarker() const { return offset; }
+	void rewind(const size_t marker);
+	void reset() { rewind(0); }
+
+	bool owns(const void* memory) const;
+	size_t getUsed() const { return offset; }
+	size_t getCapacity() const { return capacity; }
+
+	// Highest offset reached since init, useful for sizing the arena
+	size_t getPeak() const { return std::max(peak, offset); }
+
+private:
+	std::unique_ptr<uint8_t[]> memory;
+	size_t capacity = 0;
+	size_t offset = 0;
+	size_t peak = 0;
+};
+
+// Adapts a linear arena to std::pmr so standard containers can allocate from it. Requests the arena cannot satisfy are passed to the
+// upstream resource and counted, a non zero overflow count means the arena is too small for steady state use
+class arenaMemoryResource : public std::pmr::memory_resource
+{
+public:
+	explicit arenaMemoryResource(linearArena& inArena, std::pmr::memory_resource* inUpstream = std::pmr::new_delete_resource());
+
+	linearArena& getArena() const { return arena; }
+	uint64_t getOverflowCount() const { return overflowCount; }
+
+private:
+	linearArena& arena;
+	std::pmr::memory_resource* upstream;
+	uint64_t overflowCount = 0;
+
+private:
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void* memory, size_t bytes, size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+};
+
+template <typename T>
+T* linearArena::allocateArray(const size_t count)
+{
+	static_assert(std::is_trivially_destructible_v<T>, "linearArena::allocateArray: arena memory is released without running destructors");
+	return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+}
\ No newline at end of file
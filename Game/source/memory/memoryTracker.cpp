@@ -0,0 +1,403 @@
+#include "pch.h"
+#include "memoryTracker.h"
+#include "platform/framework/abstract/platformConsole.h"
+#include "platform/framework/abstract/platformOS.h"
+
+#include <new>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif // defined(_MSC_VER)
+
+static constexpr const char* tagNames[] =
+{
+	"untagged",
+	"game",
+	"platform",
+	"graphics",
+	"fileIO",
+	"math",
+	"ecs",
+	"scene",
+	"jobs",
+	"profiler"
+};
+static_assert(_countof(tagNames) == static_cast<size_t>(eMemoryTag::count), "memoryTracker: tag names do not match eMemoryTag");
+
+// Each tag's counters sit on their own cache line so threads allocating under different tags do not contend
+struct alignas(64) sTagCounters
+{
+	std::atomic<int64_t> liveBytes = 0;
+	std::atomic<int64_t> peakBytes = 0;
+	std::atomic<int64_t> liveAllocations = 0;
+	std::atomic<uint64_t> totalAllocations = 0;
+	std::atomic<uint64_t> budgetBytes = 0;
+	std::atomic<bool> overBudget = false;
+};
+
+// Slot 0 is reserved for allocations whose call site could not be stored
+struct sCallSiteCounters
+{
+	std::atomic<uintptr_t> address = 0;
+	std::atomic<int64_t> liveBytes = 0;
+	std::atomic<uint64_t> totalAllocations = 0;
+};
+
+static sTagCounters tagCounters[static_cast<size_t>(eMemoryTag::count)];
+static sCallSiteCounters callSites[memoryTracker::maxCallSites];
+static thread_local eMemoryTag threadTag = eMemoryTag::untagged;
+
+// Only touched by the thread calling reportBudgetWarnings
+static bool budgetWarned[static_cast<size_t>(eMemoryTag::count)] = {};
+
+static void printFormatted(const char* format, ...)
+{
+	// Formats on the stack so reports can be printed while the heap is being torn down
+	char buffer[512];
+	va_list args;
+	va_start(args, format);
+	const int32_t length = vsnprintf(buffer, sizeof(buffer), format, args);
+	va_end(args);
+
+	if (length > 0)
+	{
+		platformLayer::console::consolePrint(std::string_view(buffer, std::min<size_t>(static_cast<size_t>(length), sizeof(buffer) - 1)));
+	}
+}
+
+static void printCallSites(const char* heading, const uint32_t count, const bool sortByLiveBytes)
+{
+	std::vector<sMemoryCallSiteStats> sites;
+	memoryTracker::getTopCallSites(count, sortByLiveBytes, sites);
+	if (sites.empty())
+	{
+		return;
+	}
+
+	printFormatted("%s", heading);
+	for (const sMemoryCallSiteStats& site : sites)
+	{
+		const std::string description = (site.address != nullptr) ? platformLayer::os::getAddressDescription(site.address) : std::string("unknown");
+		printFormatted("  %12lld bytes %10llu allocations  %s", static_cast<long long>(site.liveBytes),
+			static_cast<unsigned long long>(site.totalAllocations), description.c_str());
+	}
+}
+
+#if defined(ENABLE_MEMORY_TRACKING)
+// Placed immediately before every pointer handed out by operator new
+struct sAllocationHeader
+{
+	uint64_t size;
+	// Distance from the block returned by malloc to the user pointer
+	uint32_t offset;
+	uint16_t callSite;
+	uint8_t tag;
+	uint8_t magic;
+};
+static_assert(sizeof(sAllocationHeader) == 16, "memoryTracker: allocation header must keep the default alignment of the user pointer");
+
+static constexpr uint8_t allocationMagic = 0xA7;
+
+// Linear probes before a new call site gives up and is counted against the unknown slot
+static constexpr uint32_t maxCallSiteProbes = 32;
+
+// Call sites listed by the leak report
+static constexpr uint32_t leakReportCallSiteCount = 16;
+
+static uint16_t findCallSite(const void* address)
+{
+	const uintptr_t key = reinterpret_cast<uintptr_t>(address);
+	if (key == 0)
+	{
+		return 0;
+	}
+
+	// Fibonacci hash into slots 1 to maxCallSites - 1
+	uint32_t slot = static_cast<uint32_t>((static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull) >> 40) % (memoryTracker::maxCallSites - 1);
+	for (uint32_t probe = 0; probe < maxCallSiteProbes; ++probe)
+	{
+		sCallSiteCounters& site = callSites[slot + 1];
+		uintptr_t current = site.address.load(std::memory_order_relaxed);
+		if (current == key)
+		{
+			return static_cast<uint16_t>(slot + 1);
+		}
+
+		if ((current == 0) && site.address.compare_exchange_strong(current, key, std::memory_order_relaxed))
+		{
+			return static_cast<uint16_t>(slot + 1);
+		}
+
+		// Another thread may have claimed the slot for this call site
+		if (current == key)
+		{
+			return static_cast<uint16_t>(slot + 1);
+		}
+
+		slot = (slot + 1) % (memoryTracker::maxCallSites - 1);
+	}
+	return 0;
+}
+
+static void* trackedAllocate(size_t size, size_t alignment, const void* returnAddress)
+{
+	alignment = std::max<size_t>(alignment, sizeof(sAllocationHeader));
+
+	// The header is 16 bytes and malloc is 16 byte aligned, so over aligned blocks need at most alignment bytes of padding
+	uint8_t* const block = static_cast<uint8_t*>(malloc(size + alignment));
+	if (block == nullptr)
+	{
+		return nullptr;
+	}
+
+	const uintptr_t user = (reinterpret_cast<uintptr_t>(block) + sizeof(sAllocationHeader) + (alignment - 1)) & ~static_cast<uintptr_t>(alignment - 1);
+	sAllocationHeader* const header = reinterpret_cast<sAllocationHeader*>(user) - 1;
+	header->size = size;
+	header->offset = static_cast<uint32_t>(user - reinterpret_cast<uintptr_t>(block));
+	header->callSite = findCallSite(returnAddress);
+	header->tag = static_cast<uint8_t>(threadTag);
+	header->magic = allocationMagic;
+
+	sTagCounters& counters = tagCounters[header->tag];
+	const int64_t live = counters.liveBytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed) + static_cast<int64_t>(size);
+	counters.liveAllocations.fetch_add(1, std::memory_order_relaxed);
+	counters.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	int64_t peak = counters.peakBytes.load(std::memory_order_relaxed);
+	while ((live > peak) && !counters.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+	{
+	}
+
+	const uint64_t budget = counters.budgetBytes.load(std::memory_order_relaxed);
+	if ((budget != 0) && (static_cast<uint64_t>(live) > budget) && !counters.overBudget.load(std::memory_order_relaxed))
+	{
+		counters.overBudget.store(true, std::memory_order_relaxed);
+	}
+
+	sCallSiteCounters& site = callSites[header->callSite];
+	site.liveBytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+	site.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	return reinterpret_cast<void*>(user);
+}
+
+static void trackedFree(void* memory)
+{
+	if (memory == nullptr)
+	{
+		return;
+	}
+
+	// A foreign or double free would corrupt the counters and the heap. The header may be unusable, so fail without allocating
+	sAllocationHeader* const header = static_cast<sAllocationHeader*>(memory) - 1;
+	if (header->magic != allocationMagic)
+	{
+		std::fputs("memoryTracker: freed memory that was not allocated by the tracking operator new, or was already freed.\n", stderr);
+		std::abort();
+	}
+	header->magic = 0;
+
+	sTagCounters& counters = tagCounters[header->tag];
+	counters.liveBytes.fetch_sub(static_cast<int64_t>(header->size), std::memory_order_relaxed);
+	counters.liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+	callSites[header->callSite].liveBytes.fetch_sub(static_cast<int64_t>(header->size), std::memory_order_relaxed);
+
+	free(static_cast<uint8_t*>(memory) - header->offset);
+}
+
+#if defined(_MSC_VER)
+#define MEMORY_TRACKER_RETURN_ADDRESS() _ReturnAddress()
+#else
+#define MEMORY_TRACKER_RETURN_ADDRESS() __builtin_return_address(0)
+#endif // defined(_MSC_VER)
+
+static void* trackedAllocateOrThrow(size_t size, size_t alignment, const void* returnAddress)
+{
+	void* const memory = trackedAllocate(size, alignment, returnAddress);
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void* operator new(size_t size) { return trackedAllocateOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__, MEMORY_TRACKER_RETURN_ADDRESS()); }
+void* operator new[](size_t size) { return trackedAllocateOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__, MEMORY_TRACKER_RETURN_ADDRESS()); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return trackedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__, MEMORY_TRACKER_RETURN_ADDRESS()); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return trackedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__, MEMORY_TRACKER_RETURN_ADDRESS()); }
+void* operator new(size_t size, std::align_val_t alignment) { return trackedAllocateOrThrow(size, static_cast<size_t>(alignment), MEMORY_TRACKER_RETURN_ADDRESS()); }
+void* operator new[](size_t size, std::align_val_t alignment) { return trackedAllocateOrThrow(size, static_cast<size_t>(alignment), MEMORY_TRACKER_RETURN_ADDRESS()); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return trackedAllocate(size, static_cast<size_t>(alignment), MEMORY_TRACKER_RETURN_ADDRESS()); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return trackedAllocate(size, static_cast<size_t>(alignment), MEMORY_TRACKER_RETURN_ADDRESS()); }
+
+void operator delete(void* memory) noexcept { trackedFree(memory); }
+void operator delete[](void* memory) noexcept { trackedFree(memory); }
+void operator delete(void* memory, size_t) noexcept { trackedFree(memory); }
+void operator delete[](void* memory, size_t) noexcept { trackedFree(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { trackedFree(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { trackedFree(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { trackedFree(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { trackedFree(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { trackedFree(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept { trackedFree(memory); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept { trackedFree(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept { trackedFree(memory); }
+
+// Reports whatever is still allocated once everything else has been destroyed. Constructed before and so destroyed after all
+// other static objects
+struct sLeakReport
+{
+	~sLeakReport()
+	{
+		int64_t liveBytes = 0;
+		int64_t liveAllocations = 0;
+		for (const sTagCounters& counters : tagCounters)
+		{
+			liveBytes += counters.liveBytes.load(std::memory_order_relaxed);
+			liveAllocations += counters.liveAllocations.load(std::memory_order_relaxed);
+		}
+
+		if (liveAllocations == 0)
+		{
+			return;
+		}
+
+		printFormatted("memoryTracker: %lld bytes in %lld allocations still live at exit.", static_cast<long long>(liveBytes), static_cast<long long>(liveAllocations));
+		for (size_t i = 0; i < _countof(tagCounters); ++i)
+		{
+			const int64_t tagAllocations = tagCounters[i].liveAllocations.load(std::memory_order_relaxed);
+			if (tagAllocations != 0)
+			{
+				printFormatted("  %-10s %12lld bytes %10lld allocations", tagNames[i],
+					static_cast<long long>(tagCounters[i].liveBytes.load(std::memory_order_relaxed)), static_cast<long long>(tagAllocations));
+			}
+		}
+		printCallSites("memoryTracker: leaking call sites:", leakReportCallSiteCount, true);
+	}
+};
+
+#if defined(_MSC_VER)
+#pragma warning(disable : 4073)
+#pragma init_seg(lib)
+static sLeakReport leakReport;
+#else
+static sLeakReport leakReport __attribute__((init_priority(101)));
+#endif // defined(_MSC_VER)
+#endif // defined(ENABLE_MEMORY_TRACKING)
+
+bool memoryTracker::isEnabled()
+{
+#if defined(ENABLE_MEMORY_TRACKING)
+	return true;
+#else
+	return false;
+#endif // defined(ENABLE_MEMORY_TRACKING)
+}
+
+const char* memoryTracker::getTagName(const eMemoryTag tag)
+{
+	return (tag < eMemoryTag::count) ? tagNames[static_cast<size_t>(tag)] : "invalid";
+}
+
+sMemoryTagStats memoryTracker::getTagStats(const eMemoryTag tag)
+{
+	const sTagCounters& counters = tagCounters[static_cast<size_t>(tag)];
+
+	sMemoryTagStats stats;
+	stats.liveBytes = counters.liveBytes.load(std::memory_order_relaxed);
+	stats.peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+	stats.liveAllocations = counters.liveAllocations.load(std::memory_order_relaxed);
+	stats.totalAllocations = counters.totalAllocations.load(std::memory_order_relaxed);
+	stats.budgetBytes = counters.budgetBytes.load(std::memory_order_relaxed);
+	return stats;
+}
+
+void memoryTracker::setBudget(const eMemoryTag tag, const uint64_t budgetBytes)
+{
+	tagCounters[static_cast<size_t>(tag)].budgetBytes.store(budgetBytes, std::memory_order_relaxed);
+}
+
+void memoryTracker::reportBudgetWarnings()
+{
+	for (size_t i = 0; i < _countof(tagCounters); ++i)
+	{
+		sTagCounters& counters = tagCounters[i];
+		const uint64_t budget = counters.budgetBytes.load(std::memory_order_relaxed);
+		const int64_t live = counters.liveBytes.load(std::memory_order_relaxed);
+
+		// Warn once each time a tag goes over budget rather than every frame it stays there
+		if (counters.overBudget.exchange(false, std::memory_order_relaxed) && !budgetWarned[i] && (budget != 0))
+		{
+			printFormatted("memoryTracker: warning: %s is over its budget of %llu bytes, %lld bytes live, peak %lld bytes.", tagNames[i],
+				static_cast<unsigned long long>(budget), static_cast<long long>(live), static_cast<long long>(counters.peakBytes.load(std::memory_order_relaxed)));
+			budgetWarned[i] = true;
+		}
+		else if (budgetWarned[i] && ((budget == 0) || (static_cast<uint64_t>(std::max<int64_t>(live, 0)) <= budget)))
+		{
+			budgetWarned[i] = false;
+		}
+	}
+}
+
+void memoryTracker::getTopCallSites(const uint32_t maxCount, const bool sortByLiveBytes, std::vector<sMemoryCallSiteStats>& outCallSites)
+{
+	outCallSites.clear();
+	for (const sCallSiteCounters& site : callSites)
+	{
+		const uint64_t totalAllocations = site.totalAllocations.load(std::memory_order_relaxed);
+		const int64_t liveBytes = site.liveBytes.load(std::memory_order_relaxed);
+		if ((totalAllocations == 0) || (sortByLiveBytes && (liveBytes <= 0)))
+		{
+			continue;
+		}
+
+		sMemoryCallSiteStats stats;
+		stats.address = reinterpret_cast<const void*>(site.address.load(std::memory_order_relaxed));
+		stats.liveBytes = liveBytes;
+		stats.totalAllocations = totalAllocations;
+		outCallSites.push_back(stats);
+	}
+
+	const size_t count = std::min<size_t>(maxCount, outCallSites.size());
+	std::partial_sort(outCallSites.begin(), outCallSites.begin() + count, outCallSites.end(),
+		[sortByLiveBytes](const sMemoryCallSiteStats& a, const sMemoryCallSiteStats& b)
+		{
+			return sortByLiveBytes ? (a.liveBytes > b.liveBytes) : (a.totalAllocations > b.totalAllocations);
+		});
+	outCallSites.resize(count);
+}
+
+void memoryTracker::printReport(const uint32_t callSiteCount)
+{
+	if (!isEnabled())
+	{
+		return;
+	}
+
+	printFormatted("memoryTracker: %-10s %14s %14s %12s %14s %14s", "tag", "live bytes", "peak bytes", "live allocs", "total allocs", "budget bytes");
+	for (size_t i = 0; i < _countof(tagCounters); ++i)
+	{
+		const sMemoryTagStats stats = getTagStats(static_cast<eMemoryTag>(i));
+		if (stats.totalAllocations == 0)
+		{
+			continue;
+		}
+
+		printFormatted("memoryTracker: %-10s %14lld %14lld %12lld %14llu %14llu", tagNames[i], static_cast<long long>(stats.liveBytes),
+			static_cast<long long>(stats.peakBytes), static_cast<long long>(stats.liveAllocations),
+			static_cast<unsigned long long>(stats.totalAllocations), static_cast<unsigned long long>(stats.budgetBytes));
+	}
+
+	printCallSites("memoryTracker: call sites holding the most memory:", callSiteCount, true);
+	printCallSites("memoryTracker: call sites allocating most often:", callSiteCount, false);
+}
+
+eMemoryTag memoryTracker::getThreadTag()
+{
+	return threadTag;
+}
+
+void memoryTracker::setThreadTag(const eMemoryTag tag)
+{
+	threadTag = tag;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+// Subsystems that heap allocations are attributed to. Allocations take the tag of the innermost MEMORY_TAG_SCOPE on the allocating thread
+enum class eMemoryTag : uint8_t
+{
+	untagged = 0,
+	game,
+	platform,
+	graphics,
+	fileIO,
+	math,
+	ecs,
+	scene,
+	jobs,
+	profiler,
+	count
+};
+
+#if defined(ENABLE_MEMORY_TRACKING)
+#define MEMORY_TAG_CONCATENATE_INNER(a, b) a##b
+#define MEMORY_TAG_CONCATENATE(a, b) MEMORY_TAG_CONCATENATE_INNER(a, b)
+
+// Tags heap allocations made by the calling thread until the end of the enclosing scope
+#define MEMORY_TAG_SCOPE(tag) const memoryTagScope MEMORY_TAG_CONCATENATE(memoryTagScope, __LINE__)(tag)
+#else
+#define MEMORY_TAG_SCOPE(tag)
+#endif // defined(ENABLE_MEMORY_TRACKING)
+
+struct sMemoryTagStats
+{
+	int64_t liveBytes = 0;
+	int64_t peakBytes = 0;
+	int64_t liveAllocations = 0;
+	uint64_t totalAllocations = 0;
+	uint64_t budgetBytes = 0;
+};
+
+struct sMemoryCallSiteStats
+{
+	const void* address = nullptr;
+	int64_t liveBytes = 0;
+	uint64_t totalAllocations = 0;
+};
+
+// Counts heap allocations by tag and by call site through replacements of the global operator new and delete, compiled in when
+// ENABLE_MEMORY_TRACKING is defined, which only debug builds do. Each allocation carries a 16 byte header holding its size, tag and
+// call site so delete can undo the counts, and freeing memory without a valid header aborts. The counters are relaxed atomics and call
+// sites are found in a fixed size lock free table, so the tracker never allocates or locks itself. The call site is the return address
+// of operator new, the code that asked for the memory after inlining. Whatever is still allocated after all static objects are
+// destroyed is printed as a leak report. With tracking compiled out every query returns zeros
+class memoryTracker
+{
+public:
+	static constexpr uint32_t maxCallSites = 8192;
+
+public:
+	static bool isEnabled();
+
+	static const char* getTagName(const eMemoryTag tag);
+	static sMemoryTagStats getTagStats(const eMemoryTag tag);
+
+	// Sets the number of live bytes a tag should stay under. 0 removes the budget
+	static void setBudget(const eMemoryTag tag, const uint64_t budgetBytes);
+
+	// Prints a warning for every tag that went over its budget since the last call. Call regularly from one thread, e.g. once per frame
+	static void reportBudgetWarnings();
+
+	// Returns up to maxCount call sites ordered by live bytes, or by total allocations when sortByLiveBytes is false
+	static void getTopCallSites(const uint32_t maxCount, const bool sortByLiveBytes, std::vector<sMemoryCallSiteStats>& outCallSites);
+
+	// Prints live, peak and allocation counts per tag followed by the call sites holding the most live memory and allocating most often
+	static void printReport(const uint32_t callSiteCount);
+
+	// The calling thread's current tag
+	static eMemoryTag getThreadTag();
+	static void setThreadTag(const eMemoryTag tag);
+};
+
+class memoryTagScope
+{
+public:
+	explicit memoryTagScope(const eMemoryTag tag)
+		: previousTag(memoryTracker::getThreadTag())
+	{
+		memoryTracker::setThreadTag(tag);
+	}
+
+	~memoryTagScope()
+	{
+		memoryTracker::setThreadTag(previousTag);
+	}
+
+	memoryTagScope(const memoryTagScope&) = delete;
+	memoryTagScope& operator=(const memoryTagScope&) = delete;
+
+private:
+	eMemoryTag previousTag;
+};
\ No newline at end of file
@@ -0,0 +1,18 @@
+#include "pch.h"
+#include "scratchArena.h"
+
+linearArena& scratchArena::get()
+{
+	static thread_local linearArena arena(capacityPerThread);
+	return arena;
+}
+
+scratchScope::scratchScope()
+	: arena(scratchArena::get()), marker(arena.getMarker()), resource(arena)
+{
+}
+
+scratchScope::~scratchScope()
+{
+	arena.rewind(marker);
+}
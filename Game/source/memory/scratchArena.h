@@ -0,0 +1,41 @@
+#pragma once
+
+#include "linearArena.h"
+
+// Thread local stack of temporary memory. Each thread's arena is allocated the first time the thread uses it and kept for the life of
+// the thread, so temporary buffers inside a function cost a pointer bump instead of a heap allocation. Use a scratchScope to release
+// everything allocated inside a block when it ends
+class scratchArena
+{
+public:
+	static constexpr size_t capacityPerThread = 1024 * 1024;
+
+public:
+	// Returns the calling thread's scratch arena
+	static linearArena& get();
+};
+
+// Restores the calling thread's scratch arena to where it was when the scope was created. Scopes nest like a stack: memory from an outer
+// scope must not be grown, e.g. by pushing to a pmr container created in it, while an inner scope is alive
+class scratchScope
+{
+public:
+	scratchScope();
+	~scratchScope();
+
+	scratchScope(const scratchScope&) = delete;
+	scratchScope& operator=(const scratchScope&) = delete;
+
+	linearArena& getArena() const { return arena; }
+
+	// Allocations the scratch arena cannot satisfy fall back to the heap
+	std::pmr::memory_resource* getResource() { return &resource; }
+
+	template <typename T>
+	T* allocateArray(const size_t count) { return arena.allocateArray<T>(count); }
+
+private:
+	linearArena& arena;
+	size_t marker;
+	arenaMemoryResource resource;
+};
\ No newline at end of file
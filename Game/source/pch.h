@@ -15,6 +15,10 @@
 #include <random>
 #include <optional>
 #include <functional>
+#include <span>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
 
 #if defined(PLATFORM_WIN32)
 
@@ -40,12 +44,23 @@
 
 #include <xaudio2.h>
 
+#elif defined(PLATFORM_LINUX)
+
+// Posix libraries
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <cstring>
+#include <cwchar>
+
+// Msvc helper macros used throughout the codebase
+#define _countof(array) (sizeof(array) / sizeof(array[0]))
+
 #endif // defined(PLATFORM_WIN32)
 
 // Vulkan
 #if defined(PLATFORM_WIN32)
 #define VK_USE_PLATFORM_WIN32_KHR
-#endif // defined(PLATFORM_WIN32
 
 #pragma comment(lib, "vulkan-1.lib")
 #if defined(_DEBUG)
@@ -53,8 +68,11 @@
 #else
 #pragma comment(lib, "shaderc_combined.lib")
 #endif // defined(_DEBUG)
-#include "platform/graphics/vulkan/vendor/include/vulkan/vulkan.hpp"
-#include "platform/graphics/vulkan/vendor/include/shaderc/shaderc.hpp"
+
+// The vulkan backend only creates win32 surfaces, and the vendored headers need the rest of the vulkan sdk
+#include "platform/graphics/vulkan/vendor/Include/vulkan/vulkan.hpp"
+#include "platform/graphics/vulkan/vendor/Include/shaderc/shaderc.hpp"
+#endif // defined(PLATFORM_WIN32)
 
 // glm maths library
 #define GLM_FORCE_RADIANS
@@ -8,6 +8,6 @@ namespace platformLayer
 		extern int8_t initConsole();
 		// Returns non-zero if fails
 		extern int8_t shutdownConsole();
-		extern void consolePrint(const std::string& string);
+		extern void consolePrint(std::string_view string);
 	}
 }
\ No newline at end of file
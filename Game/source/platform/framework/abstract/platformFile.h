@@ -0,0 +1,71 @@
+#pragma once
+
+// How a mapped file is expected to be read, used to tune the operating system's read ahead
+enum class eFileAccessPattern : uint8_t
+{
+	normal = 0,
+	sequential,
+	random
+};
+
+namespace platformLayer
+{
+	namespace file
+	{
+		// Maps the whole file read only. The view starts on a page boundary and stays valid after the file is closed. An empty file maps to
+		// a null view of size 0. Returns non-zero if fails
+		extern int8_t mapFile(const std::string& file, const eFileAccessPattern accessPattern, const uint8_t*& outData, size_t& outSize);
+		extern void unmapFile(const uint8_t* data, const size_t size);
+
+		// Changes the read ahead for a range of a mapped view
+		extern void adviseMappedRange(const uint8_t* data, const size_t size, const eFileAccessPattern accessPattern);
+
+		// Starts reading a range of a mapped view into memory in the background so touching it later does not stall on page faults
+		extern void prefetchMappedRange(const uint8_t* data, const size_t size);
+
+		static constexpr intptr_t invalidFileHandle = -1;
+
+		// Opens a file for reading, other handles may still write it. Returns invalidFileHandle if fails
+		extern intptr_t openFile(const std::string& file);
+		extern void closeFile(const intptr_t file);
+
+		// Blocking read at an offset that does not move a shared file position, safe to call from several threads on one handle.
+		// Returns the number of bytes read, which is less than size at the end of the file, or -1 if fails
+		extern int64_t readFile(const intptr_t file, const uint64_t offset, void* destination, const size_t size);
+
+		// Opens a file for reading and writing, creating it if it does not exist. Other handles, including from other processes, may read
+		// and write it at the same time. Returns invalidFileHandle if fails
+		extern intptr_t openFileForWrite(const std::string& file);
+
+		// Blocking write at an offset that does not move a shared file position. Returns the number of bytes written, or -1 if fails
+		extern int64_t writeFile(const intptr_t file, const uint64_t offset, const void* source, const size_t size);
+
+		// Returns the size of an open file in bytes, or -1 if fails
+		extern int64_t getFileSize(const intptr_t file);
+
+		// Blocks until the handle holds an exclusive lock on the whole file, for serializing processes that share a file. Use a file kept
+		// only for locking, on some platforms other handles cannot read or write a locked range. Returns non-zero if fails
+		extern int8_t lockFile(const intptr_t file);
+		extern void unlockFile(const intptr_t file);
+
+		// Queue of reads serviced by the kernel without a thread blocking on each one
+		class readQueue;
+
+		struct sReadCompletion
+		{
+			uint64_t userData = 0;
+			// Bytes read, or negative if the read failed
+			int64_t result = 0;
+		};
+
+		// Returns non-zero if fails, including on platforms with no kernel read queue
+		extern int8_t createReadQueue(const uint32_t depth, std::shared_ptr<readQueue>& outQueue);
+
+		// Queues a read, returning false if the queue already holds depth reads. One thread submits at a time
+		extern bool submitRead(readQueue* queue, const intptr_t file, const uint64_t offset, void* destination, const uint32_t size, const uint64_t userData);
+
+		// Blocks until at least one submitted read finishes and returns the number of completions written, or 0 if nothing is outstanding.
+		// One thread waits at a time, it may wait while another thread submits
+		extern uint32_t waitReadCompletions(readQueue* queue, sReadCompletion* outCompletions, const uint32_t maxCount);
+	}
+}
\ No newline at end of file
@@ -12,7 +12,8 @@ namespace platformLayer
 		};
 
 		extern void showMessageBox(const eMessageLevel level, const std::string& message);
-		// Shows a message box and immediately exits the application
+		// Shows a message box and immediately exits the application. Static destructors are not run because other threads, e.g. job workers,
+		// may still be using the objects they destroy
 		extern void showMessageBoxFatal(const std::string& message);
 	}
-}
+}
\ No newline at end of file
@@ -5,5 +5,9 @@ namespace platformLayer
 	namespace os
 	{
 		extern void pollOS();
+		// Returns true if the operating system has asked the application to quit, e.g. a quit message or a terminate/interrupt signal
+		extern bool isQuitRequested();
+		// Returns the function, and source line where available, containing a code address. Used to name allocation call sites in reports
+		extern std::string getAddressDescription(const void* address);
 	}
 }
\ No newline at end of file
@@ -5,5 +5,8 @@ namespace platformLayer
 	namespace timing
 	{
 		extern void updateTiming(int64_t& outFps, double& outMs);
+
+		// Returns a monotonic timestamp in nanoseconds. Only differences between timestamps are meaningful
+		extern int64_t getTimestampNanoseconds();
 	}
 }
\ No newline at end of file
@@ -0,0 +1,17 @@
+#include "pch.h"
+#include "platform/framework/abstract/platformAudio.h"
+
+namespace platformLayer
+{
+	namespace audio
+	{
+		// Null audio device. The headless backend does not output sound
+		void initAudio()
+		{
+		}
+
+		void shutdownAudio()
+		{
+		}
+	}
+}
@@ -0,0 +1,52 @@
+#include "pch.h"
+#include "platform/framework/abstract/platformCommandLine.h"
+
+namespace platformLayer
+{
+	namespace commandLine
+	{
+		wchar_t** getArgcArgv(int32_t& outArgc)
+		{
+			// Read the null separated arguments the process was launched with
+			std::ifstream cmdline("/proc/self/cmdline", std::ifstream::in | std::ifstream::binary);
+			std::vector<std::string> args;
+			std::string arg;
+			while (std::getline(cmdline, arg, '\0'))
+			{
+				args.push_back(arg);
+			}
+
+			// Widen the arguments to match the win32 argv layout. The argv array is null terminated
+			outArgc = static_cast<int32_t>(args.size());
+			wchar_t** argv = new wchar_t*[args.size() + 1];
+			for (size_t i = 0; i < args.size(); ++i)
+			{
+				const size_t length = mbstowcs(nullptr, args[i].c_str(), 0);
+				const size_t wideLength = (length == static_cast<size_t>(-1)) ? 0 : length;
+				argv[i] = new wchar_t[wideLength + 1];
+				if (wideLength > 0)
+				{
+					mbstowcs(argv[i], args[i].c_str(), wideLength + 1);
+				}
+				argv[i][wideLength] = L'\0';
+			}
+			argv[args.size()] = nullptr;
+
+			return argv;
+		}
+
+		void freeArgv(wchar_t** argv)
+		{
+			if (argv == nullptr)
+			{
+				return;
+			}
+
+			for (wchar_t** arg = argv; *arg != nullptr; ++arg)
+			{
+				delete[] *arg;
+			}
+			delete[] argv;
+		}
+	}
+}
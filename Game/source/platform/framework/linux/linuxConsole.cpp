@@ -0,0 +1,26 @@
+#include "pch.h"
+#include "platform/framework/abstract/platformConsole.h"
+
+namespace platformLayer
+{
+	namespace console
+	{
+		int8_t initConsole()
+		{
+			// The process is already attached to the terminal that launched it. Flush every line so output is not lost when the process is killed
+			std::cout << std::unitbuf;
+			return 0;
+		}
+
+		int8_t shutdownConsole()
+		{
+			std::cout.flush();
+			return 0;
+		}
+
+		void consolePrint(std::string_view string)
+		{
+			std::cout << string << '\n';
+		}
+	}
+}
@@ -0,0 +1,33 @@
+#include "pch.h"
+#include "platform/framework/abstract/platformDisplay.h"
+
+namespace platformLayer
+{
+	namespace display
+	{
+		uint32_t getConnectedDisplayCount()
+		{
+			// A single virtual display is reported so window placement code keeps working without a display server
+			return 1;
+		}
+
+		sDisplayDesc getInfoForDisplayAtIndex(const uint32_t displayIndex)
+		{
+			if (displayIndex >= getConnectedDisplayCount())
+			{
+				return sDisplayDesc{};
+			}
+
+			sDisplayDesc info = {};
+			info.name = L"headless";
+			info.adapterName = L"headless";
+			info.topLeftX = 0;
+			info.topLeftY = 0;
+			info.width = 1920;
+			info.height = 1080;
+			info.verticalRefreshRateHertz = 60;
+
+			return info;
+		}
+	}
+}
@@ -0,0 +1,359 @@
+#include "pch.h"
+#include "platform/framework/abstract/platformFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+static int32_t getAdvice(const eFileAccessPattern accessPattern)
+{
+	switch (accessPattern)
+	{
+	case eFileAccessPattern::sequential: return MADV_SEQUENTIAL;
+	case eFileAccessPattern::random: return MADV_RANDOM;
+	default: return MADV_NORMAL;
+	}
+}
+
+// madvise needs a page aligned start address, widen the range down to the page containing data
+static void advise(const uint8_t* data, const size_t size, const int32_t advice)
+{
+	if ((data == nullptr) || (size == 0))
+	{
+		return;
+	}
+
+	static const uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+	const uintptr_t begin = reinterpret_cast<uintptr_t>(data) & ~(pageSize - 1);
+	const uintptr_t end = reinterpret_cast<uintptr_t>(data) + size;
+	madvise(reinterpret_cast<void*>(begin), end - begin, advice);
+}
+
+namespace platformLayer
+{
+	namespace file
+	{
+		// io_uring driven through the raw system calls. The submission and completion rings are shared with the kernel, reads are
+		// queued by writing entries and moving the submission tail, and finish by the kernel moving the completion tail
+		class readQueue
+		{
+		public:
+			~readQueue()
+			{
+				if (submissionEntries != nullptr)
+				{
+					munmap(submissionEntries, submissionEntriesSize);
+				}
+				if ((completionRing != nullptr) && (completionRing != submissionRing))
+				{
+					munmap(completionRing, completionRingSize);
+				}
+				if (submissionRing != nullptr)
+				{
+					munmap(submissionRing, submissionRingSize);
+				}
+				if (ringDescriptor >= 0)
+				{
+					close(ringDescriptor);
+				}
+			}
+
+		public:
+			int32_t ringDescriptor = -1;
+
+			void* submissionRing = nullptr;
+			size_t submissionRingSize = 0;
+			uint32_t* submissionHead = nullptr;
+			uint32_t* submissionTail = nullptr;
+			uint32_t submissionMask = 0;
+			uint32_t submissionCapacity = 0;
+			uint32_t* submissionArray = nullptr;
+			io_uring_sqe* submissionEntries = nullptr;
+			size_t submissionEntriesSize = 0;
+
+			void* completionRing = nullptr;
+			size_t completionRingSize = 0;
+			uint32_t* completionHead = nullptr;
+			uint32_t* completionTail = nullptr;
+			uint32_t completionMask = 0;
+			io_uring_cqe* completions = nullptr;
+
+			// Reads submitted and not yet reaped, bounded by the submission ring so the completion ring cannot overflow. Submitting and
+			// waiting can happen on different threads
+			std::atomic<uint32_t> outstanding = 0;
+		};
+
+		int8_t mapFile(const std::string& file, const eFileAccessPattern accessPattern, const uint8_t*& outData, size_t& outSize)
+		{
+			outData = nullptr;
+			outSize = 0;
+
+			const int32_t descriptor = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+			if (descriptor < 0)
+			{
+				return 1;
+			}
+
+			struct stat status = {};
+			if ((fstat(descriptor, &status) != 0) || !S_ISREG(status.st_mode))
+			{
+				close(descriptor);
+				return 1;
+			}
+
+			const size_t size = static_cast<size_t>(status.st_size);
+			if (size == 0)
+			{
+				close(descriptor);
+				return 0;
+			}
+
+			// The mapping holds its own reference to the file so the descriptor can be closed straight away
+			void* const view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+			close(descriptor);
+			if (view == MAP_FAILED)
+			{
+				return 1;
+			}
+
+			outData = static_cast<const uint8_t*>(view);
+			outSize = size;
+			if (accessPattern != eFileAccessPattern::normal)
+			{
+				advise(outData, outSize, getAdvice(accessPattern));
+			}
+			return 0;
+		}
+
+		void unmapFile(const uint8_t* data, const size_t size)
+		{
+			if (data != nullptr)
+			{
+				munmap(const_cast<uint8_t*>(data), size);
+			}
+		}
+
+		void adviseMappedRange(const uint8_t* data, const size_t size, const eFileAccessPattern accessPattern)
+		{
+			advise(data, size, getAdvice(accessPattern));
+		}
+
+		void prefetchMappedRange(const uint8_t* data, const size_t size)
+		{
+			advise(data, size, MADV_WILLNEED);
+		}
+
+		intptr_t openFile(const std::string& file)
+		{
+			const int32_t descriptor = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+			return (descriptor >= 0) ? static_cast<intptr_t>(descriptor) : invalidFileHandle;
+		}
+
+		void closeFile(const intptr_t file)
+		{
+			if (file != invalidFileHandle)
+			{
+				close(static_cast<int32_t>(file));
+			}
+		}
+
+		int64_t readFile(const intptr_t file, const uint64_t offset, void* destination, const size_t size)
+		{
+			size_t totalRead = 0;
+			while (totalRead < size)
+			{
+				const ssize_t result = pread(static_cast<int32_t>(file), static_cast<uint8_t*>(destination) + totalRead, size - totalRead, static_cast<off_t>(offset + totalRead));
+				if (result < 0)
+				{
+					if (errno == EINTR)
+					{
+						continue;
+					}
+					return -1;
+				}
+
+				// End of file
+				if (result == 0)
+				{
+					break;
+				}
+				totalRead += static_cast<size_t>(result);
+			}
+			return static_cast<int64_t>(totalRead);
+		}
+
+		intptr_t openFileForWrite(const std::string& file)
+		{
+			const int32_t descriptor = open(file.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+			return (descriptor >= 0) ? static_cast<intptr_t>(descriptor) : invalidFileHandle;
+		}
+
+		int64_t writeFile(const intptr_t file, const uint64_t offset, const void* source, const size_t size)
+		{
+			size_t totalWritten = 0;
+			while (totalWritten < size)
+			{
+				const ssize_t result = pwrite(static_cast<int32_t>(file), static_cast<const uint8_t*>(source) + totalWritten, size - totalWritten, static_cast<off_t>(offset + totalWritten));
+				if (result < 0)
+				{
+					if (errno == EINTR)
+					{
+						continue;
+					}
+					return -1;
+				}
+				totalWritten += static_cast<size_t>(result);
+			}
+			return static_cast<int64_t>(totalWritten);
+		}
+
+		int64_t getFileSize(const intptr_t file)
+		{
+			struct stat status = {};
+			if (fstat(static_cast<int32_t>(file), &status) != 0)
+			{
+				return -1;
+			}
+			return static_cast<int64_t>(status.st_size);
+		}
+
+		int8_t lockFile(const intptr_t file)
+		{
+			while (flock(static_cast<int32_t>(file), LOCK_EX) != 0)
+			{
+				if (errno != EINTR)
+				{
+					return 1;
+				}
+			}
+			return 0;
+		}
+
+		void unlockFile(const intptr_t file)
+		{
+			flock(static_cast<int32_t>(file), LOCK_UN);
+		}
+
+		int8_t createReadQueue(const uint32_t depth, std::shared_ptr<readQueue>& outQueue)
+		{
+			io_uring_params parameters = {};
+			const int32_t ringDescriptor = static_cast<int32_t>(syscall(__NR_io_uring_setup, depth, &parameters));
+			if (ringDescriptor < 0)
+			{
+				// Kernels before 5.1, or sandboxes that block io_uring
+				return 1;
+			}
+
+			std::shared_ptr<readQueue> queue = std::make_shared<readQueue>();
+			queue->ringDescriptor = ringDescriptor;
+
+			// IORING_OP_READ needs 5.6, which is also when single mmap rings were added, so treat older kernels as unsupported
+			if ((parameters.features & IORING_FEAT_SINGLE_MMAP) == 0)
+			{
+				return 1;
+			}
+
+			queue->submissionRingSize = parameters.sq_off.array + (parameters.sq_entries * sizeof(uint32_t));
+			queue->completionRingSize = parameters.cq_off.cqes + (parameters.cq_entries * sizeof(io_uring_cqe));
+			queue->submissionRingSize = std::max(queue->submissionRingSize, queue->completionRingSize);
+			queue->submissionRing = mmap(nullptr, queue->submissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringDescriptor, IORING_OFF_SQ_RING);
+			if (queue->submissionRing == MAP_FAILED)
+			{
+				queue->submissionRing = nullptr;
+				return 1;
+			}
+			queue->completionRing = queue->submissionRing;
+
+			queue->submissionEntriesSize = parameters.sq_entries * sizeof(io_uring_sqe);
+			void* const entries = mmap(nullptr, queue->submissionEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringDescriptor, IORING_OFF_SQES);
+			if (entries == MAP_FAILED)
+			{
+				return 1;
+			}
+			queue->submissionEntries = static_cast<io_uring_sqe*>(entries);
+
+			uint8_t* const submissionBase = static_cast<uint8_t*>(queue->submissionRing);
+			queue->submissionHead = reinterpret_cast<uint32_t*>(submissionBase + parameters.sq_off.head);
+			queue->submissionTail = reinterpret_cast<uint32_t*>(submissionBase + parameters.sq_off.tail);
+			queue->submissionMask = *reinterpret_cast<uint32_t*>(submissionBase + parameters.sq_off.ring_mask);
+			queue->submissionCapacity = parameters.sq_entries;
+			queue->submissionArray = reinterpret_cast<uint32_t*>(submissionBase + parameters.sq_off.array);
+
+			uint8_t* const completionBase = static_cast<uint8_t*>(queue->completionRing);
+			queue->completionHead = reinterpret_cast<uint32_t*>(completionBase + parameters.cq_off.head);
+			queue->completionTail = reinterpret_cast<uint32_t*>(completionBase + parameters.cq_off.tail);
+			queue->completionMask = *reinterpret_cast<uint32_t*>(completionBase + parameters.cq_off.ring_mask);
+			queue->completions = reinterpret_cast<io_uring_cqe*>(completionBase + parameters.cq_off.cqes);
+
+			outQueue = std::move(queue);
+			return 0;
+		}
+
+		bool submitRead(readQueue* queue, const intptr_t file, const uint64_t offset, void* destination, const uint32_t size, const uint64_t userData)
+		{
+			if (queue->outstanding.load(std::memory_order_relaxed) >= queue->submissionCapacity)
+			{
+				return false;
+			}
+
+			// Only this thread writes the tail, the kernel advances the head as it consumes entries
+			const uint32_t tail = *queue->submissionTail;
+			const uint32_t index = tail & queue->submissionMask;
+
+			io_uring_sqe& entry = queue->submissionEntries[index];
+			memset(&entry, 0, sizeof(entry));
+			entry.opcode = IORING_OP_READ;
+			// Reads of cached data would otherwise be copied inline by the submitting thread, punt them to the kernel's workers instead
+			entry.flags = IOSQE_ASYNC;
+			entry.fd = static_cast<int32_t>(file);
+			entry.off = offset;
+			entry.addr = reinterpret_cast<uint64_t>(destination);
+			entry.len = size;
+			entry.user_data = userData;
+			queue->submissionArray[index] = index;
+
+			std::atomic_ref<uint32_t>(*queue->submissionTail).store(tail + 1, std::memory_order_release);
+			queue->outstanding.fetch_add(1, std::memory_order_relaxed);
+
+			while (syscall(__NR_io_uring_enter, queue->ringDescriptor, 1, 0, 0, nullptr, 0) < 0)
+			{
+				if ((errno != EINTR) && (errno != EAGAIN) && (errno != EBUSY))
+				{
+					// Take the entry back, the kernel has not consumed it
+					std::atomic_ref<uint32_t>(*queue->submissionTail).store(tail, std::memory_order_release);
+					queue->outstanding.fetch_sub(1, std::memory_order_relaxed);
+					return false;
+				}
+			}
+			return true;
+		}
+
+		uint32_t waitReadCompletions(readQueue* queue, sReadCompletion* outCompletions, const uint32_t maxCount)
+		{
+			uint32_t head = *queue->completionHead;
+			uint32_t tail = std::atomic_ref<uint32_t>(*queue->completionTail).load(std::memory_order_acquire);
+			while ((head == tail) && (queue->outstanding.load(std::memory_order_relaxed) > 0))
+			{
+				syscall(__NR_io_uring_enter, queue->ringDescriptor, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+				tail = std::atomic_ref<uint32_t>(*queue->completionTail).load(std::memory_order_acquire);
+			}
+
+			uint32_t count = 0;
+			while ((head != tail) && (count < maxCount))
+			{
+				const io_uring_cqe& completion = queue->completions[head & queue->completionMask];
+				outCompletions[count].userData = completion.user_data;
+				outCompletions[count].result = completion.res;
+				++count;
+				++head;
+			}
+
+			std::atomic_ref<uint32_t>(*queue->completionHead).store(head, std::memory_order_release);
+			queue->outstanding.fetch_sub(count, std::memory_order_relaxed);
+			return count;
+		}
+	}
+}
@@ -0,0 +1,26 @@
+#include "pch.h"
+#include "platform/framework/abstract/platformGamepad.h"
+#include "platform/framework/events/sInputEvent.h"
+
+static std::vector<std::function<void(platformLayer::input::sInputEvent&&)>> onInputEventCallbacks;
+
+namespace platformLayer
+{
+	namespace gamepad
+	{
+		// Null gamepad device. No gamepads are ever connected on the headless backend so no input events are broadcast
+		void pollGamepads()
+		{
+		}
+
+		int8_t setGamepadVibration(const uint32_t, const uint16_t, const uint16_t)
+		{
+			return 1;
+		}
+
+		void addOnInputEventDelegate(const std::function<void(platformLayer::input::sInputEvent&&)>& inDelegate)
+		{
+			onInputEventCallbacks.push_back(inDelegate);
+		}
+	}
+}
@@ -0,0 +1,44 @@
+#include "pch.h"
+#include "platform/framework/abstract/platformMessageBox.h"
+
+namespace platformLayer
+{
+	namespace messageBox
+	{
+		void showMessageBox(const eMessageLevel level, const std::string& message)
+		{
+			const char* caption = "";
+
+			switch (level)
+			{
+			case eMessageLevel::message:
+			{
+				caption = "Message";
+			}
+			break;
+
+			case eMessageLevel::warning:
+			{
+				caption = "Warning";
+			}
+			break;
+
+			case eMessageLevel::error:
+			{
+				caption = "Error";
+			}
+			break;
+			}
+
+			// There is nothing to display a dialog on, write the message to standard error instead
+			std::cerr << caption << ": " << message << '\n';
+		}
+
+		void showMessageBoxFatal(const std::string& message)
+		{
+			std::cerr << "Fatal Error: " << message << '\n';
+			std::cout.flush();
+			std::_Exit(EXIT_FAILURE);
+		}
+	}
+}
@@ -0,0 +1,64 @@
+#include "pch.h"
+#include "platform/framework/abstract/platformOS.h"
+
+#include <dlfcn.h>
+#include <cxxabi.h>
+
+static volatile sig_atomic_t quitSignalReceived = 0;
+
+static void onQuitSignal(int)
+{
+	quitSignalReceived = 1;
+}
+
+static void installQuitSignalHandlers()
+{
+	struct sigaction action = {};
+	action.sa_handler = onQuitSignal;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGINT, &action, nullptr);
+	sigaction(SIGTERM, &action, nullptr);
+}
+
+namespace platformLayer
+{
+	namespace os
+	{
+		void pollOS()
+		{
+			// There is no message queue on the headless backend. Install the signal handlers on first poll so ctrl+c and kill request a clean shutdown
+			[[maybe_unused]] static bool signalHandlersInstalled = []() { installQuitSignalHandlers(); return true; } ();
+		}
+
+		bool isQuitRequested()
+		{
+			return quitSignalReceived != 0;
+		}
+
+		std::string getAddressDescription(const void* address)
+		{
+			char buffer[512];
+			Dl_info info = {};
+			if ((dladdr(address, &info) == 0) || (info.dli_fname == nullptr))
+			{
+				snprintf(buffer, sizeof(buffer), "%p", address);
+				return buffer;
+			}
+
+			// Static functions are not in the dynamic symbol table, fall back to the offset into the module for addr2line
+			if (info.dli_sname == nullptr)
+			{
+				snprintf(buffer, sizeof(buffer), "%s+0x%zx", info.dli_fname,
+					static_cast<size_t>(static_cast<const uint8_t*>(address) - static_cast<const uint8_t*>(info.dli_fbase)));
+				return buffer;
+			}
+
+			int32_t status = 0;
+			char* const demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+			snprintf(buffer, sizeof(buffer), "%s+0x%zx (%s)", (status == 0) ? demangled : info.dli_sname,
+				static_cast<size_t>(static_cast<const uint8_t*>(address) - static_cast<const uint8_t*>(info.dli_saddr)), info.dli_fname);
+			free(demangled);
+			return buffer;
+		}
+	}
+}
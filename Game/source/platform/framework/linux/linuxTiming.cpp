@@ -0,0 +1,29 @@
+#include "pch.h"
+#include "platform/framework/abstract/platformTiming.h"
+
+static constexpr int64_t nanosecondsPerSecond = 1000000000;
+
+namespace platformLayer
+{
+	namespace timing
+	{
+		void updateTiming(int64_t& outFps, double& outMs)
+		{
+			static int64_t startNanoseconds = getTimestampNanoseconds();
+
+			const int64_t endNanoseconds = getTimestampNanoseconds();
+			const int64_t elapsedNanoseconds = std::max<int64_t>(endNanoseconds - startNanoseconds, 1);
+			startNanoseconds = endNanoseconds;
+
+			outFps = static_cast<int64_t>((static_cast<double>(nanosecondsPerSecond) / static_cast<double>(elapsedNanoseconds)) + 0.5);
+			outMs = static_cast<double>(elapsedNanoseconds) / 1000000.0;
+		}
+
+		int64_t getTimestampNanoseconds()
+		{
+			timespec time = {};
+			clock_gettime(CLOCK_MONOTONIC, &time);
+			return (static_cast<int64_t>(time.tv_sec) * nanosecondsPerSecond) + static_cast<int64_t>(time.tv_nsec);
+		}
+	}
+}
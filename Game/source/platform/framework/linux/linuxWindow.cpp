@@ -0,0 +1,190 @@
+#include "pch.h"
+#include "linuxWindow.h"
+
+namespace platformLayer
+{
+	namespace window
+	{
+		void createWindow(const sWindowDesc& desc, std::shared_ptr<platformWindow>& outPlatformWindow)
+		{
+			outPlatformWindow = std::make_shared<platformWindow>();
+			outPlatformWindow->init(desc);
+		}
+
+		void destroyWindow(std::shared_ptr<platformWindow>& outPlatformWindow)
+		{
+			outPlatformWindow->destroy();
+			outPlatformWindow.reset();
+		}
+
+		int8_t makeWindowFullscreen(platformWindow* inPlatformWindow)
+		{
+			return inPlatformWindow->enterFullScreen();
+		}
+
+		int8_t exitWindowFullscreen(platformWindow* inPlatformWindow)
+		{
+			return inPlatformWindow->exitFullScreen();
+		}
+
+		int8_t setWindowPosition(platformWindow* inPlatformWindow, uint32_t x, uint32_t y)
+		{
+			return inPlatformWindow->setPosition(x, y);
+		}
+
+		int8_t setWindowStyle(platformWindow* inPlatformWindow, eWindowStyle inStyle)
+		{
+			return inPlatformWindow->setStyle(inStyle);
+		}
+
+		bool showWindow(platformWindow* inPlatformWindow)
+		{
+			return inPlatformWindow->show();
+		}
+
+		int8_t getWindowClientAreaDimensions(platformWindow* inPlatformWindow, uint32_t& x, uint32_t& y)
+		{
+			return inPlatformWindow->getClientAreaDimensions(x, y);
+		}
+
+		int8_t getWindowPosition(platformWindow* inPlatformWindow, uint32_t& x, uint32_t& y)
+		{
+			return inPlatformWindow->getPosition(x, y);
+		}
+
+		bool isWindowFullscreen(platformWindow* inPlatformWindow)
+		{
+			return inPlatformWindow->isFullScreen();
+		}
+
+		void* getWindowHandle(platformWindow*)
+		{
+			// Headless windows do not have a native handle
+			return nullptr;
+		}
+
+		void addResizedEventDelegate(platformWindow* inPlatformWindow, const std::function<void(platformLayer::window::sResizedEvent&&)>& inDelegate)
+		{
+			inPlatformWindow->onResizedEventCallbacks.push_back(inDelegate);
+		}
+
+		void addMinimizedEventDelegate(platformWindow* inPlatformWindow, const std::function<void(platformLayer::window::sMinimizedEvent&&)>& inDelegate)
+		{
+			inPlatformWindow->onMinimizedEventCallbacks.push_back(inDelegate);
+		}
+
+		void addMaximizedEventDelegate(platformWindow* inPlatformWindow, const std::function<void(platformLayer::window::sMaximizedEvent&&)>& inDelegate)
+		{
+			inPlatformWindow->onMaximizedEventCallbacks.push_back(inDelegate);
+		}
+
+		void addLostFocusEventDelegate(platformWindow* inPlatformWindow, const std::function<void(platformLayer::window::sLostFocusEvent&&)>& inDelegate)
+		{
+			inPlatformWindow->onLostFocusEventCallbacks.push_back(inDelegate);
+		}
+
+		void addGainedFocusEventDelegate(platformWindow* inPlatformWindow, const std::function<void(platformLayer::window::sGainedFocusEvent&&)>& inDelegate)
+		{
+			inPlatformWindow->onGainedFocusEventCallbacks.push_back(inDelegate);
+		}
+
+		void addExitSizeMoveEventDelegate(platformWindow* inPlatformWindow, const std::function<void(platformLayer::window::sExitSizeMoveEvent&&)>& inDelegate)
+		{
+			inPlatformWindow->onExitSizeMoveEventCallbacks.push_back(inDelegate);
+		}
+
+		void addEnterSizeMoveEventDelegate(platformWindow* inPlatformWindow, const std::function<void(platformLayer::window::sEnterSizeMoveEvent&&)>& inDelegate)
+		{
+			inPlatformWindow->onEnterSizeMoveEventCallbacks.push_back(inDelegate);
+		}
+
+		void addExitFullScreenEventDelegate(platformWindow* inPlatformWindow, const std::function<void(platformLayer::window::sExitFullScreenEvent&&)>& inDelegate)
+		{
+			inPlatformWindow->onExitFullScreenEventCallbacks.push_back(inDelegate);
+		}
+
+		void addEnterFullScreenEventDelegate(platformWindow* inPlatformWindow, const std::function<void(platformLayer::window::sEnterFullScreenEvent&&)>& inDelegate)
+		{
+			inPlatformWindow->onEnterFullScreenEventCallbacks.push_back(inDelegate);
+		}
+
+		void addDestroyedEventDelegate(platformWindow* inPlatformWindow, const std::function<void(platformLayer::window::sDestroyedEvent&&)>& inDelegate)
+		{
+			inPlatformWindow->onDestroyedEventCallbacks.push_back(inDelegate);
+		}
+
+		void addClosedEventDelegate(platformWindow* inPlatformWindow, const std::function<void(platformLayer::window::sClosedEvent&&)>& inDelegate)
+		{
+			inPlatformWindow->onClosedEventCallbacks.push_back(inDelegate);
+		}
+
+		void addInputEventDelegate(platformWindow* inPlatformWindow, const std::function<void(platformLayer::input::sInputEvent&&)>& inDelegate)
+		{
+			inPlatformWindow->onInputEventCallbacks.push_back(inDelegate);
+		}
+	}
+}
+
+namespace platformLayer
+{
+	namespace window
+	{
+		void platformWindow::init(const sWindowDesc& inDesc)
+		{
+			desc = inDesc;
+			visible = false;
+			inFullscreen = false;
+		}
+
+		void platformWindow::destroy()
+		{
+			visible = false;
+		}
+
+		int8_t platformWindow::enterFullScreen()
+		{
+			inFullscreen = true;
+			return 0;
+		}
+
+		int8_t platformWindow::exitFullScreen()
+		{
+			inFullscreen = false;
+			return 0;
+		}
+
+		int8_t platformWindow::setPosition(uint32_t x, uint32_t y)
+		{
+			desc.x = static_cast<int32_t>(x);
+			desc.y = static_cast<int32_t>(y);
+			return 0;
+		}
+
+		int8_t platformWindow::setStyle(eWindowStyle inStyle)
+		{
+			desc.style = inStyle;
+			return 0;
+		}
+
+		bool platformWindow::show()
+		{
+			const bool wasVisible = visible;
+			visible = true;
+			return wasVisible;
+		}
+
+		int8_t platformWindow::getClientAreaDimensions(uint32_t& x, uint32_t& y) const
+		{
+			x = static_cast<uint32_t>(desc.width);
+			y = static_cast<uint32_t>(desc.height);
+			return 0;
+		}
+
+		int8_t platformWindow::getPosition(uint32_t& x, uint32_t& y) const
+		{
+			x = static_cast<uint32_t>(desc.x);
+			y = static_cast<uint32_t>(desc.y);
+			return 0;
+		}
+	}
+}
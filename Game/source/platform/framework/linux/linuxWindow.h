@@ -0,0 +1,60 @@
+#pragma once
+
+#include "platform/framework/abstract/platformWindow.h"
+
+namespace platformLayer
+{
+	namespace window
+	{
+		// Headless window. There is no native window or display server connection on the linux backend, the window only stores its description and
+		// event callbacks so code written against the platform window interface runs unchanged.
+		// Quit requests are reported through platformLayer::os::isQuitRequested
+		class platformWindow
+		{
+		private:
+			// The description the window was created with
+			sWindowDesc desc = {};
+
+			// Stores whether the window is visible
+			bool visible = false;
+
+			// Stores whether the window is in fullscreen
+			bool inFullscreen = false;
+
+		public:
+			// Callbacks
+			std::vector<std::function<void(platformLayer::window::sResizedEvent&&)>> onResizedEventCallbacks;
+			std::vector<std::function<void(platformLayer::window::sMinimizedEvent&&)>> onMinimizedEventCallbacks;
+			std::vector<std::function<void(platformLayer::window::sMaximizedEvent&&)>> onMaximizedEventCallbacks;
+			std::vector<std::function<void(platformLayer::window::sLostFocusEvent&&)>> onLostFocusEventCallbacks;
+			std::vector<std::function<void(platformLayer::window::sGainedFocusEvent&&)>> onGainedFocusEventCallbacks;
+			std::vector<std::function<void(platformLayer::window::sExitSizeMoveEvent&&)>> onExitSizeMoveEventCallbacks;
+			std::vector<std::function<void(platformLayer::window::sEnterSizeMoveEvent&&)>> onEnterSizeMoveEventCallbacks;
+			std::vector<std::function<void(platformLayer::window::sExitFullScreenEvent&&)>> onExitFullScreenEventCallbacks;
+			std::vector<std::function<void(platformLayer::window::sEnterFullScreenEvent&&)>> onEnterFullScreenEventCallbacks;
+			std::vector<std::function<void(platformLayer::window::sDestroyedEvent&&)>> onDestroyedEventCallbacks;
+			std::vector<std::function<void(platformLayer::window::sClosedEvent&&)>> onClosedEventCallbacks;
+			std::vector<std::function<void(platformLayer::input::sInputEvent&&)>> onInputEventCallbacks;
+
+		public:
+			void init(const sWindowDesc& inDesc);
+			void destroy();
+			// Returns non-zero if the function fails
+			int8_t enterFullScreen();
+			// Returns non-zero if the function fails
+			int8_t exitFullScreen();
+			// Returns non-zero if the function fails
+			int8_t setPosition(uint32_t x, uint32_t y);
+			// Returns non-zero if the function fails
+			int8_t setStyle(eWindowStyle inStyle);
+			// Returns true if the window was previously visible and false if the window was previously hidden
+			bool show();
+
+			// Returns non-zero if the function fails
+			int8_t getClientAreaDimensions(uint32_t& x, uint32_t& y) const;
+			// Returns non-zero if the function fails
+			int8_t getPosition(uint32_t& x, uint32_t& y) const;
+			bool isFullScreen() const { return inFullscreen; }
+		};
+	}
+}
\ No newline at end of file
@@ -1,26 +1,43 @@
 #include "pch.h"
 #include "platform/framework/abstract/platformTiming.h"
 
+static constexpr int64_t nanosecondsPerSecond = 1000000000;
+
+static int64_t getPerformanceFrequency()
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	return frequency.QuadPart;
+}
+
 namespace platformLayer
 {
 	namespace timing
 	{
 		void updateTiming(int64_t& outFps, double& outMs)
 		{
-			static LARGE_INTEGER startCounter;
-			static LARGE_INTEGER endCounter;
-			static LARGE_INTEGER frequency;
-			static LARGE_INTEGER counts;
+			static int64_t startNanoseconds = getTimestampNanoseconds();
 
-			static BOOL queryPerfStartCounter = [&]() { return QueryPerformanceCounter(&startCounter); } ();
-			static BOOL queryPerfFrequency = [&]() { return QueryPerformanceFrequency(&frequency); } ();
+			const int64_t endNanoseconds = getTimestampNanoseconds();
+			const int64_t elapsedNanoseconds = std::max<int64_t>(endNanoseconds - startNanoseconds, 1);
+			startNanoseconds = endNanoseconds;
+
+			// Divide in floating point, an integer divide truncates to 0 fps once a frame takes longer than a second
+			outFps = static_cast<int64_t>((static_cast<double>(nanosecondsPerSecond) / static_cast<double>(elapsedNanoseconds)) + 0.5);
+			outMs = static_cast<double>(elapsedNanoseconds) / 1000000.0;
+		}
+
+		int64_t getTimestampNanoseconds()
+		{
+			static const int64_t frequency = getPerformanceFrequency();
 
-			QueryPerformanceCounter(&endCounter);
-			counts.QuadPart = endCounter.QuadPart - startCounter.QuadPart;
-			startCounter = endCounter;
+			LARGE_INTEGER counter;
+			QueryPerformanceCounter(&counter);
 
-			outFps = static_cast<int64_t>(frequency.QuadPart / counts.QuadPart);
-			outMs = ((1000.0 * static_cast<double>(counts.QuadPart)) / static_cast<double>(frequency.QuadPart));
+			// Convert whole seconds and the remainder separately so the multiply by 10^9 cannot overflow
+			const int64_t seconds = counter.QuadPart / frequency;
+			const int64_t remainder = counter.QuadPart % frequency;
+			return (seconds * nanosecondsPerSecond) + ((remainder * nanosecondsPerSecond) / frequency);
 		}
 	}
 }
@@ -67,7 +67,7 @@ namespace platformLayer
 			return 0;
 		}
 
-		void consolePrint(const std::string& string)
+		void consolePrint(std::string_view string)
 		{
 			std::cout << string << '\n';
 		}
@@ -0,0 +1,211 @@
+#include "pch.h"
+#include "platform/framework/abstract/platformFile.h"
+
+static DWORD getFileFlags(const eFileAccessPattern accessPattern)
+{
+	switch (accessPattern)
+	{
+	case eFileAccessPattern::sequential: return FILE_FLAG_SEQUENTIAL_SCAN;
+	case eFileAccessPattern::random: return FILE_FLAG_RANDOM_ACCESS;
+	default: return FILE_ATTRIBUTE_NORMAL;
+	}
+}
+
+namespace platformLayer
+{
+	namespace file
+	{
+		int8_t mapFile(const std::string& file, const eFileAccessPattern accessPattern, const uint8_t*& outData, size_t& outSize)
+		{
+			outData = nullptr;
+			outSize = 0;
+
+			// The access pattern flags tune the cache manager's read ahead, which also services page faults on views of the file
+			const HANDLE fileHandle = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, getFileFlags(accessPattern), nullptr);
+			if (fileHandle == INVALID_HANDLE_VALUE)
+			{
+				return 1;
+			}
+
+			LARGE_INTEGER fileSize = {};
+			if (!GetFileSizeEx(fileHandle, &fileSize))
+			{
+				CloseHandle(fileHandle);
+				return 1;
+			}
+
+			// Empty files cannot be mapped
+			if (fileSize.QuadPart == 0)
+			{
+				CloseHandle(fileHandle);
+				return 0;
+			}
+
+			const HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			CloseHandle(fileHandle);
+			if (mappingHandle == nullptr)
+			{
+				return 1;
+			}
+
+			// The view keeps the mapping and file open until it is unmapped
+			void* const view = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(mappingHandle);
+			if (view == nullptr)
+			{
+				return 1;
+			}
+
+			outData = static_cast<const uint8_t*>(view);
+			outSize = static_cast<size_t>(fileSize.QuadPart);
+			return 0;
+		}
+
+		void unmapFile(const uint8_t* data, const size_t size)
+		{
+			if (data != nullptr)
+			{
+				UnmapViewOfFile(data);
+			}
+		}
+
+		void adviseMappedRange(const uint8_t* data, const size_t size, const eFileAccessPattern accessPattern)
+		{
+			// Views have no per range read ahead control, the pattern passed to mapFile applies to the whole file. Sequential reads are
+			// helped along by prefetching the range instead
+			if (accessPattern == eFileAccessPattern::sequential)
+			{
+				prefetchMappedRange(data, size);
+			}
+		}
+
+		void prefetchMappedRange(const uint8_t* data, const size_t size)
+		{
+			if ((data == nullptr) || (size == 0))
+			{
+				return;
+			}
+
+			WIN32_MEMORY_RANGE_ENTRY range = {};
+			range.VirtualAddress = const_cast<uint8_t*>(data);
+			range.NumberOfBytes = size;
+			PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+		}
+
+		intptr_t openFile(const std::string& file)
+		{
+			const HANDLE fileHandle = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			return (fileHandle != INVALID_HANDLE_VALUE) ? reinterpret_cast<intptr_t>(fileHandle) : invalidFileHandle;
+		}
+
+		void closeFile(const intptr_t file)
+		{
+			if (file != invalidFileHandle)
+			{
+				CloseHandle(reinterpret_cast<HANDLE>(file));
+			}
+		}
+
+		int64_t readFile(const intptr_t file, const uint64_t offset, void* destination, const size_t size)
+		{
+			// ReadFile takes a 32 bit size, larger reads are split. The offset in the overlapped structure makes each read positional
+			size_t totalRead = 0;
+			while (totalRead < size)
+			{
+				const uint64_t readOffset = offset + totalRead;
+				OVERLAPPED overlapped = {};
+				overlapped.Offset = static_cast<DWORD>(readOffset);
+				overlapped.OffsetHigh = static_cast<DWORD>(readOffset >> 32);
+
+				const DWORD readSize = static_cast<DWORD>(std::min<size_t>(size - totalRead, 0x80000000ull));
+				DWORD bytesRead = 0;
+				if (!ReadFile(reinterpret_cast<HANDLE>(file), static_cast<uint8_t*>(destination) + totalRead, readSize, &bytesRead, &overlapped))
+				{
+					if (GetLastError() == ERROR_HANDLE_EOF)
+					{
+						break;
+					}
+					return -1;
+				}
+
+				// End of file
+				if (bytesRead == 0)
+				{
+					break;
+				}
+				totalRead += bytesRead;
+			}
+			return static_cast<int64_t>(totalRead);
+		}
+
+		intptr_t openFileForWrite(const std::string& file)
+		{
+			const HANDLE fileHandle = CreateFileA(file.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+			return (fileHandle != INVALID_HANDLE_VALUE) ? reinterpret_cast<intptr_t>(fileHandle) : invalidFileHandle;
+		}
+
+		int64_t writeFile(const intptr_t file, const uint64_t offset, const void* source, const size_t size)
+		{
+			size_t totalWritten = 0;
+			while (totalWritten < size)
+			{
+				const uint64_t writeOffset = offset + totalWritten;
+				OVERLAPPED overlapped = {};
+				overlapped.Offset = static_cast<DWORD>(writeOffset);
+				overlapped.OffsetHigh = static_cast<DWORD>(writeOffset >> 32);
+
+				const DWORD writeSize = static_cast<DWORD>(std::min<size_t>(size - totalWritten, 0x80000000ull));
+				DWORD bytesWritten = 0;
+				if (!WriteFile(reinterpret_cast<HANDLE>(file), static_cast<const uint8_t*>(source) + totalWritten, writeSize, &bytesWritten, &overlapped))
+				{
+					return -1;
+				}
+				totalWritten += bytesWritten;
+			}
+			return static_cast<int64_t>(totalWritten);
+		}
+
+		int64_t getFileSize(const intptr_t file)
+		{
+			LARGE_INTEGER fileSize = {};
+			if (!GetFileSizeEx(reinterpret_cast<HANDLE>(file), &fileSize))
+			{
+				return -1;
+			}
+			return static_cast<int64_t>(fileSize.QuadPart);
+		}
+
+		int8_t lockFile(const intptr_t file)
+		{
+			// Locking the largest possible range covers the whole file however large it grows
+			OVERLAPPED overlapped = {};
+			return LockFileEx(reinterpret_cast<HANDLE>(file), LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &overlapped) ? 0 : 1;
+		}
+
+		void unlockFile(const intptr_t file)
+		{
+			OVERLAPPED overlapped = {};
+			UnlockFileEx(reinterpret_cast<HANDLE>(file), 0, MAXDWORD, MAXDWORD, &overlapped);
+		}
+
+		// There is no kernel read queue on this platform, asynchronous reads use blocking reads on worker threads
+		class readQueue
+		{
+		};
+
+		int8_t createReadQueue(const uint32_t depth, std::shared_ptr<readQueue>& outQueue)
+		{
+			return 1;
+		}
+
+		bool submitRead(readQueue* queue, const intptr_t file, const uint64_t offset, void* destination, const uint32_t size, const uint64_t userData)
+		{
+			return false;
+		}
+
+		uint32_t waitReadCompletions(readQueue* queue, sReadCompletion* outCompletions, const uint32_t maxCount)
+		{
+			return 0;
+		}
+	}
+}
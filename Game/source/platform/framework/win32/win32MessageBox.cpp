@@ -43,7 +43,8 @@ namespace platformLayer
 			LPCSTR caption = "Fatal Error";
 			UINT type = MB_OK | MB_ICONERROR;
 			MessageBoxA(0, message.c_str(), caption, type);
-			exit(EXIT_FAILURE);
+			std::cout.flush();
+			std::_Exit(EXIT_FAILURE);
 		}
 	}
 }
\ No newline at end of file
@@ -1,5 +1,11 @@
 #include "pch.h"
 
+#include <DbgHelp.h>
+#pragma comment(lib, "dbghelp.lib")
+
+static bool quitRequested = false;
+static bool symbolsInitialized = false;
+
 namespace platformLayer
 {
 	namespace os
@@ -10,9 +16,57 @@ namespace platformLayer
 			MSG msg = {};
 			while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE))
 			{
+				if (msg.message == WM_QUIT)
+				{
+					quitRequested = true;
+				}
+
 				TranslateMessage(&msg);
 				DispatchMessage(&msg);
 			}
 		}
+
+		bool isQuitRequested()
+		{
+			return quitRequested;
+		}
+
+		std::string getAddressDescription(const void* address)
+		{
+			// DbgHelp is single threaded, descriptions are only requested by reports printed from one thread
+			const HANDLE process = GetCurrentProcess();
+			if (!symbolsInitialized)
+			{
+				SymSetOptions(SYMOPT_DEFERRED_LOADS | SYMOPT_LOAD_LINES | SYMOPT_UNDNAME);
+				symbolsInitialized = (SymInitialize(process, nullptr, TRUE) != FALSE);
+			}
+
+			char buffer[1024];
+			const DWORD64 symbolAddress = reinterpret_cast<DWORD64>(address);
+			alignas(SYMBOL_INFO) uint8_t symbolStorage[sizeof(SYMBOL_INFO) + MAX_SYM_NAME];
+			SYMBOL_INFO* const symbol = reinterpret_cast<SYMBOL_INFO*>(symbolStorage);
+			symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+			symbol->MaxNameLen = MAX_SYM_NAME;
+
+			DWORD64 symbolDisplacement = 0;
+			if (!symbolsInitialized || !SymFromAddr(process, symbolAddress, &symbolDisplacement, symbol))
+			{
+				snprintf(buffer, sizeof(buffer), "%p", address);
+				return buffer;
+			}
+
+			IMAGEHLP_LINE64 line = {};
+			line.SizeOfStruct = sizeof(IMAGEHLP_LINE64);
+			DWORD lineDisplacement = 0;
+			if (SymGetLineFromAddr64(process, symbolAddress, &lineDisplacement, &line))
+			{
+				snprintf(buffer, sizeof(buffer), "%s (%s:%lu)", symbol->Name, line.FileName, line.LineNumber);
+			}
+			else
+			{
+				snprintf(buffer, sizeof(buffer), "%s+0x%llx", symbol->Name, static_cast<unsigned long long>(symbolDisplacement));
+			}
+			return buffer;
+		}
 	}
 }
@@ -14,6 +14,7 @@
 #include "platform/framework/events/sResizedEvent.h"
 #include "platform/framework/events/sEnterFullScreenEvent.h"
 #include "platform/framework/events/sExitFullScreenEvent.h"
+#include "memory/scratchArena.h"
 
 namespace platformLayer
 {
@@ -208,18 +209,23 @@ static LRESULT CALLBACK WindowProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lp
 				return 0;
 			}
 
-			// Initialize raw data storage
-			std::unique_ptr<BYTE[]> rawData{ std::make_unique<BYTE[]>(dataSize) };
+			// Initialize raw data storage. Raw input arrives for every mouse movement so it is read into scratch memory rather than the heap
+			scratchScope scratch;
+			void* const rawData = scratch.getArena().allocate(dataSize, alignof(RAWINPUT));
+			if (rawData == nullptr)
+			{
+				return 0;
+			}
 
 			// Retreive raw data and store it. Return if the retreived data is the not same size
 			if (GetRawInputData(reinterpret_cast<HRAWINPUT>(lparam), RID_INPUT,
-				rawData.get(), &dataSize, sizeof(RAWINPUTHEADER)) != dataSize)
+				rawData, &dataSize, sizeof(RAWINPUTHEADER)) != dataSize)
 			{
 				return 0;
 			}
 
 			// Cast byte to raw input
-			RAWINPUT* raw = reinterpret_cast<RAWINPUT*>(rawData.get());
+			RAWINPUT* raw = static_cast<RAWINPUT*>(rawData);
 
 			// Return if the raw input is not from the mouse
 			if (raw->header.dwType != RIM_TYPEMOUSE)
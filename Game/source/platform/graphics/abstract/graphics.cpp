@@ -1,11 +1,11 @@
 #include "pch.h"
 #include "graphics.h"
+#include "platform/graphics/shaderBuild.h"
 
 #if defined(PLATFORM_WIN32)
 #include "platform/graphics/direct3D12/direct3D12Graphics.h"
-#endif // defined(PLATFORM_WIN32)
-
 #include "platform/graphics/vulkan/vulkanGraphics.h"
+#endif // defined(PLATFORM_WIN32)
 
 void graphics::create(const eGraphicsApi graphicsApi, std::shared_ptr<graphics>& outGraphics)
 {
@@ -24,6 +24,8 @@ void graphics::create(const eGraphicsApi graphicsApi, std::shared_ptr<graphics>&
 		outGraphics = std::make_shared<vulkanGraphics>();
 	}
 	break;
+#elif defined(PLATFORM_LINUX)
+		// There is no graphics backend on linux yet, every api is unsupported and only the headless modes run
 #endif // defined(PLATFORM_WIN32)
 
 	// Unhandled(unsupported api) cases will fallback on the default case
@@ -35,6 +37,31 @@ void graphics::create(const eGraphicsApi graphicsApi, std::shared_ptr<graphics>&
 	}
 }
 
+bool graphics::getShaderCompiler(const eGraphicsApi graphicsApi, [[maybe_unused]] sShaderCompiler& outCompiler)
+{
+	switch (graphicsApi)
+	{
+#if defined(PLATFORM_WIN32)
+	case eGraphicsApi::direct3d12:
+	{
+		direct3d12Graphics::getShaderCompiler(outCompiler);
+	}
+	return true;
+
+	case eGraphicsApi::vulkan:
+	{
+		vulkanGraphics::getShaderCompiler(outCompiler);
+	}
+	return true;
+#endif // defined(PLATFORM_WIN32)
+
+	default:
+	{
+		return false;
+	}
+	}
+}
+
 graphics::graphics(const eGraphicsApi inApi)
 	: graphicsObject(inApi)
 {
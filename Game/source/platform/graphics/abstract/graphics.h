@@ -1,19 +1,35 @@
 #pragma once
 
 #include "graphicsObject.h"
+#include "memory/frameArena.h"
+#include "platform/graphics/sUploadToken.h"
 
 class graphicsSurface;
-class matrix4x4;
+class matrix4x4f;
 
 struct sVertexPos3Norm3Col4UV2;
 struct sRenderData; 
 struct sMeshResources;
+struct sShaderCompiler;
+struct sGpuMemoryStats;
 
 class graphics : public graphicsObject
 {
+public:
+	// Size of each frame's arena. One arena is kept per back buffer
+	static constexpr size_t frameArenaSize = 4 * 1024 * 1024;
+
+protected:
+	// Per frame scratch of the render path, e.g. the render queue's sort histograms. Reset by beginFrame once the gpu has finished the last
+	// frame that used the same back buffer slot. Only used on the thread that runs frames
+	frameArena frameAllocator;
+
 public:
 	static void create(const eGraphicsApi graphicsApi, std::shared_ptr<graphics>& outGraphics);
 
+	// Gets the api's shader compiler without creating a device. Returns false if the api is unsupported on this platform
+	static bool getShaderCompiler(const eGraphicsApi graphicsApi, sShaderCompiler& outCompiler);
+
 public:
 	graphics(const eGraphicsApi inApi);
 	~graphics() override = default;
@@ -26,8 +42,17 @@ public:
 	virtual void resizeSurface(graphicsSurface* surface, uint32_t width, uint32_t height) = 0;
 	virtual void setSurfaceUseVSync(graphicsSurface* surface, const bool inUseVSync) = 0;
 	virtual void beginFrame() = 0;
-	virtual void render(const uint32_t numSurfaces, graphicsSurface* const* surfaces, const uint32_t renderDataCount, const sRenderData* const* renderData, const matrix4x4* const viewProjection) = 0;
+	virtual void render(const uint32_t numSurfaces, graphicsSurface* const* surfaces, const uint32_t renderDataCount, const sRenderData* const* renderData, const matrix4x4f* const viewProjection) = 0;
 	virtual void endFrame(const uint32_t numRenderedSurfaces, graphicsSurface* const* renderedSurfaces) = 0;
 	//virtual void loadMesh(const size_t vertexCount, const sVertexPos3Norm3Col4UV2* const vertices, const size_t indexCount, const uint32_t* const indices, sMeshResources& outMeshResources) = 0;
-	virtual void loadMeshes(const uint32_t meshCount, const size_t* vertexCounts, const sVertexPos3Norm3Col4UV2(* const vertices)[], const size_t* const indexCounts, const uint32_t(* const indices)[], sMeshResources** const outMeshResources) = 0;
-};
+
+	// Copies the meshes into staging memory and queues their uploads without waiting on the gpu. The mesh data may be freed on return. The
+	// meshes may be drawn straight away: they are skipped until their copies are submitted and the gpu waits for copies still running.
+	// Loads and upload queries may be made from any thread, including while another thread runs frames. They are serialised with frame
+	// recording, so a load made mid-frame waits for render to finish. Every other function must be called from the thread that runs frames
+	virtual sUploadToken loadMeshes(const uint32_t meshCount, const size_t* vertexCounts, const sVertexPos3Norm3Col4UV2(* const vertices)[], const size_t* const indexCounts, const uint32_t(* const indices)[], sMeshResources** const outMeshResources) = 0;
+	virtual bool isUploadComplete(const sUploadToken token) = 0;
+
+	// Gpu memory held by the backend's allocator
+	virtual void getMemoryStats(sGpuMemoryStats& outStats) const = 0;
+};
\ No newline at end of file
@@ -3,10 +3,15 @@
 #include "platform/framework/abstract/platformMessageBox.h"
 #include "direct3d12Surface.h"
 #include "fileIO/fileIO.h"
+#include "fileIO/virtualFileSystem.h"
+#include "platform/graphics/shaderBuild.h"
 #include "platform/graphics/sVertexPos3Norm3Col4UV2.h"
 #include "platform/graphics/sMeshResources.h"
-#include "math/matrix4x4.h"
+#include "math/matrix4x4f.h"
 #include "platform/graphics/sRenderData.h"
+#include "profiler/profiler.h"
+#include "jobs/jobSystem.h"
+#include "sString.h"
 
 using namespace Microsoft::WRL;
 
@@ -15,12 +20,19 @@ using namespace Microsoft::WRL;
 static constexpr size_t kb_64 = 65536;
 static constexpr size_t constantBufferDataStepSize = 256;
 static constexpr DWORD maxFenceWaitDurationMs = static_cast<DWORD>(std::chrono::milliseconds::max().count());
+static constexpr uint64_t unsubmittedUploadFenceValue = UINT64_MAX;
 
-struct sObjectConstantBuffer
+// Matches instanceData in the vertex shader
+struct sInstanceData
 {
 	float worldViewProjectionMatrix[16];
 };
 
+// Smallest instance buffer, buffers grow by doubling
+static constexpr uint32_t minInstanceCapacity = 1024;
+// Fewest instances written by one job
+static constexpr uint32_t minInstancesPerJob = 4096;
+
 struct sCameraConstantBuffer
 {
 };
@@ -317,6 +329,8 @@ uint8_t compileShaderFromFile(IDxcLibrary* dxcLibrary,
 	LPCWSTR file,
 	LPCWSTR entryPoint,
 	LPCWSTR targetProfile,
+	const DxcDefine* defines,
+	const uint32_t defineCount,
 	ComPtr<IDxcBlob>& outBlob,
 	std::string& outErrorMessage)
 {
@@ -324,8 +338,12 @@ uint8_t compileShaderFromFile(IDxcLibrary* dxcLibrary,
 	ComPtr<IDxcBlobEncoding> sourceBlob;
 	fatalIfFailed(dxcLibrary->CreateBlobFromFile(file, &codePage, &sourceBlob));
 
+	// Resolves #include relative to the including file
+	ComPtr<IDxcIncludeHandler> includeHandler;
+	fatalIfFailed(dxcLibrary->CreateIncludeHandler(&includeHandler));
+
 	ComPtr<IDxcOperationResult> result;
-	fatalIfFailed(dxcCompiler->Compile(sourceBlob.Get(), file, entryPoint, targetProfile, nullptr, 0, nullptr, 0, nullptr, &result));
+	fatalIfFailed(dxcCompiler->Compile(sourceBlob.Get(), file, entryPoint, targetProfile, nullptr, 0, defines, defineCount, includeHandler.Get(), &result));
 
 	HRESULT hr;
 	fatalIfFailed(result->GetStatus(&hr));
@@ -351,13 +369,71 @@ static void createCommittedBuffer(ID3D12Device8* device, D3D12_HEAP_TYPE type, U
 	fatalIfFailed(device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &resourceDesc, initialResourceState, nullptr, IID_PPV_ARGS(&outResource)));
 }
 
-static void updateBufferResource(ID3D12Resource* buffer, const void* src, const size_t width)
+// Backend object behind a gpu allocator heap. Shared heaps hold one placed buffer spanning the whole heap and allocations are ranges of it,
+// dedicated heaps are a committed buffer of their own
+struct sDirect3d12Heap
 {
-	D3D12_RANGE readRange = {};
-	void* resourceData;
-	fatalIfFailed(buffer->Map(0, &readRange, &resourceData));
-	memcpy(resourceData, src, width);
-	buffer->Unmap(0, nullptr);
+	ComPtr<ID3D12Heap> heap;
+	ComPtr<ID3D12Resource> buffer;
+	// Upload heaps stay mapped for their whole life
+	uint8_t* mappedData = nullptr;
+};
+
+static void* createBufferHeap(ID3D12Device8* device, const eDirect3d12MemoryType memoryType, const uint64_t size, const bool dedicated)
+{
+	const bool upload = (memoryType == eDirect3d12MemoryType::uploadBuffer);
+	const D3D12_HEAP_TYPE heapType = upload ? D3D12_HEAP_TYPE_UPLOAD : D3D12_HEAP_TYPE_DEFAULT;
+
+	// Upload buffers must stay in the generic read state. Default heap buffers stay in the common state: buffers are implicitly promoted to
+	// the copy destination and vertex and index buffer states when used and decay back to common when ExecuteCommandLists finishes, so
+	// ranges of one buffer are used without barriers
+	const D3D12_RESOURCE_STATES initialState = upload ? D3D12_RESOURCE_STATE_GENERIC_READ : D3D12_RESOURCE_STATE_COMMON;
+	const UINT64 width = (size + (D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1)) & ~static_cast<UINT64>(D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1);
+	const D3D12_RESOURCE_DESC resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(width);
+
+	std::unique_ptr<sDirect3d12Heap> heap = std::make_unique<sDirect3d12Heap>();
+	if (dedicated)
+	{
+		const D3D12_HEAP_PROPERTIES heapProperties = CD3DX12_HEAP_PROPERTIES(heapType);
+		if (FAILED(device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &resourceDesc, initialState, nullptr, IID_PPV_ARGS(&heap->buffer))))
+		{
+			return nullptr;
+		}
+	}
+	else
+	{
+		const CD3DX12_HEAP_DESC heapDesc(width, heapType, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT, D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS);
+		if (FAILED(device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap->heap))) ||
+			FAILED(device->CreatePlacedResource(heap->heap.Get(), 0, &resourceDesc, initialState, nullptr, IID_PPV_ARGS(&heap->buffer))))
+		{
+			return nullptr;
+		}
+	}
+
+	if (upload)
+	{
+		D3D12_RANGE readRange = {};
+		if (FAILED(heap->buffer->Map(0, &readRange, reinterpret_cast<void**>(&heap->mappedData))))
+		{
+			return nullptr;
+		}
+	}
+	return heap.release();
+}
+
+static ID3D12Resource* getBufferResource(const sGpuAllocation& allocation)
+{
+	return static_cast<const sDirect3d12Heap*>(allocation.heap)->buffer.Get();
+}
+
+static D3D12_GPU_VIRTUAL_ADDRESS getBufferAddress(const sGpuAllocation& allocation)
+{
+	return getBufferResource(allocation)->GetGPUVirtualAddress() + allocation.offset;
+}
+
+static uint8_t* getMappedData(const sGpuAllocation& allocation)
+{
+	return static_cast<const sDirect3d12Heap*>(allocation.heap)->mappedData + allocation.offset;
 }
 
 void direct3d12ConstantBuffer::init(ID3D12Device8* device, const UINT64 inHeapWidth, const size_t constantDataWidth)
@@ -434,11 +510,32 @@ void direct3d12Graphics::init(bool useWarp, uint32_t inBackBufferCount)
 
 	createEventHandle(eventHandle);
 
-	createDxcLibrary(dxcLibrary);
-	createDxcCompiler(dxcCompiler);
+	frameAllocator.init(backBufferCount, frameArenaSize);
+
+	sGpuAllocatorDesc allocatorDesc = {};
+	allocatorDesc.memoryTypeCount = static_cast<uint32_t>(eDirect3d12MemoryType::count);
+	allocatorDesc.createHeap = [this](const uint32_t memoryType, const uint64_t size, const bool dedicated)
+		{
+			return createBufferHeap(device.Get(), static_cast<eDirect3d12MemoryType>(memoryType), size, dedicated);
+		};
+	allocatorDesc.destroyHeap = [](const uint32_t memoryType, void* heap)
+		{
+			delete static_cast<sDirect3d12Heap*>(heap);
+		};
+	memoryAllocator.init(allocatorDesc);
+
+	// Upload resources. The staging buffer stays mapped for the life of the device
+	stagingBuffer = allocateBuffer(eDirect3d12MemoryType::uploadBuffer, stagingRingSize, D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT);
+	stagingRegions.init(stagingRingSize);
+	sDirect3d12UploadAllocator& uploadAllocator = uploadCommandAllocators.emplace_back();
+	createCommandAllocator(device.Get(), D3D12_COMMAND_LIST_TYPE_COPY, uploadAllocator.commandAllocator);
+	createCommandList(device.Get(), uploadAllocator.commandAllocator.Get(), nullptr, D3D12_COMMAND_LIST_TYPE_COPY, uploadCommandList);
+	createFence(device.Get(), uploadFence);
+	uploadFenceValue = 0;
+
+	frameInstances.resize(static_cast<size_t>(backBufferCount));
 
 	// Create constant buffer
-	objectConstantBuffer.init(device.Get(), kb_64, sizeof(objectConstantBuffer));
 	cameraConstantBuffer.init(device.Get(), kb_64, sizeof(cameraConstantBuffer));
 
 	// Input layout
@@ -455,9 +552,9 @@ void direct3d12Graphics::init(bool useWarp, uint32_t inBackBufferCount)
 	inputLayoutDesc.pInputElementDescs = inputLayout;
 
 	// Root signature
-	D3D12_ROOT_DESCRIPTOR objectRootCBDescriptor = {};
-	objectRootCBDescriptor.ShaderRegister = 0;
-	objectRootCBDescriptor.RegisterSpace = 0;
+	D3D12_ROOT_DESCRIPTOR instanceRootSRVDescriptor = {};
+	instanceRootSRVDescriptor.ShaderRegister = 0;
+	instanceRootSRVDescriptor.RegisterSpace = 0;
 
 	D3D12_ROOT_DESCRIPTOR cameraRootCBDescriptor = {};
 	cameraRootCBDescriptor.ShaderRegister = 1;
@@ -465,8 +562,9 @@ void direct3d12Graphics::init(bool useWarp, uint32_t inBackBufferCount)
 
 	D3D12_ROOT_PARAMETER rootParameters[2];
 
-	rootParameters[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
-	rootParameters[0].Descriptor = objectRootCBDescriptor;
+	// Instance data is a root shader resource view so each instanced draw points it at its first instance
+	rootParameters[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+	rootParameters[0].Descriptor = instanceRootSRVDescriptor;
 	rootParameters[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
 
 	rootParameters[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
@@ -491,12 +589,16 @@ void direct3d12Graphics::init(bool useWarp, uint32_t inBackBufferCount)
 	fatalIfFailed(D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1_0, &signature, nullptr));
 	fatalIfFailed(device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&rootSignature)));
 
-	// Shader compilation
-	std::vector<uint8_t> vertexShaderBuffer;
-	loadShader("shaders/direct3d12/vertexShader.hlsl", L"main", L"vs_6_0", vertexShaderBuffer);
-
-	std::vector<uint8_t> pixelShaderBuffer;
-	loadShader("shaders/direct3d12/pixelShader.hlsl", L"main", L"ps_6_0", pixelShaderBuffer);
+	// Shader compilation, the shaders compile in parallel
+	const sShaderDesc shaderDescs[] =
+	{
+		{ "shaders/direct3d12/vertexShader.hlsl", "main", "vs_6_0" },
+		{ "shaders/direct3d12/pixelShader.hlsl", "main", "ps_6_0" }
+	};
+	std::vector<std::vector<uint8_t>> shaderBuffers;
+	loadShaders(shaderDescs, shaderBuffers);
+	const std::vector<uint8_t>& vertexShaderBuffer = shaderBuffers[0];
+	const std::vector<uint8_t>& pixelShaderBuffer = shaderBuffers[1];
 
 	// Pipeline state
 	CD3DX12_DEFAULT def = {};
@@ -541,11 +643,39 @@ void direct3d12Graphics::shutdown()
 {
 	waitForGPU();
 
-	objectConstantBuffer.shutdown();
 	cameraConstantBuffer.shutdown();
-	resourceStore.clear();
+	for (sDirect3d12FrameInstances& instances : frameInstances)
+	{
+		memoryAllocator.free(instances.buffer);
+		for (sGpuAllocation& outgrownBuffer : instances.outgrownBuffers)
+		{
+			memoryAllocator.free(outgrownBuffer);
+		}
+	}
+	frameInstances.clear();
+	retireUploads();
+	pendingUploads.clear();
+	memoryAllocator.free(stagingBuffer);
+	stagingRegions.shutdown();
+	uploadCommandAllocators.clear();
+	uploadCommandList.Reset();
+	uploadFence.Reset();
+	uploadFenceValue = 0;
+	lastUploadId = 0;
+	completedUploadId = 0;
+	bufferUploadFenceValues.clear();
+	recordedUploadBuffers.clear();
+	frameUploadFenceValue = 0;
+	graphicsQueueUploadFenceValue = 0;
+	for (sGpuAllocation& buffer : bufferStore)
+	{
+		memoryAllocator.free(buffer);
+	}
+	bufferStore.clear();
+	memoryAllocator.shutdown();
 	vertexBufferViewStore.clear();
 	indexBufferViewStore.clear();
+	frameAllocator.shutdown();
 
 	backBufferCount = 0;
 	dxgiFactory.Reset();
@@ -563,9 +693,6 @@ void direct3d12Graphics::shutdown()
 	CloseHandle(eventHandle);
 	currentFrameIndex = 0;
 
-	dxcLibrary.Reset();
-	dxcCompiler.Reset();
-
 	rootSignature.Reset();
 	graphicsPipelineState.Reset();
 
@@ -694,9 +821,29 @@ void direct3d12Graphics::setSurfaceUseVSync(graphicsSurface* surface, const bool
 
 void direct3d12Graphics::beginFrame()
 {
+	PROFILE_SCOPE("graphics::beginFrame");
+
 	// Wait for the previous frame to finish on the GPU
 	waitForFence(graphicsFence.Get(), eventHandle, graphicsFenceValues[currentFrameIndex]);
 
+	// The gpu has finished with everything allocated the last time this frame index was used
+	frameAllocator.beginFrame(currentFrameIndex);
+	sDirect3d12FrameInstances& instances = frameInstances[currentFrameIndex];
+	instances.count = 0;
+	for (sGpuAllocation& outgrownBuffer : instances.outgrownBuffers)
+	{
+		memoryAllocator.free(outgrownBuffer);
+	}
+	instances.outgrownBuffers.clear();
+
+	// Submit uploads that were waiting for room in the staging ring
+	{
+		std::lock_guard<std::mutex> lock(uploadMutex);
+		retireUploads();
+		flushPendingUploads();
+		submitUploads();
+	}
+
 	// Get frame resources
 	ID3D12CommandAllocator* const graphicsCommandAllocator = graphicsCommandAllocators[currentFrameIndex].Get();
 
@@ -705,8 +852,28 @@ void direct3d12Graphics::beginFrame()
 	fatalIfFailed(graphicsCommandList->Reset(graphicsCommandAllocator, nullptr));
 }
 
-void direct3d12Graphics::render(const uint32_t numSurfaces, class graphicsSurface* const* surfaces, const uint32_t renderDataCount, const struct sRenderData* const* renderData, const matrix4x4* const viewProjection)
+void direct3d12Graphics::render(const uint32_t numSurfaces, class graphicsSurface* const* surfaces, const uint32_t renderDataCount, const struct sRenderData* const* renderData, const matrix4x4f* const viewProjection)
 {
+	PROFILE_SCOPE("graphics::render");
+
+	// Recording reads the buffer stores and upload fence values a load on another thread may be changing
+	std::lock_guard<std::mutex> lock(uploadMutex);
+
+	// Sort the items by state then front to back, so items sharing a mesh are adjacent and every surface draws them with one instanced draw
+	drawQueue.reset(renderDataCount);
+	const std::span<uint64_t> drawKeys = drawQueue.getKeys();
+	jobSystem::parallelFor(renderDataCount, minInstancesPerJob, [renderData, viewProjection, drawKeys](const uint32_t begin, const uint32_t end)
+		{
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				const float depth = renderQueue::getViewDepth(*renderData[i]->pWorldMatrix, *viewProjection);
+
+				// There is one pass and pipeline and no materials yet, so items are ordered by mesh and depth
+				drawKeys[i] = renderQueue::makeKey(0, 0, 0, static_cast<uint32_t>(renderData[i]->pMeshResources->vertexBufferViewHandle), depth);
+			}
+		});
+	drawQueue.sort(frameAllocator.getResource());
+
 	// For each surface
 	for(uint32_t i = 0; i < numSurfaces; ++i)
 	{
@@ -720,9 +887,26 @@ void direct3d12Graphics::render(const uint32_t numSurfaces, class graphicsSurfac
 
 void direct3d12Graphics::endFrame(const uint32_t numRenderedSurfaces, graphicsSurface* const* renderedSurfaces)
 {
+	PROFILE_SCOPE("graphics::endFrame");
+
 	// Stop recording command list
 	fatalIfFailed(graphicsCommandList->Close());
 
+	// Make the graphics queue wait for copies still running on the copy queue the first time a frame draws their buffers. Buffers uploaded
+	// by earlier frames, or whose copies had already finished, need no wait
+	{
+		std::lock_guard<std::mutex> lock(uploadMutex);
+		if (frameUploadFenceValue > graphicsQueueUploadFenceValue)
+		{
+			if (uploadFence->GetCompletedValue() < frameUploadFenceValue)
+			{
+				fatalIfFailed(graphicsQueue->Wait(uploadFence.Get(), frameUploadFenceValue));
+			}
+			graphicsQueueUploadFenceValue = frameUploadFenceValue;
+		}
+		frameUploadFenceValue = 0;
+	}
+
 	// Execute command lists
 	ID3D12CommandList* graphicsExecuteLists[] = { graphicsCommandList.Get() };
 	graphicsQueue->ExecuteCommandLists(_countof(graphicsExecuteLists), graphicsExecuteLists);
@@ -802,22 +986,20 @@ void direct3d12Graphics::endFrame(const uint32_t numRenderedSurfaces, graphicsSu
 //	waitForFence(graphicsFence.Get(), eventHandle, graphicsFenceValues[currentFrameIndex], maxFenceWaitDurationMs);
 //}
 
-void direct3d12Graphics::loadMeshes(const uint32_t meshCount, const size_t* vertexCounts, const sVertexPos3Norm3Col4UV2(* const vertices)[], const size_t* const indexCounts, const uint32_t(* const indices)[], struct sMeshResources** const outMeshResources)
+sUploadToken direct3d12Graphics::loadMeshes(const uint32_t meshCount, const size_t* vertexCounts, const sVertexPos3Norm3Col4UV2(* const vertices)[], const size_t* const indexCounts, const uint32_t(* const indices)[], struct sMeshResources** const outMeshResources)
 {
-	// Before the CPU can reset the graphics command allocator for the current frame, it needs to wait until previous work stored in the allocator has completed on the GPU
-	waitForFence(graphicsFence.Get(), eventHandle, graphicsFenceValues[currentFrameIndex], maxFenceWaitDurationMs);
-	ID3D12CommandAllocator* graphicsCommandAllocator = graphicsCommandAllocators[currentFrameIndex].Get();
-	fatalIfFailed(graphicsCommandAllocator->Reset());
-	fatalIfFailed(graphicsCommandList->Reset(graphicsCommandAllocator, nullptr));
+	PROFILE_SCOPE("graphics::loadMeshes");
 
-	// Create and write to upload heaps
-	std::vector<ComPtr<ID3D12Resource>> uploadBuffers(meshCount * 2);
-	for (uint32_t i = 0, j = 0; i < meshCount; ++i, j += 2)
+	std::lock_guard<std::mutex> lock(uploadMutex);
+
+	// Free staging memory of finished uploads before taking more
+	retireUploads();
+
+	const uint64_t uploadId = ++lastUploadId;
+	for (uint32_t i = 0; i < meshCount; ++i)
 	{
 		const size_t meshVertexCount = vertexCounts[i];
-		const sVertexPos3Norm3Col4UV2(*meshVertices)[] = vertices;
 		const size_t meshIndexCount = indexCounts[i];
-		const uint32_t(*meshIndices)[] = indices;
 		sMeshResources& outMeshResource = *outMeshResources[i];
 
 		const size_t vertexBufferWidth = sizeof(sVertexPos3Norm3Col4UV2) * meshVertexCount;
@@ -825,68 +1007,117 @@ void direct3d12Graphics::loadMeshes(const uint32_t meshCount, const size_t* vert
 
 		outMeshResource.indexCount = static_cast<uint32_t>(meshIndexCount);
 
-		ComPtr<ID3D12Resource>& vertexUploadBuffer = uploadBuffers[j];
-		createCommittedBuffer(device.Get(), D3D12_HEAP_TYPE_UPLOAD, vertexBufferWidth, D3D12_RESOURCE_STATE_GENERIC_READ, vertexUploadBuffer);
-		updateBufferResource(vertexUploadBuffer.Get(), vertices, vertexBufferWidth);
-
-		ComPtr<ID3D12Resource>& indexUploadBuffer = uploadBuffers[j + 1];
-		createCommittedBuffer(device.Get(), D3D12_HEAP_TYPE_UPLOAD, indexBufferWidth, D3D12_RESOURCE_STATE_GENERIC_READ, indexUploadBuffer);
-		updateBufferResource(indexUploadBuffer.Get(), indices, indexBufferWidth);
-
-		// Create default heaps and submit copy upload heaps to default heaps work to the graphics queue
-		createDefaultBufferAndRecordCopyCommand(graphicsCommandList.Get(), uploadBuffers[j].Get(), static_cast<UINT>(vertexBufferWidth), outMeshResource.vertexBufferResourceHandle);
-		createDefaultBufferAndRecordCopyCommand(graphicsCommandList.Get(), uploadBuffers[j + 1].Get(), static_cast<UINT>(indexBufferWidth), outMeshResource.indexBufferResourceHandle);
-
-		D3D12_RESOURCE_BARRIER resourceBarriers[] = {
-			CD3DX12_RESOURCE_BARRIER::Transition(resourceStore[outMeshResource.vertexBufferResourceHandle].Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER),
-			CD3DX12_RESOURCE_BARRIER::Transition(resourceStore[outMeshResource.indexBufferResourceHandle].Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_INDEX_BUFFER)
-		};
-		graphicsCommandList->ResourceBarrier(_countof(resourceBarriers), resourceBarriers);
+		// Allocate default heap buffers. The buffers are promoted to the copy destination state by the copy and decay back to common once the
+		// copy command list finishes, so no barriers are needed on either queue and the graphics queue promotes them again when drawing
+		createDefaultBuffer(vertexBufferWidth, outMeshResource.vertexBufferResourceHandle);
+		createDefaultBuffer(indexBufferWidth, outMeshResource.indexBufferResourceHandle);
 
 		// Create buffer views
 		createVertexBufferView(outMeshResource.vertexBufferResourceHandle, sizeof(sVertexPos3Norm3Col4UV2), static_cast<UINT>(vertexBufferWidth), outMeshResource.vertexBufferViewHandle);
 		createIndexBufferView(outMeshResource.indexBufferResourceHandle, DXGI_FORMAT_R32_UINT, static_cast<UINT>(indexBufferWidth), outMeshResource.indexBufferViewHandle);
+
+		// Copy to staging memory and record the copies to the default buffers
+		queueUpload(outMeshResource.vertexBufferResourceHandle, vertices, vertexBufferWidth, uploadId);
+		queueUpload(outMeshResource.indexBufferResourceHandle, indices, indexBufferWidth, uploadId);
 	}
 
-	fatalIfFailed(graphicsCommandList->Close());
-	ID3D12CommandList* commandLists[] = { graphicsCommandList.Get() };
-	graphicsQueue->ExecuteCommandLists(_countof(commandLists), commandLists);
+	submitUploads();
+	return { uploadId };
+}
 
-	graphicsFenceValues[currentFrameIndex] = ++graphicsFenceValue;
-	graphicsQueue->Signal(graphicsFence.Get(), graphicsFenceValue);
+bool direct3d12Graphics::isUploadComplete(const sUploadToken token)
+{
+	std::lock_guard<std::mutex> lock(uploadMutex);
+	retireUploads();
+	return (token.value <= completedUploadId);
+}
 
-	// Wait for the copy work to finish as the upload buffers are released after exiting this function
-	waitForFence(graphicsFence.Get(), eventHandle, graphicsFenceValues[currentFrameIndex], maxFenceWaitDurationMs);
+void direct3d12Graphics::getMemoryStats(sGpuMemoryStats& outStats) const
+{
+	memoryAllocator.getStats(outStats);
 }
 
-void direct3d12Graphics::loadShader(const std::string& shaderSourceFile, LPCWSTR entryPoint, LPCWSTR targetProfile, std::vector<uint8_t>& outBuffer)
+void direct3d12Graphics::getShaderCompiler(sShaderCompiler& outCompiler)
 {
-	static const std::string compiledShaderFileExtension = "bin";
+	ComPtr<IDxcCompiler> dxcCompiler;
+	createDxcCompiler(dxcCompiler);
 
-	const std::string shaderCompiledFile = fileIO::replaceExtension(shaderSourceFile, compiledShaderFileExtension);
-	if (fileIO::fileExists(shaderCompiledFile))
+	ComPtr<IDxcVersionInfo> dxcVersionInfo;
+	UINT32 dxcMajorVersion = 0;
+	UINT32 dxcMinorVersion = 0;
+	if (SUCCEEDED(dxcCompiler.As(&dxcVersionInfo)))
 	{
-		fileIO::readSerializedBuffer(shaderCompiledFile, outBuffer);
+		dxcVersionInfo->GetVersion(&dxcMajorVersion, &dxcMinorVersion);
 	}
-	else
+
+	outCompiler.compile = &direct3d12Graphics::compileShader;
+	outCompiler.version = sString::printf("dxc %u.%u", dxcMajorVersion, dxcMinorVersion);
+}
+
+void direct3d12Graphics::loadShaders(std::span<const sShaderDesc> descs, std::vector<std::vector<uint8_t>>& outBuffers)
+{
+	// Shipped builds carry compiled shaders in a pak instead of their sources
+	if (!fileIO::fileExists(descs.front().sourceFile))
+	{
+		outBuffers.resize(descs.size());
+		for (size_t i = 0; i < descs.size(); ++i)
+		{
+			if (!virtualFileSystem::readFile(fileIO::replaceExtension(descs[i].sourceFile, "bin"), outBuffers[i]))
+			{
+				platformLayer::messageBox::showMessageBoxFatal("direct3d12Graphics::loadShaders: Failed to find shader " + descs[i].sourceFile + ".");
+			}
+		}
+		return;
+	}
+
+	sShaderCompiler compiler;
+	getShaderCompiler(compiler);
+	const sShaderBuildResult result = shaderBuild::build(descs, compiler, &outBuffers);
+	if (!result.succeeded())
 	{
-		ComPtr<IDxcBlob> blob;
-		compileShader(std::wstring(shaderSourceFile.begin(), shaderSourceFile.end()).c_str(), entryPoint, targetProfile, blob);
-		const size_t bufferSize = blob->GetBufferSize();
-		outBuffer.resize(bufferSize);
-		memcpy(outBuffer.data(), blob->GetBufferPointer(), bufferSize);
-		fileIO::writeSerializedBuffer(shaderCompiledFile, outBuffer);
+		platformLayer::messageBox::showMessageBoxFatal("direct3d12Graphics::loadShaders: Failed to compile shaders.\n" + result.diagnostics);
 	}
 }
 
-void direct3d12Graphics::compileShader(LPCWSTR file, LPCWSTR entryPoint, LPCWSTR targetProfile, ComPtr<IDxcBlob>& outDxcBlob)
+bool direct3d12Graphics::compileShader(const sShaderDesc& desc, std::vector<uint8_t>& outBinary, std::string& outErrors)
 {
-	std::string errorMessage;
+	const std::wstring file(desc.sourceFile.begin(), desc.sourceFile.end());
+	const std::wstring entryPoint(desc.entryPoint.begin(), desc.entryPoint.end());
+	const std::wstring targetProfile(desc.profile.begin(), desc.profile.end());
+
+	// Defines are NAME or NAME=VALUE
+	std::vector<std::wstring> defineStrings;
+	defineStrings.reserve(desc.defines.size() * 2);
+	std::vector<DxcDefine> defines(desc.defines.size());
+	for (size_t i = 0; i < desc.defines.size(); ++i)
+	{
+		const std::string& define = desc.defines[i];
+		const size_t separator = define.find('=');
+		defineStrings.emplace_back(define.begin(), (separator == std::string::npos) ? define.end() : define.begin() + separator);
+		defines[i].Name = defineStrings.back().c_str();
+		if (separator != std::string::npos)
+		{
+			defineStrings.emplace_back(define.begin() + separator + 1, define.end());
+			defines[i].Value = defineStrings.back().c_str();
+		}
+	}
+
+	// Dxc compiler instances are not thread safe, each compile makes its own so shaders can compile on every job thread
+	ComPtr<IDxcLibrary> dxcLibrary;
+	ComPtr<IDxcCompiler> dxcCompiler;
+	createDxcLibrary(dxcLibrary);
+	createDxcCompiler(dxcCompiler);
 
-	if (compileShaderFromFile(dxcLibrary.Get(), dxcCompiler.Get(), file, entryPoint, targetProfile, outDxcBlob, errorMessage) == 0)
+	ComPtr<IDxcBlob> blob;
+	if (compileShaderFromFile(dxcLibrary.Get(), dxcCompiler.Get(), file.c_str(), entryPoint.c_str(), targetProfile.c_str(), defines.data(),
+		static_cast<uint32_t>(defines.size()), blob, outErrors) == 0)
 	{
-		platformLayer::messageBox::showMessageBoxFatal("direct3d12Graphics::compileShader: Failed to compile shader. " + errorMessage);
+		return false;
 	}
+
+	const uint8_t* const blobData = static_cast<const uint8_t*>(blob->GetBufferPointer());
+	outBinary.assign(blobData, blobData + blob->GetBufferSize());
+	return true;
 }
 
 void direct3d12Graphics::waitForGPU()
@@ -897,10 +1128,23 @@ void direct3d12Graphics::waitForGPU()
 	{
 		waitForFence(graphicsFence.Get(), eventHandle, graphicsFenceValues[i], maxFenceWaitDurationMs);
 	}
+
+	// Wait for uploads to finish executing on the GPU
+	if (uploadFence != nullptr)
+	{
+		uint64_t lastUploadFenceValue = 0;
+		{
+			std::lock_guard<std::mutex> lock(uploadMutex);
+			lastUploadFenceValue = uploadFenceValue;
+		}
+		waitForFence(uploadFence.Get(), eventHandle, lastUploadFenceValue, maxFenceWaitDurationMs);
+	}
 }
 
-void direct3d12Graphics::recordSurface(const direct3d12Surface* surface, ID3D12GraphicsCommandList6* commandList, const uint32_t renderDataCount, const struct sRenderData* const* renderData, const matrix4x4* const viewProjection)
+void direct3d12Graphics::recordSurface(const direct3d12Surface* surface, ID3D12GraphicsCommandList6* commandList, const uint32_t renderDataCount, const struct sRenderData* const* renderData, const matrix4x4f* const viewProjection)
 {
+	PROFILE_SCOPE("recordSurface");
+
 	ID3D12Resource* const backBuffer = surface->renderTargetViews[surface->currentBackBufferIndex].Get();
 
 	D3D12_RESOURCE_BARRIER backBufferResourceStartTransitionBarrier = CD3DX12_RESOURCE_BARRIER::Transition(backBuffer, D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
@@ -930,22 +1174,64 @@ void direct3d12Graphics::recordSurface(const direct3d12Surface* surface, ID3D12G
 	commandList->SetGraphicsRootConstantBufferView(1, cameraConstantBuffer.GetGPUVirtualAddress());
 	cameraConstantBuffer.increment();
 
-	for (uint32_t i = 0; i < renderDataCount; ++i)
+	// Write every item's instance data in bulk in draw order, the item drawn ith is instance i
+	const uint32_t* const drawOrder = drawQueue.getIndices().data();
+	D3D12_GPU_VIRTUAL_ADDRESS instancesAddress = 0;
+	sInstanceData* const instances = allocateInstances(renderDataCount, instancesAddress);
+	jobSystem::parallelFor(renderDataCount, minInstancesPerJob, [renderData, viewProjection, drawOrder, instances](const uint32_t begin, const uint32_t end)
+		{
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				// Instance memory is write combined, the matrix is written once and never read back
+				const matrix4x4f worldViewProjectionMatrix = *renderData[drawOrder[i]]->pWorldMatrix * *viewProjection;
+				memcpy(instances[i].worldViewProjectionMatrix, worldViewProjectionMatrix.values, sizeof(instances[i].worldViewProjectionMatrix));
+			}
+		});
+
+	// Draw each run of items sharing a mesh with one instanced draw. Buffers are only bound when they differ from the bound ones
+	size_t boundVertexBufferView = SIZE_MAX;
+	size_t boundIndexBufferView = SIZE_MAX;
+	const sMeshResources* runMesh = nullptr;
+	uint32_t runStart = 0;
+	for (uint32_t i = 0; i <= renderDataCount; ++i)
 	{
-		// Update object constants
-		matrix4x4 worldViewProjectionMatrix = *renderData[i]->pWorldMatrix * *viewProjection;
-		sObjectConstantBuffer objectConstants = {};
-		// Copy matrix values cast to 32-bit floating point values
-		std::transform(std::begin(worldViewProjectionMatrix.values), std::end(worldViewProjectionMatrix.values), std::begin(objectConstants.worldViewProjectionMatrix), [](const double& value) {return static_cast<float>(value); });
-		objectConstantBuffer.update(&objectConstants, sizeof(objectConstants));
-		commandList->SetGraphicsRootConstantBufferView(0, objectConstantBuffer.GetGPUVirtualAddress());
-		objectConstantBuffer.increment();
+		const sMeshResources* const mesh = (i < renderDataCount) ? renderData[drawOrder[i]]->pMeshResources : nullptr;
+		if (mesh == runMesh)
+		{
+			continue;
+		}
+
+		if (runMesh != nullptr)
+		{
+			if (runMesh->vertexBufferViewHandle != boundVertexBufferView)
+			{
+				commandList->IASetVertexBuffers(0, 1, &vertexBufferViewStore[runMesh->vertexBufferViewHandle]);
+				boundVertexBufferView = runMesh->vertexBufferViewHandle;
+			}
+			if (runMesh->indexBufferViewHandle != boundIndexBufferView)
+			{
+				commandList->IASetIndexBuffer(&indexBufferViewStore[runMesh->indexBufferViewHandle]);
+				boundIndexBufferView = runMesh->indexBufferViewHandle;
+			}
+			commandList->SetGraphicsRootShaderResourceView(0, instancesAddress + (static_cast<UINT64>(runStart) * sizeof(sInstanceData)));
+			commandList->DrawIndexedInstanced(runMesh->indexCount, i - runStart, 0, 0, 0);
+		}
+
+		runMesh = mesh;
+		runStart = i;
 
-		// Draw
-		const sMeshResources* const mesh = renderData[i]->pMeshResources;
-		commandList->IASetVertexBuffers(0, 1, &vertexBufferViewStore[mesh->vertexBufferViewHandle]);
-		commandList->IASetIndexBuffer(&indexBufferViewStore[mesh->indexBufferViewHandle]);
-		commandList->DrawIndexedInstanced(mesh->indexCount, 1, 0, 0, 0);
+		// Meshes still waiting for room in the staging ring are not drawn yet. Their items end the runs either side, so skipping the run
+		// keeps draw and instance indices equal
+		if (mesh != nullptr)
+		{
+			const uint64_t meshUploadFenceValue = std::max(bufferUploadFenceValues[mesh->vertexBufferResourceHandle], bufferUploadFenceValues[mesh->indexBufferResourceHandle]);
+			if (meshUploadFenceValue == unsubmittedUploadFenceValue)
+			{
+				runMesh = nullptr;
+				continue;
+			}
+			frameUploadFenceValue = std::max(frameUploadFenceValue, meshUploadFenceValue);
+		}
 	}
 
 	D3D12_RESOURCE_BARRIER backBufferResourceEndTransitionBarrier = CD3DX12_RESOURCE_BARRIER::Transition(backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
@@ -957,20 +1243,191 @@ void direct3d12Graphics::presentSurface(direct3d12Surface* surface, const bool u
 	fatalIfFailed(surface->swapChain->Present(useVSync ? 1 : 0, ((tearingSupported) && (!useVSync)) ? DXGI_PRESENT_ALLOW_TEARING : 0));
 }
 
-void direct3d12Graphics::createDefaultBufferAndRecordCopyCommand(ID3D12GraphicsCommandList6* commandList, ID3D12Resource* copySrcBffer, UINT64 width,
-	size_t& outDefaultBufferResourceHandle)
+sInstanceData* direct3d12Graphics::allocateInstances(const uint32_t count, D3D12_GPU_VIRTUAL_ADDRESS& outAddress)
+{
+	sDirect3d12FrameInstances& instances = frameInstances[currentFrameIndex];
+	if ((instances.count + count) > instances.capacity)
+	{
+		if (instances.buffer.isValid())
+		{
+			instances.outgrownBuffers.push_back(instances.buffer);
+		}
+		instances.capacity = std::max({ minInstanceCapacity, instances.capacity * 2, count });
+		instances.buffer = allocateBuffer(eDirect3d12MemoryType::uploadBuffer, static_cast<UINT64>(instances.capacity) * sizeof(sInstanceData), D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT);
+		instances.count = 0;
+	}
+
+	const uint32_t firstInstance = instances.count;
+	instances.count += count;
+	outAddress = getBufferAddress(instances.buffer) + (static_cast<UINT64>(firstInstance) * sizeof(sInstanceData));
+	return reinterpret_cast<sInstanceData*>(getMappedData(instances.buffer)) + firstInstance;
+}
+
+sGpuAllocation direct3d12Graphics::allocateBuffer(const eDirect3d12MemoryType memoryType, const UINT64 width, const UINT64 alignment)
+{
+	sGpuAllocation allocation = memoryAllocator.allocate(static_cast<uint32_t>(memoryType), width, alignment);
+	if (!allocation.isValid())
+	{
+		platformLayer::messageBox::showMessageBoxFatal("direct3d12Graphics::allocateBuffer: failed to allocate gpu memory.");
+	}
+	return allocation;
+}
+
+void direct3d12Graphics::createDefaultBuffer(const UINT64 width, size_t& outDefaultBufferResourceHandle)
+{
+	bufferStore.emplace_back(allocateBuffer(eDirect3d12MemoryType::defaultBuffer, width, D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT));
+	bufferUploadFenceValues.emplace_back(unsubmittedUploadFenceValue);
+	outDefaultBufferResourceHandle = bufferStore.size() - 1;
+}
+
+bool direct3d12Graphics::stageUpload(const size_t destinationBufferHandle, const void* const data, const UINT64 width)
+{
+	if (width == 0)
+	{
+		// Nothing to copy, the buffer is ready
+		bufferUploadFenceValues[destinationBufferHandle] = 0;
+		return true;
+	}
+
+	const sGpuAllocation& destinationBuffer = bufferStore[destinationBufferHandle];
+
+	// Copies larger than the whole ring get upload memory of their own, freed when the submission retires
+	if (width > stagingRegions.getCapacity())
+	{
+		beginUploadCommands();
+		const sGpuAllocation& uploadBuffer = currentUploadSubmission.uploadBuffers.emplace_back(allocateBuffer(eDirect3d12MemoryType::uploadBuffer, width, D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT));
+		memcpy(getMappedData(uploadBuffer), data, width);
+		uploadCommandList->CopyBufferRegion(getBufferResource(destinationBuffer), destinationBuffer.offset, getBufferResource(uploadBuffer), uploadBuffer.offset, width);
+		recordedUploadBuffers.push_back(destinationBufferHandle);
+		return true;
+	}
+
+	uint64_t stagingOffset = 0;
+	if (!stagingRegions.allocate(width, D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT, stagingOffset))
+	{
+		return false;
+	}
+
+	beginUploadCommands();
+	memcpy(getMappedData(stagingBuffer) + stagingOffset, data, width);
+	uploadCommandList->CopyBufferRegion(getBufferResource(destinationBuffer), destinationBuffer.offset, getBufferResource(stagingBuffer), stagingBuffer.offset + stagingOffset, width);
+	recordedUploadBuffers.push_back(destinationBufferHandle);
+	return true;
+}
+
+void direct3d12Graphics::queueUpload(const size_t destinationBufferHandle, const void* const data, const UINT64 width, const uint64_t uploadId)
+{
+	// Uploads already waiting go first so uploads complete in the order they were made
+	if ((pendingUploads.empty()) && (stageUpload(destinationBufferHandle, data, width)))
+	{
+		return;
+	}
+
+	sDirect3d12PendingUpload& pendingUpload = pendingUploads.emplace_back();
+	pendingUpload.destinationBufferHandle = destinationBufferHandle;
+	pendingUpload.uploadId = uploadId;
+	const uint8_t* const bytes = static_cast<const uint8_t*>(data);
+	pendingUpload.data.assign(bytes, bytes + width);
+}
+
+void direct3d12Graphics::beginUploadCommands()
+{
+	if (uploadCommandListOpen)
+	{
+		return;
+	}
+
+	// Reuse a command allocator the gpu has finished with. Another is created while every one is in flight
+	const uint64_t completedFenceValue = uploadFence->GetCompletedValue();
+	currentUploadAllocator = uploadCommandAllocators.size();
+	for (size_t i = 0; i < uploadCommandAllocators.size(); ++i)
+	{
+		if (uploadCommandAllocators[i].fenceValue <= completedFenceValue)
+		{
+			currentUploadAllocator = i;
+			break;
+		}
+	}
+
+	if (currentUploadAllocator == uploadCommandAllocators.size())
+	{
+		createCommandAllocator(device.Get(), D3D12_COMMAND_LIST_TYPE_COPY, uploadCommandAllocators.emplace_back().commandAllocator);
+	}
+
+	ID3D12CommandAllocator* const uploadCommandAllocator = uploadCommandAllocators[currentUploadAllocator].commandAllocator.Get();
+	fatalIfFailed(uploadCommandAllocator->Reset());
+	fatalIfFailed(uploadCommandList->Reset(uploadCommandAllocator, nullptr));
+	uploadCommandListOpen = true;
+}
+
+void direct3d12Graphics::submitUploads()
 {
-	ComPtr<ID3D12Resource>& defaultBuffer = resourceStore.emplace_back(nullptr);
-	outDefaultBufferResourceHandle = resourceStore.size() - 1;
-	createCommittedBuffer(device.Get(), D3D12_HEAP_TYPE_DEFAULT, width, D3D12_RESOURCE_STATE_COPY_DEST, defaultBuffer);
-	commandList->CopyBufferRegion(defaultBuffer.Get(), 0, copySrcBffer, 0, width);
+	if (!uploadCommandListOpen)
+	{
+		return;
+	}
+
+	fatalIfFailed(uploadCommandList->Close());
+	ID3D12CommandList* commandLists[] = { uploadCommandList.Get() };
+	copyQueue->ExecuteCommandLists(_countof(commandLists), commandLists);
+	++uploadFenceValue;
+	fatalIfFailed(copyQueue->Signal(uploadFence.Get(), uploadFenceValue));
+	uploadCommandListOpen = false;
+
+	// Tag everything the submission copies from and to with its fence value
+	for (const size_t bufferHandle : recordedUploadBuffers)
+	{
+		bufferUploadFenceValues[bufferHandle] = uploadFenceValue;
+	}
+	recordedUploadBuffers.clear();
+	uploadCommandAllocators[currentUploadAllocator].fenceValue = uploadFenceValue;
+	stagingRegions.submit(uploadFenceValue);
+	currentUploadSubmission.fenceValue = uploadFenceValue;
+	currentUploadSubmission.completedUploadId = pendingUploads.empty() ? lastUploadId : (pendingUploads.front().uploadId - 1);
+	uploadSubmissions.push_back(std::move(currentUploadSubmission));
+	currentUploadSubmission = {};
+}
+
+void direct3d12Graphics::retireUploads()
+{
+	const uint64_t completedFenceValue = uploadFence->GetCompletedValue();
+	stagingRegions.retire(completedFenceValue);
+	while ((!uploadSubmissions.empty()) && (uploadSubmissions.front().fenceValue <= completedFenceValue))
+	{
+		sDirect3d12UploadSubmission& submission = uploadSubmissions.front();
+		for (sGpuAllocation& uploadBuffer : submission.uploadBuffers)
+		{
+			memoryAllocator.free(uploadBuffer);
+		}
+		completedUploadId = submission.completedUploadId;
+		uploadSubmissions.pop_front();
+	}
+
+	// With nothing in flight or waiting every upload so far is complete, including any that had nothing to copy
+	if ((uploadSubmissions.empty()) && (pendingUploads.empty()) && (!uploadCommandListOpen))
+	{
+		completedUploadId = lastUploadId;
+	}
+}
+
+void direct3d12Graphics::flushPendingUploads()
+{
+	while (!pendingUploads.empty())
+	{
+		const sDirect3d12PendingUpload& pendingUpload = pendingUploads.front();
+		if (!stageUpload(pendingUpload.destinationBufferHandle, pendingUpload.data.data(), pendingUpload.data.size()))
+		{
+			break;
+		}
+		pendingUploads.pop_front();
+	}
 }
 
 void direct3d12Graphics::createVertexBufferView(const size_t vertexBufferResourceHandle, const UINT vertexStride, const UINT bufferWidth, size_t& outVertexBufferViewHandle)
 {
 	D3D12_VERTEX_BUFFER_VIEW& vertexBufferView = vertexBufferViewStore.emplace_back();
 	outVertexBufferViewHandle = vertexBufferViewStore.size() - 1;
-	vertexBufferView.BufferLocation = resourceStore[vertexBufferResourceHandle]->GetGPUVirtualAddress();
+	vertexBufferView.BufferLocation = getBufferAddress(bufferStore[vertexBufferResourceHandle]);
 	vertexBufferView.StrideInBytes = vertexStride;
 	vertexBufferView.SizeInBytes = bufferWidth;
 }
@@ -979,7 +1436,7 @@ void direct3d12Graphics::createIndexBufferView(const size_t indexBufferResourceH
 {
 	D3D12_INDEX_BUFFER_VIEW& indexBufferView = indexBufferViewStore.emplace_back();
 	outIndexBufferViewHandle = indexBufferViewStore.size() - 1;
-	indexBufferView.BufferLocation = resourceStore[indexBufferResourceHandle]->GetGPUVirtualAddress();
+	indexBufferView.BufferLocation = getBufferAddress(bufferStore[indexBufferResourceHandle]);
 	indexBufferView.Format = format;
 	indexBufferView.SizeInBytes = bufferWidth;
 }
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <mutex>
 #include "platform/graphics/abstract/graphics.h"
+#include "platform/graphics/shaderBuild.h"
+#include "platform/graphics/gpuAllocator.h"
+#include "platform/graphics/stagingRing.h"
+#include "platform/graphics/renderQueue.h"
 
 struct sDescriptorSizes
 {
@@ -10,6 +15,16 @@ struct sDescriptorSizes
 	UINT samplerDescriptorSize;
 };
 
+// Memory types of the gpu allocator. Each is a heap type holding only buffers
+enum class eDirect3d12MemoryType : uint32_t
+{
+	// Gpu only, e.g. vertex and index buffers
+	defaultBuffer = 0,
+	// Cpu writable and persistently mapped, e.g. copy sources
+	uploadBuffer,
+	count
+};
+
 // Constant buffer implemented as a ring buffer, storing versions of constant data at 256 byte intervals
 class direct3d12ConstantBuffer
 {
@@ -38,6 +53,42 @@ private:
 	uint32_t getOffsetToCurrentPosition();
 };
 
+// Upload waiting for space in the staging ring. The data is copied so the caller can free its own
+struct sDirect3d12PendingUpload
+{
+	size_t destinationBufferHandle = 0;
+	uint64_t uploadId = 0;
+	std::vector<uint8_t> data;
+};
+
+// Upload command list submission that has not been retired yet
+struct sDirect3d12UploadSubmission
+{
+	uint64_t fenceValue = 0;
+	// Every upload id up to this one is complete once the fence value is reached
+	uint64_t completedUploadId = 0;
+	// Upload buffers of copies too large for the staging ring, freed when the submission retires
+	std::vector<sGpuAllocation> uploadBuffers;
+};
+
+// Upload command allocator, free to reset once the upload fence reaches its fence value
+struct sDirect3d12UploadAllocator
+{
+	Microsoft::WRL::ComPtr<ID3D12CommandAllocator> commandAllocator;
+	uint64_t fenceValue = 0;
+};
+
+// Instance data written by the cpu each frame and read by the vertex shader through SV_InstanceID. Outgrown buffers are kept until the
+// frame slot is reused because commands recorded earlier in the frame still read them
+struct sDirect3d12FrameInstances
+{
+	sGpuAllocation buffer = {};
+	uint32_t capacity = 0;
+	uint32_t count = 0;
+	std::vector<sGpuAllocation> outgrownBuffers;
+};
+
+struct sInstanceData;
 class direct3d12Surface;
 
 class direct3d12Graphics : public graphics
@@ -59,19 +110,54 @@ private:
 	HANDLE eventHandle = {};
 	uint32_t currentFrameIndex = 0;
 
-	Microsoft::WRL::ComPtr<IDxcLibrary> dxcLibrary;
-	Microsoft::WRL::ComPtr<IDxcCompiler> dxcCompiler;
-
 	Microsoft::WRL::ComPtr<ID3D12RootSignature> rootSignature;
 	Microsoft::WRL::ComPtr<ID3D12PipelineState> graphicsPipelineState;
 
-	std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> resourceStore;
+	// Buffers are ranges of a few large heaps instead of one committed resource each
+	gpuAllocator memoryAllocator;
+	std::vector<sGpuAllocation> bufferStore;
 	std::vector<D3D12_VERTEX_BUFFER_VIEW> vertexBufferViewStore;
 	std::vector<D3D12_INDEX_BUFFER_VIEW> indexBufferViewStore;
 
-	direct3d12ConstantBuffer objectConstantBuffer = {};
+	// Uploads are copied through a persistently mapped staging ring and retired by fence value, so loading never waits on the gpu. Uploads
+	// that do not fit while the ring is in flight wait in pendingUploads and are submitted by beginFrame as regions retire. Copies execute on
+	// the copy queue, and the graphics queue waits on the upload fence only when a frame first draws a buffer whose copy may be running.
+	// Meshes may be loaded from any thread while the render thread records frames, so uploadMutex guards every member from bufferStore to
+	// graphicsQueueUploadFenceValue. Loads take it for their whole call and frames for their upload work and recording
+	std::mutex uploadMutex;
+	static constexpr UINT64 stagingRingSize = 32 * 1024 * 1024;
+	sGpuAllocation stagingBuffer = {};
+	stagingRing stagingRegions;
+	std::deque<sDirect3d12PendingUpload> pendingUploads;
+	std::deque<sDirect3d12UploadSubmission> uploadSubmissions;
+	sDirect3d12UploadSubmission currentUploadSubmission = {};
+	std::vector<sDirect3d12UploadAllocator> uploadCommandAllocators;
+	size_t currentUploadAllocator = 0;
+	Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList6> uploadCommandList;
+	bool uploadCommandListOpen = false;
+	Microsoft::WRL::ComPtr<ID3D12Fence> uploadFence;
+	uint64_t uploadFenceValue = 0;
+	uint64_t lastUploadId = 0;
+	uint64_t completedUploadId = 0;
+	// Upload fence value signalled after each bufferStore buffer's copy, UINT64_MAX until the copy is submitted
+	std::vector<uint64_t> bufferUploadFenceValues;
+	// Buffers copied by the upload command list being recorded
+	std::vector<size_t> recordedUploadBuffers;
+	// Highest upload fence value needed by the buffers drawn this frame, and the highest the graphics queue has already waited for
+	uint64_t frameUploadFenceValue = 0;
+	uint64_t graphicsQueueUploadFenceValue = 0;
+
+	// Items of the frame in draw order, sorted once and recorded for every surface
+	renderQueue drawQueue;
+
+	// One instance buffer per back buffer, so the cpu writes a frame's instances while the gpu reads the previous frame's
+	std::vector<sDirect3d12FrameInstances> frameInstances;
 	direct3d12ConstantBuffer cameraConstantBuffer = {};
 
+public:
+	// Dxc, safe to use without a device, e.g. to precompile shaders offline
+	static void getShaderCompiler(sShaderCompiler& outCompiler);
+
 public:
 	direct3d12Graphics();
 	~direct3d12Graphics() final = default;
@@ -85,20 +171,40 @@ public:
 	void resizeSurface(graphicsSurface* surface, uint32_t width, uint32_t height) final;
 	void setSurfaceUseVSync(graphicsSurface* surface, const bool inUseVSync) final;
 	void beginFrame() final;
-	void render(const uint32_t numSurfaces, graphicsSurface* const* surfaces, const uint32_t renderDataCount, const sRenderData* const* renderData, const matrix4x4* const viewProjection) final;
+	void render(const uint32_t numSurfaces, graphicsSurface* const* surfaces, const uint32_t renderDataCount, const sRenderData* const* renderData, const matrix4x4f* const viewProjection) final;
 	void endFrame(const uint32_t numRenderedSurfaces, graphicsSurface* const* renderedSurfaces) final;
 	//void loadMesh(const size_t vertexCount, const sVertexPos3Norm3Col4UV2* const vertices, const size_t indexCount, const uint32_t* const indices, sMeshResources& outMeshResource) final;
-	void loadMeshes(const uint32_t meshCount, const size_t* vertexCounts, const sVertexPos3Norm3Col4UV2(*vertices)[], const size_t* const indexCounts, const uint32_t(*indices)[], sMeshResources** const outMeshResources) final;
+	sUploadToken loadMeshes(const uint32_t meshCount, const size_t* vertexCounts, const sVertexPos3Norm3Col4UV2(*vertices)[], const size_t* const indexCounts, const uint32_t(*indices)[], sMeshResources** const outMeshResources) final;
+	bool isUploadComplete(const sUploadToken token) final;
+	void getMemoryStats(sGpuMemoryStats& outStats) const final;
 
 private:
-	void loadShader(const std::string& shaderSourceFile, LPCWSTR entryPoint, LPCWSTR targetProfile, std::vector<uint8_t>& outBuffer);
-	void compileShader(LPCWSTR file, LPCWSTR entryPoint, LPCWSTR targetProfile, Microsoft::WRL::ComPtr<IDxcBlob>& outDxcBlob);
+	// Loads the shaders through the shader cache, compiling any that changed in parallel. Fails fatally with every shader's diagnostics
+	void loadShaders(std::span<const sShaderDesc> descs, std::vector<std::vector<uint8_t>>& outBuffers);
+	static bool compileShader(const sShaderDesc& desc, std::vector<uint8_t>& outBinary, std::string& outErrors);
 	// Waits on the CPU thread for all GPU work to finish
 	void waitForGPU();
-	void recordSurface(const direct3d12Surface* surface, ID3D12GraphicsCommandList6* commandList, const uint32_t renderDataCount, const sRenderData* const* renderData, const matrix4x4* const viewProjection);
+	void recordSurface(const direct3d12Surface* surface, ID3D12GraphicsCommandList6* commandList, const uint32_t renderDataCount, const sRenderData* const* renderData, const matrix4x4f* const viewProjection);
+	// Reserves count instances in the current frame's instance buffer, growing it if it is full. outAddress receives the gpu address of the
+	// first reserved instance
+	sInstanceData* allocateInstances(const uint32_t count, D3D12_GPU_VIRTUAL_ADDRESS& outAddress);
 	void presentSurface(direct3d12Surface* surface, const bool useVSync, const bool tearingSupported);
-	void createDefaultBufferAndRecordCopyCommand(ID3D12GraphicsCommandList6* commandList, ID3D12Resource* copySrcBffer, UINT64 width, size_t& outDefaultBufferResourceHandle);
+	// Fails fatally if the memory cannot be allocated
+	sGpuAllocation allocateBuffer(const eDirect3d12MemoryType memoryType, const UINT64 width, const UINT64 alignment);
+	void createDefaultBuffer(const UINT64 width, size_t& outDefaultBufferResourceHandle);
+	// Copies data into staging memory and records its copy to the default buffer. Returns false if the staging ring has no room until earlier
+	// uploads retire
+	bool stageUpload(const size_t destinationBufferHandle, const void* const data, const UINT64 width);
+	// Stages the upload, or keeps a copy of the data in pendingUploads if the staging ring is full
+	void queueUpload(const size_t destinationBufferHandle, const void* const data, const UINT64 width, const uint64_t uploadId);
+	// Starts recording the upload command list with a command allocator the gpu has finished with
+	void beginUploadCommands();
+	// Executes the recorded upload commands on the copy queue and signals the upload fence
+	void submitUploads();
+	// Frees the staging memory and upload buffers of submissions the gpu has finished
+	void retireUploads();
+	// Stages as many pending uploads as the staging ring has room for
+	void flushPendingUploads();
 	void createVertexBufferView(const size_t vertexBufferResourceHandle, const UINT vertexStride, const UINT bufferWidth, size_t& outVertexBufferViewHandle);
 	void createIndexBufferView(const size_t indexBufferResourceHandle, const DXGI_FORMAT format, const UINT bufferWidth, size_t& outIndexBufferViewHandle);
-};
-
+};
\ No newline at end of file
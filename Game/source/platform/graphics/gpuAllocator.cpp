@@ -0,0 +1,464 @@
+#include "pch.h"
+#include "gpuAllocator.h"
+#include "memory/memoryTracker.h"
+
+#include <bit>
+
+// Sizes below this are mapped linearly into the first first level, one second level class per minAlignment bytes
+static constexpr uint64_t smallSizeLimit = gpuAllocator::minAlignment * 32;
+static constexpr uint32_t smallSizeLimitLog2 = 9;
+static_assert((1ull << smallSizeLimitLog2) == smallSizeLimit, "gpuAllocator: smallSizeLimitLog2 does not match smallSizeLimit");
+
+static uint64_t alignUp(const uint64_t value, const uint64_t alignment)
+{
+	return (value + (alignment - 1)) & ~(alignment - 1);
+}
+
+gpuAllocator::~gpuAllocator()
+{
+	shutdown();
+}
+
+void gpuAllocator::init(const sGpuAllocatorDesc& desc)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::graphics);
+	assert(desc.createHeap && desc.destroyHeap && "gpuAllocator::init: heap functions are required");
+
+	std::lock_guard<std::mutex> lock(mutex);
+	settings = desc;
+	settings.heapSize = alignUp(std::max(settings.heapSize, smallSizeLimit), minAlignment);
+
+	pools.assign(desc.memoryTypeCount, sPool());
+	for (sPool& pool : pools)
+	{
+		for (uint32_t (&freeLists)[secondLevelCount] : pool.freeLists)
+		{
+			std::fill(std::begin(freeLists), std::end(freeLists), invalidIndex);
+		}
+	}
+}
+
+void gpuAllocator::shutdown()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	for (const sHeap& heap : heaps)
+	{
+		if (heap.handle != nullptr)
+		{
+			settings.destroyHeap(heap.memoryType, heap.handle);
+		}
+	}
+
+	pools.clear();
+	blocks.clear();
+	unusedBlocks.clear();
+	heaps.clear();
+	unusedHeaps.clear();
+}
+
+sGpuAllocation gpuAllocator::allocate(const uint32_t memoryType, const uint64_t size, const uint64_t alignment)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::graphics);
+	std::lock_guard<std::mutex> lock(mutex);
+	assert((memoryType < pools.size()) && "gpuAllocator::allocate: invalid memory type");
+
+	const uint64_t alignedSize = alignUp(std::max<uint64_t>(size, 1), minAlignment);
+	const uint64_t blockAlignment = std::bit_ceil(std::max(alignment, minAlignment));
+
+	sGpuAllocation allocation = {};
+	allocation.memoryType = memoryType;
+
+	if (alignedSize >= settings.dedicatedThreshold)
+	{
+		const uint32_t heapIndex = createHeap(memoryType, alignedSize, true);
+		if (heapIndex == invalidIndex)
+		{
+			return {};
+		}
+
+		sHeap& heap = heaps[heapIndex];
+		heap.usedBytes = alignedSize;
+		heap.allocationCount = 1;
+		allocation.heap = heap.handle;
+		allocation.size = alignedSize;
+		allocation.heapIndex = heapIndex;
+		allocation.block = invalidIndex;
+		return allocation;
+	}
+
+	// A block this large fits the allocation wherever the aligned offset lands in it
+	const uint64_t searchSize = alignedSize + (blockAlignment - minAlignment);
+	sPool& pool = pools[memoryType];
+	uint32_t block = findFreeBlock(pool, searchSize);
+	if (block == invalidIndex)
+	{
+		const uint32_t heapIndex = createHeap(memoryType, std::max(settings.heapSize, alignUp(searchSize, minAlignment)), false);
+		if (heapIndex == invalidIndex)
+		{
+			return {};
+		}
+
+		block = findFreeBlock(pool, searchSize);
+		assert(block != invalidIndex);
+	}
+	removeFreeBlock(pool, block);
+
+	sHeap& heap = heaps[blocks[block].heapIndex];
+	if (heap.allocationCount == 0)
+	{
+		--pool.emptyHeapCount;
+	}
+
+	// Alignment padding in front of the allocation stays free
+	const uint64_t alignedOffset = alignUp(blocks[block].offset, blockAlignment);
+	if (alignedOffset != blocks[block].offset)
+	{
+		const uint32_t padding = createBlock();
+		sBlock& paddingBlock = blocks[padding];
+		sBlock& allocatedBlock = blocks[block];
+		paddingBlock.offset = allocatedBlock.offset;
+		paddingBlock.size = alignedOffset - allocatedBlock.offset;
+		paddingBlock.heapIndex = allocatedBlock.heapIndex;
+		paddingBlock.previousPhysical = allocatedBlock.previousPhysical;
+		paddingBlock.nextPhysical = block;
+		if (paddingBlock.previousPhysical != invalidIndex)
+		{
+			blocks[paddingBlock.previousPhysical].nextPhysical = padding;
+		}
+
+		allocatedBlock.previousPhysical = padding;
+		allocatedBlock.offset = alignedOffset;
+		allocatedBlock.size -= paddingBlock.size;
+		insertFreeBlock(pool, padding);
+	}
+
+	// The rest of the block after the allocation goes back to the free lists
+	if (blocks[block].size > alignedSize)
+	{
+		const uint32_t remainder = createBlock();
+		sBlock& remainderBlock = blocks[remainder];
+		sBlock& allocatedBlock = blocks[block];
+		remainderBlock.offset = allocatedBlock.offset + alignedSize;
+		remainderBlock.size = allocatedBlock.size - alignedSize;
+		remainderBlock.heapIndex = allocatedBlock.heapIndex;
+		remainderBlock.previousPhysical = block;
+		remainderBlock.nextPhysical = allocatedBlock.nextPhysical;
+		if (remainderBlock.nextPhysical != invalidIndex)
+		{
+			blocks[remainderBlock.nextPhysical].previousPhysical = remainder;
+		}
+
+		allocatedBlock.nextPhysical = remainder;
+		allocatedBlock.size = alignedSize;
+		insertFreeBlock(pool, remainder);
+	}
+
+	const sBlock& allocatedBlock = blocks[block];
+	heap.usedBytes += allocatedBlock.size;
+	++heap.allocationCount;
+
+	allocation.heap = heap.handle;
+	allocation.offset = allocatedBlock.offset;
+	allocation.size = allocatedBlock.size;
+	allocation.heapIndex = allocatedBlock.heapIndex;
+	allocation.block = block;
+	return allocation;
+}
+
+void gpuAllocator::free(sGpuAllocation& allocation)
+{
+	if (!allocation.isValid())
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (allocation.block == invalidIndex)
+	{
+		destroyHeap(allocation.heapIndex);
+		allocation = {};
+		return;
+	}
+
+	sPool& pool = pools[allocation.memoryType];
+	uint32_t block = allocation.block;
+	sHeap& heap = heaps[blocks[block].heapIndex];
+	heap.usedBytes -= blocks[block].size;
+	--heap.allocationCount;
+
+	// Merge with free neighbours so free space does not stay split after the allocations between it are gone
+	const uint32_t previous = blocks[block].previousPhysical;
+	if ((previous != invalidIndex) && blocks[previous].free)
+	{
+		removeFreeBlock(pool, previous);
+		blocks[previous].size += blocks[block].size;
+		blocks[previous].nextPhysical = blocks[block].nextPhysical;
+		if (blocks[previous].nextPhysical != invalidIndex)
+		{
+			blocks[blocks[previous].nextPhysical].previousPhysical = previous;
+		}
+		releaseBlock(block);
+		block = previous;
+	}
+
+	const uint32_t next = blocks[block].nextPhysical;
+	if ((next != invalidIndex) && blocks[next].free)
+	{
+		removeFreeBlock(pool, next);
+		blocks[block].size += blocks[next].size;
+		blocks[block].nextPhysical = blocks[next].nextPhysical;
+		if (blocks[block].nextPhysical != invalidIndex)
+		{
+			blocks[blocks[block].nextPhysical].previousPhysical = block;
+		}
+		releaseBlock(next);
+	}
+
+	// An empty heap is one free block. Only one empty heap is kept per memory type
+	if (heap.allocationCount == 0)
+	{
+		if (pool.emptyHeapCount > 0)
+		{
+			releaseBlock(block);
+			destroyHeap(allocation.heapIndex);
+			allocation = {};
+			return;
+		}
+		++pool.emptyHeapCount;
+	}
+
+	insertFreeBlock(pool, block);
+	allocation = {};
+}
+
+void gpuAllocator::getStats(sGpuMemoryStats& outStats) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	outStats = {};
+	for (const sHeap& heap : heaps)
+	{
+		addStats(heap, outStats);
+	}
+
+	for (const sBlock& block : blocks)
+	{
+		if (block.free)
+		{
+			++outStats.freeBlockCount;
+			outStats.freeBytes += block.size;
+			outStats.largestFreeBlock = std::max(outStats.largestFreeBlock, block.size);
+		}
+	}
+}
+
+void gpuAllocator::getStats(const uint32_t memoryType, sGpuMemoryStats& outStats) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	outStats = {};
+	for (const sHeap& heap : heaps)
+	{
+		if (heap.memoryType == memoryType)
+		{
+			addStats(heap, outStats);
+		}
+	}
+
+	for (const sBlock& block : blocks)
+	{
+		if (block.free && (heaps[block.heapIndex].memoryType == memoryType))
+		{
+			++outStats.freeBlockCount;
+			outStats.freeBytes += block.size;
+			outStats.largestFreeBlock = std::max(outStats.largestFreeBlock, block.size);
+		}
+	}
+}
+
+void gpuAllocator::mapSize(const uint64_t size, uint32_t& outFirstLevel, uint32_t& outSecondLevel)
+{
+	if (size < smallSizeLimit)
+	{
+		outFirstLevel = 0;
+		outSecondLevel = static_cast<uint32_t>(size / minAlignment);
+		return;
+	}
+
+	const uint32_t highestBit = static_cast<uint32_t>(std::bit_width(size) - 1);
+	outFirstLevel = highestBit - smallSizeLimitLog2 + 1;
+	outSecondLevel = static_cast<uint32_t>(size >> (highestBit - secondLevelLog2)) - secondLevelCount;
+}
+
+uint32_t gpuAllocator::findFreeBlock(sPool& pool, const uint64_t size) const
+{
+	// Rounding up to the next class boundary means any block in the class found is large enough
+	uint64_t searchSize = size;
+	if (searchSize >= smallSizeLimit)
+	{
+		const uint32_t highestBit = static_cast<uint32_t>(std::bit_width(searchSize) - 1);
+		searchSize += (1ull << (highestBit - secondLevelLog2)) - 1;
+	}
+
+	uint32_t firstLevel = 0;
+	uint32_t secondLevel = 0;
+	mapSize(searchSize, firstLevel, secondLevel);
+	if (firstLevel >= firstLevelCount)
+	{
+		return invalidIndex;
+	}
+
+	uint32_t secondLevelMap = pool.secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+	if (secondLevelMap == 0)
+	{
+		const uint64_t firstLevelMap = (firstLevel + 1 < 64) ? (pool.firstLevelBitmap & (~0ull << (firstLevel + 1))) : 0;
+		if (firstLevelMap == 0)
+		{
+			return invalidIndex;
+		}
+
+		firstLevel = static_cast<uint32_t>(std::countr_zero(firstLevelMap));
+		secondLevelMap = pool.secondLevelBitmaps[firstLevel];
+	}
+
+	secondLevel = static_cast<uint32_t>(std::countr_zero(secondLevelMap));
+	return pool.freeLists[firstLevel][secondLevel];
+}
+
+void gpuAllocator::insertFreeBlock(sPool& pool, const uint32_t block)
+{
+	uint32_t firstLevel = 0;
+	uint32_t secondLevel = 0;
+	mapSize(blocks[block].size, firstLevel, secondLevel);
+	assert(firstLevel < firstLevelCount);
+
+	const uint32_t head = pool.freeLists[firstLevel][secondLevel];
+	blocks[block].free = true;
+	blocks[block].previousFree = invalidIndex;
+	blocks[block].nextFree = head;
+	if (head != invalidIndex)
+	{
+		blocks[head].previousFree = block;
+	}
+
+	pool.freeLists[firstLevel][secondLevel] = block;
+	pool.firstLevelBitmap |= (1ull << firstLevel);
+	pool.secondLevelBitmaps[firstLevel] |= (1u << secondLevel);
+}
+
+void gpuAllocator::removeFreeBlock(sPool& pool, const uint32_t block)
+{
+	uint32_t firstLevel = 0;
+	uint32_t secondLevel = 0;
+	mapSize(blocks[block].size, firstLevel, secondLevel);
+
+	sBlock& freeBlock = blocks[block];
+	if (freeBlock.previousFree != invalidIndex)
+	{
+		blocks[freeBlock.previousFree].nextFree = freeBlock.nextFree;
+	}
+	else
+	{
+		pool.freeLists[firstLevel][secondLevel] = freeBlock.nextFree;
+	}
+
+	if (freeBlock.nextFree != invalidIndex)
+	{
+		blocks[freeBlock.nextFree].previousFree = freeBlock.previousFree;
+	}
+
+	if (pool.freeLists[firstLevel][secondLevel] == invalidIndex)
+	{
+		pool.secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+		if (pool.secondLevelBitmaps[firstLevel] == 0)
+		{
+			pool.firstLevelBitmap &= ~(1ull << firstLevel);
+		}
+	}
+
+	freeBlock.free = false;
+	freeBlock.previousFree = invalidIndex;
+	freeBlock.nextFree = invalidIndex;
+}
+
+uint32_t gpuAllocator::createBlock()
+{
+	if (!unusedBlocks.empty())
+	{
+		const uint32_t block = unusedBlocks.back();
+		unusedBlocks.pop_back();
+		blocks[block] = {};
+		return block;
+	}
+
+	blocks.emplace_back();
+	return static_cast<uint32_t>(blocks.size() - 1);
+}
+
+void gpuAllocator::releaseBlock(const uint32_t block)
+{
+	blocks[block] = {};
+	unusedBlocks.push_back(block);
+}
+
+uint32_t gpuAllocator::createHeap(const uint32_t memoryType, const uint64_t size, const bool dedicated)
+{
+	void* const handle = settings.createHeap(memoryType, size, dedicated);
+	if (handle == nullptr)
+	{
+		return invalidIndex;
+	}
+
+	uint32_t heapIndex = 0;
+	if (!unusedHeaps.empty())
+	{
+		heapIndex = unusedHeaps.back();
+		unusedHeaps.pop_back();
+	}
+	else
+	{
+		heapIndex = static_cast<uint32_t>(heaps.size());
+		heaps.emplace_back();
+	}
+
+	sHeap& heap = heaps[heapIndex];
+	heap = {};
+	heap.handle = handle;
+	heap.size = size;
+	heap.memoryType = memoryType;
+	heap.dedicated = dedicated;
+
+	// A shared heap starts as one free block covering all of it
+	if (!dedicated)
+	{
+		const uint32_t block = createBlock();
+		blocks[block].size = size;
+		blocks[block].heapIndex = heapIndex;
+		insertFreeBlock(pools[memoryType], block);
+		++pools[memoryType].emptyHeapCount;
+	}
+	return heapIndex;
+}
+
+void gpuAllocator::destroyHeap(const uint32_t heapIndex)
+{
+	sHeap& heap = heaps[heapIndex];
+	settings.destroyHeap(heap.memoryType, heap.handle);
+	heap = {};
+	unusedHeaps.push_back(heapIndex);
+}
+
+void gpuAllocator::addStats(const sHeap& heap, sGpuMemoryStats& outStats) const
+{
+	if (heap.handle == nullptr)
+	{
+		return;
+	}
+
+	++outStats.heapCount;
+	outStats.reservedBytes += heap.size;
+	outStats.usedBytes += heap.usedBytes;
+	outStats.allocationCount += heap.allocationCount;
+	if (heap.dedicated)
+	{
+		++outStats.dedicatedHeapCount;
+	}
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <mutex>
+
+// Creates the backend object for a heap of size bytes of a memory type, e.g. an ID3D12Heap or a VkDeviceMemory. dedicated is true for a heap
+// holding a single large allocation. Returns nullptr on failure
+using gpuHeapCreateFunction = std::function<void*(const uint32_t memoryType, const uint64_t size, const bool dedicated)>;
+using gpuHeapDestroyFunction = std::function<void(const uint32_t memoryType, void* heap)>;
+
+struct sGpuAllocatorDesc
+{
+	// Memory types are backend defined, e.g. vulkan memory type indices
+	uint32_t memoryTypeCount = 1;
+	// Size of each shared heap. Heaps are created as memory types run out of space
+	uint64_t heapSize = 64ull * 1024 * 1024;
+	// Allocations at least this large get a heap of their own instead of taking most of a shared one
+	uint64_t dedicatedThreshold = 16ull * 1024 * 1024;
+	gpuHeapCreateFunction createHeap;
+	gpuHeapDestroyFunction destroyHeap;
+};
+
+struct sGpuAllocation
+{
+	// Backend heap object returned by the create function
+	void* heap = nullptr;
+	uint64_t offset = 0;
+	uint64_t size = 0;
+	uint32_t memoryType = 0;
+
+	// Used by the allocator to free the allocation
+	uint32_t heapIndex = 0;
+	uint32_t block = 0;
+
+	bool isValid() const { return (heap != nullptr); }
+};
+
+struct sGpuMemoryStats
+{
+	uint32_t heapCount = 0;
+	uint32_t dedicatedHeapCount = 0;
+	uint32_t allocationCount = 0;
+	uint32_t freeBlockCount = 0;
+	// Bytes in every heap, shared and dedicated
+	uint64_t reservedBytes = 0;
+	uint64_t usedBytes = 0;
+	// Free bytes in the shared heaps and the largest single range of them
+	uint64_t freeBytes = 0;
+	uint64_t largestFreeBlock = 0;
+
+	// 0 while the free space is one range, approaching 1 as it is split into many small ones
+	float getFragmentation() const { return (freeBytes == 0) ? 0.0f : 1.0f - (static_cast<float>(largestFreeBlock) / static_cast<float>(freeBytes)); }
+};
+
+// Sub-allocates gpu memory from a few large heaps per memory type, so thousands of buffers cost a handful of driver allocations. The heaps are
+// created and destroyed through backend callbacks and the allocator only hands out offsets, so it works for any api. Free ranges are kept in
+// a two level segregated fit (TLSF) structure: a first level per power of two size and 32 linear second level classes in each, with a
+// bitmap per level, so allocating and freeing are constant time and freed ranges merge with free neighbours immediately. Alignments are
+// rounded up to a power of two of at least minAlignment. Allocations above the dedicated threshold get a heap of their own. One empty heap
+// is kept per memory type so repeatedly loading and unloading does not create and destroy heaps. Thread safe
+class gpuAllocator
+{
+public:
+	static constexpr uint64_t minAlignment = 16;
+
+public:
+	gpuAllocator() = default;
+	~gpuAllocator();
+
+	gpuAllocator(const gpuAllocator&) = delete;
+	gpuAllocator& operator=(const gpuAllocator&) = delete;
+
+	void init(const sGpuAllocatorDesc& desc);
+
+	// Destroys every heap. Allocations must not be used afterwards
+	void shutdown();
+
+	/** Allocates size bytes of a memory type at an offset that is a multiple of alignment
+	* @return The allocation, invalid if a heap could not be created
+	*/
+	sGpuAllocation allocate(const uint32_t memoryType, const uint64_t size, const uint64_t alignment);
+
+	// Frees the allocation and resets it. Freeing an invalid allocation does nothing
+	void free(sGpuAllocation& allocation);
+
+	void getStats(sGpuMemoryStats& outStats) const;
+	void getStats(const uint32_t memoryType, sGpuMemoryStats& outStats) const;
+
+private:
+	static constexpr uint32_t secondLevelLog2 = 5;
+	static constexpr uint32_t secondLevelCount = 1 << secondLevelLog2;
+	static constexpr uint32_t firstLevelCount = 48;
+	static constexpr uint32_t invalidIndex = UINT32_MAX;
+
+	struct sBlock
+	{
+		uint64_t offset = 0;
+		uint64_t size = 0;
+		uint32_t heapIndex = 0;
+		uint32_t previousPhysical = invalidIndex;
+		uint32_t nextPhysical = invalidIndex;
+		uint32_t previousFree = invalidIndex;
+		uint32_t nextFree = invalidIndex;
+		bool free = false;
+	};
+
+	struct sHeap
+	{
+		void* handle = nullptr;
+		uint64_t size = 0;
+		uint64_t usedBytes = 0;
+		uint32_t memoryType = 0;
+		uint32_t allocationCount = 0;
+		bool dedicated = false;
+	};
+
+	struct sPool
+	{
+		uint64_t firstLevelBitmap = 0;
+		uint32_t secondLevelBitmaps[firstLevelCount] = {};
+		uint32_t freeLists[firstLevelCount][secondLevelCount] = {};
+		uint32_t emptyHeapCount = 0;
+	};
+
+	sGpuAllocatorDesc settings;
+	std::vector<sPool> pools;
+	std::vector<sBlock> blocks;
+	std::vector<uint32_t> unusedBlocks;
+	std::vector<sHeap> heaps;
+	std::vector<uint32_t> unusedHeaps;
+	mutable std::mutex mutex;
+
+private:
+	static void mapSize(const uint64_t size, uint32_t& outFirstLevel, uint32_t& outSecondLevel);
+	uint32_t findFreeBlock(sPool& pool, const uint64_t size) const;
+	void insertFreeBlock(sPool& pool, const uint32_t block);
+	void removeFreeBlock(sPool& pool, const uint32_t block);
+	uint32_t createBlock();
+	void releaseBlock(const uint32_t block);
+	uint32_t createHeap(const uint32_t memoryType, const uint64_t size, const bool dedicated);
+	void destroyHeap(const uint32_t heapIndex);
+	void addStats(const sHeap& heap, sGpuMemoryStats& outStats) const;
+};
\ No newline at end of file
@@ -0,0 +1,205 @@
+#include "pch.h"
+#include "renderQueue.h"
+#include "jobs/jobSystem.h"
+#include "profiler/profiler.h"
+#include "math/matrix4x4f.h"
+
+static constexpr uint32_t radixBits = 8;
+static constexpr uint32_t radixSize = 1 << radixBits;
+static constexpr uint32_t digitCount = 64 / radixBits;
+// Fewest keys per block, smaller sorts run as one block on the calling thread
+static constexpr uint32_t minKeysPerBlock = 16384;
+static constexpr uint32_t maxBlockCount = 64;
+
+static uint32_t getDigit(const uint64_t key, const uint32_t digit)
+{
+	return static_cast<uint32_t>(key >> (digit * radixBits)) & (radixSize - 1);
+}
+
+uint64_t renderQueue::makeKey(const uint32_t pass, const uint32_t pipeline, const uint32_t material, const uint32_t mesh, const float depth)
+{
+	// The bits of a positive float order the same way as its value, so the top bits of the exponent and mantissa are a depth that keeps
+	// its precision near the camera without knowing the depth range
+	uint32_t depthKey = 0;
+	if (depth > 0.0f)
+	{
+		uint32_t depthValue = 0;
+		memcpy(&depthValue, &depth, sizeof(depthValue));
+		depthKey = depthValue >> (31 - depthBits);
+	}
+
+	return (static_cast<uint64_t>(pass & ((1u << passBits) - 1)) << passShift) |
+		(static_cast<uint64_t>(pipeline & ((1u << pipelineBits) - 1)) << pipelineShift) |
+		(static_cast<uint64_t>(material & ((1u << materialBits) - 1)) << materialShift) |
+		(static_cast<uint64_t>(mesh & ((1u << meshBits) - 1)) << meshShift) |
+		static_cast<uint64_t>(depthKey);
+}
+
+float renderQueue::getViewDepth(const matrix4x4f& worldMatrix, const matrix4x4f& viewProjection)
+{
+	const float* const world = worldMatrix.values;
+	const float* const clipW = &viewProjection.values[12];
+	return (clipW[0] * world[3]) + (clipW[1] * world[7]) + (clipW[2] * world[11]) + clipW[3];
+}
+
+sRenderStateChanges renderQueue::countStateChanges(std::span<const uint64_t> keys)
+{
+	sRenderStateChanges changes;
+	if (keys.empty())
+	{
+		return changes;
+	}
+
+	// The first item binds everything
+	uint64_t previousKey = ~keys[0];
+	for (const uint64_t key : keys)
+	{
+		const uint64_t differentBits = key ^ previousKey;
+		changes.passChanges += ((differentBits >> passShift) != 0) ? 1 : 0;
+		changes.pipelineChanges += ((differentBits >> pipelineShift) != 0) ? 1 : 0;
+		changes.materialChanges += ((differentBits >> materialShift) != 0) ? 1 : 0;
+		changes.meshChanges += ((differentBits >> meshShift) != 0) ? 1 : 0;
+		previousKey = key;
+	}
+	return changes;
+}
+
+void renderQueue::radixSort(uint64_t* keys, uint32_t* values, uint64_t* scratchKeys, uint32_t* scratchValues, const uint32_t count,
+	std::pmr::memory_resource* scratchMemory)
+{
+	PROFILE_SCOPE("renderQueue::radixSort");
+
+	if (count < 2)
+	{
+		return;
+	}
+
+	const uint32_t blockCount = std::clamp((count + (minKeysPerBlock - 1)) / minKeysPerBlock, 1u, maxBlockCount);
+	const uint32_t blockSize = (count + (blockCount - 1)) / blockCount;
+
+	// Histograms of every digit from one read of the keys. Totals do not depend on the order, so they show which digits every key shares
+	std::pmr::vector<uint32_t> digitHistograms(static_cast<size_t>(blockCount) * digitCount * radixSize, 0, scratchMemory);
+	jobSystem::parallelFor(blockCount, 1, [keys, count, blockSize, &digitHistograms](const uint32_t firstBlock, const uint32_t lastBlock)
+		{
+			for (uint32_t block = firstBlock; block < lastBlock; ++block)
+			{
+				uint32_t* const histogram = &digitHistograms[static_cast<size_t>(block) * digitCount * radixSize];
+				const uint32_t end = std::min(count, (block + 1) * blockSize);
+				for (uint32_t i = block * blockSize; i < end; ++i)
+				{
+					const uint64_t key = keys[i];
+					for (uint32_t digit = 0; digit < digitCount; ++digit)
+					{
+						++histogram[(digit * radixSize) + getDigit(key, digit)];
+					}
+				}
+			}
+		});
+
+	std::pmr::vector<uint32_t> blockOffsets(static_cast<size_t>(blockCount) * radixSize, 0, scratchMemory);
+	uint64_t* sourceKeys = keys;
+	uint32_t* sourceValues = values;
+	uint64_t* destinationKeys = scratchKeys;
+	uint32_t* destinationValues = scratchValues;
+	bool firstPass = true;
+	for (uint32_t digit = 0; digit < digitCount; ++digit)
+	{
+		// Skip the pass if every key is in one bucket
+		bool shared = false;
+		for (uint32_t bucket = 0; (bucket < radixSize) && (!shared); ++bucket)
+		{
+			uint32_t total = 0;
+			for (uint32_t block = 0; block < blockCount; ++block)
+			{
+				total += digitHistograms[(static_cast<size_t>(block) * digitCount * radixSize) + (digit * radixSize) + bucket];
+			}
+			shared = (total == count);
+		}
+		if (shared)
+		{
+			continue;
+		}
+
+		// Count each block's buckets. The first pass reads the keys in their original order, whose counts are already known
+		if (firstPass)
+		{
+			for (uint32_t block = 0; block < blockCount; ++block)
+			{
+				memcpy(&blockOffsets[static_cast<size_t>(block) * radixSize], &digitHistograms[(static_cast<size_t>(block) * digitCount * radixSize) + (digit * radixSize)],
+					radixSize * sizeof(uint32_t));
+			}
+		}
+		else
+		{
+			jobSystem::parallelFor(blockCount, 1, [sourceKeys, count, blockSize, digit, &blockOffsets](const uint32_t firstBlock, const uint32_t lastBlock)
+				{
+					for (uint32_t block = firstBlock; block < lastBlock; ++block)
+					{
+						uint32_t* const histogram = &blockOffsets[static_cast<size_t>(block) * radixSize];
+						std::fill(histogram, histogram + radixSize, 0);
+						const uint32_t end = std::min(count, (block + 1) * blockSize);
+						for (uint32_t i = block * blockSize; i < end; ++i)
+						{
+							++histogram[getDigit(sourceKeys[i], digit)];
+						}
+					}
+				});
+		}
+
+		// Exclusive prefix sum in bucket then block order, so each block writes a bucket after the earlier blocks and the sort stays stable
+		uint32_t offset = 0;
+		for (uint32_t bucket = 0; bucket < radixSize; ++bucket)
+		{
+			for (uint32_t block = 0; block < blockCount; ++block)
+			{
+				uint32_t& blockOffset = blockOffsets[(static_cast<size_t>(block) * radixSize) + bucket];
+				const uint32_t bucketCount = blockOffset;
+				blockOffset = offset;
+				offset += bucketCount;
+			}
+		}
+
+		jobSystem::parallelFor(blockCount, 1, [sourceKeys, sourceValues, destinationKeys, destinationValues, count, blockSize, digit, &blockOffsets](const uint32_t firstBlock, const uint32_t lastBlock)
+			{
+				for (uint32_t block = firstBlock; block < lastBlock; ++block)
+				{
+					uint32_t* const offsets = &blockOffsets[static_cast<size_t>(block) * radixSize];
+					const uint32_t end = std::min(count, (block + 1) * blockSize);
+					for (uint32_t i = block * blockSize; i < end; ++i)
+					{
+						const uint32_t position = offsets[getDigit(sourceKeys[i], digit)]++;
+						destinationKeys[position] = sourceKeys[i];
+						destinationValues[position] = sourceValues[i];
+					}
+				}
+			});
+
+		std::swap(sourceKeys, destinationKeys);
+		std::swap(sourceValues, destinationValues);
+		firstPass = false;
+	}
+
+	// An odd number of passes leaves the result in the scratch arrays
+	if (sourceKeys != keys)
+	{
+		memcpy(keys, sourceKeys, static_cast<size_t>(count) * sizeof(uint64_t));
+		memcpy(values, sourceValues, static_cast<size_t>(count) * sizeof(uint32_t));
+	}
+}
+
+void renderQueue::reset(const uint32_t count)
+{
+	keys.resize(count);
+	indices.resize(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		indices[i] = i;
+	}
+}
+
+void renderQueue::sort(std::pmr::memory_resource* scratchMemory)
+{
+	scratchKeys.resize(keys.size());
+	scratchIndices.resize(indices.size());
+	radixSort(keys.data(), indices.data(), scratchKeys.data(), scratchIndices.data(), size(), scratchMemory);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <memory_resource>
+
+// State changes a recording loop makes drawing items in key order
+struct sRenderStateChanges
+{
+	uint32_t passChanges = 0;
+	uint32_t pipelineChanges = 0;
+	uint32_t materialChanges = 0;
+	// One draw per run of items with the same pass, pipeline, material and mesh
+	uint32_t meshChanges = 0;
+};
+
+// Orders render items by a 64 bit key packing, from the most significant bits, pass, pipeline, material, mesh and depth. Sorting by the
+// key keeps items that share state adjacent so the recording loop binds each pipeline, material and mesh once, and draws a mesh's items
+// front to back. Keys are written in place, e.g. from parallel jobs, then sorted with a parallel radix sort
+class renderQueue
+{
+public:
+	static constexpr uint32_t depthBits = 20;
+	static constexpr uint32_t meshBits = 20;
+	static constexpr uint32_t materialBits = 12;
+	static constexpr uint32_t pipelineBits = 8;
+	static constexpr uint32_t passBits = 4;
+	static_assert((depthBits + meshBits + materialBits + pipelineBits + passBits) == 64, "renderQueue: key fields must fill 64 bits");
+
+	static constexpr uint32_t meshShift = depthBits;
+	static constexpr uint32_t materialShift = meshShift + meshBits;
+	static constexpr uint32_t pipelineShift = materialShift + materialBits;
+	static constexpr uint32_t passShift = pipelineShift + pipelineBits;
+
+public:
+	/** Packs a key. Ids are truncated to their field, depth is a distance along the view direction and items behind the camera sort first
+	* @return The key
+	*/
+	static uint64_t makeKey(const uint32_t pass, const uint32_t pipeline, const uint32_t material, const uint32_t mesh, const float depth);
+
+	/** Depth of an item for its key, the clip space w of its world position. Both matrices are laid out for row vectors as passed to
+	* graphics::render, so the world translation is in values 3, 7 and 11 and the clip w row is values 12 to 15
+	* @return The distance of the item along the view direction
+	*/
+	static float getViewDepth(const class matrix4x4f& worldMatrix, const class matrix4x4f& viewProjection);
+
+	// The key without its depth, equal for items that can share a draw
+	static uint64_t getStateKey(const uint64_t key) { return key >> meshShift; }
+
+	// Counts the state changes of drawing keys in their current order
+	static sRenderStateChanges countStateChanges(std::span<const uint64_t> keys);
+
+	/** Sorts keys in ascending order and moves values with them, stable for equal keys. A least significant digit radix sort of 8 bit
+	* digits, each pass histograms and scatters blocks of the keys in parallel jobs. Passes over digits every key shares are skipped, so
+	* unused key fields cost nothing. The scratch arrays must hold count elements. The result is written back to keys and values. The
+	* block histograms, up to about 600 KB, are allocated from scratchMemory
+	*/
+	static void radixSort(uint64_t* keys, uint32_t* values, uint64_t* scratchKeys, uint32_t* scratchValues, const uint32_t count,
+		std::pmr::memory_resource* scratchMemory);
+
+public:
+	// Makes count items with indices 0 to count - 1. Their keys must be written through getKeys before sorting
+	void reset(const uint32_t count);
+
+	// Sorts the items. Keys, indices and their scratch arrays keep their capacity between sorts, so only the histograms are allocated
+	// from scratchMemory, e.g. the frame arena
+	void sort(std::pmr::memory_resource* scratchMemory);
+
+	uint32_t size() const { return static_cast<uint32_t>(keys.size()); }
+	std::span<uint64_t> getKeys() { return keys; }
+	std::span<const uint64_t> getKeys() const { return keys; }
+
+	// Item indices in key order once sorted
+	std::span<const uint32_t> getIndices() const { return indices; }
+
+private:
+	std::vector<uint64_t> keys;
+	std::vector<uint32_t> indices;
+	std::vector<uint64_t> scratchKeys;
+	std::vector<uint32_t> scratchIndices;
+};
\ No newline at end of file
@@ -3,5 +3,5 @@
 struct sRenderData
 {
 	struct sMeshResources* pMeshResources;
-	class matrix4x4* pWorldMatrix;
+	class matrix4x4f* pWorldMatrix;
 };
\ No newline at end of file
@@ -0,0 +1,7 @@
+#pragma once
+
+// Returned by an upload. The uploaded resources have reached gpu memory once graphics::isUploadComplete returns true for the token
+struct sUploadToken
+{
+	uint64_t value = 0;
+};
\ No newline at end of file
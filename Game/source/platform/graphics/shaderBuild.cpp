@@ -0,0 +1,184 @@
+#include "pch.h"
+#include "shaderBuild.h"
+#include "fileIO/fileIO.h"
+#include "jobs/jobSystem.h"
+#include "profiler/profiler.h"
+#include "sString.h"
+#include "memory/memoryTracker.h"
+
+// Splits text into tokens separated by spaces or tabs
+static std::vector<std::string_view> splitTokens(std::string_view text)
+{
+	std::vector<std::string_view> tokens;
+	size_t position = 0;
+	while (true)
+	{
+		const size_t begin = text.find_first_not_of(" \t\r", position);
+		if (begin == std::string_view::npos)
+		{
+			return tokens;
+		}
+		const size_t end = std::min(text.find_first_of(" \t\r", begin), text.size());
+		tokens.push_back(text.substr(begin, end - begin));
+		position = end;
+	}
+}
+
+bool shaderBuild::parseManifest(const std::string& file, std::vector<sShaderDesc>& outShaders, std::string& outErrors)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::graphics);
+
+	const fileIO::mappedFile manifest(file, eFileAccessPattern::sequential);
+	if (!manifest.isOpen())
+	{
+		outErrors = "could not read " + file;
+		return false;
+	}
+
+	const std::string_view text(reinterpret_cast<const char*>(manifest.getData().data()), manifest.getSize());
+	size_t lineStart = 0;
+	uint32_t lineNumber = 0;
+	while (lineStart < text.size())
+	{
+		size_t lineEnd = text.find('\n', lineStart);
+		lineEnd = (lineEnd == std::string_view::npos) ? text.size() : lineEnd;
+		std::string_view line = text.substr(lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
+		++lineNumber;
+
+		line = line.substr(0, line.find('#'));
+		const std::vector<std::string_view> tokens = splitTokens(line);
+		if (tokens.empty())
+		{
+			continue;
+		}
+
+		if (tokens.size() < 3)
+		{
+			outErrors += sString::printf("%s(%u): expected a source, entry point and profile.\n", file.c_str(), lineNumber);
+			continue;
+		}
+
+		// Permutation groups, each a list of alternative defines that also includes building without any of them
+		std::vector<std::vector<std::string>> groups;
+		bool isValid = true;
+		for (size_t i = 3; i < tokens.size(); ++i)
+		{
+			const std::string_view token = tokens[i];
+			if ((token.size() < 3) || (token.front() != '[') || (token.back() != ']'))
+			{
+				isValid = false;
+				break;
+			}
+
+			std::vector<std::string>& group = groups.emplace_back(1);
+			std::string_view alternatives = token.substr(1, token.size() - 2);
+			while (!alternatives.empty())
+			{
+				const size_t separator = std::min(alternatives.find('|'), alternatives.size());
+				group.emplace_back(alternatives.substr(0, separator));
+				alternatives.remove_prefix(std::min(separator + 1, alternatives.size()));
+			}
+		}
+
+		if (!isValid)
+		{
+			outErrors += sString::printf("%s(%u): permutation groups must be written as [DEFINE|DEFINE=VALUE].\n", file.c_str(), lineNumber);
+			continue;
+		}
+
+		// Counts through every combination, the first alternative of each group is the empty one
+		std::vector<size_t> choices(groups.size(), 0);
+		while (true)
+		{
+			sShaderDesc& desc = outShaders.emplace_back();
+			desc.sourceFile = tokens[0];
+			desc.entryPoint = tokens[1];
+			desc.profile = tokens[2];
+			for (size_t i = 0; i < groups.size(); ++i)
+			{
+				if (!groups[i][choices[i]].empty())
+				{
+					desc.defines.push_back(groups[i][choices[i]]);
+				}
+			}
+
+			size_t group = 0;
+			for (; group < groups.size(); ++group)
+			{
+				if (++choices[group] < groups[group].size())
+				{
+					break;
+				}
+				choices[group] = 0;
+			}
+			if (group == groups.size())
+			{
+				break;
+			}
+		}
+	}
+	return outErrors.empty();
+}
+
+sShaderBuildResult shaderBuild::build(std::span<const sShaderDesc> shaders, const sShaderCompiler& compiler, std::vector<std::vector<uint8_t>>* outBinaries)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::graphics);
+	PROFILE_SCOPE("shaderBuild::build");
+
+	struct sShaderOutput
+	{
+		std::vector<uint8_t> binary;
+		std::string errors;
+		bool succeeded = false;
+		bool fromCache = false;
+	};
+
+	std::vector<sShaderOutput> outputs(shaders.size());
+
+	// One shader per job, compile times vary too much between shaders for larger batches to balance
+	jobSystem::parallelFor(static_cast<uint32_t>(shaders.size()), 1, [&shaders, &compiler, &outputs](const uint32_t begin, const uint32_t end)
+		{
+			MEMORY_TAG_SCOPE(eMemoryTag::graphics);
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				PROFILE_SCOPE("shaderBuild::compile");
+				sShaderOutput& output = outputs[i];
+				output.succeeded = shaderCache::load(shaders[i], compiler.version, compiler.compile, output.binary, output.errors, &output.fromCache);
+			}
+		});
+
+	sShaderBuildResult result;
+	for (size_t i = 0; i < shaders.size(); ++i)
+	{
+		if (outputs[i].succeeded && outputs[i].fromCache)
+		{
+			++result.cachedCount;
+			continue;
+		}
+		if (outputs[i].succeeded)
+		{
+			++result.compiledCount;
+			continue;
+		}
+
+		const sShaderDesc& desc = shaders[i];
+		++result.failedCount;
+		result.diagnostics += sString::printf("%s (%s, %s", desc.sourceFile.c_str(), desc.entryPoint.c_str(), desc.profile.c_str());
+		for (const std::string& define : desc.defines)
+		{
+			result.diagnostics += ", " + define;
+		}
+		result.diagnostics += "):\n" + outputs[i].errors + "\n";
+	}
+
+	if (outBinaries != nullptr)
+	{
+		outBinaries->resize(shaders.size());
+		for (size_t i = 0; i < shaders.size(); ++i)
+		{
+			(*outBinaries)[i] = std::move(outputs[i].binary);
+		}
+	}
+	return result;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "shaderCache.h"
+
+// A graphics api's shader compiler. compile must be safe to call from several threads at once
+struct sShaderCompiler
+{
+	shaderCompileFunction compile;
+	// Part of every shader cache key so binaries from another compiler version are never reused
+	std::string version;
+};
+
+struct sShaderBuildResult
+{
+	uint32_t cachedCount = 0;
+	uint32_t compiledCount = 0;
+	uint32_t failedCount = 0;
+	// Every failed shader's diagnostics in manifest order
+	std::string diagnostics;
+
+	bool succeeded() const { return failedCount == 0; }
+};
+
+// Compiles sets of shaders on the job system, one job per shader, going through the shader cache so only shaders with changed sources
+// are compiled. Startup builds the shaders the renderer needs and the build shaders run mode precompiles a whole manifest.
+//
+// A manifest lists one shader per line as source, entry point and profile followed by optional permutation groups, e.g.
+//   shaders/direct3d12/pixelShader.hlsl main ps_6_0 [USE_FOG] [LIGHTS=1|LIGHTS=4]
+// Each group adds one of its defines or none, every combination of the groups is built. Text after # is a comment
+class shaderBuild
+{
+public:
+	/** Reads a manifest and expands its permutations
+	* @return True if the manifest was read, false with the offending lines in outErrors otherwise
+	*/
+	static bool parseManifest(const std::string& file, std::vector<sShaderDesc>& outShaders, std::string& outErrors);
+
+	/** Loads or compiles every shader in parallel. When outBinaries is not null it receives each shader's binary at the shader's index,
+	* left empty for shaders that failed
+	* @return Counts of cached, compiled and failed shaders with the failures' diagnostics
+	*/
+	static sShaderBuildResult build(std::span<const sShaderDesc> shaders, const sShaderCompiler& compiler, std::vector<std::vector<uint8_t>>* outBinaries);
+};
\ No newline at end of file
@@ -0,0 +1,439 @@
+#include "pch.h"
+#include "shaderCache.h"
+#include "platform/framework/abstract/platformFile.h"
+#include "platform/framework/abstract/platformConsole.h"
+#include "fileIO/fileIO.h"
+#include "sString.h"
+#include "memory/memoryTracker.h"
+
+#include <mutex>
+#include <unordered_set>
+
+struct sShaderCacheHeader
+{
+	static constexpr uint32_t expectedMagic = 0x31434853; // "SHC1"
+	static constexpr uint32_t currentVersion = 1;
+
+	uint32_t magic = expectedMagic;
+	uint32_t version = currentVersion;
+};
+
+struct sShaderCacheRecord
+{
+	uint64_t key = 0;
+	// Location of the binary in the blob file
+	uint64_t offset = 0;
+	uint32_t size = 0;
+	uint32_t binaryChecksum = 0;
+	// Hash of the fields above. A record another process is still writing, or left half written when it crashed, fails the check
+	uint64_t recordChecksum = 0;
+};
+static_assert(sizeof(sShaderCacheRecord) == 32, "sShaderCacheRecord: layout is part of the file format");
+
+static std::mutex cacheMutex;
+static bool opened = false;
+static std::string blobFile;
+static intptr_t lockHandle = platformLayer::file::invalidFileHandle;
+static intptr_t indexHandle = platformLayer::file::invalidFileHandle;
+static intptr_t blobHandle = platformLayer::file::invalidFileHandle;
+
+// Records read from the index so far. indexEnd is the file offset after the last valid record
+static std::unordered_map<uint64_t, sShaderCacheRecord> records;
+static uint64_t indexEnd = 0;
+static fileIO::mappedFile blobMap;
+
+static std::atomic<uint32_t> hitCount = 0;
+static std::atomic<uint32_t> missCount = 0;
+
+static uint64_t rotateLeft(const uint64_t value, const uint32_t count)
+{
+	return (value << count) | (value >> (64 - count));
+}
+
+// 64 bit xxHash
+static uint64_t hashBytes(const uint8_t* data, const size_t size)
+{
+	static constexpr uint64_t prime1 = 11400714785074694791ull;
+	static constexpr uint64_t prime2 = 14029467366897019727ull;
+	static constexpr uint64_t prime3 = 1609587929392839161ull;
+	static constexpr uint64_t prime4 = 9650029242287828579ull;
+	static constexpr uint64_t prime5 = 2870177450012600261ull;
+
+	const auto read64 = [](const uint8_t* bytes) { uint64_t value; memcpy(&value, bytes, sizeof(value)); return value; };
+	const auto read32 = [](const uint8_t* bytes) { uint32_t value; memcpy(&value, bytes, sizeof(value)); return value; };
+	const auto round = [](uint64_t accumulator, const uint64_t input) { return rotateLeft(accumulator + (input * prime2), 31) * prime1; };
+	const auto merge = [&round](const uint64_t accumulator, const uint64_t value) { return ((accumulator ^ round(0, value)) * prime1) + prime4; };
+
+	const uint8_t* current = data;
+	const uint8_t* const end = data + size;
+	uint64_t hash = 0;
+	if (size >= 32)
+	{
+		uint64_t accumulators[4] = { prime1 + prime2, prime2, 0, 0 - prime1 };
+		for (; (end - current) >= 32; current += 32)
+		{
+			for (size_t i = 0; i < 4; ++i)
+			{
+				accumulators[i] = round(accumulators[i], read64(current + (i * 8)));
+			}
+		}
+
+		hash = rotateLeft(accumulators[0], 1) + rotateLeft(accumulators[1], 7) + rotateLeft(accumulators[2], 12) + rotateLeft(accumulators[3], 18);
+		for (const uint64_t accumulator : accumulators)
+		{
+			hash = merge(hash, accumulator);
+		}
+	}
+	else
+	{
+		hash = prime5;
+	}
+
+	hash += size;
+	for (; (end - current) >= 8; current += 8)
+	{
+		hash = (rotateLeft(hash ^ round(0, read64(current)), 27) * prime1) + prime4;
+	}
+	if ((end - current) >= 4)
+	{
+		hash = (rotateLeft(hash ^ (read32(current) * prime1), 23) * prime2) + prime3;
+		current += 4;
+	}
+	for (; current < end; ++current)
+	{
+		hash = rotateLeft(hash ^ (*current * prime5), 11) * prime1;
+	}
+
+	hash ^= hash >> 33;
+	hash *= prime2;
+	hash ^= hash >> 29;
+	hash *= prime3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+static uint64_t getRecordChecksum(const sShaderCacheRecord& record)
+{
+	return hashBytes(reinterpret_cast<const uint8_t*>(&record), offsetof(sShaderCacheRecord, recordChecksum));
+}
+
+// Appends a length prefixed field so neighbouring fields cannot run into each other
+static void appendKeyField(std::string& keyData, std::string_view field)
+{
+	const uint64_t size = field.size();
+	keyData.append(reinterpret_cast<const char*>(&size), sizeof(size));
+	keyData.append(field);
+}
+
+// Adds a source file and the files it includes with #include "file" to keyData. System includes are left to the compiler version.
+// Returns false if the file could not be read
+static bool appendSourceFile(const std::filesystem::path& file, std::unordered_set<std::string>& visitedFiles, std::string& keyData)
+{
+	const std::string fileName = file.lexically_normal().generic_string();
+	if (!visitedFiles.insert(fileName).second)
+	{
+		return true;
+	}
+
+	const fileIO::mappedFile source(fileName, eFileAccessPattern::sequential);
+	if (!source.isOpen())
+	{
+		return false;
+	}
+
+	const std::string_view text(reinterpret_cast<const char*>(source.getData().data()), source.getSize());
+	appendKeyField(keyData, fileName);
+	appendKeyField(keyData, text);
+
+	size_t lineStart = 0;
+	while (lineStart < text.size())
+	{
+		size_t lineEnd = text.find('\n', lineStart);
+		lineEnd = (lineEnd == std::string_view::npos) ? text.size() : lineEnd;
+		std::string_view line = text.substr(lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
+
+		line.remove_prefix(std::min(line.find_first_not_of(" \t"), line.size()));
+		if (!line.starts_with('#'))
+		{
+			continue;
+		}
+		line.remove_prefix(1);
+		line.remove_prefix(std::min(line.find_first_not_of(" \t"), line.size()));
+		if (!line.starts_with("include"))
+		{
+			continue;
+		}
+
+		const size_t nameStart = line.find('"');
+		const size_t nameEnd = (nameStart == std::string_view::npos) ? std::string_view::npos : line.find('"', nameStart + 1);
+		if (nameEnd == std::string_view::npos)
+		{
+			continue;
+		}
+
+		// A missing include is part of the key by name only, the compile reports the error
+		const std::filesystem::path includeFile = file.parent_path() / line.substr(nameStart + 1, nameEnd - nameStart - 1);
+		if (!appendSourceFile(includeFile, visitedFiles, keyData))
+		{
+			appendKeyField(keyData, includeFile.generic_string());
+		}
+	}
+	return true;
+}
+
+// Reads records appended to the index since the last call. Called with cacheMutex held
+static void readNewRecords()
+{
+	const int64_t fileSize = platformLayer::file::getFileSize(indexHandle);
+	if (fileSize <= static_cast<int64_t>(indexEnd))
+	{
+		return;
+	}
+
+	const uint64_t recordCount = (static_cast<uint64_t>(fileSize) - indexEnd) / sizeof(sShaderCacheRecord);
+	std::vector<sShaderCacheRecord> newRecords(static_cast<size_t>(recordCount));
+	const int64_t bytesRead = platformLayer::file::readFile(indexHandle, indexEnd, newRecords.data(), newRecords.size() * sizeof(sShaderCacheRecord));
+	if (bytesRead < 0)
+	{
+		return;
+	}
+
+	const size_t readCount = static_cast<size_t>(bytesRead) / sizeof(sShaderCacheRecord);
+	for (size_t i = 0; i < readCount; ++i)
+	{
+		const sShaderCacheRecord& record = newRecords[i];
+		if (record.recordChecksum != getRecordChecksum(record))
+		{
+			// Stop at a record that is not fully written, it is read again once it is. A writer holding the lock overwrites it
+			return;
+		}
+
+		// The first record for a key wins, later duplicates from racing processes are ignored
+		records.emplace(record.key, record);
+		indexEnd += sizeof(sShaderCacheRecord);
+	}
+}
+
+// Returns true and the binary if the cache holds key. Called with cacheMutex held
+static bool copyBinary(const sShaderCacheRecord& record, std::vector<uint8_t>& outBinary)
+{
+	// The blob file only grows, it is mapped again when another process has added binaries past the end of the current view
+	if ((record.offset + record.size) > blobMap.getSize())
+	{
+		blobMap.open(blobFile, eFileAccessPattern::random);
+		if ((record.offset + record.size) > blobMap.getSize())
+		{
+			return false;
+		}
+	}
+
+	const std::span<const uint8_t> binary = blobMap.getData().subspan(static_cast<size_t>(record.offset), record.size);
+	if (static_cast<uint32_t>(hashBytes(binary.data(), binary.size())) != record.binaryChecksum)
+	{
+		return false;
+	}
+
+	outBinary.assign(binary.begin(), binary.end());
+	return true;
+}
+
+bool shaderCache::open(const std::string& directory)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::graphics);
+	close();
+
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+
+	const std::filesystem::path path(directory);
+	blobFile = (path / "shaderCache.blobs").string();
+	lockHandle = platformLayer::file::openFileForWrite((path / "shaderCache.lock").string());
+	indexHandle = platformLayer::file::openFileForWrite((path / "shaderCache.index").string());
+	blobHandle = platformLayer::file::openFileForWrite(blobFile);
+	if ((lockHandle == platformLayer::file::invalidFileHandle) || (indexHandle == platformLayer::file::invalidFileHandle) ||
+		(blobHandle == platformLayer::file::invalidFileHandle) || (platformLayer::file::lockFile(lockHandle) != 0))
+	{
+		platformLayer::console::consolePrint(sString::printf("shaderCache::open: could not open the cache in %s.", directory.c_str()));
+		opened = true;
+		close();
+		return false;
+	}
+
+	// The first process to open the directory writes the header
+	sShaderCacheHeader header;
+	if (platformLayer::file::getFileSize(indexHandle) == 0)
+	{
+		platformLayer::file::writeFile(indexHandle, 0, &header, sizeof(header));
+	}
+
+	const bool isValid = (platformLayer::file::readFile(indexHandle, 0, &header, sizeof(header)) == sizeof(header)) &&
+		(header.magic == sShaderCacheHeader::expectedMagic) && (header.version == sShaderCacheHeader::currentVersion);
+	if (isValid)
+	{
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		indexEnd = sizeof(sShaderCacheHeader);
+		readNewRecords();
+	}
+	platformLayer::file::unlockFile(lockHandle);
+
+	opened = true;
+	if (!isValid)
+	{
+		platformLayer::console::consolePrint(sString::printf("shaderCache::open: %s holds a cache in an unsupported format, delete it to rebuild.", directory.c_str()));
+		close();
+		return false;
+	}
+
+	blobMap.open(blobFile, eFileAccessPattern::random);
+	return true;
+}
+
+void shaderCache::close()
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	if (!opened)
+	{
+		return;
+	}
+
+	blobMap.close();
+	platformLayer::file::closeFile(blobHandle);
+	platformLayer::file::closeFile(indexHandle);
+	platformLayer::file::closeFile(lockHandle);
+	blobHandle = platformLayer::file::invalidFileHandle;
+	indexHandle = platformLayer::file::invalidFileHandle;
+	lockHandle = platformLayer::file::invalidFileHandle;
+	records.clear();
+	indexEnd = 0;
+	opened = false;
+}
+
+bool shaderCache::isOpen()
+{
+	return opened;
+}
+
+uint64_t shaderCache::computeKey(const sShaderDesc& desc, std::string_view compilerVersion)
+{
+	std::string keyData;
+	std::unordered_set<std::string> visitedFiles;
+	if (!appendSourceFile(desc.sourceFile, visitedFiles, keyData))
+	{
+		return 0;
+	}
+
+	appendKeyField(keyData, desc.entryPoint);
+	appendKeyField(keyData, desc.profile);
+	for (const std::string& define : desc.defines)
+	{
+		appendKeyField(keyData, define);
+	}
+	appendKeyField(keyData, compilerVersion);
+
+	// 0 is reserved for failure
+	return std::max<uint64_t>(hashBytes(reinterpret_cast<const uint8_t*>(keyData.data()), keyData.size()), 1);
+}
+
+bool shaderCache::find(const uint64_t key, std::vector<uint8_t>& outBinary)
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	if (!opened)
+	{
+		return false;
+	}
+
+	std::unordered_map<uint64_t, sShaderCacheRecord>::const_iterator found = records.find(key);
+	if (found == records.end())
+	{
+		// Another process may have compiled it since the index was last read
+		readNewRecords();
+		found = records.find(key);
+		if (found == records.end())
+		{
+			return false;
+		}
+	}
+	return copyBinary(found->second, outBinary);
+}
+
+bool shaderCache::store(const uint64_t key, std::span<const uint8_t> binary)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::graphics);
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	if (!opened || (binary.size() > UINT32_MAX) || (platformLayer::file::lockFile(lockHandle) != 0))
+	{
+		return false;
+	}
+
+	readNewRecords();
+	bool stored = records.contains(key);
+	if (!stored)
+	{
+		// The binary is written before the record that points at it, so readers never find a record for missing data
+		sShaderCacheRecord record;
+		record.key = key;
+		record.offset = static_cast<uint64_t>(std::max<int64_t>(platformLayer::file::getFileSize(blobHandle), 0));
+		record.size = static_cast<uint32_t>(binary.size());
+		record.binaryChecksum = static_cast<uint32_t>(hashBytes(binary.data(), binary.size()));
+		record.recordChecksum = getRecordChecksum(record);
+
+		stored = (platformLayer::file::writeFile(blobHandle, record.offset, binary.data(), binary.size()) == static_cast<int64_t>(binary.size())) &&
+			(platformLayer::file::writeFile(indexHandle, indexEnd, &record, sizeof(record)) == sizeof(record));
+		if (stored)
+		{
+			records.emplace(key, record);
+			indexEnd += sizeof(record);
+		}
+	}
+
+	platformLayer::file::unlockFile(lockHandle);
+	return stored;
+}
+
+bool shaderCache::load(const sShaderDesc& desc, std::string_view compilerVersion, const shaderCompileFunction& compile, std::vector<uint8_t>& outBinary,
+	std::string& outErrors, bool* outFromCache)
+{
+	if (outFromCache != nullptr)
+	{
+		*outFromCache = false;
+	}
+
+	const uint64_t key = computeKey(desc, compilerVersion);
+	if (key == 0)
+	{
+		outErrors = "could not read " + desc.sourceFile;
+		return false;
+	}
+
+	if (find(key, outBinary))
+	{
+		hitCount.fetch_add(1, std::memory_order_relaxed);
+		if (outFromCache != nullptr)
+		{
+			*outFromCache = true;
+		}
+		return true;
+	}
+
+	missCount.fetch_add(1, std::memory_order_relaxed);
+	if (!compile(desc, outBinary, outErrors))
+	{
+		return false;
+	}
+
+	// A failed store only costs a compile next time
+	store(key, outBinary);
+	return true;
+}
+
+sShaderCacheStats shaderCache::getStats()
+{
+	sShaderCacheStats stats;
+	stats.hits = hitCount.load(std::memory_order_relaxed);
+	stats.misses = missCount.load(std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	stats.entryCount = static_cast<uint32_t>(records.size());
+	return stats;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+// One shader to compile: a source file, its entry point and target profile, and the preprocessor defines of the permutation
+struct sShaderDesc
+{
+	std::string sourceFile;
+	std::string entryPoint;
+	// e.g. vs_6_0 or ps_6_0
+	std::string profile;
+	// NAME or NAME=VALUE
+	std::vector<std::string> defines;
+};
+
+// Compiles a shader, returning false with the compiler's diagnostics in outErrors if it fails
+using shaderCompileFunction = std::function<bool(const sShaderDesc& desc, std::vector<uint8_t>& outBinary, std::string& outErrors)>;
+
+struct sShaderCacheStats
+{
+	uint32_t hits = 0;
+	uint32_t misses = 0;
+	uint32_t entryCount = 0;
+};
+
+// Compiled shader binaries keyed by a hash of everything that affects the output: the source, every file it includes, the entry point,
+// profile, defines and the compiler that built it. Editing a shader or a header it includes changes the key, so only the affected
+// shaders are recompiled and a warm start compiles nothing. The cache is two append only files, an index of keys and a file of binaries
+// that is memory mapped for lookups. Appends are serialized between processes with a lock file and between threads with a mutex, so any
+// number of game instances and build tools can share a cache directory
+class shaderCache
+{
+public:
+	/** Opens or creates the cache in directory. Without an open cache load always compiles
+	* @return True if the cache was opened, otherwise false
+	*/
+	static bool open(const std::string& directory);
+	static void close();
+	static bool isOpen();
+
+	/** Hashes the shader's sources and settings together with compilerVersion, which should change whenever the compiler's output may
+	* @return The key, or 0 if the source file could not be read
+	*/
+	static uint64_t computeKey(const sShaderDesc& desc, std::string_view compilerVersion);
+
+	/** Copies the binary stored under key into outBinary
+	* @return True if the cache holds the key, otherwise false
+	*/
+	static bool find(const uint64_t key, std::vector<uint8_t>& outBinary);
+
+	/** Adds a binary under key. Another process storing the same key first is not an error
+	* @return True if the cache holds the key afterwards, otherwise false
+	*/
+	static bool store(const uint64_t key, std::span<const uint8_t> binary);
+
+	/** Finds the shader in the cache, or compiles and stores it on a miss. Safe to call from several threads. outFromCache, when not null,
+	* is set to whether the shader was found in the cache
+	* @return True if outBinary holds the shader, false if compilation failed with the diagnostics in outErrors
+	*/
+	static bool load(const sShaderDesc& desc, std::string_view compilerVersion, const shaderCompileFunction& compile, std::vector<uint8_t>& outBinary,
+		std::string& outErrors, bool* outFromCache = nullptr);
+
+	static sShaderCacheStats getStats();
+};
\ No newline at end of file
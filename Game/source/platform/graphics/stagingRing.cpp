@@ -0,0 +1,74 @@
+#include "pch.h"
+#include "stagingRing.h"
+
+void stagingRing::init(const uint64_t inCapacity)
+{
+	capacity = inCapacity;
+	head = 0;
+	tail = 0;
+	submittedHead = 0;
+	submissions.clear();
+}
+
+void stagingRing::shutdown()
+{
+	*this = {};
+}
+
+bool stagingRing::allocate(const uint64_t size, const uint64_t alignment, uint64_t& outOffset)
+{
+	assert(((alignment & (alignment - 1)) == 0) && "stagingRing::allocate: alignment must be a power of two");
+
+	if ((size == 0) || (size > capacity))
+	{
+		return false;
+	}
+
+	if (head == tail)
+	{
+		// Nothing is in flight, start from the beginning so a region as large as the ring fits
+		head = 0;
+		tail = 0;
+		submittedHead = 0;
+	}
+
+	const uint64_t position = head % capacity;
+	uint64_t start = (position + (alignment - 1)) & ~(alignment - 1);
+	if ((start + size) > capacity)
+	{
+		// Regions are contiguous, skip the end of the ring
+		start = 0;
+	}
+
+	const uint64_t padding = (start >= position) ? (start - position) : (capacity - position);
+	if ((getUsedBytes() + padding + size) > capacity)
+	{
+		return false;
+	}
+
+	head += padding + size;
+	outOffset = start;
+	return true;
+}
+
+void stagingRing::submit(const uint64_t fenceValue)
+{
+	if (!hasUnsubmitted())
+	{
+		return;
+	}
+
+	sSubmission& submission = submissions.emplace_back();
+	submission.head = head;
+	submission.fenceValue = fenceValue;
+	submittedHead = head;
+}
+
+void stagingRing::retire(const uint64_t completedFenceValue)
+{
+	while ((!submissions.empty()) && (submissions.front().fenceValue <= completedFenceValue))
+	{
+		tail = submissions.front().head;
+		submissions.pop_front();
+	}
+}
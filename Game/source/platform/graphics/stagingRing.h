@@ -0,0 +1,47 @@
+#pragma once
+
+#include <deque>
+
+// Tracks the ranges of a persistently mapped upload buffer used as a ring. Regions are allocated at the head and tagged with the fence value
+// of the submission that copies from them, then retired from the tail once that fence value completes on the gpu, so staging memory is
+// reused without waiting on the gpu. Only offsets are handed out, the backend owns the buffer. Not thread safe
+class stagingRing
+{
+public:
+	void init(const uint64_t inCapacity);
+	void shutdown();
+
+	/** Reserves size bytes at a multiple of alignment, a power of two. A region that would run past the end of the ring starts again at the
+	* beginning and the skipped bytes are retired with it
+	* @return True if the region was reserved, false if the ring is too full until earlier submissions retire
+	*/
+	bool allocate(const uint64_t size, const uint64_t alignment, uint64_t& outOffset);
+
+	// Tags every region allocated since the last submit with the fence value signalled after the copies from them
+	void submit(const uint64_t fenceValue);
+
+	// Frees the regions of every submission whose fence value is at most completedFenceValue
+	void retire(const uint64_t completedFenceValue);
+
+	uint64_t getCapacity() const { return capacity; }
+	uint64_t getUsedBytes() const { return head - tail; }
+
+	// True if regions were allocated since the last submit
+	bool hasUnsubmitted() const { return (head != submittedHead); }
+
+private:
+	struct sSubmission
+	{
+		// Head of the ring when the submission was made, every byte before it is freed once the fence value completes
+		uint64_t head = 0;
+		uint64_t fenceValue = 0;
+	};
+
+private:
+	uint64_t capacity = 0;
+	// Running byte counts, the ring offset is the count modulo the capacity
+	uint64_t head = 0;
+	uint64_t tail = 0;
+	uint64_t submittedHead = 0;
+	std::deque<sSubmission> submissions;
+};
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "sString.h"
 #include "platform/framework/abstract/platformConsole.h"
 #include "vulkanSurface.h"
+#include "fileIO/fileIO.h"
 
 #define VULKAN_VALIDATION_LAYER_NAME "VK_LAYER_KHRONOS_validation"
 
@@ -429,6 +430,23 @@ static void createImage(const vk::Device& device, const vk::ImageType imageType,
 	}
 }
 
+static uint32_t findMemoryType(const vk::PhysicalDeviceMemoryProperties& memoryProperties, const uint32_t memoryTypeBits, const vk::MemoryPropertyFlags properties)
+{
+	for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i)
+	{
+		if (((memoryTypeBits & (1u << i)) != 0) && ((memoryProperties.memoryTypes[i].propertyFlags & properties) == properties))
+		{
+			return i;
+		}
+	}
+	return UINT32_MAX;
+}
+
+static vk::DeviceMemory toDeviceMemory(void* heap)
+{
+	return vk::DeviceMemory(reinterpret_cast<VkDeviceMemory>(heap));
+}
+
 vulkanGraphics::vulkanGraphics()
 	: graphics(eGraphicsApi::vulkan)
 {
@@ -444,10 +462,14 @@ void vulkanGraphics::init(bool softwareRenderer, uint32_t inBackBufferCount)
 	backBufferCount = inBackBufferCount;
 	makeInstance();
 	makeDevice();
+	makeMemoryAllocator();
+	frameAllocator.init(backBufferCount, frameArenaSize);
 }
 
 void vulkanGraphics::shutdown()
 {
+	frameAllocator.shutdown();
+	memoryAllocator.shutdown();
 	destroyDevice();
 	destroyInstance();
 }
@@ -553,6 +575,7 @@ void vulkanGraphics::createSurface(void* hwnd, uint32_t width, uint32_t height,
 	// Create depth stencil image
 	createImage(device, vk::ImageType::e2D, depthStencilFormat, vk::Extent3D(swapchainExtent, 1), 1, 1, vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal,
 		vk::ImageUsageFlagBits::eDepthStencilAttachment, vk::SharingMode::eExclusive, 0, nullptr, vk::ImageLayout::eUndefined, apiSurface->depthStencilImage);
+	apiSurface->depthStencilMemory = allocateImageMemory(apiSurface->depthStencilImage, vk::MemoryPropertyFlagBits::eDeviceLocal);
 }
 
 void vulkanGraphics::destroySurface(std::shared_ptr<graphicsSurface>& surface)
@@ -563,6 +586,7 @@ void vulkanGraphics::destroySurface(std::shared_ptr<graphicsSurface>& surface)
 
 	// Destroy depth stencil image
 	device.destroyImage(apiSurface->depthStencilImage);
+	memoryAllocator.free(apiSurface->depthStencilMemory);
 
 	// Destroy image views
 	for (const vk::ImageView& imageView : apiSurface->imageViews)
@@ -593,10 +617,13 @@ void vulkanGraphics::setSurfaceUseVSync(graphicsSurface* surface, const bool inU
 
 void vulkanGraphics::beginFrame()
 {
+	// Frames are not yet recorded or submitted, so the arenas are cycled in order as if each frame had finished on the gpu
+	frameAllocator.beginFrame(currentFrameIndex);
+	currentFrameIndex = (currentFrameIndex + 1) % std::max(backBufferCount, 1u);
 }
 
 void vulkanGraphics::render(const uint32_t numSurfaces, graphicsSurface* const* surfaces, const uint32_t renderDataCount, const sRenderData* const* renderData, 
-	const matrix4x4* const viewProjection)
+	const matrix4x4f* const viewProjection)
 {
 }
 
@@ -608,9 +635,21 @@ void vulkanGraphics::endFrame(const uint32_t numSurfaces, graphicsSurface* const
 //{
 //}
 
-void vulkanGraphics::loadMeshes(const uint32_t meshCount, const size_t* vertexCounts, const sVertexPos3Norm3Col4UV2(* const vertices)[], 
+sUploadToken vulkanGraphics::loadMeshes(const uint32_t meshCount, const size_t* vertexCounts, const sVertexPos3Norm3Col4UV2(* const vertices)[], 
 	const size_t* const indexCounts, const uint32_t(* const indices)[], sMeshResources** const outMeshResources)
 {
+	return {};
+}
+
+bool vulkanGraphics::isUploadComplete(const sUploadToken token)
+{
+	// Nothing is uploaded yet
+	return true;
+}
+
+void vulkanGraphics::getMemoryStats(sGpuMemoryStats& outStats) const
+{
+	memoryAllocator.getStats(outStats);
 }
 
 void vulkanGraphics::createInstanceLayersAndExtensionsConfiguration(std::vector<const char*>& outEnabledLayerNames, std::vector<const char*>& outEnabledExtensionNames)
@@ -689,3 +728,126 @@ void vulkanGraphics::destroyDevice()
 	device.destroy();
 }
 
+void vulkanGraphics::makeMemoryAllocator()
+{
+	memoryProperties = physicalDevice.getMemoryProperties();
+	bufferImageGranularity = physicalDevice.getProperties().limits.bufferImageGranularity;
+
+	sGpuAllocatorDesc allocatorDesc = {};
+	allocatorDesc.memoryTypeCount = memoryProperties.memoryTypeCount;
+	allocatorDesc.createHeap = [this](const uint32_t memoryType, const uint64_t size, const bool dedicated) -> void*
+		{
+			try
+			{
+				return reinterpret_cast<void*>(static_cast<VkDeviceMemory>(device.allocateMemory(vk::MemoryAllocateInfo(size, memoryType))));
+			}
+			catch (vk::SystemError err)
+			{
+				return nullptr;
+			}
+		};
+	allocatorDesc.destroyHeap = [this](const uint32_t memoryType, void* heap)
+		{
+			device.freeMemory(toDeviceMemory(heap));
+		};
+	memoryAllocator.init(allocatorDesc);
+}
+
+sGpuAllocation vulkanGraphics::allocateImageMemory(const vk::Image& image, const vk::MemoryPropertyFlags properties)
+{
+	const vk::MemoryRequirements requirements = device.getImageMemoryRequirements(image);
+	const uint32_t memoryType = findMemoryType(memoryProperties, requirements.memoryTypeBits, properties);
+	if (memoryType == UINT32_MAX)
+	{
+		platformLayer::messageBox::showMessageBoxFatal("vulkanGraphics::allocateImageMemory: no memory type supports the image.");
+	}
+
+	// Optimal tiling images get whole bufferImageGranularity pages so they never share a page with a linear buffer
+	const vk::DeviceSize alignment = std::max(requirements.alignment, bufferImageGranularity);
+	const vk::DeviceSize size = (requirements.size + (bufferImageGranularity - 1)) / bufferImageGranularity * bufferImageGranularity;
+	sGpuAllocation allocation = memoryAllocator.allocate(memoryType, size, alignment);
+	if (!allocation.isValid())
+	{
+		platformLayer::messageBox::showMessageBoxFatal("vulkanGraphics::allocateImageMemory: failed to allocate device memory.");
+	}
+
+	device.bindImageMemory(image, toDeviceMemory(allocation.heap), allocation.offset);
+	return allocation;
+}
+
+// Shader kinds are picked from the profile's stage prefix, the same profiles direct3d12 uses
+static shaderc_shader_kind getShaderKind(const std::string& profile)
+{
+	static constexpr std::pair<std::string_view, shaderc_shader_kind> stageKinds[] =
+	{
+		{ "vs", shaderc_vertex_shader },
+		{ "ps", shaderc_fragment_shader },
+		{ "cs", shaderc_compute_shader },
+		{ "gs", shaderc_geometry_shader },
+		{ "hs", shaderc_tess_control_shader },
+		{ "ds", shaderc_tess_evaluation_shader }
+	};
+
+	for (const std::pair<std::string_view, shaderc_shader_kind>& stageKind : stageKinds)
+	{
+		if (profile.starts_with(stageKind.first))
+		{
+			return stageKind.second;
+		}
+	}
+	return shaderc_glsl_infer_from_source;
+}
+
+void vulkanGraphics::getShaderCompiler(sShaderCompiler& outCompiler)
+{
+	unsigned int spirvVersion = 0;
+	unsigned int spirvRevision = 0;
+	shaderc_get_spv_version(&spirvVersion, &spirvRevision);
+
+	outCompiler.compile = &vulkanGraphics::compileShader;
+	outCompiler.version = sString::printf("shaderc spirv %u.%u", spirvVersion, spirvRevision);
+}
+
+bool vulkanGraphics::compileShader(const sShaderDesc& desc, std::vector<uint8_t>& outBinary, std::string& outErrors)
+{
+	const fileIO::mappedFile source(desc.sourceFile, eFileAccessPattern::sequential);
+	if (!source.isOpen())
+	{
+		outErrors = "could not read " + desc.sourceFile;
+		return false;
+	}
+
+	shaderc::CompileOptions options;
+	options.SetOptimizationLevel(shaderc_optimization_level_performance);
+	if (fileIO::getExtension(desc.sourceFile) == ".hlsl")
+	{
+		options.SetSourceLanguage(shaderc_source_language_hlsl);
+	}
+
+	// Defines are NAME or NAME=VALUE
+	for (const std::string& define : desc.defines)
+	{
+		const size_t separator = define.find('=');
+		if (separator == std::string::npos)
+		{
+			options.AddMacroDefinition(define);
+		}
+		else
+		{
+			options.AddMacroDefinition(define.substr(0, separator), define.substr(separator + 1));
+		}
+	}
+
+	// A compiler per call keeps compilation safe to run from several threads
+	const shaderc::Compiler compiler;
+	const shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(reinterpret_cast<const char*>(source.getData().data()), source.getSize(),
+		getShaderKind(desc.profile), desc.sourceFile.c_str(), desc.entryPoint.c_str(), options);
+	if (result.GetCompilationStatus() != shaderc_compilation_status_success)
+	{
+		outErrors = result.GetErrorMessage();
+		return false;
+	}
+
+	outBinary.assign(reinterpret_cast<const uint8_t*>(result.cbegin()), reinterpret_cast<const uint8_t*>(result.cend()));
+	return true;
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "platform/graphics/abstract/graphics.h"
+#include "platform/graphics/shaderBuild.h"
+#include "platform/graphics/gpuAllocator.h"
 
 struct sQueueFamilyIndices
 {
@@ -20,6 +22,7 @@ private:
 #endif // defined(_DEBUG)
 
 	uint32_t backBufferCount = 0;
+	uint32_t currentFrameIndex = 0;
 
 	vk::Instance instance = {};
 
@@ -31,6 +34,15 @@ private:
 	vk::Queue computeQueue = {};
 	vk::Queue transferQueue = {};
 
+	// Device memory is sub-allocated from large vkAllocateMemory heaps, one allocator memory type per vulkan memory type
+	gpuAllocator memoryAllocator;
+	vk::PhysicalDeviceMemoryProperties memoryProperties = {};
+	vk::DeviceSize bufferImageGranularity = 1;
+
+public:
+	// Shaderc, safe to use without a device, e.g. to precompile shaders offline
+	static void getShaderCompiler(sShaderCompiler& outCompiler);
+
 public:
 	vulkanGraphics();
 	~vulkanGraphics() final = default;
@@ -44,10 +56,12 @@ public:
 	void resizeSurface(graphicsSurface* surface, uint32_t width, uint32_t height) final;
 	void setSurfaceUseVSync(graphicsSurface* surface, const bool inUseVSync) final;
 	void beginFrame() final;
-	void render(const uint32_t numSurfaces, graphicsSurface* const* surfaces, const uint32_t renderDataCount, const sRenderData* const* renderData, const matrix4x4* const viewProjection) final;
+	void render(const uint32_t numSurfaces, graphicsSurface* const* surfaces, const uint32_t renderDataCount, const sRenderData* const* renderData, const matrix4x4f* const viewProjection) final;
 	void endFrame(const uint32_t numSurfaces, graphicsSurface* const* surfaces) final;
 	//void loadMesh(const size_t vertexCount, const sVertexPos3Norm3Col4UV2* const vertices, const size_t indexCount, const uint32_t* const indices, sMeshResources& outMeshResources) final;
-	void loadMeshes(const uint32_t meshCount, const size_t* vertexCounts, const sVertexPos3Norm3Col4UV2(* const vertices)[], const size_t* const indexCounts, const uint32_t(* const indices)[], sMeshResources** const outMeshResources) final;
+	sUploadToken loadMeshes(const uint32_t meshCount, const size_t* vertexCounts, const sVertexPos3Norm3Col4UV2(* const vertices)[], const size_t* const indexCounts, const uint32_t(* const indices)[], sMeshResources** const outMeshResources) final;
+	bool isUploadComplete(const sUploadToken token) final;
+	void getMemoryStats(sGpuMemoryStats& outStats) const final;
 
 private:
 	void createInstanceLayersAndExtensionsConfiguration(std::vector<const char*>& outEnabledLayerNames, std::vector<const char*>& outEnabledExtensionNames);
@@ -59,5 +73,13 @@ private:
 	void makeDevice();
 	void destroyDevice();
 
+	void makeMemoryAllocator();
+
+	// Allocates memory for the image and binds it. Fails fatally if no memory type has the properties or the memory cannot be allocated
+	sGpuAllocation allocateImageMemory(const vk::Image& image, const vk::MemoryPropertyFlags properties);
+
+	// Compiles a glsl or hlsl shader to spir-v
+	static bool compileShader(const sShaderDesc& desc, std::vector<uint8_t>& outBinary, std::string& outErrors);
+
 
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "platform/graphics/abstract/graphicsSurface.h"
+#include "platform/graphics/gpuAllocator.h"
 
 class vulkanSurface : public graphicsSurface
 {
@@ -10,6 +11,7 @@ public:
 	std::vector<vk::Image> images = {};
 	std::vector<vk::ImageView> imageViews = {};
 	vk::Image depthStencilImage = {};
+	sGpuAllocation depthStencilMemory = {};
 
 public:
 	vulkanSurface();
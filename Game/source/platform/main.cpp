@@ -1,5 +1,5 @@
 #include "pch.h"
-#include "Game/Game.h"
+#include "game/game.h"
 
 static int initGame()
 {
@@ -14,6 +14,14 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
 	return initGame();
 }
 
+#elif defined(PLATFORM_LINUX)
+
+int main()
+{
+	// Arguments are read back through platformLayer::commandLine
+	return initGame();
+}
+
 #else
 
 unsupported platform
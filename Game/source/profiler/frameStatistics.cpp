@@ -0,0 +1,225 @@
+#include "pch.h"
+#include "frameStatistics.h"
+#include "profiler.h"
+#include "platform/framework/abstract/platformMessageBox.h"
+#include "memory/memoryTracker.h"
+
+#include <iomanip>
+#include <string_view>
+
+static constexpr double nanosecondsPerMillisecond = 1000000.0;
+static constexpr double nanosecondsPerSecond = 1000000000.0;
+
+static bool openExportFile(std::ofstream& ofStream, const std::string& file, const char* caller)
+{
+	ofStream.open(file, std::ios::out | std::ios::binary);
+	if (!ofStream)
+	{
+		platformLayer::messageBox::showMessageBox(platformLayer::messageBox::eMessageLevel::error, std::string(caller) + ": Failed to write frame statistics to " + file + '.');
+		return false;
+	}
+
+	ofStream << std::fixed << std::setprecision(3);
+	return true;
+}
+
+static void writeJsonSummary(std::ofstream& ofStream, const sFrameTimeSummary& summary)
+{
+	ofStream << "{\"frames\":" << summary.frameCount << ",\"meanMs\":" << summary.meanMs << ",\"p50Ms\":" << summary.p50Ms << ",\"p95Ms\":" << summary.p95Ms
+		<< ",\"p99Ms\":" << summary.p99Ms << ",\"maxMs\":" << summary.maxMs << '}';
+}
+
+void frameStatistics::init(const sFrameStatisticsDesc& inDesc)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::profiler);
+	desc = inDesc;
+	desc.windowIntervalCount = std::max(desc.windowIntervalCount, 1u);
+	windowHistograms.assign(desc.windowIntervalCount, frameTimeHistogram());
+}
+
+void frameStatistics::recordFrame(const int64_t timestampNanoseconds)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::profiler);
+	if (previousTimestamp == 0)
+	{
+		firstTimestamp = timestampNanoseconds;
+		previousTimestamp = timestampNanoseconds;
+		intervalStartTimestamp = timestampNanoseconds;
+		return;
+	}
+
+	const int64_t duration = std::max<int64_t>(timestampNanoseconds - previousTimestamp, 0);
+	intervalHistogram.record(static_cast<uint64_t>(duration));
+	totalHistogram.record(static_cast<uint64_t>(duration));
+
+	// The median from the last interval lets the threshold follow the normal frame time, so a slow machine is not a stream of hitches
+	const double thresholdMs = std::max(desc.hitchThresholdMs, desc.hitchMedianMultiple * hitchMedianMs);
+	if ((static_cast<double>(duration) / nanosecondsPerMillisecond) > thresholdMs)
+	{
+		recordHitch(previousTimestamp, timestampNanoseconds, thresholdMs);
+	}
+
+	previousFrameDuration = duration;
+	previousTimestamp = timestampNanoseconds;
+	++frameCount;
+
+	if (static_cast<double>(timestampNanoseconds - intervalStartTimestamp) >= (desc.intervalSeconds * nanosecondsPerSecond))
+	{
+		completeInterval(timestampNanoseconds);
+	}
+}
+
+sFrameTimeSummary frameStatistics::getWindowSummary() const
+{
+	frameTimeHistogram window;
+	const uint32_t windowCount = std::min(completedIntervalCount, static_cast<uint32_t>(windowHistograms.size()));
+	for (uint32_t i = 0; i < windowCount; ++i)
+	{
+		window.add(windowHistograms[i]);
+	}
+	return summarize(window);
+}
+
+bool frameStatistics::exportCsv(const std::string& file) const
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::profiler);
+	std::ofstream ofStream;
+	if (!openExportFile(ofStream, file, "frameStatistics::exportCsv"))
+	{
+		return false;
+	}
+
+	ofStream << "startSeconds,frames,meanMs,p50Ms,p95Ms,p99Ms,maxMs\n";
+	for (const sIntervalSummary& interval : intervalSummaries)
+	{
+		const sFrameTimeSummary& summary = interval.summary;
+		ofStream << interval.startSeconds << ',' << summary.frameCount << ',' << summary.meanMs << ',' << summary.p50Ms << ',' << summary.p95Ms << ','
+			<< summary.p99Ms << ',' << summary.maxMs << '\n';
+	}
+	return ofStream.good();
+}
+
+bool frameStatistics::exportJson(const std::string& file) const
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::profiler);
+	std::ofstream ofStream;
+	if (!openExportFile(ofStream, file, "frameStatistics::exportJson"))
+	{
+		return false;
+	}
+
+	ofStream << "{\n\"total\":";
+	writeJsonSummary(ofStream, getTotalSummary());
+	ofStream << ",\n\"window\":";
+	writeJsonSummary(ofStream, getWindowSummary());
+
+	ofStream << ",\n\"histogram\":[";
+	bool firstBucket = true;
+	for (uint32_t i = 0; i < frameTimeHistogram::bucketCount; ++i)
+	{
+		if (totalHistogram.getBucketCount(i) == 0)
+		{
+			continue;
+		}
+
+		ofStream << (firstBucket ? "\n" : ",\n") << "{\"lowerNs\":" << frameTimeHistogram::getBucketLowerBound(i) << ",\"upperNs\":" << frameTimeHistogram::getBucketUpperBound(i)
+			<< ",\"count\":" << totalHistogram.getBucketCount(i) << '}';
+		firstBucket = false;
+	}
+
+	ofStream << "],\n\"hitches\":[";
+	for (size_t i = 0; i < hitches.size(); ++i)
+	{
+		const sHitchEvent& hitch = hitches[i];
+		ofStream << ((i == 0) ? "\n" : ",\n") << "{\"frame\":" << hitch.frameIndex << ",\"timeSeconds\":" << hitch.timeSeconds << ",\"frameMs\":" << hitch.frameMs
+			<< ",\"thresholdMs\":" << hitch.thresholdMs << ",\"zones\":[";
+		for (size_t z = 0; z < hitch.zones.size(); ++z)
+		{
+			// Zone names are identifiers from PROFILE_SCOPE, quotes and backslashes are the only characters that need escaping
+			std::string name = (hitch.zones[z].name != nullptr) ? hitch.zones[z].name : "unnamed";
+			for (size_t c = 0; c < name.size(); ++c)
+			{
+				if ((name[c] == '"') || (name[c] == '\\'))
+				{
+					name.insert(c++, 1, '\\');
+				}
+			}
+
+			ofStream << ((z == 0) ? "" : ",") << "{\"name\":\"" << name << "\",\"hitchFrameMs\":" << hitch.zones[z].hitchFrameMs << ",\"previousFrameMs\":" << hitch.zones[z].previousFrameMs << '}';
+		}
+		ofStream << "]}";
+	}
+	ofStream << "]\n}\n";
+	return ofStream.good();
+}
+
+sFrameTimeSummary frameStatistics::summarize(const frameTimeHistogram& histogram)
+{
+	sFrameTimeSummary summary;
+	summary.frameCount = histogram.getTotalCount();
+	summary.meanMs = histogram.getMean() / nanosecondsPerMillisecond;
+	summary.p50Ms = static_cast<double>(histogram.getValueAtPercentile(50.0)) / nanosecondsPerMillisecond;
+	summary.p95Ms = static_cast<double>(histogram.getValueAtPercentile(95.0)) / nanosecondsPerMillisecond;
+	summary.p99Ms = static_cast<double>(histogram.getValueAtPercentile(99.0)) / nanosecondsPerMillisecond;
+	summary.maxMs = static_cast<double>(histogram.getMax()) / nanosecondsPerMillisecond;
+	return summary;
+}
+
+void frameStatistics::completeInterval(const int64_t timestampNanoseconds)
+{
+	sIntervalSummary& interval = intervalSummaries.emplace_back();
+	interval.startSeconds = static_cast<double>(intervalStartTimestamp - firstTimestamp) / nanosecondsPerSecond;
+	interval.summary = summarize(intervalHistogram);
+	hitchMedianMs = interval.summary.p50Ms;
+
+	if (!windowHistograms.empty())
+	{
+		windowHistograms[completedIntervalCount % windowHistograms.size()] = intervalHistogram;
+	}
+	++completedIntervalCount;
+
+	intervalHistogram.clear();
+	intervalStartTimestamp = timestampNanoseconds;
+}
+
+void frameStatistics::recordHitch(const int64_t frameBeginNanoseconds, const int64_t frameEndNanoseconds, const double thresholdMs)
+{
+	sHitchEvent& hitch = hitches.emplace_back();
+	hitch.frameIndex = frameCount;
+	hitch.timeSeconds = static_cast<double>(frameBeginNanoseconds - firstTimestamp) / nanosecondsPerSecond;
+	hitch.frameMs = static_cast<double>(frameEndNanoseconds - frameBeginNanoseconds) / nanosecondsPerMillisecond;
+	hitch.thresholdMs = thresholdMs;
+
+	// Compare each zone's time in the hitch frame with the frame before it. The zones that grew the most are the ones that blew up
+	const int64_t previousFrameBeginNanoseconds = frameBeginNanoseconds - previousFrameDuration;
+	std::vector<sProfileZone> zones;
+	profiler::collectZones(previousFrameBeginNanoseconds, frameEndNanoseconds, zones);
+
+	std::unordered_map<std::string_view, sHitchZone> zoneTotals;
+	for (const sProfileZone& zone : zones)
+	{
+		if (zone.name == nullptr)
+		{
+			continue;
+		}
+
+		sHitchZone& total = zoneTotals[zone.name];
+		total.name = zone.name;
+
+		// Zones crossing a frame boundary are split between the frames they overlap
+		const int64_t hitchOverlap = std::min(zone.endNanoseconds, frameEndNanoseconds) - std::max(zone.beginNanoseconds, frameBeginNanoseconds);
+		const int64_t previousOverlap = std::min(zone.endNanoseconds, frameBeginNanoseconds) - std::max(zone.beginNanoseconds, previousFrameBeginNanoseconds);
+		total.hitchFrameMs += static_cast<double>(std::max<int64_t>(hitchOverlap, 0)) / nanosecondsPerMillisecond;
+		total.previousFrameMs += static_cast<double>(std::max<int64_t>(previousOverlap, 0)) / nanosecondsPerMillisecond;
+	}
+
+	hitch.zones.reserve(zoneTotals.size());
+	for (const std::pair<const std::string_view, sHitchZone>& total : zoneTotals)
+	{
+		hitch.zones.push_back(total.second);
+	}
+
+	std::sort(hitch.zones.begin(), hitch.zones.end(),
+		[](const sHitchZone& a, const sHitchZone& b) { return (a.hitchFrameMs - a.previousFrameMs) > (b.hitchFrameMs - b.previousFrameMs); });
+	hitch.zones.resize(std::min<size_t>(hitch.zones.size(), desc.hitchZoneCount));
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "frameTimeHistogram.h"
+
+struct sFrameStatisticsDesc
+{
+	// Length of each summary interval in seconds. Percentiles are reported per interval and over a sliding window of intervals
+	double intervalSeconds = 1.0;
+
+	// Number of recent intervals in the sliding window
+	uint32_t windowIntervalCount = 10;
+
+	// A frame is a hitch when it takes longer than both the absolute threshold and the multiple of the last interval's median
+	double hitchThresholdMs = 1000.0 / 30.0;
+	double hitchMedianMultiple = 2.0;
+
+	// Number of profiler zones recorded with each hitch, ordered by how much longer they took than in the frame before
+	uint32_t hitchZoneCount = 8;
+};
+
+struct sFrameTimeSummary
+{
+	uint64_t frameCount = 0;
+	double meanMs = 0.0;
+	double p50Ms = 0.0;
+	double p95Ms = 0.0;
+	double p99Ms = 0.0;
+	double maxMs = 0.0;
+};
+
+// Total time spent in every zone with the same name during a hitch frame and during the frame before it
+struct sHitchZone
+{
+	const char* name = nullptr;
+	double hitchFrameMs = 0.0;
+	double previousFrameMs = 0.0;
+};
+
+struct sHitchEvent
+{
+	uint64_t frameIndex = 0;
+	double timeSeconds = 0.0;
+	double frameMs = 0.0;
+	double thresholdMs = 0.0;
+	std::vector<sHitchZone> zones;
+};
+
+// Aggregates frame times into log histograms. Each interval has its own histogram so percentiles over the sliding window are the sum of
+// a few histograms rather than a sort of every frame. Hitches look up the profiler zones recorded during the frame, which is only
+// possible when the profiler is compiled in
+class frameStatistics
+{
+public:
+	void init(const sFrameStatisticsDesc& inDesc);
+
+	// Call once per frame with the timestamp the frame started at. The first call starts timing and records nothing
+	void recordFrame(const int64_t timestampNanoseconds);
+
+	// Returns the summary over the completed intervals in the sliding window
+	sFrameTimeSummary getWindowSummary() const;
+
+	// Returns the summary over every frame recorded
+	sFrameTimeSummary getTotalSummary() const { return summarize(totalHistogram); }
+
+	const std::vector<sHitchEvent>& getHitches() const { return hitches; }
+
+	/** Writes one row per completed interval with its frame count and percentiles
+	* @return True if the file was written, otherwise false
+	*/
+	bool exportCsv(const std::string& file) const;
+
+	/** Writes the total and window summaries, the non empty histogram buckets and every hitch with its zones
+	* @return True if the file was written, otherwise false
+	*/
+	bool exportJson(const std::string& file) const;
+
+private:
+	struct sIntervalSummary
+	{
+		double startSeconds = 0.0;
+		sFrameTimeSummary summary;
+	};
+
+private:
+	sFrameStatisticsDesc desc;
+	int64_t firstTimestamp = 0;
+	int64_t previousTimestamp = 0;
+	int64_t previousFrameDuration = 0;
+	int64_t intervalStartTimestamp = 0;
+	uint64_t frameCount = 0;
+	double hitchMedianMs = 0.0;
+
+	frameTimeHistogram intervalHistogram;
+	frameTimeHistogram totalHistogram;
+
+	// Ring of the most recent completed interval histograms
+	std::vector<frameTimeHistogram> windowHistograms;
+	uint32_t completedIntervalCount = 0;
+
+	std::vector<sIntervalSummary> intervalSummaries;
+	std::vector<sHitchEvent> hitches;
+
+private:
+	static sFrameTimeSummary summarize(const frameTimeHistogram& histogram);
+	void completeInterval(const int64_t timestampNanoseconds);
+	void recordHitch(const int64_t frameBeginNanoseconds, const int64_t frameEndNanoseconds, const double thresholdMs);
+};
\ No newline at end of file
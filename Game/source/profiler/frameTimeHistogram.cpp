@@ -0,0 +1,85 @@
+#include "pch.h"
+#include "frameTimeHistogram.h"
+
+#include <bit>
+
+void frameTimeHistogram::record(const uint64_t nanoseconds)
+{
+	++counts[getBucketIndex(nanoseconds)];
+	++totalCount;
+	totalNanoseconds += nanoseconds;
+	minRecorded = std::min(minRecorded, nanoseconds);
+	maxRecorded = std::max(maxRecorded, nanoseconds);
+}
+
+void frameTimeHistogram::add(const frameTimeHistogram& other)
+{
+	for (uint32_t i = 0; i < bucketCount; ++i)
+	{
+		counts[i] += other.counts[i];
+	}
+	totalCount += other.totalCount;
+	totalNanoseconds += other.totalNanoseconds;
+	minRecorded = std::min(minRecorded, other.minRecorded);
+	maxRecorded = std::max(maxRecorded, other.maxRecorded);
+}
+
+void frameTimeHistogram::clear()
+{
+	*this = frameTimeHistogram();
+}
+
+uint64_t frameTimeHistogram::getValueAtPercentile(const double percentile) const
+{
+	if (totalCount == 0)
+	{
+		return 0;
+	}
+
+	// The rank of the requested value, at least the first value so percentile 0 returns the minimum bucket
+	const double clampedPercentile = std::clamp(percentile, 0.0, 100.0);
+	const uint64_t rank = std::max<uint64_t>(static_cast<uint64_t>(std::ceil((clampedPercentile / 100.0) * static_cast<double>(totalCount))), 1);
+
+	uint64_t cumulativeCount = 0;
+	for (uint32_t i = 0; i < bucketCount; ++i)
+	{
+		cumulativeCount += counts[i];
+		if (cumulativeCount >= rank)
+		{
+			// The recorded maximum is exact, never report a value above it
+			return std::min(getBucketUpperBound(i), maxRecorded);
+		}
+	}
+	return maxRecorded;
+}
+
+uint32_t frameTimeHistogram::getBucketIndex(const uint64_t nanoseconds)
+{
+	const uint64_t value = std::min(nanoseconds, maxValue);
+	if (value < (2 * subBucketCount))
+	{
+		return static_cast<uint32_t>(value);
+	}
+
+	// The leading bit selects the power of two range and the next subBucketBits bits select the linear bucket inside it
+	const uint32_t magnitude = static_cast<uint32_t>(std::bit_width(value)) - 1;
+	const uint32_t subBucket = static_cast<uint32_t>(value >> (magnitude - subBucketBits)) & (subBucketCount - 1);
+	return (2 * subBucketCount) + ((magnitude - subBucketBits - 1) * subBucketCount) + subBucket;
+}
+
+uint64_t frameTimeHistogram::getBucketLowerBound(const uint32_t bucket)
+{
+	if (bucket < (2 * subBucketCount))
+	{
+		return bucket;
+	}
+
+	const uint32_t magnitude = ((bucket - (2 * subBucketCount)) / subBucketCount) + subBucketBits + 1;
+	const uint64_t subBucket = (bucket - (2 * subBucketCount)) % subBucketCount;
+	return (subBucketCount + subBucket) << (magnitude - subBucketBits);
+}
+
+uint64_t frameTimeHistogram::getBucketUpperBound(const uint32_t bucket)
+{
+	return (bucket + 1 < bucketCount) ? (getBucketLowerBound(bucket + 1) - 1) : maxValue;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+// Log bucketed histogram of durations in nanoseconds, in the style of HdrHistogram. Values below 2 * subBucketCount are counted exactly,
+// above that every power of two range is split into subBucketCount linear buckets, so a value is stored within 1 / subBucketCount of
+// its true size across the whole range from 1 ns to maxValue. Recording is a few bit operations and an increment
+class frameTimeHistogram
+{
+public:
+	static constexpr uint32_t subBucketBits = 5;
+	static constexpr uint32_t subBucketCount = 1u << subBucketBits;
+
+	// Values above this are counted in the last bucket. 2^40 ns is about 18 minutes
+	static constexpr uint32_t maxMagnitude = 40;
+	static constexpr uint64_t maxValue = (static_cast<uint64_t>(1) << (maxMagnitude + 1)) - 1;
+	static constexpr uint32_t bucketCount = (2 * subBucketCount) + ((maxMagnitude - subBucketBits) * subBucketCount);
+
+public:
+	void record(const uint64_t nanoseconds);
+
+	// Adds every count of other into this histogram
+	void add(const frameTimeHistogram& other);
+	void clear();
+
+	// Returns the highest value equivalent to the bucket holding the given percentile in [0, 100]. Returns 0 for an empty histogram
+	uint64_t getValueAtPercentile(const double percentile) const;
+
+	uint64_t getTotalCount() const { return totalCount; }
+	uint64_t getMin() const { return (totalCount > 0) ? minRecorded : 0; }
+	uint64_t getMax() const { return maxRecorded; }
+	double getMean() const { return (totalCount > 0) ? (static_cast<double>(totalNanoseconds) / static_cast<double>(totalCount)) : 0.0; }
+
+	uint64_t getBucketCount(const uint32_t bucket) const { return counts[bucket]; }
+	static uint32_t getBucketIndex(const uint64_t nanoseconds);
+	static uint64_t getBucketLowerBound(const uint32_t bucket);
+	static uint64_t getBucketUpperBound(const uint32_t bucket);
+
+private:
+	uint64_t counts[bucketCount] = {};
+	uint64_t totalCount = 0;
+	uint64_t totalNanoseconds = 0;
+	uint64_t minRecorded = UINT64_MAX;
+	uint64_t maxRecorded = 0;
+};
\ No newline at end of file
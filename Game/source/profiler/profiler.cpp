@@ -0,0 +1,261 @@
+#include "pch.h"
+#include "profiler.h"
+#include "platform/framework/abstract/platformTiming.h"
+#include "platform/framework/abstract/platformMessageBox.h"
+#include "memory/memoryTracker.h"
+
+static_assert((profiler::zonesPerThread & (profiler::zonesPerThread - 1)) == 0, "profiler: zonesPerThread must be a power of two");
+static_assert((profiler::maxFrameMarkers & (profiler::maxFrameMarkers - 1)) == 0, "profiler: maxFrameMarkers must be a power of two");
+
+// Slots are atomics so a reader can copy a ring while its owner overwrites it. Relaxed loads and stores compile to plain moves
+struct sZoneSlot
+{
+	std::atomic<const char*> name = nullptr;
+	std::atomic<int64_t> beginNanoseconds = 0;
+	std::atomic<int64_t> endNanoseconds = 0;
+};
+
+struct sFrameSlot
+{
+	std::atomic<uint64_t> frameIndex = 0;
+	std::atomic<int64_t> timestamp = 0;
+};
+
+// Single producer ring of zones owned by one thread. writeCount is published after the slot is written
+struct sThreadZoneBuffer
+{
+	alignas(64) std::atomic<uint64_t> writeCount = 0;
+	std::atomic<const char*> threadName = nullptr;
+	uint32_t threadId = 0;
+	alignas(64) sZoneSlot zones[profiler::zonesPerThread];
+};
+
+// Buffers are kept until the program exits so zones from finished threads can still be exported
+static std::unique_ptr<sThreadZoneBuffer> ownedThreadBuffers[profiler::maxThreads];
+static std::atomic<sThreadZoneBuffer*> threadBuffers[profiler::maxThreads] = {};
+static std::atomic<uint32_t> threadBufferCount = 0;
+static thread_local sThreadZoneBuffer* localThreadBuffer = nullptr;
+
+static std::atomic<uint64_t> frameCount = 0;
+static sFrameSlot frameMarkers[profiler::maxFrameMarkers];
+
+static sThreadZoneBuffer* getLocalThreadBuffer()
+{
+	if (localThreadBuffer == nullptr)
+	{
+		MEMORY_TAG_SCOPE(eMemoryTag::profiler);
+		const uint32_t index = threadBufferCount.fetch_add(1, std::memory_order_relaxed);
+		if (index >= profiler::maxThreads)
+		{
+			// Too many threads, zones from this thread are dropped
+			return nullptr;
+		}
+
+		ownedThreadBuffers[index] = std::make_unique<sThreadZoneBuffer>();
+		ownedThreadBuffers[index]->threadId = index;
+		localThreadBuffer = ownedThreadBuffers[index].get();
+		threadBuffers[index].store(localThreadBuffer, std::memory_order_release);
+	}
+	return localThreadBuffer;
+}
+
+// Appends the zones of one thread that were not overwritten while they were being copied
+static void copyThreadZones(const sThreadZoneBuffer& buffer, std::vector<sProfileZone>& outZones)
+{
+	const uint64_t writeCount = buffer.writeCount.load(std::memory_order_acquire);
+	const uint64_t first = (writeCount > profiler::zonesPerThread) ? (writeCount - profiler::zonesPerThread) : 0;
+
+	const size_t outStart = outZones.size();
+	for (uint64_t i = first; i < writeCount; ++i)
+	{
+		const sZoneSlot& slot = buffer.zones[i & (profiler::zonesPerThread - 1)];
+		sProfileZone& zone = outZones.emplace_back();
+		zone.name = slot.name.load(std::memory_order_relaxed);
+		zone.beginNanoseconds = slot.beginNanoseconds.load(std::memory_order_relaxed);
+		zone.endNanoseconds = slot.endNanoseconds.load(std::memory_order_relaxed);
+		zone.threadId = buffer.threadId;
+	}
+
+	// Slots the owner started writing since writeCount was read may be torn. The owner can be one zone ahead of the count it has published
+	std::atomic_thread_fence(std::memory_order_acquire);
+	const uint64_t laterWriteCount = buffer.writeCount.load(std::memory_order_relaxed);
+	const uint64_t firstIntact = ((laterWriteCount + 1) > profiler::zonesPerThread) ? ((laterWriteCount + 1) - profiler::zonesPerThread) : 0;
+	if (firstIntact > first)
+	{
+		const size_t tornCount = static_cast<size_t>(std::min(firstIntact, writeCount) - first);
+		outZones.erase(outZones.begin() + outStart, outZones.begin() + outStart + tornCount);
+	}
+}
+
+static void appendFormatted(std::string& out, const char* format, ...)
+{
+	// Every formatted event fragment fits in the fixed buffer so exporting does not allocate per event
+	char buffer[256];
+	va_list args;
+	va_start(args, format);
+	const int32_t length = vsnprintf(buffer, sizeof(buffer), format, args);
+	va_end(args);
+	out.append(buffer, static_cast<size_t>(std::clamp<int32_t>(length, 0, sizeof(buffer) - 1)));
+}
+
+static void appendEscapedJsonString(std::string& out, const char* string)
+{
+	out += '"';
+	for (const char* c = (string != nullptr) ? string : "unnamed"; *c != '\0'; ++c)
+	{
+		if ((*c == '"') || (*c == '\\'))
+		{
+			out += '\\';
+		}
+		out += *c;
+	}
+	out += '"';
+}
+
+int64_t profiler::getTimestamp()
+{
+	return platformLayer::timing::getTimestampNanoseconds();
+}
+
+void profiler::recordZone(const char* name, const int64_t beginNanoseconds, const int64_t endNanoseconds)
+{
+	sThreadZoneBuffer* const buffer = getLocalThreadBuffer();
+	if (buffer == nullptr)
+	{
+		return;
+	}
+
+	const uint64_t writeIndex = buffer->writeCount.load(std::memory_order_relaxed);
+	sZoneSlot& slot = buffer->zones[writeIndex & (zonesPerThread - 1)];
+	slot.name.store(name, std::memory_order_relaxed);
+	slot.beginNanoseconds.store(beginNanoseconds, std::memory_order_relaxed);
+	slot.endNanoseconds.store(endNanoseconds, std::memory_order_relaxed);
+	buffer->writeCount.store(writeIndex + 1, std::memory_order_release);
+}
+
+void profiler::markFrame()
+{
+	const uint64_t frameIndex = frameCount.load(std::memory_order_relaxed);
+	sFrameSlot& slot = frameMarkers[frameIndex & (maxFrameMarkers - 1)];
+	slot.frameIndex.store(frameIndex, std::memory_order_relaxed);
+	slot.timestamp.store(getTimestamp(), std::memory_order_relaxed);
+	frameCount.store(frameIndex + 1, std::memory_order_release);
+}
+
+void profiler::setThreadName(const char* name)
+{
+	if (sThreadZoneBuffer* const buffer = getLocalThreadBuffer())
+	{
+		buffer->threadName.store(name, std::memory_order_release);
+	}
+}
+
+uint64_t profiler::getFrameCount()
+{
+	return frameCount.load(std::memory_order_acquire);
+}
+
+void profiler::collectZones(const int64_t beginNanoseconds, const int64_t endNanoseconds, std::vector<sProfileZone>& outZones)
+{
+	const uint32_t threadCount = std::min(threadBufferCount.load(std::memory_order_acquire), maxThreads);
+	for (uint32_t i = 0; i < threadCount; ++i)
+	{
+		const sThreadZoneBuffer* const buffer = threadBuffers[i].load(std::memory_order_acquire);
+		if (buffer == nullptr)
+		{
+			continue;
+		}
+
+		const size_t outStart = outZones.size();
+		copyThreadZones(*buffer, outZones);
+		outZones.erase(std::remove_if(outZones.begin() + outStart, outZones.end(),
+			[beginNanoseconds, endNanoseconds](const sProfileZone& zone) { return (zone.endNanoseconds <= beginNanoseconds) || (zone.beginNanoseconds >= endNanoseconds); }),
+			outZones.end());
+	}
+}
+
+bool profiler::exportChromeTrace(const std::string& file)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::profiler);
+	std::vector<sProfileZone> zones;
+	collectZones(INT64_MIN, INT64_MAX, zones);
+
+	std::vector<std::pair<uint64_t, int64_t>> frames;
+	const uint64_t markedFrameCount = frameCount.load(std::memory_order_acquire);
+	for (uint64_t i = (markedFrameCount > maxFrameMarkers) ? (markedFrameCount - maxFrameMarkers) : 0; i < markedFrameCount; ++i)
+	{
+		const sFrameSlot& slot = frameMarkers[i & (maxFrameMarkers - 1)];
+		frames.emplace_back(slot.frameIndex.load(std::memory_order_relaxed), slot.timestamp.load(std::memory_order_relaxed));
+	}
+
+	// Timestamps are written relative to the earliest event in microseconds, the unit of the trace event format
+	int64_t baseNanoseconds = INT64_MAX;
+	for (const sProfileZone& zone : zones)
+	{
+		baseNanoseconds = std::min(baseNanoseconds, zone.beginNanoseconds);
+	}
+	for (const std::pair<uint64_t, int64_t>& frame : frames)
+	{
+		baseNanoseconds = std::min(baseNanoseconds, frame.second);
+	}
+	const auto toMicroseconds = [baseNanoseconds](const int64_t nanoseconds) { return static_cast<double>(nanoseconds - baseNanoseconds) / 1000.0; };
+
+	std::ofstream ofStream(file, std::ios::out | std::ios::binary);
+	if (!ofStream)
+	{
+		platformLayer::messageBox::showMessageBox(platformLayer::messageBox::eMessageLevel::error, "profiler::exportChromeTrace: Failed to write trace to " + file + '.');
+		return false;
+	}
+
+	std::string json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+	bool firstEvent = true;
+	const auto beginEvent = [&json, &firstEvent]()
+		{
+			if (!firstEvent)
+			{
+				json += ",\n";
+			}
+			firstEvent = false;
+		};
+
+	const uint32_t threadCount = std::min(threadBufferCount.load(std::memory_order_acquire), maxThreads);
+	for (uint32_t i = 0; i < threadCount; ++i)
+	{
+		const sThreadZoneBuffer* const buffer = threadBuffers[i].load(std::memory_order_acquire);
+		const char* const threadName = (buffer != nullptr) ? buffer->threadName.load(std::memory_order_acquire) : nullptr;
+		if (threadName != nullptr)
+		{
+			beginEvent();
+			appendFormatted(json, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", i);
+			appendEscapedJsonString(json, threadName);
+			json += "}}";
+		}
+	}
+
+	for (const std::pair<uint64_t, int64_t>& frame : frames)
+	{
+		beginEvent();
+		appendFormatted(json, "{\"name\":\"frame %llu\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":%.3f}",
+			static_cast<unsigned long long>(frame.first), toMicroseconds(frame.second));
+	}
+
+	for (const sProfileZone& zone : zones)
+	{
+		beginEvent();
+		json += "{\"name\":";
+		appendEscapedJsonString(json, zone.name);
+		appendFormatted(json, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+			zone.threadId, toMicroseconds(zone.beginNanoseconds), static_cast<double>(zone.endNanoseconds - zone.beginNanoseconds) / 1000.0);
+
+		// Flush in blocks so large traces are not built in memory all at once
+		if (json.size() > (1 << 20))
+		{
+			ofStream.write(json.data(), json.size());
+			json.clear();
+		}
+	}
+
+	json += "\n]}\n";
+	ofStream.write(json.data(), json.size());
+	return ofStream.good();
+}
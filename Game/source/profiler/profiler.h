@@ -0,0 +1,83 @@
+#pragma once
+
+// Zone names are stored by pointer and must have static storage duration, e.g. string literals
+#if defined(ENABLE_PROFILER)
+#define PROFILE_CONCATENATE_INNER(a, b) a##b
+#define PROFILE_CONCATENATE(a, b) PROFILE_CONCATENATE_INNER(a, b)
+
+// Records a zone from this line to the end of the enclosing scope
+#define PROFILE_SCOPE(name) const profileScope PROFILE_CONCATENATE(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+
+// Marks the start of a new frame. Call from one thread only, normally the game thread
+#define PROFILE_FRAME() profiler::markFrame()
+
+// Names the calling thread in exported traces
+#define PROFILE_THREAD(name) profiler::setThreadName(name)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_FRAME()
+#define PROFILE_THREAD(name)
+#endif // defined(ENABLE_PROFILER)
+
+// A finished zone with timestamps from platformLayer::timing::getTimestampNanoseconds
+struct sProfileZone
+{
+	const char* name = nullptr;
+	int64_t beginNanoseconds = 0;
+	int64_t endNanoseconds = 0;
+	uint32_t threadId = 0;
+};
+
+// Scoped cpu profiler. Each thread records finished zones into its own fixed size ring buffer, so recording is a timestamp read and
+// a few stores with no locks or allocation after the thread's first zone. Readers copy the rings while threads keep recording and drop
+// any zone that was overwritten during the copy. Only the most recent zonesPerThread zones of each thread are kept.
+// Use the PROFILE_ macros rather than calling this directly so profiling compiles out when ENABLE_PROFILER is not defined
+class profiler
+{
+public:
+	static constexpr uint32_t zonesPerThread = 16384;
+	static constexpr uint32_t maxThreads = 64;
+	static constexpr uint32_t maxFrameMarkers = 4096;
+
+public:
+	static int64_t getTimestamp();
+
+	static void recordZone(const char* name, const int64_t beginNanoseconds, const int64_t endNanoseconds);
+	static void markFrame();
+	static void setThreadName(const char* name);
+
+	// Returns the number of frames marked since the program started
+	static uint64_t getFrameCount();
+
+	// Copies every recorded zone that overlaps [beginNanoseconds, endNanoseconds) into outZones
+	static void collectZones(const int64_t beginNanoseconds, const int64_t endNanoseconds, std::vector<sProfileZone>& outZones);
+
+	/** Writes every recorded zone and frame marker to a chrome trace event json file, viewable in chrome://tracing or ui.perfetto.dev.
+	* Call from the thread that marks frames
+	* @return True if the file was written, otherwise false
+	*/
+	static bool exportChromeTrace(const std::string& file);
+};
+
+class profileScope
+{
+public:
+	explicit profileScope(const char* inName)
+		: name(inName), beginNanoseconds(profiler::getTimestamp())
+	{
+	}
+
+	~profileScope()
+	{
+		profiler::recordZone(name, beginNanoseconds, profiler::getTimestamp());
+	}
+
+	profileScope(const profileScope&) = delete;
+	profileScope& operator=(const profileScope&) = delete;
+
+private:
+	const char* name;
+	int64_t beginNanoseconds;
+};
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "sGuid.h"
 #include "math/mathLibrary.h"
+#include "math/randomEngine.h"
 #include "sString.h"
 
 sGuid::sGuid()
@@ -8,12 +9,21 @@ sGuid::sGuid()
     reset();
 }
 
+sGuid::sGuid(const uint32_t inA, const uint32_t inB, const uint32_t inC, const uint32_t inD)
+    : a(inA), b(inB), c(inC), d(inD)
+{
+}
+
 void sGuid::newGuid()
 {
-    a = mathLibrary::randomUInt32();
-    b = mathLibrary::randomUInt32();
-    c = mathLibrary::randomUInt32();
-    d = mathLibrary::randomUInt32();
+    // Two 64-bit draws from the calling thread's engine fill all four components
+    randomEngine& engine = mathLibrary::getThreadRandomEngine();
+    const uint64_t high = engine.next();
+    const uint64_t low = engine.next();
+    a = static_cast<uint32_t>(high >> 32);
+    b = static_cast<uint32_t>(high);
+    c = static_cast<uint32_t>(low >> 32);
+    d = static_cast<uint32_t>(low);
 }
 
 void sGuid::reset()
@@ -15,6 +15,9 @@ public:
 	// Default constructor
 	sGuid();
 
+	// Constructs a guid from its components, e.g. when reading it back from an archive
+	sGuid(const uint32_t inA, const uint32_t inB, const uint32_t inC, const uint32_t inD);
+
 	// Access immutable individual components through index
 	const uint32_t& operator[](const size_t index) const
 	{
@@ -1,27 +1,75 @@
 #include "pch.h"
 #include "sString.h"
+#include "memory/linearArena.h"
+
+// Most formatted strings fit in this many bytes and are formatted once, longer ones are measured here and formatted again
+static constexpr size_t stackFormatBufferSize = 256;
 
 std::string sString::printf(const char* format, ...)
 {
 	va_list args;
 	va_start(args, format);
 
-	// Convert to formatted string to a string. Requires heap allocation
-	size_t size = vsnprintf(nullptr, 0, format, args) + 1;
+	// Formatting consumes the argument list, so format with a copy in case a second pass is needed
+	va_list firstPassArgs;
+	va_copy(firstPassArgs, args);
+	char stackBuffer[stackFormatBufferSize];
+	const int32_t length = vsnprintf(stackBuffer, sizeof(stackBuffer), format, firstPassArgs);
+	va_end(firstPassArgs);
+
 	std::string buf;
-	buf.resize(size);
-	vsnprintf(buf.data(), size, format, args);
-	buf[size - 1] = '\0';
+	if (length > 0)
+	{
+		if (static_cast<size_t>(length) < sizeof(stackBuffer))
+		{
+			buf.assign(stackBuffer, static_cast<size_t>(length));
+		}
+		else
+		{
+			// The string owns its terminator, so the formatted characters exactly fill the resized string
+			buf.resize(static_cast<size_t>(length));
+			vsnprintf(buf.data(), buf.size() + 1, format, args);
+		}
+	}
+
+	va_end(args);
+
+	return buf;
+}
+
+std::string_view sString::printf(linearArena& arena, const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
 
-	// Print string created from formatted string
-	//std::cout << buf << '\n';
+	va_list firstPassArgs;
+	va_copy(firstPassArgs, args);
+	char stackBuffer[stackFormatBufferSize];
+	const int32_t length = vsnprintf(stackBuffer, sizeof(stackBuffer), format, firstPassArgs);
+	va_end(firstPassArgs);
 
-	// Just print formatted string
-	//vprintf(format, args);
+	std::string_view result;
+	if (length > 0)
+	{
+		// Keep a terminator so the characters can be passed to c apis
+		char* const characters = static_cast<char*>(arena.allocate(static_cast<size_t>(length) + 1, alignof(char)));
+		if (characters != nullptr)
+		{
+			if (static_cast<size_t>(length) < sizeof(stackBuffer))
+			{
+				memcpy(characters, stackBuffer, static_cast<size_t>(length) + 1);
+			}
+			else
+			{
+				vsnprintf(characters, static_cast<size_t>(length) + 1, format, args);
+			}
+			result = std::string_view(characters, static_cast<size_t>(length));
+		}
+	}
 
 	va_end(args);
 
-	return buf;
+	return result;
 }
 
 sString::sString(const std::string& string)
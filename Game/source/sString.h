@@ -1,11 +1,17 @@
 #pragma once
 
+class linearArena;
+
 // Thin wrapper struct around std::string to provide helper functions
 struct sString
 {
 public:
 	static std::string printf(const char* format, ...);
 
+	// Formats into arena memory instead of the heap. The view is valid until the arena is rewound past it, e.g. when the enclosing
+	// scratchScope ends. Returns an empty view if the arena is full
+	static std::string_view printf(linearArena& arena, const char* format, ...);
+
 public:
 	sString() = default;
 	sString(const std::string& string);
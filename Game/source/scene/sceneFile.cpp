@@ -0,0 +1,92 @@
+#include "pch.h"
+#include "sceneFile.h"
+#include "transformHierarchy.h"
+#include "fileIO/fileIO.h"
+#include "profiler/profiler.h"
+#include "memory/memoryTracker.h"
+
+#include <fstream>
+
+bool sceneFile::save(const std::string& file, transformHierarchy& transforms)
+{
+	PROFILE_SCOPE("sceneFile::save");
+	MEMORY_TAG_SCOPE(eMemoryTag::scene);
+
+	transforms.update();
+	const std::span<const uint32_t> nodes = transforms.getDepthFirstNodes();
+
+	// Node ids are not stored, parents are referenced by their position in the file
+	std::unordered_map<uint32_t, uint32_t> fileIndices;
+	fileIndices.reserve(nodes.size());
+
+	blobBuilder builder(schemaHash, currentVersion);
+	const uint64_t root = builder.allocate<sSceneFileRoot>();
+	const uint64_t fileNodes = builder.allocate<sSceneFileNode>(transforms.getNodeCount());
+
+	uint32_t count = 0;
+	for (const uint32_t node : nodes)
+	{
+		if (node == transformHierarchy::invalidNode)
+		{
+			continue;
+		}
+
+		sSceneFileNode& fileNode = builder.get<sSceneFileNode>(fileNodes + (count * sizeof(sSceneFileNode)));
+		const uint32_t parent = transforms.getParent(node);
+		fileNode.parent = (parent == transformHierarchy::invalidNode) ? transformHierarchy::invalidNode : fileIndices.at(parent);
+		fileNode.userData = transforms.getUserData(node);
+		transforms.getLocalTransform(node, fileNode.position, fileNode.rotation, fileNode.scale);
+
+		fileIndices.emplace(node, count);
+		++count;
+	}
+	builder.setArray(builder.get<sSceneFileRoot>(root).nodes, fileNodes, count);
+
+	const std::vector<uint8_t>& blob = builder.finish();
+	std::ofstream stream(file, std::ios::out | std::ios::binary | std::ios::trunc);
+	stream.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+	return stream.good();
+}
+
+bool sceneFile::load(const std::string& file, transformHierarchy& transforms, std::vector<uint32_t>* outNodes)
+{
+	PROFILE_SCOPE("sceneFile::load");
+	MEMORY_TAG_SCOPE(eMemoryTag::scene);
+
+	const fileIO::mappedFile mapped(file, eFileAccessPattern::sequential);
+	if (!mapped.isOpen())
+	{
+		return false;
+	}
+
+	const std::span<const uint8_t> data = mapped.getData();
+	const sSceneFileRoot* const root = blobView::getRoot<sSceneFileRoot>(data, schemaHash);
+	if ((root == nullptr) || !blobView::isInRange(data, root->nodes))
+	{
+		return false;
+	}
+
+	// Every parent has to come before its children so it has been created when they are
+	const std::span<const sSceneFileNode> fileNodes = root->nodes.getSpan();
+	for (size_t i = 0; i < fileNodes.size(); ++i)
+	{
+		if ((fileNodes[i].parent != transformHierarchy::invalidNode) && (fileNodes[i].parent >= i))
+		{
+			return false;
+		}
+	}
+
+	std::vector<uint32_t> createdNodes(fileNodes.size());
+	for (size_t i = 0; i < fileNodes.size(); ++i)
+	{
+		const sSceneFileNode& fileNode = fileNodes[i];
+		const uint32_t parent = (fileNode.parent == transformHierarchy::invalidNode) ? transformHierarchy::invalidNode : createdNodes[fileNode.parent];
+		createdNodes[i] = transforms.createNode(parent, fileNode.position, fileNode.rotation, fileNode.scale, fileNode.userData);
+	}
+
+	if (outNodes != nullptr)
+	{
+		*outNodes = std::move(createdNodes);
+	}
+	return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "serialization/relocatable.h"
+#include "math/vector3f.h"
+#include "math/quaternionf.h"
+
+class transformHierarchy;
+
+// One transformHierarchy node in a scene blob
+struct sSceneFileNode
+{
+	// Index of the parent in the scene's node array, or transformHierarchy::invalidNode for a root. Parents come before their children
+	uint32_t parent = 0;
+	uint32_t userData = 0;
+	uint32_t padding[2] = {};
+	vector3f position;
+	quaternionf rotation;
+	vector3f scale;
+};
+static_assert(sizeof(sSceneFileNode) == 64, "sSceneFileNode: layout is part of the file format");
+
+// Root of a scene blob
+struct sSceneFileRoot
+{
+	relativeArray<sSceneFileNode> nodes;
+};
+
+// Scenes saved as relocatable blobs. Loading maps the file and creates nodes straight from the mapped arrays, there is no parsing step
+class sceneFile
+{
+public:
+	static constexpr uint64_t schemaHash = archiveFormat::hashSchema("scene");
+	static constexpr uint32_t currentVersion = 1;
+
+public:
+	/** Writes every node of the hierarchy to file. Updates the hierarchy first so nodes are written in depth first order
+	* @return True if the file was written, otherwise false
+	*/
+	static bool save(const std::string& file, transformHierarchy& transforms);
+
+	/** Creates the scene's nodes in transforms. outNodes, when given, receives the created node ids in file order
+	* @return True if the file was a valid scene and its nodes were created, otherwise false
+	*/
+	static bool load(const std::string& file, transformHierarchy& transforms, std::vector<uint32_t>* outNodes = nullptr);
+};
\ No newline at end of file
@@ -0,0 +1,432 @@
+#include "pch.h"
+#include "transformHierarchy.h"
+#include "math/vector3f.h"
+#include "math/quaternionf.h"
+#include "math/transformBatch.h"
+#include "jobs/jobSystem.h"
+#include "memory/memoryTracker.h"
+
+// Minimum nodes per job when a level or a run of local matrices is split across threads
+static constexpr uint32_t minNodesPerJob = 512;
+
+// Dirty nodes are sorted into depth first order while fewer than one in this many nodes are dirty, otherwise every node is scanned
+static constexpr size_t dirtySortThreshold = 32;
+
+#if defined(_DEBUG)
+// Largest difference allowed between the simd batch kernel and the scalar reference. Only rounding of the rotation scale products differs
+static constexpr float batchValidationTolerance = 1.0e-4f;
+#endif // defined(_DEBUG)
+
+uint32_t transformHierarchy::createNode(const uint32_t parent, const vector3f& position, const quaternionf& rotation, const vector3f& scale, const uint32_t userData)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::scene);
+	assert((parent == invalidNode) || (nodeIndices[parent] != invalidNode));
+
+	uint32_t node;
+	if (freeNodes.empty())
+	{
+		node = static_cast<uint32_t>(nodeIndices.size());
+		nodeIndices.push_back(invalidNode);
+		parentNodes.push_back(invalidNode);
+		userDatas.push_back(0);
+		localDirty.push_back(0);
+		firstChildren.push_back(invalidNode);
+		lastChildren.push_back(invalidNode);
+		nextSiblings.push_back(invalidNode);
+		previousSiblings.push_back(invalidNode);
+	}
+	else
+	{
+		node = freeNodes.back();
+		freeNodes.pop_back();
+	}
+
+	// New nodes are appended out of order and moved into place by the next rebuild
+	const uint32_t index = static_cast<uint32_t>(indexNodes.size());
+	positionX.push_back(position.x);
+	positionY.push_back(position.y);
+	positionZ.push_back(position.z);
+	rotationX.push_back(rotation.x);
+	rotationY.push_back(rotation.y);
+	rotationZ.push_back(rotation.z);
+	rotationW.push_back(rotation.w);
+	scaleX.push_back(scale.x);
+	scaleY.push_back(scale.y);
+	scaleZ.push_back(scale.z);
+	localMatrices.push_back(matrix3x4f::identity());
+	worldMatrices.push_back(matrix3x4f::identity());
+	parentIndices.push_back(invalidNode);
+	subtreeSizes.push_back(1);
+	depths.push_back(0);
+	indexNodes.push_back(node);
+
+	nodeIndices[node] = index;
+	parentNodes[node] = parent;
+	userDatas[node] = userData;
+	++nodeCount;
+	linkNode(node);
+
+	markDirty(node);
+	orderDirty = true;
+	return node;
+}
+
+void transformHierarchy::destroyNode(const uint32_t node, std::vector<uint32_t>* outDestroyedNodes)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::scene);
+	assert(nodeIndices[node] != invalidNode);
+
+	// The subtree is found through the child lists, so the depth first order can stay stale until the next update
+	unlinkNode(node);
+	destroyStack.clear();
+	destroyStack.push_back(node);
+	while (!destroyStack.empty())
+	{
+		const uint32_t destroyedNode = destroyStack.back();
+		destroyStack.pop_back();
+		for (uint32_t child = firstChildren[destroyedNode]; child != invalidNode; child = nextSiblings[child])
+		{
+			destroyStack.push_back(child);
+		}
+
+		// Slots of destroyed nodes are skipped by the rebuild
+		indexNodes[nodeIndices[destroyedNode]] = invalidNode;
+		nodeIndices[destroyedNode] = invalidNode;
+		parentNodes[destroyedNode] = invalidNode;
+		firstChildren[destroyedNode] = invalidNode;
+		lastChildren[destroyedNode] = invalidNode;
+		nextSiblings[destroyedNode] = invalidNode;
+		previousSiblings[destroyedNode] = invalidNode;
+		freeNodes.push_back(destroyedNode);
+		--nodeCount;
+		if (outDestroyedNodes != nullptr)
+		{
+			outDestroyedNodes->push_back(destroyedNode);
+		}
+	}
+	orderDirty = true;
+}
+
+void transformHierarchy::setParent(const uint32_t node, const uint32_t parent)
+{
+	// A node cannot become a child of its own subtree
+	assert((parent == invalidNode) || !isInSubtree(parent, node));
+
+	unlinkNode(node);
+	parentNodes[node] = parent;
+	linkNode(node);
+	markDirty(node);
+	orderDirty = true;
+}
+
+void transformHierarchy::setLocalTransform(const uint32_t node, const vector3f& position, const quaternionf& rotation, const vector3f& scale)
+{
+	const uint32_t index = nodeIndices[node];
+	positionX[index] = position.x;
+	positionY[index] = position.y;
+	positionZ[index] = position.z;
+	rotationX[index] = rotation.x;
+	rotationY[index] = rotation.y;
+	rotationZ[index] = rotation.z;
+	rotationW[index] = rotation.w;
+	scaleX[index] = scale.x;
+	scaleY[index] = scale.y;
+	scaleZ[index] = scale.z;
+	markDirty(node);
+}
+
+void transformHierarchy::getLocalTransform(const uint32_t node, vector3f& outPosition, quaternionf& outRotation, vector3f& outScale) const
+{
+	const uint32_t index = nodeIndices[node];
+	outPosition = vector3f(positionX[index], positionY[index], positionZ[index]);
+	outRotation.x = rotationX[index];
+	outRotation.y = rotationY[index];
+	outRotation.z = rotationZ[index];
+	outRotation.w = rotationW[index];
+	outScale = vector3f(scaleX[index], scaleY[index], scaleZ[index]);
+}
+
+void transformHierarchy::setLocalPosition(const uint32_t node, const vector3f& position)
+{
+	const uint32_t index = nodeIndices[node];
+	positionX[index] = position.x;
+	positionY[index] = position.y;
+	positionZ[index] = position.z;
+	markDirty(node);
+}
+
+void transformHierarchy::setLocalRotation(const uint32_t node, const quaternionf& rotation)
+{
+	const uint32_t index = nodeIndices[node];
+	rotationX[index] = rotation.x;
+	rotationY[index] = rotation.y;
+	rotationZ[index] = rotation.z;
+	rotationW[index] = rotation.w;
+	markDirty(node);
+}
+
+void transformHierarchy::update()
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::scene);
+	changedNodes.clear();
+
+	if (orderDirty)
+	{
+		rebuildOrder();
+	}
+
+	if (dirtyNodes.empty())
+	{
+		return;
+	}
+
+	// Dirty nodes are needed in depth first order. Sorting a few is cheaper than walking every node, walking wins once many are dirty
+	dirtyIndices.clear();
+	if ((dirtyNodes.size() * dirtySortThreshold) < nodeCount)
+	{
+		for (const uint32_t node : dirtyNodes)
+		{
+			localDirty[node] = 0;
+			if (nodeIndices[node] != invalidNode)
+			{
+				dirtyIndices.push_back(nodeIndices[node]);
+			}
+		}
+		std::sort(dirtyIndices.begin(), dirtyIndices.end());
+	}
+	else
+	{
+		for (uint32_t i = 0; i < nodeCount; ++i)
+		{
+			if (localDirty[indexNodes[i]] != 0)
+			{
+				dirtyIndices.push_back(i);
+			}
+		}
+
+		for (const uint32_t node : dirtyNodes)
+		{
+			localDirty[node] = 0;
+		}
+	}
+	dirtyNodes.clear();
+
+	updateLocalMatrices();
+
+	// Every node below a changed node needs a new world matrix. Subtrees are contiguous so a dirty node inside an already
+	// collected subtree adds nothing
+	for (std::vector<uint32_t>& indices : levelIndices)
+	{
+		indices.clear();
+	}
+
+	uint32_t collectedEnd = 0;
+	for (const uint32_t dirtyIndex : dirtyIndices)
+	{
+		if (dirtyIndex < collectedEnd)
+		{
+			continue;
+		}
+
+		collectedEnd = dirtyIndex + subtreeSizes[dirtyIndex];
+		for (uint32_t i = dirtyIndex; i < collectedEnd; ++i)
+		{
+			if (depths[i] >= levelIndices.size())
+			{
+				levelIndices.resize(depths[i] + 1);
+			}
+			levelIndices[depths[i]].push_back(i);
+			changedNodes.push_back(indexNodes[i]);
+		}
+	}
+
+	// Parents are complete before their children start as each level waits for the one above
+	for (const std::vector<uint32_t>& indices : levelIndices)
+	{
+		jobSystem::parallelFor(static_cast<uint32_t>(indices.size()), minNodesPerJob, [this, &indices](const uint32_t begin, const uint32_t end)
+			{
+				for (uint32_t i = begin; i < end; ++i)
+				{
+					const uint32_t index = indices[i];
+					const uint32_t parentIndex = parentIndices[index];
+					worldMatrices[index] = (parentIndex == invalidNode) ? localMatrices[index] : (worldMatrices[parentIndex] * localMatrices[index]);
+				}
+			});
+	}
+}
+
+void transformHierarchy::markDirty(const uint32_t node)
+{
+	if (localDirty[node] == 0)
+	{
+		localDirty[node] = 1;
+		dirtyNodes.push_back(node);
+	}
+}
+
+void transformHierarchy::linkNode(const uint32_t node)
+{
+	const uint32_t parent = parentNodes[node];
+	uint32_t& first = (parent == invalidNode) ? firstRoot : firstChildren[parent];
+	uint32_t& last = (parent == invalidNode) ? lastRoot : lastChildren[parent];
+
+	previousSiblings[node] = last;
+	nextSiblings[node] = invalidNode;
+	if (last == invalidNode)
+	{
+		first = node;
+	}
+	else
+	{
+		nextSiblings[last] = node;
+	}
+	last = node;
+}
+
+void transformHierarchy::unlinkNode(const uint32_t node)
+{
+	const uint32_t parent = parentNodes[node];
+	uint32_t& first = (parent == invalidNode) ? firstRoot : firstChildren[parent];
+	uint32_t& last = (parent == invalidNode) ? lastRoot : lastChildren[parent];
+
+	const uint32_t previous = previousSiblings[node];
+	const uint32_t next = nextSiblings[node];
+	((previous == invalidNode) ? first : nextSiblings[previous]) = next;
+	((next == invalidNode) ? last : previousSiblings[next]) = previous;
+	previousSiblings[node] = invalidNode;
+	nextSiblings[node] = invalidNode;
+}
+
+bool transformHierarchy::isInSubtree(uint32_t node, const uint32_t subtreeRoot) const
+{
+	for (; node != invalidNode; node = parentNodes[node])
+	{
+		if (node == subtreeRoot)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void transformHierarchy::rebuildOrder()
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::scene);
+	orderDirty = false;
+	++orderRebuildCount;
+
+	// Depth first walk of the child lists. After a node without children, climb until an ancestor below the root has a next sibling
+	order.clear();
+	order.reserve(nodeCount);
+	for (uint32_t root = firstRoot; root != invalidNode; root = nextSiblings[root])
+	{
+		uint32_t node = root;
+		while (true)
+		{
+			order.push_back(node);
+			if (firstChildren[node] != invalidNode)
+			{
+				node = firstChildren[node];
+				continue;
+			}
+
+			while ((node != root) && (nextSiblings[node] == invalidNode))
+			{
+				node = parentNodes[node];
+			}
+
+			if (node == root)
+			{
+				break;
+			}
+			node = nextSiblings[node];
+		}
+	}
+	assert(order.size() == nodeCount);
+
+	const auto permute = [this](auto& values)
+		{
+			std::remove_reference_t<decltype(values)> reordered(order.size());
+			for (size_t i = 0; i < order.size(); ++i)
+			{
+				reordered[i] = values[nodeIndices[order[i]]];
+			}
+			values.swap(reordered);
+		};
+
+	permute(positionX);
+	permute(positionY);
+	permute(positionZ);
+	permute(rotationX);
+	permute(rotationY);
+	permute(rotationZ);
+	permute(rotationW);
+	permute(scaleX);
+	permute(scaleY);
+	permute(scaleZ);
+	permute(localMatrices);
+	permute(worldMatrices);
+
+	indexNodes = order;
+	for (uint32_t i = 0; i < order.size(); ++i)
+	{
+		nodeIndices[order[i]] = i;
+	}
+
+	parentIndices.resize(order.size());
+	depths.resize(order.size());
+	for (uint32_t i = 0; i < order.size(); ++i)
+	{
+		const uint32_t parent = parentNodes[order[i]];
+		parentIndices[i] = (parent != invalidNode) ? nodeIndices[parent] : invalidNode;
+		depths[i] = (parent != invalidNode) ? (depths[parentIndices[i]] + 1) : 0;
+	}
+
+	// Children follow their parent so walking backwards accumulates every subtree before its root is reached
+	subtreeSizes.assign(order.size(), 1);
+	for (uint32_t i = static_cast<uint32_t>(order.size()); i > 0; --i)
+	{
+		if (parentIndices[i - 1] != invalidNode)
+		{
+			subtreeSizes[parentIndices[i - 1]] += subtreeSizes[i - 1];
+		}
+	}
+}
+
+void transformHierarchy::updateLocalMatrices()
+{
+	// Dirty nodes are sorted so neighbours form runs that the batch kernel computes straight from the structure of arrays
+	size_t runStart = 0;
+	for (size_t i = 0; i < dirtyIndices.size(); ++i)
+	{
+		if (((i + 1) < dirtyIndices.size()) && (dirtyIndices[i + 1] == (dirtyIndices[i] + 1)))
+		{
+			continue;
+		}
+
+		const uint32_t first = dirtyIndices[runStart];
+		const uint32_t runLength = static_cast<uint32_t>(i + 1 - runStart);
+		runStart = i + 1;
+
+		jobSystem::parallelFor(runLength, minNodesPerJob, [this, first](const uint32_t begin, const uint32_t end)
+			{
+				const uint32_t offset = first + begin;
+				sTransformBatch batch;
+				batch.positionX = &positionX[offset];
+				batch.positionY = &positionY[offset];
+				batch.positionZ = &positionZ[offset];
+				batch.rotationX = &rotationX[offset];
+				batch.rotationY = &rotationY[offset];
+				batch.rotationZ = &rotationZ[offset];
+				batch.rotationW = &rotationW[offset];
+				batch.scaleX = &scaleX[offset];
+				batch.scaleY = &scaleY[offset];
+				batch.scaleZ = &scaleZ[offset];
+				batch.count = end - begin;
+				transformBatch::computeWorldMatrices(batch, &localMatrices[offset]);
+#if defined(_DEBUG)
+				assert(transformBatch::validate(batch) <= batchValidationTolerance);
+#endif // defined(_DEBUG)
+			});
+	}
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "math/matrix3x4f.h"
+
+class vector3f;
+class quaternionf;
+
+// Parent/child transforms stored in depth first order in contiguous structure of arrays storage, so every subtree is one contiguous
+// range and every parent comes before its children. Nodes are addressed by stable ids mapped to their current position in the arrays.
+// Creating, destroying and reparenting nodes only edit first child / next sibling links, the order is rebuilt once by the next update.
+// Changing a local transform flags the node. update() recomputes the local matrices of flagged nodes and the world matrices of their
+// subtrees one depth level at a time, each level split across job system threads. Nodes that never change cost nothing per update
+class transformHierarchy
+{
+public:
+	static constexpr uint32_t invalidNode = UINT32_MAX;
+
+public:
+	// Creates a node under parent, or a root if parent is invalidNode. userData is returned by getUserData, e.g. an entity index
+	uint32_t createNode(const uint32_t parent, const vector3f& position, const quaternionf& rotation, const vector3f& scale, const uint32_t userData = 0);
+
+	// Destroys the node and every node below it. The destroyed node ids are appended to outDestroyedNodes if it is not null
+	void destroyNode(const uint32_t node, std::vector<uint32_t>* outDestroyedNodes = nullptr);
+
+	// Moves the node and its subtree under parent, or makes it a root if parent is invalidNode. The local transform is kept
+	void setParent(const uint32_t node, const uint32_t parent);
+
+	void setLocalTransform(const uint32_t node, const vector3f& position, const quaternionf& rotation, const vector3f& scale);
+	void setLocalPosition(const uint32_t node, const vector3f& position);
+	void setLocalRotation(const uint32_t node, const quaternionf& rotation);
+
+	void getLocalTransform(const uint32_t node, vector3f& outPosition, quaternionf& outRotation, vector3f& outScale) const;
+
+	// World matrix as of the last update
+	const matrix3x4f& getWorldMatrix(const uint32_t node) const { return worldMatrices[nodeIndices[node]]; }
+	uint32_t getParent(const uint32_t node) const { return parentNodes[node]; }
+	uint32_t getUserData(const uint32_t node) const { return userDatas[node]; }
+	uint32_t getNodeCount() const { return nodeCount; }
+
+	// Number of times update has rebuilt the depth first order after structural changes
+	uint32_t getOrderRebuildCount() const { return orderRebuildCount; }
+
+	// Brings every world matrix up to date
+	void update();
+
+	// Every node in depth first order as of the last update, so parents come before their children
+	std::span<const uint32_t> getDepthFirstNodes() const { return indexNodes; }
+
+	// Nodes whose world matrix was recomputed by the last update, in depth first order
+	std::span<const uint32_t> getChangedNodes() const { return changedNodes; }
+
+private:
+	// Indexed by depth first position
+	std::vector<float> positionX;
+	std::vector<float> positionY;
+	std::vector<float> positionZ;
+	std::vector<float> rotationX;
+	std::vector<float> rotationY;
+	std::vector<float> rotationZ;
+	std::vector<float> rotationW;
+	std::vector<float> scaleX;
+	std::vector<float> scaleY;
+	std::vector<float> scaleZ;
+	std::vector<matrix3x4f> localMatrices;
+	std::vector<matrix3x4f> worldMatrices;
+	std::vector<uint32_t> parentIndices;
+	std::vector<uint32_t> subtreeSizes;
+	std::vector<uint32_t> depths;
+	std::vector<uint32_t> indexNodes;
+
+	// Indexed by node id. nodeIndices is invalidNode for free ids
+	std::vector<uint32_t> nodeIndices;
+	std::vector<uint32_t> parentNodes;
+	std::vector<uint32_t> userDatas;
+	std::vector<uint8_t> localDirty;
+	std::vector<uint32_t> freeNodes;
+	uint32_t nodeCount = 0;
+
+	// Child lists by node id, kept up to date by every structural change. Roots form one more sibling list
+	std::vector<uint32_t> firstChildren;
+	std::vector<uint32_t> lastChildren;
+	std::vector<uint32_t> nextSiblings;
+	std::vector<uint32_t> previousSiblings;
+	uint32_t firstRoot = invalidNode;
+	uint32_t lastRoot = invalidNode;
+
+	// Node ids whose local transform changed since the last update
+	std::vector<uint32_t> dirtyNodes;
+
+	// Set when nodes are created, destroyed or reparented. The depth first order is rebuilt on the next update
+	bool orderDirty = false;
+	uint32_t orderRebuildCount = 0;
+
+	// Scratch reused between updates
+	std::vector<uint32_t> dirtyIndices;
+	std::vector<std::vector<uint32_t>> levelIndices;
+	std::vector<uint32_t> changedNodes;
+	std::vector<uint32_t> order;
+	std::vector<uint32_t> destroyStack;
+
+private:
+	void markDirty(const uint32_t node);
+
+	// Appends the node to the child list of its parent, or to the roots
+	void linkNode(const uint32_t node);
+	void unlinkNode(const uint32_t node);
+	bool isInSubtree(uint32_t node, const uint32_t subtreeRoot) const;
+
+	void rebuildOrder();
+	void updateLocalMatrices();
+};
\ No newline at end of file
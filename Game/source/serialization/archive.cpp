@@ -0,0 +1,154 @@
+#include "pch.h"
+#include "archive.h"
+#include "memory/memoryTracker.h"
+
+uint64_t archiveFormat::checksum(std::span<const uint8_t> payload)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (const uint8_t byte : payload)
+	{
+		hash ^= byte;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+const sArchiveHeader* archiveFormat::validate(std::span<const uint8_t> data, const uint64_t schemaHash, const eArchiveFlags flags, const bool verifyChecksum)
+{
+	if (data.size() < payloadOffset)
+	{
+		return nullptr;
+	}
+
+	const sArchiveHeader* const header = reinterpret_cast<const sArchiveHeader*>(data.data());
+	if ((header->magic != sArchiveHeader::expectedMagic) || (header->formatVersion != sArchiveHeader::currentFormatVersion) ||
+		(header->schemaHash != schemaHash) || (header->flags != static_cast<uint16_t>(flags)) || (header->payloadSize > (data.size() - payloadOffset)))
+	{
+		return nullptr;
+	}
+
+	if (verifyChecksum && (checksum(data.subspan(payloadOffset, static_cast<size_t>(header->payloadSize))) != header->payloadChecksum))
+	{
+		return nullptr;
+	}
+	return header;
+}
+
+void archiveFormat::writeHeader(std::vector<uint8_t>& buffer, const uint64_t schemaHash, const uint32_t schemaVersion, const eArchiveFlags flags)
+{
+	assert((buffer.size() >= payloadOffset) && "archiveFormat::writeHeader: buffer has no room for the header");
+
+	sArchiveHeader header = {};
+	header.flags = static_cast<uint16_t>(flags);
+	header.schemaHash = schemaHash;
+	header.schemaVersion = schemaVersion;
+	header.payloadSize = buffer.size() - payloadOffset;
+	header.payloadChecksum = checksum(std::span<const uint8_t>(buffer).subspan(payloadOffset));
+	memcpy(buffer.data(), &header, sizeof(header));
+}
+
+archiveWriter::archiveWriter(const uint64_t schemaHash, const uint32_t schemaVersion)
+	: schema(schemaHash), version(schemaVersion)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::fileIO);
+
+	// The header is filled in by finish, once the payload is known
+	buffer.resize(archiveFormat::payloadOffset);
+	archiveFormat::writeHeader(buffer, schemaHash, schemaVersion, eArchiveFlags::none);
+}
+
+void archiveWriter::serializeBytes(const void* data, const size_t size)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::fileIO);
+
+	if (size == 0)
+	{
+		return;
+	}
+
+	const uint8_t* const bytes = static_cast<const uint8_t*>(data);
+	buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+uint64_t archiveWriter::beginObject()
+{
+	const uint64_t object = buffer.size();
+	const uint64_t placeholder = 0;
+	serializeBytes(&placeholder, sizeof(placeholder));
+	return object;
+}
+
+void archiveWriter::endObject(const uint64_t object)
+{
+	const uint64_t size = buffer.size() - (object + sizeof(uint64_t));
+	memcpy(buffer.data() + object, &size, sizeof(size));
+}
+
+const std::vector<uint8_t>& archiveWriter::finish()
+{
+	archiveFormat::writeHeader(buffer, schema, version, eArchiveFlags::none);
+	return buffer;
+}
+
+archiveReader::archiveReader(std::span<const uint8_t> data, const uint64_t schemaHash, const bool verifyChecksum)
+{
+	const sArchiveHeader* const header = archiveFormat::validate(data, schemaHash, eArchiveFlags::none, verifyChecksum);
+	if (header == nullptr)
+	{
+		failed = true;
+		return;
+	}
+
+	payload = data.subspan(archiveFormat::payloadOffset, static_cast<size_t>(header->payloadSize));
+	limit = payload.size();
+	version = header->schemaVersion;
+}
+
+void archiveReader::serializeBytes(void* data, const size_t size)
+{
+	if (!canRead(size))
+	{
+		memset(data, 0, size);
+		return;
+	}
+
+	if (size > 0)
+	{
+		memcpy(data, payload.data() + position, size);
+		position += size;
+	}
+}
+
+bool archiveReader::canRead(const uint64_t size)
+{
+	if (failed || (size > (limit - position)))
+	{
+		failed = true;
+		return false;
+	}
+	return true;
+}
+
+uint64_t archiveReader::beginObject()
+{
+	uint64_t size = 0;
+	serializeBytes(&size, sizeof(size));
+	if (!canRead(size))
+	{
+		return limit;
+	}
+
+	const uint64_t outerLimit = limit;
+	limit = position + size;
+	return outerLimit;
+}
+
+void archiveReader::endObject(const uint64_t outerLimit)
+{
+	// Fields written by a newer version are skipped
+	if (!failed)
+	{
+		position = limit;
+	}
+	limit = outerLimit;
+}
@@ -0,0 +1,291 @@
+#pragma once
+
+#include <unordered_map>
+
+// Header at the start of every archive and blob. Everything is little endian. schemaHash names what the payload holds and schemaVersion
+// is the version of that layout the writer used, so a reader can refuse data meant for something else and branch on older versions
+struct sArchiveHeader
+{
+	static constexpr uint32_t expectedMagic = 0x31435241; // "ARC1"
+	static constexpr uint16_t currentFormatVersion = 1;
+
+	uint32_t magic = expectedMagic;
+	uint16_t formatVersion = currentFormatVersion;
+	uint16_t flags = 0;
+	uint64_t schemaHash = 0;
+	uint32_t schemaVersion = 0;
+	uint32_t padding = 0;
+	uint64_t payloadSize = 0;
+	// 64 bit FNV-1a of the payload
+	uint64_t payloadChecksum = 0;
+};
+static_assert(sizeof(sArchiveHeader) == 40, "sArchiveHeader: layout is part of the file format");
+
+enum class eArchiveFlags : uint16_t
+{
+	none = 0,
+	// The payload is a blob read in place through relative pointers rather than a stream of values
+	relocatable = 1 << 0
+};
+
+class archiveFormat
+{
+public:
+	// The payload starts here rather than straight after the header so blob contents stay 16 byte aligned in a page aligned mapping
+	static constexpr size_t payloadOffset = 48;
+
+	// 64 bit FNV-1a of a schema name, e.g. hashSchema("scene"). constexpr so schema hashes can be compile time constants
+	static constexpr uint64_t hashSchema(std::string_view name)
+	{
+		uint64_t hash = 14695981039346656037ull;
+		for (const char character : name)
+		{
+			hash ^= static_cast<uint8_t>(character);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	static uint64_t checksum(std::span<const uint8_t> payload);
+
+	/** Checks data starts with a header for the schema with the flags set and that the payload it describes is all there
+	* @return The header, or nullptr if the data is not a valid archive of the schema
+	*/
+	static const sArchiveHeader* validate(std::span<const uint8_t> data, const uint64_t schemaHash, const eArchiveFlags flags, const bool verifyChecksum);
+
+	static void writeHeader(std::vector<uint8_t>& buffer, const uint64_t schemaHash, const uint32_t schemaVersion, const eArchiveFlags flags);
+};
+
+// Types whose serialized layout never changes, e.g. math types, are written without the size prefix that lets readers skip fields
+// added by newer versions. Specialize to true for small leaf types stored in bulk
+template <typename T>
+struct isArchiveFixedLayout : std::false_type {};
+
+namespace archiveDetail
+{
+	template <typename T>
+	struct isVector : std::false_type {};
+	template <typename T, typename allocatorType>
+	struct isVector<std::vector<T, allocatorType>> : std::true_type {};
+
+	template <typename T>
+	struct isArray : std::false_type {};
+	template <typename T, size_t count>
+	struct isArray<std::array<T, count>> : std::true_type {};
+
+	template <typename T>
+	struct isUnorderedMap : std::false_type {};
+	template <typename keyType, typename valueType, typename hashType, typename equalType, typename allocatorType>
+	struct isUnorderedMap<std::unordered_map<keyType, valueType, hashType, equalType, allocatorType>> : std::true_type {};
+
+	// Values copied as raw bytes, alone or as a whole array
+	template <typename T>
+	constexpr bool isRaw = std::is_arithmetic_v<T> || std::is_enum_v<T>;
+}
+
+// Serializes one value through archive, reading into it when archiveType::isReading and writing it otherwise. Arithmetic types, enums,
+// strings, vectors, std::array, C arrays and unordered maps are handled here. Other types need a function found by argument
+// dependent lookup
+//   template <typename archiveType> void serialize(archiveType& archive, sType& value)
+// which calls archive(value.field) for each field and can branch on archive.getVersion() for fields added later. Each such value is
+// prefixed with its size, so a reader built before a field was added skips it
+template <typename archiveType, typename T>
+void serializeValue(archiveType& archive, T& value)
+{
+	if constexpr (archiveDetail::isRaw<T>)
+	{
+		archive.serializeBytes(&value, sizeof(T));
+	}
+	else if constexpr (std::is_array_v<T>)
+	{
+		using elementType = std::remove_extent_t<T>;
+		if constexpr (archiveDetail::isRaw<elementType>)
+		{
+			archive.serializeBytes(value, sizeof(T));
+		}
+		else
+		{
+			for (elementType& element : value)
+			{
+				serializeValue(archive, element);
+			}
+		}
+	}
+	else if constexpr (std::is_same_v<T, std::string>)
+	{
+		uint64_t size = value.size();
+		archive.serializeBytes(&size, sizeof(size));
+		if constexpr (archiveType::isReading)
+		{
+			if (!archive.canRead(size))
+			{
+				return;
+			}
+			value.resize(static_cast<size_t>(size));
+		}
+		archive.serializeBytes(value.data(), value.size());
+	}
+	else if constexpr (archiveDetail::isVector<T>::value)
+	{
+		using elementType = typename T::value_type;
+		static_assert(!std::is_same_v<elementType, bool>, "serializeValue: std::vector<bool> is not supported, use std::vector<uint8_t>");
+
+		uint64_t count = value.size();
+		archive.serializeBytes(&count, sizeof(count));
+		if constexpr (archiveType::isReading)
+		{
+			// Every element takes at least a byte, so a corrupt count fails here instead of allocating
+			if (!archive.canRead(count))
+			{
+				return;
+			}
+			value.resize(static_cast<size_t>(count));
+		}
+
+		if constexpr (archiveDetail::isRaw<elementType>)
+		{
+			archive.serializeBytes(value.data(), value.size() * sizeof(elementType));
+		}
+		else
+		{
+			for (elementType& element : value)
+			{
+				serializeValue(archive, element);
+			}
+		}
+	}
+	else if constexpr (archiveDetail::isArray<T>::value)
+	{
+		using elementType = typename T::value_type;
+		if constexpr (archiveDetail::isRaw<elementType>)
+		{
+			archive.serializeBytes(value.data(), value.size() * sizeof(elementType));
+		}
+		else
+		{
+			for (elementType& element : value)
+			{
+				serializeValue(archive, element);
+			}
+		}
+	}
+	else if constexpr (archiveDetail::isUnorderedMap<T>::value)
+	{
+		using keyType = typename T::key_type;
+		using mappedType = typename T::mapped_type;
+
+		uint64_t count = value.size();
+		archive.serializeBytes(&count, sizeof(count));
+		if constexpr (archiveType::isReading)
+		{
+			value.clear();
+			if (!archive.canRead(count))
+			{
+				return;
+			}
+			value.reserve(static_cast<size_t>(count));
+			for (uint64_t i = 0; (i < count) && archive.isValid(); ++i)
+			{
+				keyType key = {};
+				mappedType mapped = {};
+				serializeValue(archive, key);
+				serializeValue(archive, mapped);
+				value.emplace(std::move(key), std::move(mapped));
+			}
+		}
+		else
+		{
+			for (std::pair<const keyType, mappedType>& pair : value)
+			{
+				serializeValue(archive, const_cast<keyType&>(pair.first));
+				serializeValue(archive, pair.second);
+			}
+		}
+	}
+	else if constexpr (isArchiveFixedLayout<T>::value)
+	{
+		serialize(archive, value);
+	}
+	else
+	{
+		const uint64_t object = archive.beginObject();
+		serialize(archive, value);
+		archive.endObject(object);
+	}
+}
+
+// Writes values to a growing buffer behind an archive header
+class archiveWriter
+{
+public:
+	static constexpr bool isReading = false;
+
+public:
+	archiveWriter(const uint64_t schemaHash, const uint32_t schemaVersion);
+
+	uint32_t getVersion() const { return version; }
+	bool isValid() const { return true; }
+
+	template <typename T>
+	void operator()(const T& value)
+	{
+		// Writing never modifies the value, serializeValue takes it non const so one serialize function serves reads and writes
+		serializeValue(*this, const_cast<T&>(value));
+	}
+
+	void serializeBytes(const void* data, const size_t size);
+
+	// Writes a size placeholder and returns its position. endObject fills it in with the size of everything written after it
+	uint64_t beginObject();
+	void endObject(const uint64_t object);
+
+	/** Fills in the header's payload size and checksum
+	* @return The finished archive, ready to be written to a file
+	*/
+	const std::vector<uint8_t>& finish();
+
+private:
+	std::vector<uint8_t> buffer;
+	uint64_t schema = 0;
+	uint32_t version = 0;
+};
+
+// Reads values from an archive in place, e.g. from a fileIO::mappedFile. Reads are bounds checked: reading past the end of the data or of
+// the current object marks the reader invalid and zero fills whatever was being read, so loaders check isValid once at the end
+class archiveReader
+{
+public:
+	static constexpr bool isReading = true;
+
+public:
+	// Checks the header. Data for another schema, a truncated payload or, when verifyChecksum is set, a checksum mismatch leaves the reader invalid
+	archiveReader(std::span<const uint8_t> data, const uint64_t schemaHash, const bool verifyChecksum = false);
+
+	// The version the archive was written with, which may be newer than the reader's
+	uint32_t getVersion() const { return version; }
+	bool isValid() const { return !failed; }
+
+	template <typename T>
+	void operator()(T& value)
+	{
+		serializeValue(*this, value);
+	}
+
+	void serializeBytes(void* data, const size_t size);
+
+	// Checks at least size bytes are left in the current object, failing the reader if not
+	bool canRead(const uint64_t size);
+
+	// Reads an object's size prefix and limits reads to the object. Returns the enclosing limit for endObject, which moves to the end of
+	// the object, skipping fields the reader does not know, and restores it
+	uint64_t beginObject();
+	void endObject(const uint64_t outerLimit);
+
+private:
+	std::span<const uint8_t> payload;
+	uint64_t position = 0;
+	// End of the innermost object being read
+	uint64_t limit = 0;
+	uint32_t version = 0;
+	bool failed = false;
+};
\ No newline at end of file
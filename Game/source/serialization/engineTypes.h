@@ -0,0 +1,136 @@
+#pragma once
+
+#include "archive.h"
+#include "sGuid.h"
+#include "math/vector2d.h"
+#include "math/vector3d.h"
+#include "math/vector4d.h"
+#include "math/vector3f.h"
+#include "math/vector4f.h"
+#include "math/quaternion.h"
+#include "math/quaternionf.h"
+#include "math/rotator.h"
+#include "math/transform.h"
+#include "math/matrix4x4.h"
+#include "math/matrix4x4f.h"
+#include "math/matrix3x4f.h"
+
+// Archive support for engine types. Their layouts are fixed, so they are written field by field without a size prefix. Padding is not
+// written, e.g. a vector3f takes 12 bytes
+template <> struct isArchiveFixedLayout<sGuid> : std::true_type {};
+template <> struct isArchiveFixedLayout<vector2d> : std::true_type {};
+template <> struct isArchiveFixedLayout<vector3d> : std::true_type {};
+template <> struct isArchiveFixedLayout<vector4d> : std::true_type {};
+template <> struct isArchiveFixedLayout<vector3f> : std::true_type {};
+template <> struct isArchiveFixedLayout<vector4f> : std::true_type {};
+template <> struct isArchiveFixedLayout<quaternion> : std::true_type {};
+template <> struct isArchiveFixedLayout<quaternionf> : std::true_type {};
+template <> struct isArchiveFixedLayout<rotator> : std::true_type {};
+template <> struct isArchiveFixedLayout<transform> : std::true_type {};
+template <> struct isArchiveFixedLayout<matrix4x4> : std::true_type {};
+template <> struct isArchiveFixedLayout<matrix4x4f> : std::true_type {};
+template <> struct isArchiveFixedLayout<matrix3x4f> : std::true_type {};
+
+template <typename archiveType>
+void serialize(archiveType& archive, sGuid& value)
+{
+	uint32_t components[4] = { value[0], value[1], value[2], value[3] };
+	archive(components);
+	if constexpr (archiveType::isReading)
+	{
+		value = sGuid(components[0], components[1], components[2], components[3]);
+	}
+}
+
+template <typename archiveType>
+void serialize(archiveType& archive, vector2d& value)
+{
+	archive(value.x);
+	archive(value.y);
+}
+
+template <typename archiveType>
+void serialize(archiveType& archive, vector3d& value)
+{
+	archive(value.x);
+	archive(value.y);
+	archive(value.z);
+}
+
+template <typename archiveType>
+void serialize(archiveType& archive, vector4d& value)
+{
+	archive(value.x);
+	archive(value.y);
+	archive(value.z);
+	archive(value.w);
+}
+
+template <typename archiveType>
+void serialize(archiveType& archive, vector3f& value)
+{
+	archive(value.x);
+	archive(value.y);
+	archive(value.z);
+}
+
+template <typename archiveType>
+void serialize(archiveType& archive, vector4f& value)
+{
+	archive(value.x);
+	archive(value.y);
+	archive(value.z);
+	archive(value.w);
+}
+
+template <typename archiveType>
+void serialize(archiveType& archive, quaternion& value)
+{
+	archive(value.w);
+	archive(value.x);
+	archive(value.y);
+	archive(value.z);
+}
+
+template <typename archiveType>
+void serialize(archiveType& archive, quaternionf& value)
+{
+	archive(value.x);
+	archive(value.y);
+	archive(value.z);
+	archive(value.w);
+}
+
+template <typename archiveType>
+void serialize(archiveType& archive, rotator& value)
+{
+	archive(value.pitch);
+	archive(value.yaw);
+	archive(value.roll);
+}
+
+template <typename archiveType>
+void serialize(archiveType& archive, transform& value)
+{
+	archive(value.position);
+	archive(value.rotation);
+	archive(value.scale);
+}
+
+template <typename archiveType>
+void serialize(archiveType& archive, matrix4x4& value)
+{
+	archive(value.values);
+}
+
+template <typename archiveType>
+void serialize(archiveType& archive, matrix4x4f& value)
+{
+	archive(value.values);
+}
+
+template <typename archiveType>
+void serialize(archiveType& archive, matrix3x4f& value)
+{
+	archive(value.values);
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "pch.h"
+#include "relocatable.h"
+#include "memory/memoryTracker.h"
+
+blobBuilder::blobBuilder(const uint64_t schemaHash, const uint32_t schemaVersion)
+	: schema(schemaHash), version(schemaVersion)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::fileIO);
+
+	buffer.resize(archiveFormat::payloadOffset);
+	archiveFormat::writeHeader(buffer, schemaHash, schemaVersion, eArchiveFlags::relocatable);
+}
+
+uint64_t blobBuilder::addString(std::string_view text)
+{
+	const uint64_t offset = allocateBytes(text.size() + 1, 1);
+	if (!text.empty())
+	{
+		memcpy(buffer.data() + offset, text.data(), text.size());
+	}
+	return offset;
+}
+
+void blobBuilder::setString(relativeString& string, const uint64_t targetOffset, const size_t length)
+{
+	setArray(string.characters, targetOffset, length + 1);
+}
+
+const std::vector<uint8_t>& blobBuilder::finish()
+{
+	archiveFormat::writeHeader(buffer, schema, version, eArchiveFlags::relocatable);
+	return buffer;
+}
+
+uint64_t blobBuilder::allocateBytes(const uint64_t size, const size_t alignment)
+{
+	MEMORY_TAG_SCOPE(eMemoryTag::fileIO);
+
+	// Offsets are aligned relative to the start of the blob, which is mapped on a page boundary when loaded
+	const uint64_t offset = (buffer.size() + (alignment - 1)) & ~static_cast<uint64_t>(alignment - 1);
+
+	// New bytes, including the alignment padding, are zeroed so blobs are deterministic
+	buffer.resize(static_cast<size_t>(offset + size), 0);
+	return offset;
+}
+
+int64_t blobBuilder::getRelativeOffset(const void* field, const uint64_t targetOffset) const
+{
+	const uint8_t* const fieldAddress = static_cast<const uint8_t*>(field);
+	assert((fieldAddress >= buffer.data()) && (fieldAddress < (buffer.data() + buffer.size())) && "blobBuilder: field is not inside the blob");
+	assert((targetOffset <= buffer.size()) && "blobBuilder: target is outside the blob");
+
+	const int64_t fieldOffset = static_cast<int64_t>(fieldAddress - buffer.data());
+	return static_cast<int64_t>(targetOffset) - fieldOffset;
+}
+
+bool blobView::isInRange(std::span<const uint8_t> data, const relativeString& string)
+{
+	if (!isInRange(data, string.characters))
+	{
+		return false;
+	}
+
+	// The terminator has to be there for c_str
+	return string.characters.empty() || (string.characters[static_cast<size_t>(string.characters.size() - 1)] == '\0');
+}
+
+bool blobView::isInRange(std::span<const uint8_t> data, const void* field, const int64_t offset, const uint64_t count, const size_t elementSize, const size_t alignment)
+{
+	if (count == 0)
+	{
+		return true;
+	}
+
+	const uint8_t* const fieldAddress = static_cast<const uint8_t*>(field);
+	const int64_t dataSize = static_cast<int64_t>(data.size());
+	if ((fieldAddress < data.data()) || (fieldAddress >= (data.data() + data.size())) || (offset <= -dataSize) || (offset >= dataSize))
+	{
+		return false;
+	}
+
+	const int64_t fieldOffset = static_cast<int64_t>(fieldAddress - data.data());
+	const int64_t start = fieldOffset + offset;
+	if ((start < static_cast<int64_t>(archiveFormat::payloadOffset)) || (start > dataSize) || ((static_cast<uint64_t>(start) % alignment) != 0))
+	{
+		return false;
+	}
+
+	const uint64_t available = data.size() - static_cast<uint64_t>(start);
+	return (count <= (available / elementSize));
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "archive.h"
+
+// Blobs are flat structs read in place from a memory map. Instead of pointers they hold offsets relative to the field itself, so a blob
+// is valid wherever it is loaded and needs no fix-up pass after mapping: the fix-up is the add in get(). Blob types must be trivially
+// destructible, hold no real pointers and need at most 16 byte alignment.
+// A newer schema version may append fields to the end of the root and add arrays, so older readers see the prefix they know. Changing the
+// layout of an existing array element needs a new root type, chosen by the reader from the blob's version
+template <typename T>
+class relativePointer
+{
+public:
+	relativePointer() = default;
+
+	// Copying would keep the offset but not the target, only the builder sets relative pointers
+	relativePointer(const relativePointer&) = delete;
+	relativePointer& operator=(const relativePointer&) = delete;
+
+	const T* get() const { return (offset == 0) ? nullptr : reinterpret_cast<const T*>(reinterpret_cast<const uint8_t*>(this) + offset); }
+	const T* operator->() const { return get(); }
+	const T& operator*() const { return *get(); }
+	explicit operator bool() const { return (offset != 0); }
+
+private:
+	friend class blobBuilder;
+	friend class blobView;
+
+	int64_t offset = 0;
+};
+
+template <typename T>
+class relativeArray
+{
+public:
+	relativeArray() = default;
+	relativeArray(const relativeArray&) = delete;
+	relativeArray& operator=(const relativeArray&) = delete;
+
+	const T* data() const { return (count == 0) ? nullptr : reinterpret_cast<const T*>(reinterpret_cast<const uint8_t*>(this) + offset); }
+	uint64_t size() const { return count; }
+	bool empty() const { return (count == 0); }
+
+	const T& operator[](const size_t index) const
+	{
+		assert((index < count) && "relativeArray::operator[]: index out of range");
+		return data()[index];
+	}
+
+	const T* begin() const { return data(); }
+	const T* end() const { return data() + count; }
+	std::span<const T> getSpan() const { return std::span<const T>(data(), static_cast<size_t>(count)); }
+
+private:
+	friend class blobBuilder;
+	friend class blobView;
+
+	int64_t offset = 0;
+	uint64_t count = 0;
+};
+
+// Null terminated, the terminator is not counted in the length
+class relativeString
+{
+public:
+	std::string_view view() const { return characters.empty() ? std::string_view() : std::string_view(characters.data(), static_cast<size_t>(characters.size() - 1)); }
+	const char* c_str() const { return characters.empty() ? "" : characters.data(); }
+
+private:
+	friend class blobBuilder;
+	friend class blobView;
+
+	relativeArray<char> characters;
+};
+
+// Lays a blob out in a growing buffer behind an archive header. The first allocation is the blob's root. Allocations are addressed by
+// their offset because a reference from get is invalidated by the next allocation, so allocate everything a field points at before
+// getting the field to set it
+class blobBuilder
+{
+public:
+	static constexpr size_t maxAlignment = 16;
+
+public:
+	blobBuilder(const uint64_t schemaHash, const uint32_t schemaVersion);
+
+	/** Allocates count default constructed Ts
+	* @return The offset of the first T in the blob
+	*/
+	template <typename T>
+	uint64_t allocate(const uint64_t count = 1)
+	{
+		static_assert(std::is_trivially_destructible_v<T>, "blobBuilder::allocate: blob types must be trivially destructible");
+		static_assert(alignof(T) <= maxAlignment, "blobBuilder::allocate: blob types must need at most 16 byte alignment");
+
+		const uint64_t offset = allocateBytes(sizeof(T) * count, alignof(T));
+		for (uint64_t i = 0; i < count; ++i)
+		{
+			new (buffer.data() + offset + (i * sizeof(T))) T();
+		}
+		return offset;
+	}
+
+	/** Allocates a copy of values
+	* @return The offset of the first value in the blob
+	*/
+	template <typename T>
+	uint64_t addArray(std::span<const T> values)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "blobBuilder::addArray: copied values must be trivially copyable");
+		static_assert(alignof(T) <= maxAlignment, "blobBuilder::addArray: blob types must need at most 16 byte alignment");
+
+		const uint64_t offset = allocateBytes(values.size_bytes(), alignof(T));
+		if (!values.empty())
+		{
+			memcpy(buffer.data() + offset, values.data(), values.size_bytes());
+		}
+		return offset;
+	}
+
+	/** Allocates a null terminated copy of text
+	* @return The offset of the first character in the blob
+	*/
+	uint64_t addString(std::string_view text);
+
+	template <typename T>
+	T& get(const uint64_t offset)
+	{
+		assert(((offset + sizeof(T)) <= buffer.size()) && "blobBuilder::get: offset is outside the blob");
+		return *reinterpret_cast<T*>(buffer.data() + offset);
+	}
+
+	// Points a field inside the blob, e.g. get<sRoot>(root).items, at an allocation
+	template <typename T>
+	void setPointer(relativePointer<T>& pointer, const uint64_t targetOffset)
+	{
+		pointer.offset = getRelativeOffset(&pointer, targetOffset);
+	}
+
+	template <typename T>
+	void setArray(relativeArray<T>& array, const uint64_t targetOffset, const uint64_t count)
+	{
+		array.offset = (count == 0) ? 0 : getRelativeOffset(&array, targetOffset);
+		array.count = count;
+	}
+
+	void setString(relativeString& string, const uint64_t targetOffset, const size_t length);
+
+	/** Fills in the header's payload size and checksum
+	* @return The finished blob, ready to be written to a file
+	*/
+	const std::vector<uint8_t>& finish();
+
+private:
+	std::vector<uint8_t> buffer;
+	uint64_t schema = 0;
+	uint32_t version = 0;
+
+private:
+	uint64_t allocateBytes(const uint64_t size, const size_t alignment);
+	int64_t getRelativeOffset(const void* field, const uint64_t targetOffset) const;
+};
+
+// Reads blobs in place
+class blobView
+{
+public:
+	/** Checks data, e.g. the contents of a fileIO::mappedFile, is a blob of the schema with a root of at least sizeof(T). The blob is used
+	* where it is, nothing is copied or fixed up. outVersion receives the version the blob was written with
+	* @return The blob's root, or nullptr if data is not a valid blob of the schema
+	*/
+	template <typename T>
+	static const T* getRoot(std::span<const uint8_t> data, const uint64_t schemaHash, uint32_t* outVersion = nullptr, const bool verifyChecksum = false)
+	{
+		const sArchiveHeader* const header = archiveFormat::validate(data, schemaHash, eArchiveFlags::relocatable, verifyChecksum);
+		if ((header == nullptr) || (header->payloadSize < sizeof(T)) || ((reinterpret_cast<uintptr_t>(data.data()) % blobBuilder::maxAlignment) != 0))
+		{
+			return nullptr;
+		}
+
+		if (outVersion != nullptr)
+		{
+			*outVersion = header->schemaVersion;
+		}
+		return reinterpret_cast<const T*>(data.data() + archiveFormat::payloadOffset);
+	}
+
+	// Checks an array read from a blob lies inside the blob's data, so a corrupt file cannot send reads outside the mapping
+	template <typename T>
+	static bool isInRange(std::span<const uint8_t> data, const relativeArray<T>& array)
+	{
+		return isInRange(data, &array, array.offset, array.count, sizeof(T), alignof(T));
+	}
+
+	static bool isInRange(std::span<const uint8_t> data, const relativeString& string);
+
+private:
+	static bool isInRange(std::span<const uint8_t> data, const void* field, const int64_t offset, const uint64_t count, const size_t elementSize, const size_t alignment);
+};
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "pch.h"
+#include "scene/transformHierarchy.h"
+#include "math/vector3f.h"
+#include "math/quaternionf.h"
+#include "jobs/jobSystem.h"
+
+static uint32_t failureCount = 0;
+
+static void check(const bool condition, const char* message)
+{
+	if (!condition)
+	{
+		std::printf("FAILED: %s\n", message);
+		++failureCount;
+	}
+}
+
+static float getWorldX(const transformHierarchy& transforms, const uint32_t node)
+{
+	return transforms.getWorldMatrix(node).values[3];
+}
+
+// Destroys and reparents many nodes in one frame. Structural changes must not rebuild the depth first order themselves, the next
+// update rebuilds it once for all of them
+static void testManyStructuralChangesRebuildOnce()
+{
+	static constexpr uint32_t rootCount = 1000;
+
+	// Every root has a child one unit along x, which has a grandchild one more unit along x
+	transformHierarchy transforms;
+	std::vector<uint32_t> roots;
+	std::vector<uint32_t> children;
+	std::vector<uint32_t> grandchildren;
+	for (uint32_t i = 0; i < rootCount; ++i)
+	{
+		roots.push_back(transforms.createNode(transformHierarchy::invalidNode, vector3f(static_cast<float>(i), 0.0f, 0.0f), quaternionf(), vector3f(1.0f, 1.0f, 1.0f)));
+		children.push_back(transforms.createNode(roots.back(), vector3f(1.0f, 0.0f, 0.0f), quaternionf(), vector3f(1.0f, 1.0f, 1.0f)));
+		grandchildren.push_back(transforms.createNode(children.back(), vector3f(1.0f, 0.0f, 0.0f), quaternionf(), vector3f(1.0f, 1.0f, 1.0f)));
+	}
+	transforms.update();
+	check(transforms.getOrderRebuildCount() == 1, "creating nodes rebuilds the order once");
+
+	// Destroy the even roots with their subtrees and move the odd children under the next odd root
+	std::vector<uint32_t> destroyedNodes;
+	for (uint32_t i = 0; i < rootCount; i += 2)
+	{
+		transforms.destroyNode(roots[i], &destroyedNodes);
+	}
+	for (uint32_t i = 1; (i + 2) < rootCount; i += 2)
+	{
+		transforms.setParent(children[i], roots[i + 2]);
+	}
+	check(transforms.getOrderRebuildCount() == 1, "destroyNode and setParent do not rebuild the order");
+	check(destroyedNodes.size() == (rootCount / 2) * 3, "destroyNode reports every node of the subtree");
+	check(transforms.getNodeCount() == (rootCount / 2) * 3, "destroyed nodes are removed from the count");
+
+	transforms.update();
+	check(transforms.getOrderRebuildCount() == 2, "the next update rebuilds the order once");
+	check(transforms.getDepthFirstNodes().size() == transforms.getNodeCount(), "the rebuilt order holds every live node");
+
+	for (uint32_t i = 1; (i + 2) < rootCount; i += 2)
+	{
+		const float rootX = static_cast<float>(i + 2);
+		check(transforms.getParent(children[i]) == roots[i + 2], "setParent changes the parent");
+		check(getWorldX(transforms, children[i]) == rootX + 1.0f, "a moved child follows its new parent");
+		check(getWorldX(transforms, grandchildren[i]) == rootX + 2.0f, "a moved subtree follows its new parent");
+	}
+
+	// Destroyed ids are reused by new nodes
+	const uint32_t reused = transforms.createNode(transformHierarchy::invalidNode, vector3f(5.0f, 0.0f, 0.0f), quaternionf(), vector3f(1.0f, 1.0f, 1.0f));
+	check(std::find(destroyedNodes.begin(), destroyedNodes.end(), reused) != destroyedNodes.end(), "createNode reuses destroyed ids");
+	transforms.update();
+	check(getWorldX(transforms, reused) == 5.0f, "a reused node gets its own transform");
+}
+
+int main()
+{
+	jobSystem::init(2);
+	testManyStructuralChangesRebuildOnce();
+	jobSystem::shutdown();
+
+	if (failureCount > 0)
+	{
+		std::printf("%u checks failed\n", failureCount);
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}